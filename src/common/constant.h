@@ -89,6 +89,8 @@ class Constant {
   inline static const std::string kDocumentIndexApplyLogIdPrefix = "DOCUMENT_INDEX_APPLY_LOG";
   // Define document index snapshot max log prefix.
   inline static const std::string kDocumentIndexSnapshotLogIdPrefix = "DOCUMENT_INDEX_SNAPSHOT_LOG";
+  // Request attachment of GetVectorIndexSnapshot, only get the snapshot meta and not make checkpoint.
+  inline static const std::string kSnapshotMetaOnlyAttachment = "SNAPSHOT_META_ONLY";
 
   // Define default raft snapshot policy
   inline static const std::string kDefaultRaftSnapshotPolicy = "checkpoint";
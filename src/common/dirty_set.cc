@@ -0,0 +1,44 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/dirty_set.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "butil/scoped_lock.h"
+
+namespace dingodb {
+
+void DirtySet::Add(int64_t id) {
+  BAIDU_SCOPED_LOCK(mutex_);
+  ids_.insert(id);
+}
+
+std::vector<int64_t> DirtySet::Take() {
+  std::unordered_set<int64_t> ids;
+  {
+    BAIDU_SCOPED_LOCK(mutex_);
+    ids.swap(ids_);
+  }
+
+  return std::vector<int64_t>(ids.begin(), ids.end());
+}
+
+size_t DirtySet::Size() {
+  BAIDU_SCOPED_LOCK(mutex_);
+  return ids_.size();
+}
+
+}  // namespace dingodb
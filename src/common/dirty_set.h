@@ -0,0 +1,64 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGODB_COMMON_DIRTY_SET_H_
+#define DINGODB_COMMON_DIRTY_SET_H_
+
+#include <atomic>
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+#include "bthread/mutex.h"
+
+namespace dingodb {
+
+// Dirty flag of one index, the write path only do an atomic exchange,
+// and the id is put into the DirtySet just when the flag turn from clean to dirty.
+class DirtyFlag {
+ public:
+  DirtyFlag() = default;
+  ~DirtyFlag() = default;
+
+  // Return true if turn from clean to dirty.
+  bool Mark() { return !is_dirty_.exchange(true, std::memory_order_acq_rel); }
+  void Clear() { is_dirty_.store(false, std::memory_order_release); }
+  bool IsDirty() const { return is_dirty_.load(std::memory_order_acquire); }
+
+ private:
+  std::atomic<bool> is_dirty_{false};
+};
+
+// Dirty index id set, scrub only need to check the dirty index.
+class DirtySet {
+ public:
+  DirtySet() = default;
+  ~DirtySet() = default;
+
+  DirtySet(const DirtySet&) = delete;
+  DirtySet& operator=(const DirtySet&) = delete;
+
+  void Add(int64_t id);
+  // Take all dirty id, the set is empty after take.
+  std::vector<int64_t> Take();
+  size_t Size();
+
+ private:
+  bthread::Mutex mutex_;
+  std::unordered_set<int64_t> ids_;
+};
+
+}  // namespace dingodb
+
+#endif  // DINGODB_COMMON_DIRTY_SET_H_
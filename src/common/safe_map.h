@@ -158,6 +158,27 @@ class DingoSafeMap {
     return values.size();
   }
 
+  // Traverse
+  // visit all key-value of the current foreground version in place, without copy value out,
+  // the visitor return false to stop traverse, return the visited count.
+  // the visitor run with the read lock of the map held, so it must not modify this map.
+  int Traverse(const std::function<bool(const T_KEY &, const T_VALUE &)> &visitor) {
+    TypeScopedPtr ptr;
+    if (safe_map.Read(&ptr) != 0) {
+      return -1;
+    }
+
+    int count = 0;
+    for (typename TypeRawMap::const_iterator it = ptr->begin(); it != ptr->end(); ++it) {
+      ++count;
+      if (!visitor(it->first, it->second)) {
+        break;
+      }
+    }
+
+    return count;
+  }
+
   // GetAllKeyValues
   // get all keys and values of the map
   int GetAllKeyValues(std::vector<T_KEY> &keys, std::vector<T_VALUE> &values,
@@ -641,6 +662,27 @@ class DingoSafeStdMap {
     return values.size();
   }
 
+  // Traverse
+  // visit all key-value in key order in place, without copy value out,
+  // the visitor return false to stop traverse, return the visited count.
+  // the visitor run with the read lock of the map held, so it must not modify this map.
+  int Traverse(const std::function<bool(const T_KEY &, const T_VALUE &)> &visitor) {
+    TypeScopedPtr ptr;
+    if (safe_map.Read(&ptr) != 0) {
+      return -1;
+    }
+
+    int count = 0;
+    for (auto it = ptr->begin(); it != ptr->end(); ++it) {
+      ++count;
+      if (!visitor(it->first, it->second)) {
+        break;
+      }
+    }
+
+    return count;
+  }
+
   // GetAllKeyValues
   // get all keys and values of the map
   int GetAllKeyValues(std::vector<T_KEY> &keys, std::vector<T_VALUE> &values,
@@ -733,6 +775,27 @@ class DingoSafeStdMap {
     return values.size();
   }
 
+  // TraverseRange
+  // visit the key-value of range [lower_bound, upper_bound) by const reference, without copy value out,
+  // the visitor return false to stop traverse, return the visited count
+  int TraverseRange(const T_KEY &lower_bound, const T_KEY &upper_bound,
+                    const std::function<bool(const T_KEY &, const T_VALUE &)> &visitor) {
+    TypeScopedPtr ptr;
+    if (safe_map.Read(&ptr) != 0) {
+      return -1;
+    }
+
+    int count = 0;
+    for (auto it = ptr->lower_bound(lower_bound); it != ptr->end() && it->first < upper_bound; ++it) {
+      ++count;
+      if (!visitor(it->first, it->second)) {
+        break;
+      }
+    }
+
+    return count;
+  }
+
   // FinIntervalValues
   // The real range is [lower_bound, upper_bound)
   int FindIntervalValues(std::vector<T_VALUE> &values, T_KEY lower_bound, T_KEY upper_bound,
@@ -22,6 +22,7 @@
 #include "brpc/controller.h"
 #include "bthread/mutex.h"
 #include "butil/status.h"
+#include "common/constant.h"
 #include "common/helper.h"
 #include "common/logging.h"
 #include "fmt/core.h"
@@ -189,9 +190,9 @@ butil::Status ServiceAccess::InstallVectorIndexSnapshot(const pb::node::InstallV
   return butil::Status();
 }
 
-butil::Status ServiceAccess::GetVectorIndexSnapshot(const pb::node::GetVectorIndexSnapshotRequest& request,
-                                                    const butil::EndPoint& endpoint,
-                                                    pb::node::GetVectorIndexSnapshotResponse& response) {
+static butil::Status SendGetVectorIndexSnapshot(const pb::node::GetVectorIndexSnapshotRequest& request,
+                                                const butil::EndPoint& endpoint, bool meta_only,
+                                                pb::node::GetVectorIndexSnapshotResponse& response) {
   auto channel = ChannelPool::GetInstance().GetChannel(endpoint);
   if (channel == nullptr) {
     return butil::Status(pb::error::EINTERNAL, "Get channel failed, endpoint: %s",
@@ -200,6 +201,9 @@ butil::Status ServiceAccess::GetVectorIndexSnapshot(const pb::node::GetVectorInd
 
   brpc::Controller cntl;
   cntl.set_timeout_ms(6000);
+  if (meta_only) {
+    cntl.request_attachment().append(Constant::kSnapshotMetaOnlyAttachment);
+  }
   pb::node::NodeService_Stub stub(channel.get());
 
   stub.GetVectorIndexSnapshot(&cntl, &request, &response, nullptr);
@@ -221,6 +225,18 @@ butil::Status ServiceAccess::GetVectorIndexSnapshot(const pb::node::GetVectorInd
   return butil::Status();
 }
 
+butil::Status ServiceAccess::GetVectorIndexSnapshot(const pb::node::GetVectorIndexSnapshotRequest& request,
+                                                    const butil::EndPoint& endpoint,
+                                                    pb::node::GetVectorIndexSnapshotResponse& response) {
+  return SendGetVectorIndexSnapshot(request, endpoint, false, response);
+}
+
+butil::Status ServiceAccess::GetVectorIndexSnapshotMeta(const pb::node::GetVectorIndexSnapshotRequest& request,
+                                                        const butil::EndPoint& endpoint,
+                                                        pb::node::GetVectorIndexSnapshotResponse& response) {
+  return SendGetVectorIndexSnapshot(request, endpoint, true, response);
+}
+
 butil::Status ServiceAccess::CheckVectorIndex(const pb::node::CheckVectorIndexRequest& request,
                                               const butil::EndPoint& endpoint,
                                               pb::node::CheckVectorIndexResponse& response) {
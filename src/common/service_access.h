@@ -63,6 +63,10 @@ class ServiceAccess {
   static butil::Status GetVectorIndexSnapshot(const pb::node::GetVectorIndexSnapshotRequest& request,
                                               const butil::EndPoint& endpoint,
                                               pb::node::GetVectorIndexSnapshotResponse& response);
+  // Only get the snapshot meta, the peer not make checkpoint for it.
+  static butil::Status GetVectorIndexSnapshotMeta(const pb::node::GetVectorIndexSnapshotRequest& request,
+                                                  const butil::EndPoint& endpoint,
+                                                  pb::node::GetVectorIndexSnapshotResponse& response);
 
   static butil::Status CheckVectorIndex(const pb::node::CheckVectorIndexRequest& request,
                                         const butil::EndPoint& endpoint, pb::node::CheckVectorIndexResponse& response);
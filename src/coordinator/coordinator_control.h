@@ -21,6 +21,7 @@
 #include <memory>
 #include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "bthread/types.h"
@@ -29,6 +30,7 @@
 #include "common/meta_control.h"
 #include "common/safe_map.h"
 #include "coordinator/coordinator_meta_storage.h"
+#include "coordinator/entity_metrics_aggregator.h"
 #include "engine/engine.h"
 #include "engine/snapshot.h"
 #include "google/protobuf/stubs/callback.h"
@@ -503,6 +505,9 @@ class CoordinatorControl : public MetaControl {
   // return bool
   bool TrySetStoreToOffline(int64_t store_id);
 
+  // reset last_seen_timestamp of all stores to now, called on leader start
+  void ResetStoreLiveness();
+
   static std::mt19937 GetUrbg();
 
   // get storemap
@@ -527,10 +532,22 @@ class CoordinatorControl : public MetaControl {
   static bool CheckStoreOperationResult(pb::coordinator::RegionCmdType cmd_type, pb::error::Errno errcode);
   void SendStoreOperation(const pb::common::Store &store, const pb::coordinator::StoreOperation &store_operation,
                           pb::coordinator_internal::MetaIncrement &meta_increment);
+  // send store operations concurrently, one batched rpc for each store
+  void SendStoreOperations(
+      const std::vector<std::pair<pb::common::Store, pb::coordinator::StoreOperation>> &store_operations,
+      pb::coordinator_internal::MetaIncrement &meta_increment);
+  void HandleStoreOperationResult(const pb::common::Store &store,
+                                  const pb::coordinator::StoreOperation &store_operation, const butil::Status &status,
+                                  const pb::push::PushStoreOperationResponse &response,
+                                  pb::coordinator_internal::MetaIncrement &meta_increment);
   void TryToSendStoreOperations();
   static butil::Status RpcSendPushStoreOperation(const pb::common::Location &location,
                                                  pb::push::PushStoreOperationRequest &request,
                                                  pb::push::PushStoreOperationResponse &response);
+  static void RpcSendPushStoreOperations(const std::vector<pb::common::Location> &locations,
+                                         std::vector<pb::push::PushStoreOperationRequest> &requests,
+                                         std::vector<pb::push::PushStoreOperationResponse> &responses,
+                                         std::vector<butil::Status> &statuses);
 
   // get store operation
   int GetStoreOperation(int64_t store_id, pb::coordinator::StoreOperation &store_operation);
@@ -774,6 +791,13 @@ class CoordinatorControl : public MetaControl {
   // calculate single index metrics
   int64_t CalculateIndexMetricsSingle(int64_t index_id, pb::meta::IndexMetrics &index_metrics);
 
+  // get table/index metrics from entity_metrics_aggregator_, return -1 if not found
+  int64_t GetTableMetricsFromAggregator(int64_t table_id, pb::meta::TableMetrics &table_metrics);
+  int64_t GetIndexMetricsFromAggregator(int64_t index_id, pb::meta::IndexMetrics &index_metrics);
+
+  // rebuild entity_metrics_aggregator_ from region_metrics_map_ periodically
+  void RebuildEntityMetricsIfNeeded();
+
   // functions below are for raft fsm
   bool IsLeader() override;                                            // for raft fsm
   void SetLeaderTerm(int64_t term) override;                           // for raft fsm
@@ -998,6 +1022,9 @@ class CoordinatorControl : public MetaControl {
 
   // 8.table_metrics
   DingoSafeMap<int64_t, pb::coordinator_internal::TableMetricsInternal> table_metrics_map_;
+  // table and index metrics aggregated from region metrics, updated by heartbeat delta
+  EntityMetricsAggregator entity_metrics_aggregator_;
+  int64_t last_entity_metrics_rebuild_ms_{0};
 
   // 9.store_operation
   DingoSafeMap<int64_t, pb::coordinator_internal::StoreOperationInternal> store_operation_map_;
@@ -19,11 +19,15 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <map>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "braft/configuration.h"
+#include "brpc/callback.h"
+#include "brpc/controller.h"
 #include "butil/containers/flat_map.h"
 #include "butil/scoped_lock.h"
 #include "butil/status.h"
@@ -31,6 +35,7 @@
 #include "common/constant.h"
 #include "common/helper.h"
 #include "common/logging.h"
+#include "common/service_access.h"
 #include "config/config_helper.h"
 #include "coordinator/coordinator_control.h"
 #include "fmt/core.h"
@@ -74,6 +79,14 @@ DECLARE_int64(max_hnsw_memory_size_of_region);
 DECLARE_int32(max_hnsw_nlinks_of_region);
 
 DEFINE_int32(max_send_region_cmd_per_store, 100, "max send region cmd per store");
+DEFINE_int64(coordinator_push_store_operation_timeout_ms, 10000, "timeout ms of one push store operation rpc");
+DEFINE_int64(coordinator_push_store_operation_deadline_ms, 30000,
+             "deadline ms of push store operation to all stores include retry");
+DEFINE_int32(coordinator_push_store_operation_max_retry_times, 3, "max retry times of push store operation rpc");
+DEFINE_int32(coordinator_task_list_process_concurrency, 8, "concurrency of process task list in one round");
+DEFINE_int32(coordinator_task_list_max_process_per_round, 1024, "max task list to advance in one round");
+DEFINE_int32(coordinator_task_list_max_pending_region_cmd_per_store, 256,
+             "max pending region cmd of one store, the task list is deferred when its store exceed the limit");
 
 DEFINE_int64(max_region_count, 40000, "max region of dingo");
 
@@ -340,6 +353,7 @@ void CoordinatorControl::DeleteRegionMetrics(int64_t region_id) {
   }
 
   region_metrics_map_.Erase(region_id);
+  entity_metrics_aggregator_.RemoveRegion(region_id);
 }
 
 butil::Status CoordinatorControl::GetOrphanRegion(int64_t store_id,
@@ -554,8 +568,9 @@ int64_t CoordinatorControl::UpdateStoreMap(const pb::common::Store& store,
                  store_to_update.resource_tag() != store.resource_tag() ||
                  store_to_update.keyring() != store.keyring() ||
                  store_to_update.leader_num_weight() != store.leader_num_weight()) {
-        // this is normal heartbeat, with state change or location change
-        // so only need to update state & last_seen_timestamp, no need to update epoch
+        // this is normal heartbeat, with location or resource_tag change
+        // this is a structural change, so update epoch to let other stores pull the new store map
+        need_update_epoch = true;
         auto* store_increment = meta_increment.add_stores();
         store_increment->set_id(store.id());
         store_increment->set_op_type(::dingodb::pb::coordinator_internal::MetaIncrementOpType::UPDATE);
@@ -572,8 +587,25 @@ int64_t CoordinatorControl::UpdateStoreMap(const pb::common::Store& store,
         // only update state & last_seen_timestamp
         store_increment_store->set_state(pb::common::StoreState::STORE_NORMAL);
         store_increment_store->set_last_seen_timestamp(butil::gettimeofday_ms());
+      } else if (store_to_update.state() != pb::common::StoreState::STORE_NORMAL) {
+        // this is normal heartbeat of an offline store, the store is back online
+        // the state change must be seen by other stores, so update epoch and write it through raft
+        DINGO_LOG(INFO) << "STORE STATUS CHANGE store_id = " << store.id()
+                        << " old status = " << pb::common::StoreState_Name(store_to_update.state())
+                        << " new status = STORE_NORMAL";
+
+        need_update_epoch = true;
+        auto* store_increment = meta_increment.add_stores();
+        store_increment->set_id(store.id());
+        store_increment->set_op_type(::dingodb::pb::coordinator_internal::MetaIncrementOpType::UPDATE);
+
+        auto* store_increment_store = store_increment->mutable_store();
+        *store_increment_store = store_to_update;
+        store_increment_store->set_state(pb::common::StoreState::STORE_NORMAL);
+        store_increment_store->set_last_seen_timestamp(butil::gettimeofday_ms());
       } else {
         // this is normal heartbeat, with no state change and no location change
+        // the last_seen_timestamp is soft state only kept in leader memory, not go through raft
         store_to_update.set_last_seen_timestamp(butil::gettimeofday_ms());
         store_to_update.set_state(pb::common::StoreState::STORE_NORMAL);
         auto ret = store_map_.Put(store_to_update.id(), store_to_update);
@@ -608,10 +640,10 @@ int64_t CoordinatorControl::UpdateStoreMap(const pb::common::Store& store,
   }
 
   if (need_update_epoch) {
-    GetNextId(pb::coordinator::IdEpochType::EPOCH_STORE, meta_increment);
+    store_map_epoch = GetNextId(pb::coordinator::IdEpochType::EPOCH_STORE, meta_increment);
   }
 
-  DINGO_LOG(INFO) << "UpdateStoreMap store_id=" << store.id();
+  DINGO_LOG(INFO) << "UpdateStoreMap store_id=" << store.id() << ", store_map_epoch=" << store_map_epoch;
 
   return store_map_epoch;
 }
@@ -647,6 +679,24 @@ bool CoordinatorControl::TrySetRegionToOnline(int64_t region_id) {
   return false;
 }
 
+void CoordinatorControl::ResetStoreLiveness() {
+  std::vector<int64_t> store_ids;
+  store_map_.GetAllKeys(store_ids);
+
+  auto now_ms = butil::gettimeofday_ms();
+  for (auto store_id : store_ids) {
+    pb::common::Store store;
+    if (store_map_.Get(store_id, store) < 0) {
+      continue;
+    }
+
+    store.set_last_seen_timestamp(now_ms);
+    store_map_.PutIfExists(store_id, store);
+  }
+
+  DINGO_LOG(INFO) << "ResetStoreLiveness store_count=" << store_ids.size() << ", now_ms=" << now_ms;
+}
+
 bool CoordinatorControl::TrySetStoreToOffline(int64_t store_id) {
   pb::common::Store store_to_update;
   int ret = store_map_.Get(store_id, store_to_update);
@@ -654,8 +704,28 @@ bool CoordinatorControl::TrySetStoreToOffline(int64_t store_id) {
     if (store_to_update.state() == pb::common::StoreState::STORE_NORMAL &&
         store_to_update.last_seen_timestamp() + (FLAGS_store_heartbeat_timeout * 1000) < butil::gettimeofday_ms()) {
       // update store's state to STORE_OFFLINE
-      store_to_update.set_state(pb::common::StoreState::STORE_OFFLINE);
-      store_map_.Put(store_id, store_to_update);
+      // the state change must be seen by other stores, which only pull the store map when epoch changed,
+      // so write it through raft with a new store map epoch
+      pb::coordinator_internal::MetaIncrement meta_increment;
+      auto* store_increment = meta_increment.add_stores();
+      store_increment->set_id(store_id);
+      store_increment->set_op_type(::dingodb::pb::coordinator_internal::MetaIncrementOpType::UPDATE);
+
+      auto* store_increment_store = store_increment->mutable_store();
+      *store_increment_store = store_to_update;
+      store_increment_store->set_state(pb::common::StoreState::STORE_OFFLINE);
+
+      auto store_map_epoch = GetNextId(pb::coordinator::IdEpochType::EPOCH_STORE, meta_increment);
+
+      auto ret1 = SubmitMetaIncrementSync(meta_increment);
+      if (!ret1.ok()) {
+        DINGO_LOG(ERROR) << "TrySetStoreToOffline SubmitMetaIncrementSync failed, store_id=" << store_id
+                         << ", errcode: " << ret1.error_code() << ", errmsg: " << ret1.error_str();
+        return false;
+      }
+
+      DINGO_LOG(INFO) << "STORE STATUS CHANGE store_id = " << store_id << " new status = STORE_OFFLINE"
+                      << ", store_map_epoch=" << store_map_epoch;
       return true;
     }
   }
@@ -1254,6 +1324,7 @@ void CoordinatorControl::RecycleOrphanRegionOnStore() {
 
     // delete region_metrics
     region_metrics_map_.Erase(region.first);
+    entity_metrics_aggregator_.RemoveRegion(region.first);
   }
 
   if (meta_increment.ByteSizeLong() > 0) {
@@ -1269,18 +1340,10 @@ void CoordinatorControl::RecycleOrphanRegionOnCoordinator() {
     return;
   }
 
-  butil::FlatMap<int64_t, pb::coordinator_internal::RegionInternal> regions;
-  regions.init(3000);
-  region_map_.GetRawMapCopy(regions);
-
-  if (regions.empty()) {
-    DINGO_LOG(DEBUG) << "No region to recycle";
-    return;
-  }
-
   std::vector<int64_t> delete_region_ids;
-  for (const auto& it : regions) {
-    const auto& region = it.second;
+  auto region_count = region_map_.Traverse([this, &delete_region_ids](
+                                               const int64_t& /*region_id*/,
+                                               const pb::coordinator_internal::RegionInternal& region) -> bool {
     if (region.definition().table_id() > 0) {
       auto exists = deleted_table_meta_->Exists(region.definition().table_id());
       if (exists) {
@@ -1300,6 +1363,12 @@ void CoordinatorControl::RecycleOrphanRegionOnCoordinator() {
                       << " table_id: " << region.definition().table_id()
                       << " index_id: " << region.definition().index_id() << " is not table or index";
     }
+    return true;
+  });
+
+  if (region_count <= 0) {
+    DINGO_LOG(DEBUG) << "No region to recycle";
+    return;
   }
 
   pb::coordinator_internal::MetaIncrement meta_increment;
@@ -1312,12 +1381,17 @@ void CoordinatorControl::RecycleOrphanRegionOnCoordinator() {
     SubmitMetaIncrementSync(meta_increment);
 
     // clear up region_metrics
-    std::vector<int64_t> region_ids_in_metrics;
-    region_metrics_map_.GetAllKeys(region_ids_in_metrics);
-    for (auto region_id : region_ids_in_metrics) {
-      if (!region_map_.Exists(region_id)) {
-        region_metrics_map_.Erase(region_id);
-      }
+    std::vector<int64_t> orphan_region_ids;
+    region_metrics_map_.Traverse(
+        [this, &orphan_region_ids](const int64_t& region_id, const pb::common::RegionMetrics& /*region_metrics*/) {
+          if (!region_map_.Exists(region_id)) {
+            orphan_region_ids.push_back(region_id);
+          }
+          return true;
+        });
+    for (auto region_id : orphan_region_ids) {
+      region_metrics_map_.Erase(region_id);
+      entity_metrics_aggregator_.RemoveRegion(region_id);
     }
   }
 }
@@ -1966,13 +2040,11 @@ butil::Status CoordinatorControl::CreateShadowRegion(
   }
 
   // select store for region
-  butil::FlatMap<int64_t, pb::common::Store> store_map_copy;
-  store_map_copy.init(100);
-  store_map_.GetRawMapCopy(store_map_copy);
   selected_stores_for_regions.reserve(store_ids.size());
   for (auto id : store_ids) {
-    if (store_map_copy.seek(id) != nullptr) {
-      selected_stores_for_regions.push_back(store_map_copy[id]);
+    pb::common::Store store;
+    if (store_map_.Get(id, store) > 0) {
+      selected_stores_for_regions.push_back(store);
     }
   }
   if (selected_stores_for_regions.size() != store_ids.size()) {
@@ -3403,98 +3475,87 @@ butil::Status CoordinatorControl::TransferLeaderRegionWithTaskList(
 }
 
 butil::Status CoordinatorControl::ValidateTaskListConflict(int64_t region_id, int64_t second_region_id) {
-  // check task_list conflict
-  butil::FlatMap<int64_t, pb::coordinator::TaskList> task_list_map_temp;
-  task_list_map_temp.init(1000);
-  int ret = task_list_map_.GetRawMapCopy(task_list_map_temp);
-  if (ret < 0) {
-    DINGO_LOG(ERROR) << "ValidateTaskListConflict task_list_map_.GetRawMapCopy "
-                        "failed, region_id = "
-                     << region_id;
-    return butil::Status(pb::error::Errno::EINTERNAL, "ValidateTaskListConflict task_list_map_.GetRawMapCopy failed");
-  }
+  auto is_conflict = [region_id, second_region_id](const pb::coordinator::RegionCmd& region_cmd) -> bool {
+    if (region_cmd.region_id() == region_id || region_cmd.region_id() == second_region_id) {
+      return true;
+    } else if (region_cmd.region_cmd_type() == pb::coordinator::CMD_MERGE) {
+      if (region_cmd.merge_request().source_region_id() == region_id ||
+          region_cmd.merge_request().source_region_id() == second_region_id ||
+          region_cmd.merge_request().target_region_id() == region_id ||
+          region_cmd.merge_request().target_region_id() == second_region_id) {
+        return true;
+      }
+    } else if (region_cmd.region_cmd_type() == pb::coordinator::CMD_SPLIT) {
+      if (region_cmd.split_request().split_from_region_id() == region_id ||
+          region_cmd.split_request().split_from_region_id() == second_region_id ||
+          region_cmd.split_request().split_to_region_id() == region_id ||
+          region_cmd.split_request().split_to_region_id() == second_region_id) {
+        return true;
+      }
+    }
+    return false;
+  };
 
-  for (const auto& task_list : task_list_map_temp) {
-    for (const auto& task : task_list.second.tasks()) {
+  // check task_list conflict, traverse in place and stop at the first conflict
+  bool task_list_conflict = false;
+  int ret = task_list_map_.Traverse([&is_conflict, &task_list_conflict](const int64_t& /*task_list_id*/,
+                                                                        const pb::coordinator::TaskList& task_list) {
+    for (const auto& task : task_list.tasks()) {
       for (const auto& store_operation : task.store_operations()) {
         for (const auto& region_cmd : store_operation.region_cmds()) {
-          bool is_conflict = false;
-          if (region_cmd.region_id() == region_id || region_cmd.region_id() == second_region_id) {
-            is_conflict = true;
-          } else if (region_cmd.region_cmd_type() == pb::coordinator::CMD_MERGE) {
-            if (region_cmd.merge_request().source_region_id() == region_id ||
-                region_cmd.merge_request().source_region_id() == second_region_id ||
-                region_cmd.merge_request().target_region_id() == region_id ||
-                region_cmd.merge_request().target_region_id() == second_region_id) {
-              is_conflict = true;
-            }
-          } else if (region_cmd.region_cmd_type() == pb::coordinator::CMD_SPLIT) {
-            if (region_cmd.split_request().split_from_region_id() == region_id ||
-                region_cmd.split_request().split_from_region_id() == second_region_id ||
-                region_cmd.split_request().split_to_region_id() == region_id ||
-                region_cmd.split_request().split_to_region_id() == second_region_id) {
-              is_conflict = true;
-            }
-          }
-
-          if (is_conflict) {
-            std::string s = fmt::format("ValidateTaskListConflict task_list conflict, region_id = {}", region_id);
-            DINGO_LOG(ERROR) << s;
-            return butil::Status(pb::error::Errno::ETASK_LIST_CONFLICT, s);
+          if (is_conflict(region_cmd)) {
+            task_list_conflict = true;
+            return false;
           }
         }
       }
     }
+    return true;
+  });
+  if (ret < 0) {
+    DINGO_LOG(ERROR) << "ValidateTaskListConflict task_list_map_.Traverse "
+                        "failed, region_id = "
+                     << region_id;
+    return butil::Status(pb::error::Errno::EINTERNAL, "ValidateTaskListConflict task_list_map_.Traverse failed");
+  }
+  if (task_list_conflict) {
+    std::string s = fmt::format("ValidateTaskListConflict task_list conflict, region_id = {}", region_id);
+    DINGO_LOG(ERROR) << s;
+    return butil::Status(pb::error::Errno::ETASK_LIST_CONFLICT, s);
   }
 
   // check store operation conflict
-  butil::FlatMap<int64_t, pb::coordinator_internal::StoreOperationInternal> store_operation_map_temp;
-  store_operation_map_temp.init(1000);
-  ret = store_operation_map_.GetRawMapCopy(store_operation_map_temp);
+  bool store_operation_conflict = false;
+  ret = store_operation_map_.Traverse(
+      [this, &is_conflict, &store_operation_conflict](
+          const int64_t& /*store_id*/, const pb::coordinator_internal::StoreOperationInternal& store_operation) {
+        for (auto region_cmd_id : store_operation.region_cmd_ids()) {
+          pb::coordinator_internal::RegionCmdInternal region_cmd_internal;
+          auto ret = region_cmd_map_.Get(region_cmd_id, region_cmd_internal);
+          if (ret < 0) {
+            continue;
+          }
+
+          if (is_conflict(region_cmd_internal.region_cmd())) {
+            store_operation_conflict = true;
+            return false;
+          }
+        }
+        return true;
+      });
   if (ret < 0) {
-    DINGO_LOG(ERROR) << "ValidateTaskListConflict store_operation_map_.GetRawMapCopy "
+    DINGO_LOG(ERROR) << "ValidateTaskListConflict store_operation_map_.Traverse "
                         "failed, region_id = "
                      << region_id;
     return butil::Status(pb::error::Errno::EINTERNAL,
-                         "ValidateTaskListConflict store_operation_map_.GetRawMapCopy "
+                         "ValidateTaskListConflict store_operation_map_.Traverse "
                          "failed, region_id = " +
                              std::to_string(region_id));
   }
-
-  for (const auto& store_operation : store_operation_map_temp) {
-    for (auto region_cmd_id : store_operation.second.region_cmd_ids()) {
-      pb::coordinator_internal::RegionCmdInternal region_cmd_internal;
-      auto ret = region_cmd_map_.Get(region_cmd_id, region_cmd_internal);
-      if (ret < 0) {
-        continue;
-      }
-      const auto& region_cmd = region_cmd_internal.region_cmd();
-
-      bool is_conflict = false;
-      if (region_cmd.region_id() == region_id || region_cmd.region_id() == second_region_id) {
-        is_conflict = true;
-      } else if (region_cmd.region_cmd_type() == pb::coordinator::CMD_MERGE) {
-        if (region_cmd.merge_request().source_region_id() == region_id ||
-            region_cmd.merge_request().source_region_id() == second_region_id ||
-            region_cmd.merge_request().target_region_id() == region_id ||
-            region_cmd.merge_request().target_region_id() == second_region_id) {
-          is_conflict = true;
-        }
-      } else if (region_cmd.region_cmd_type() == pb::coordinator::CMD_SPLIT) {
-        if (region_cmd.split_request().split_from_region_id() == region_id ||
-            region_cmd.split_request().split_from_region_id() == second_region_id ||
-            region_cmd.split_request().split_to_region_id() == region_id ||
-            region_cmd.split_request().split_to_region_id() == second_region_id) {
-          is_conflict = true;
-        }
-      }
-
-      if (is_conflict) {
-        std::string s = fmt::format("ValidateTaskListConflict store_operation conflict, region_id = {}", region_id);
-        DINGO_LOG(ERROR) << s;
-        return butil::Status(pb::error::Errno::ESTORE_OPERATION_CONFLICT, s);
-      }
-    }
+  if (store_operation_conflict) {
+    std::string s = fmt::format("ValidateTaskListConflict store_operation conflict, region_id = {}", region_id);
+    DINGO_LOG(ERROR) << s;
+    return butil::Status(pb::error::Errno::ESTORE_OPERATION_CONFLICT, s);
   }
 
   return butil::Status::OK();
@@ -4256,6 +4317,7 @@ void CoordinatorControl::UpdateRegionMapAndStoreOperation(const pb::common::Stor
       region_metrics_to_update = region_metrics;
       *(region_metrics_to_update.mutable_region_status()) = GenRegionStatus(region_metrics);
       region_metrics_map_.Put(region_metrics.id(), region_metrics_to_update);
+      entity_metrics_aggregator_.UpdateRegion(region_metrics_to_update);
 
       DINGO_LOG(INFO) << "region_metrics_to_update is first time put into region_metrics_map_, region_id = "
                       << region_metrics.id() << ", from store_id: " << store_metrics.id();
@@ -4446,6 +4508,8 @@ void CoordinatorControl::UpdateRegionMapAndStoreOperation(const pb::common::Stor
       *(region_metrics_to_update.mutable_region_status()) = region_status_to_update;
 
       region_metrics_map_.Put(region_metrics.id(), region_metrics_to_update);
+      // apply the delta of region to table/index metrics
+      entity_metrics_aggregator_.UpdateRegion(region_metrics_to_update);
 
       DINGO_LOG(DEBUG) << "UpdateRegionMapAndStoreOperation region_metrics_map_ update region_id = "
                        << region_metrics.id() << " last_update_timestamp = "
@@ -5496,27 +5560,133 @@ butil::Status CoordinatorControl::ProcessTaskList() {
 
   AtomicGuard atomic_guard(is_processing_task_list_);
 
-  butil::FlatMap<int64_t, pb::coordinator::TaskList> task_list_map;
-  task_list_map.init(100);
-  auto ret = task_list_map_.GetRawMapCopy(task_list_map);
+  int64_t start_time_ms = Helper::TimestampMs();
+
+  // pending region cmd count of every store, used to limit the region cmd in flight of one store
+  std::map<int64_t, int64_t> store_pending_region_cmd_count;
+  store_operation_map_.Traverse(
+      [&store_pending_region_cmd_count](const int64_t& store_id,
+                                        const pb::coordinator_internal::StoreOperationInternal& store_operation) {
+        store_pending_region_cmd_count[store_id] = store_operation.region_cmd_ids_size();
+        return true;
+      });
+
+  // select the task lists to advance in this round, the task list is independent of each other,
+  // the older task list(smaller id) is prior, the task list whose store is overloaded is deferred to next round
+  std::vector<pb::coordinator::TaskList> task_lists;
+  auto ret = task_list_map_.Traverse([&task_lists](const int64_t&, const pb::coordinator::TaskList& task_list) {
+    task_lists.push_back(task_list);
+    return true;
+  });
   if (ret < 0) {
-    DINGO_LOG(ERROR) << "task_list_map_.GetRawMapCopy failed";
-    return butil::Status(pb::error::EINTERNAL, "task_list_map_.GetRawMapCopy failed");
+    DINGO_LOG(ERROR) << "task_list_map_.Traverse failed";
+    return butil::Status(pb::error::EINTERNAL, "task_list_map_.Traverse failed");
   }
 
-  if (task_list_map.empty()) {
+  if (task_lists.empty()) {
     DINGO_LOG(DEBUG) << "task_list_map is empty";
     return butil::Status::OK();
   }
 
-  pb::coordinator_internal::MetaIncrement meta_increment;
+  std::sort(task_lists.begin(), task_lists.end(),
+            [](const pb::coordinator::TaskList& a, const pb::coordinator::TaskList& b) { return a.id() < b.id(); });
 
-  for (const auto& it : task_list_map) {
-    const auto& task_list = it.second;
+  std::vector<const pb::coordinator::TaskList*> selected_task_lists;
+  int64_t deferred_count = 0;
+  for (const auto& task_list : task_lists) {
+    if (selected_task_lists.size() >= FLAGS_coordinator_task_list_max_process_per_round) {
+      deferred_count = task_lists.size() - selected_task_lists.size();
+      break;
+    }
+
+    if (task_list.next_step() < task_list.tasks_size()) {
+      const auto& task = task_list.tasks(task_list.next_step());
 
-    ProcessSingleTaskList(task_list, meta_increment);
+      bool is_overload = false;
+      for (const auto& store_operation : task.store_operations()) {
+        auto it = store_pending_region_cmd_count.find(store_operation.id());
+        int64_t pending_count = it == store_pending_region_cmd_count.end() ? 0 : it->second;
+        // a task with more cmds than the limit is still allowed on an idle store, or it will never advance
+        if (pending_count > 0 && pending_count + store_operation.region_cmds_size() >
+                                     FLAGS_coordinator_task_list_max_pending_region_cmd_per_store) {
+          is_overload = true;
+          break;
+        }
+      }
+
+      if (is_overload) {
+        DINGO_LOG(INFO) << "store is overload, defer task_list to next round, task_list_id=" << task_list.id();
+        ++deferred_count;
+        continue;
+      }
+
+      for (const auto& store_operation : task.store_operations()) {
+        store_pending_region_cmd_count[store_operation.id()] += store_operation.region_cmds_size();
+      }
+    }
+
+    selected_task_lists.push_back(&task_list);
   }
 
+  // advance the selected task lists concurrently, every task list generate its own meta_increment,
+  // and only the meta_increment of success task list is merged, so a failed task list is not partially applied
+  struct Parameter {
+    CoordinatorControl* coordinator_control;
+    std::vector<const pb::coordinator::TaskList*> task_lists;
+    std::vector<pb::coordinator_internal::MetaIncrement> meta_increments;
+    std::vector<butil::Status> statuses;
+    std::atomic<int> offset{0};
+  };
+
+  auto param = std::make_shared<Parameter>();
+  param->coordinator_control = this;
+  param->task_lists.swap(selected_task_lists);
+  param->meta_increments.resize(param->task_lists.size());
+  param->statuses.resize(param->task_lists.size());
+
+  auto task = [](void* arg) -> void* {
+    auto* param = static_cast<Parameter*>(arg);
+
+    for (;;) {
+      int offset = param->offset.fetch_add(1, std::memory_order_relaxed);
+      if (offset >= param->task_lists.size()) {
+        break;
+      }
+
+      param->statuses[offset] = param->coordinator_control->ProcessSingleTaskList(*param->task_lists[offset],
+                                                                                  param->meta_increments[offset]);
+    }
+
+    return nullptr;
+  };
+
+  int concurrency = std::min(static_cast<int>(param->task_lists.size()),
+                             std::max(FLAGS_coordinator_task_list_process_concurrency, 1));
+  if (concurrency <= 1) {
+    task(param.get());
+  } else if (!Helper::ParallelRunTask(task, param.get(), concurrency)) {
+    DINGO_LOG(ERROR) << "ParallelRunTask process task list failed";
+    return butil::Status(pb::error::EINTERNAL, "ParallelRunTask process task list failed");
+  }
+
+  // coalesce all state transitions of this round into one meta_increment
+  pb::coordinator_internal::MetaIncrement meta_increment;
+  int64_t failed_count = 0;
+  for (size_t i = 0; i < param->task_lists.size(); ++i) {
+    if (!param->statuses[i].ok()) {
+      DINGO_LOG(ERROR) << "ProcessSingleTaskList failed, task_list_id=" << param->task_lists[i]->id()
+                       << ", error=" << param->statuses[i].error_str();
+      ++failed_count;
+      continue;
+    }
+
+    meta_increment.MergeFrom(param->meta_increments[i]);
+  }
+
+  DINGO_LOG_IF(INFO, !param->task_lists.empty())
+      << fmt::format("process task list, total={} processed={} deferred={} failed={} cost={}ms", task_lists.size(),
+                     param->task_lists.size(), deferred_count, failed_count, Helper::TimestampMs() - start_time_ms);
+
   if (meta_increment.ByteSizeLong() == 0) {
     return butil::Status::OK();
   }
@@ -5881,12 +6051,7 @@ bool CoordinatorControl::CheckStoreOperationResult(pb::coordinator::RegionCmdTyp
 
 /**
  * The `SendStoreOperation` function is responsible for sending a store operation to a specific store in the system.
- * It first checks the state of the store. If the store is in a normal state and its last seen timestamp is within the
- * heartbeat timeout, it proceeds with sending the operation. If the store is not in a normal state or its last seen
- * timestamp is beyond the heartbeat timeout, it logs a warning message and returns without sending the operation. If
- * the store is offline, it attempts to set the store to offline and returns. It then checks if the store operation
- * has any region commands. If not, it logs a debug message and returns without sending the operation. Note: The
- * actual sending of the store operation is not implemented in this function.
+ * It is a wrapper of `SendStoreOperations` with only one store.
  *
  * @param store The store to which the operation is to be sent.
  * @param store_operation The operation to be sent to the store.
@@ -5895,45 +6060,97 @@ bool CoordinatorControl::CheckStoreOperationResult(pb::coordinator::RegionCmdTyp
 void CoordinatorControl::SendStoreOperation(const pb::common::Store& store,
                                             const pb::coordinator::StoreOperation& store_operation,
                                             pb::coordinator_internal::MetaIncrement& meta_increment) {
-  if (store.state() == pb::common::StoreState::STORE_NORMAL) {
-    if (store.last_seen_timestamp() + (FLAGS_store_heartbeat_timeout * 1000) < butil::gettimeofday_ms()) {
-      DINGO_LOG(INFO) << "... update store " << store.id() << " state to offline";
-      TrySetStoreToOffline(store.id());
-      return;
+  std::vector<std::pair<pb::common::Store, pb::coordinator::StoreOperation>> store_operations;
+  store_operations.emplace_back(store, store_operation);
+  SendStoreOperations(store_operations, meta_increment);
+}
+
+/**
+ * The `SendStoreOperations` function is responsible for sending store operations to stores concurrently.
+ * It first checks the state of each store. If the store is in a normal state and its last seen timestamp is within
+ * the heartbeat timeout, the store operation is sent. If the store is not in a normal state, it logs a warning message
+ * and skips this store. If the last seen timestamp is beyond the heartbeat timeout, it attempts to set the store to
+ * offline. All region commands of one store are sent in one `PushStoreOperation` rpc, and the rpcs of different stores
+ * are sent asynchronously, so the latency is decided by the slowest store rather than the total command count. After
+ * all rpcs are finished, the results are handled one by one, and the meta_increment is generated.
+ *
+ * @param store_operations The stores and the operations to be sent to the stores, one operation for each store.
+ * @param meta_increment A reference to a MetaIncrement object.
+ */
+void CoordinatorControl::SendStoreOperations(
+    const std::vector<std::pair<pb::common::Store, pb::coordinator::StoreOperation>>& store_operations,
+    pb::coordinator_internal::MetaIncrement& meta_increment) {
+  std::vector<const pb::common::Store*> stores;
+  std::vector<pb::common::Location> locations;
+  std::vector<pb::push::PushStoreOperationRequest> requests;
+
+  for (const auto& [store, store_operation] : store_operations) {
+    if (store.state() == pb::common::StoreState::STORE_NORMAL) {
+      if (store.last_seen_timestamp() + (FLAGS_store_heartbeat_timeout * 1000) < butil::gettimeofday_ms()) {
+        DINGO_LOG(INFO) << "... update store " << store.id() << " state to offline";
+        TrySetStoreToOffline(store.id());
+        continue;
+      }
+    } else {
+      DINGO_LOG(WARNING) << "... store " << store.id() << " state is not STORE_NORMAL, will not send store_operation";
+      continue;
     }
-  } else {
-    DINGO_LOG(WARNING) << "... store " << store.id() << " state is not STORE_NORMAL, will not send store_operation";
-    return;
-  }
 
-  // send store_operation
-  if (store_operation.region_cmds_size() <= 0) {
-    DINGO_LOG(DEBUG) << "... store_operation.region_cmds_size() <= 0, store_id=" << store.id()
-                     << " region_cmds_size=" << store_operation.region_cmds_size();
-    return;
-  }
+    if (store_operation.region_cmds_size() <= 0) {
+      DINGO_LOG(DEBUG) << "... store_operation.region_cmds_size() <= 0, store_id=" << store.id()
+                       << " region_cmds_size=" << store_operation.region_cmds_size();
+      continue;
+    }
 
-  DINGO_LOG(INFO) << "... send store_operation to store " << store.id();
+    if (!store.has_server_location()) {
+      DINGO_LOG(ERROR) << "... store " << store.id() << " has no server_location";
+      continue;
+    }
+    if (store.server_location().port() <= 0 || store.server_location().port() > 65535) {
+      DINGO_LOG(ERROR) << "... store " << store.id() << " has invalid server_location.port "
+                       << store.server_location().port();
+      continue;
+    }
 
-  // send store_operation to store
-  // prepare request and response
-  pb::push::PushStoreOperationRequest request;
-  pb::push::PushStoreOperationResponse response;
+    DINGO_LOG(INFO) << "... send store_operation to store " << store.id()
+                    << ", region_cmd_count: " << store_operation.region_cmds_size();
 
-  *(request.mutable_store_operation()) = store_operation;
+    stores.push_back(&store);
+    locations.push_back(store.server_location());
+    auto& request = requests.emplace_back();
+    *(request.mutable_store_operation()) = store_operation;
+  }
 
-  // send rpcs
-  if (!store.has_server_location()) {
-    DINGO_LOG(ERROR) << "... store " << store.id() << " has no server_location";
+  if (requests.empty()) {
     return;
   }
-  if (store.server_location().port() <= 0 || store.server_location().port() > 65535) {
-    DINGO_LOG(ERROR) << "... store " << store.id() << " has invalid server_location.port "
-                     << store.server_location().port();
-    return;
+
+  std::vector<pb::push::PushStoreOperationResponse> responses;
+  std::vector<butil::Status> statuses;
+  RpcSendPushStoreOperations(locations, requests, responses, statuses);
+
+  for (size_t i = 0; i < requests.size(); ++i) {
+    HandleStoreOperationResult(*stores[i], requests[i].store_operation(), statuses[i], responses[i], meta_increment);
   }
+}
 
-  auto status = RpcSendPushStoreOperation(store.server_location(), request, response);
+/**
+ * The `HandleStoreOperationResult` function is responsible for handling the result of a store operation rpc.
+ * If the rpc is success, all region commands are deleted. If the rpc failed, it checks each region command result,
+ * the region command meet ERAFT_NOTLEADER is moved to the new leader store, the region command need retry is updated
+ * with the error, and other region commands are deleted.
+ *
+ * @param store The store to which the operation is sent.
+ * @param store_operation The operation sent to the store.
+ * @param status The status of the rpc.
+ * @param response The response of the rpc.
+ * @param meta_increment A reference to a MetaIncrement object.
+ */
+void CoordinatorControl::HandleStoreOperationResult(const pb::common::Store& store,
+                                                    const pb::coordinator::StoreOperation& store_operation,
+                                                    const butil::Status& status,
+                                                    const pb::push::PushStoreOperationResponse& response,
+                                                    pb::coordinator_internal::MetaIncrement& meta_increment) {
   if (status.error_code() == pb::error::Errno::ESEND_STORE_OPERATION_FAIL) {
     DINGO_LOG(WARNING) << "... send store_operation to store " << store.id()
                        << " failed ESEND_STORE_OPERATION_FAIL, will try this store future";
@@ -6090,16 +6307,11 @@ void CoordinatorControl::TryToSendStoreOperations() {
   std::shuffle(shuff_store_map.begin(), shuff_store_map.end(), CoordinatorControl::GetUrbg());
 
   // 1.send store_operation of create_region
+  // all create region_cmds of one store are sent in one rpc, and the rpcs of stores are sent concurrently
   {
     pb::coordinator_internal::MetaIncrement meta_increment;
 
-    std::map<int64_t, pb::common::Store> tmp_store_map;
-    for (const auto& store : shuff_store_map) {
-      tmp_store_map[store.id()] = store;
-    }
-
-    std::map<int64_t, std::vector<pb::coordinator::RegionCmd>> tmp_create_operation;
-
+    std::vector<std::pair<pb::common::Store, pb::coordinator::StoreOperation>> store_operations;
     for (const auto& store : shuff_store_map) {
       pb::coordinator::StoreOperation create_store_operation;
       int ret = GetStoreOperationOfCreateForSend(store.id(), create_store_operation);
@@ -6114,53 +6326,13 @@ void CoordinatorControl::TryToSendStoreOperations() {
         continue;
       }
 
-      std::vector<pb::coordinator::RegionCmd> region_cmds =
-          Helper::PbRepeatedToVector(create_store_operation.region_cmds());
-
-      std::shuffle(region_cmds.begin(), region_cmds.end(), CoordinatorControl::GetUrbg());
-
-      tmp_create_operation[store.id()] = region_cmds;
+      create_store_operation.set_id(store.id());
+      store_operations.emplace_back(store, std::move(create_store_operation));
     }
 
-    for (int32_t i = 0; i < 1000; i++) {
-      if (tmp_create_operation.empty()) {
-        break;
-      }
-
-      DINGO_LOG(INFO) << "... send store_operation of create_region, loop: " << i++;
-
-      for (auto& it : tmp_create_operation) {
-        auto store_id = it.first;
-        auto& region_cmds = it.second;
-
-        if (region_cmds.empty()) {
-          tmp_create_operation.erase(store_id);
-          break;
-        }
-
-        auto region_cmd = region_cmds.back();
-        region_cmds.pop_back();
-
-        auto store_it = tmp_store_map.find(store_id);
-        if (store_it == tmp_store_map.end()) {
-          DINGO_LOG(ERROR) << "... store " << store_id << " not found";
-          continue;
-        }
-        auto store = store_it->second;
-
-        // send store_operation to store
-        // prepare request and response
-        pb::push::PushStoreOperationRequest request;
-        pb::push::PushStoreOperationResponse response;
-
-        pb::coordinator::StoreOperation store_operation;
-        store_operation.set_id(store.id());
-        *(store_operation.add_region_cmds()) = region_cmd;
-        *(request.mutable_store_operation()) = store_operation;
-
-        // send rpcs
-        SendStoreOperation(store, store_operation, meta_increment);
-      }
+    if (!store_operations.empty()) {
+      DINGO_LOG(INFO) << "... send store_operation of create_region, store_count: " << store_operations.size();
+      SendStoreOperations(store_operations, meta_increment);
     }
 
     if (meta_increment.ByteSizeLong() > 0) {
@@ -6172,18 +6344,12 @@ void CoordinatorControl::TryToSendStoreOperations() {
   {
     pb::coordinator_internal::MetaIncrement meta_increment;
 
+    std::vector<std::pair<pb::common::Store, pb::coordinator::StoreOperation>> store_operations;
     for (const auto& store : shuff_store_map) {
-      if (store.state() == pb::common::StoreState::STORE_NORMAL) {
-        if (store.last_seen_timestamp() + (FLAGS_store_heartbeat_timeout * 1000) < butil::gettimeofday_ms()) {
-          DINGO_LOG(INFO) << "... update store " << store.id() << " state to offline";
-          TrySetStoreToOffline(store.id());
-          continue;
-        }
-      } else {
+      if (store.state() != pb::common::StoreState::STORE_NORMAL) {
         continue;
       }
 
-      // send store_operation
       pb::coordinator::StoreOperation store_operation;
       int ret = GetStoreOperationOfNotCreateForSend(store.id(), store_operation);
       if (ret < 0) {
@@ -6197,17 +6363,12 @@ void CoordinatorControl::TryToSendStoreOperations() {
         continue;
       }
 
-      DINGO_LOG(INFO) << "... send store_operation to store " << store.id();
-
-      // send store_operation to store
-      // prepare request and response
-      pb::push::PushStoreOperationRequest request;
-      pb::push::PushStoreOperationResponse response;
-
-      *(request.mutable_store_operation()) = store_operation;
+      store_operations.emplace_back(store, std::move(store_operation));
+    }
 
-      // send rpcs
-      SendStoreOperation(store, store_operation, meta_increment);
+    // the offline store is checked in SendStoreOperations
+    if (!store_operations.empty()) {
+      SendStoreOperations(store_operations, meta_increment);
     }
 
     if (meta_increment.ByteSizeLong() > 0) {
@@ -6218,12 +6379,7 @@ void CoordinatorControl::TryToSendStoreOperations() {
 
 /**
  * The `RpcSendPushStoreOperation` function is responsible for sending a `PushStoreOperation` request to a remote
- * store server. It first builds the remote server location string from the provided location. It then initializes a
- * BRPC channel to the remote server and sets a timeout for the RPC. The function sends a `PushStoreOperation` request
- * to the remote server and waits for a response. If the RPC fails, it logs an error message and retries the operation
- * up to a maximum number of times. If the RPC succeeds, it logs a success message and returns a success status. If
- * the RPC response indicates an error, it logs detailed error information including the error code and message, the
- * store ID, the number of region commands in the request, and the number of region command results in the response.
+ * store server. It is a wrapper of `RpcSendPushStoreOperations` with only one request.
  *
  * @param location The location of the remote store server.
  * @param request The `PushStoreOperationRequest` to be sent to the remote store server.
@@ -6234,51 +6390,127 @@ void CoordinatorControl::TryToSendStoreOperations() {
 butil::Status CoordinatorControl::RpcSendPushStoreOperation(const pb::common::Location& location,
                                                             pb::push::PushStoreOperationRequest& request,
                                                             pb::push::PushStoreOperationResponse& response) {
-  int retry_times = 0;
-  int max_retry_times = 3;
+  std::vector<pb::common::Location> locations = {location};
+  std::vector<pb::push::PushStoreOperationRequest> requests(1);
+  requests[0].Swap(&request);
+
+  std::vector<pb::push::PushStoreOperationResponse> responses;
+  std::vector<butil::Status> statuses;
+  RpcSendPushStoreOperations(locations, requests, responses, statuses);
+
+  request.Swap(&requests[0]);
+  response.Swap(&responses[0]);
+  return statuses[0];
+}
+
+/**
+ * The `RpcSendPushStoreOperations` function is responsible for sending `PushStoreOperation` requests to remote store
+ * servers concurrently. The channel of each store is cached in the `ChannelPool`, so no new connection is created for
+ * each rpc. All requests are sent asynchronously and then joined, the failed rpc is retried up to a maximum number of
+ * times, and all rpcs include retries must be finished before the deadline. If the rpc response indicates an error,
+ * it logs detailed error information including the error code and message, the store ID, the number of region
+ * commands in the request, and the number of region command results in the response.
+ *
+ * @param locations The locations of the remote store servers.
+ * @param requests The `PushStoreOperationRequest`s to be sent to the remote store servers.
+ * @param responses The `PushStoreOperationResponse`s received from the remote store servers.
+ * @param statuses The results of the rpcs. If the rpc was successful, the status is OK. If the rpc failed, the status
+ * indicates the error.
+ */
+void CoordinatorControl::RpcSendPushStoreOperations(const std::vector<pb::common::Location>& locations,
+                                                    std::vector<pb::push::PushStoreOperationRequest>& requests,
+                                                    std::vector<pb::push::PushStoreOperationResponse>& responses,
+                                                    std::vector<butil::Status>& statuses) {
+  responses.clear();
+  responses.resize(requests.size());
+  statuses.assign(requests.size(),
+                  butil::Status(pb::error::Errno::ESEND_STORE_OPERATION_FAIL,
+                                "connect with store server fail, no leader found or connect timeout"));
+
+  std::vector<size_t> pending_indexes(requests.size());
+  for (size_t i = 0; i < requests.size(); ++i) {
+    pending_indexes[i] = i;
+  }
+
+  int64_t deadline_ms = Helper::TimestampMs() + FLAGS_coordinator_push_store_operation_deadline_ms;
+  for (int retry_times = 0; retry_times < FLAGS_coordinator_push_store_operation_max_retry_times; ++retry_times) {
+    if (pending_indexes.empty()) {
+      break;
+    }
 
-  do {
-    // rpc
-    brpc::Channel channel;
-    if (channel.Init(location.host().c_str(), location.port(), nullptr) != 0) {
-      DINGO_LOG(ERROR) << "... channel init failed";
-      return butil::Status(pb::error::Errno::ESTORE_NOT_FOUND, "cannot connect store");
+    int64_t remaining_ms = deadline_ms - Helper::TimestampMs();
+    if (remaining_ms <= 0) {
+      DINGO_LOG(WARNING) << "... send store_operation deadline exceeded, pending store count: "
+                         << pending_indexes.size() << ", retry_times: " << retry_times;
+      break;
     }
 
-    brpc::Controller cntl;
-    cntl.set_timeout_ms(30000L);
+    // send all rpcs asynchronously
+    std::vector<std::unique_ptr<brpc::Controller>> cntls(pending_indexes.size());
+    for (size_t j = 0; j < pending_indexes.size(); ++j) {
+      auto index = pending_indexes[j];
+      auto channel = ChannelPool::GetInstance().GetChannel(Helper::LocationToEndPoint(locations[index]));
+      if (channel == nullptr) {
+        DINGO_LOG(ERROR) << "... channel init failed, location: " << locations[index].ShortDebugString();
+        statuses[index] = butil::Status(pb::error::Errno::ESTORE_NOT_FOUND, "cannot connect store");
+        continue;
+      }
 
-    pb::push::PushService_Stub(&channel).PushStoreOperation(&cntl, &request, &response, nullptr);
+      cntls[j] = std::make_unique<brpc::Controller>();
+      cntls[j]->set_timeout_ms(std::min(remaining_ms, FLAGS_coordinator_push_store_operation_timeout_ms));
 
-    if (cntl.Failed()) {
-      DINGO_LOG(ERROR) << "... rpc failed, will retry, error code: " << cntl.ErrorCode()
-                       << ", error message: " << cntl.ErrorText();
-      continue;
+      responses[index].Clear();
+      pb::push::PushService_Stub(channel.get())
+          .PushStoreOperation(cntls[j].get(), &requests[index], &responses[index], brpc::DoNothing());
     }
 
-    auto errcode = response.error().errcode();
-    if (errcode == pb::error::Errno::OK) {
-      DINGO_LOG(INFO) << "... rpc success, will not retry, store_id: " << request.store_operation().id()
-                      << ", region_cmd_count: " << request.store_operation().region_cmds_size();
-      return butil::Status::OK();
-    } else {
-      DINGO_LOG(ERROR) << "... rpc failed, error code: " << response.error().errcode()
-                       << ", error message: " << response.error().errmsg()
-                       << ", store_id: " << request.store_operation().id()
-                       << ", region_cmd_count: " << request.store_operation().region_cmds_size()
-                       << ", region_cmd_result_count: " << response.region_cmd_results_size();
-      for (const auto& it : response.region_cmd_results()) {
-        DINGO_LOG(ERROR) << "... rpc failed, region_cmd_id: " << it.region_cmd_id()
-                         << ", region_cmd_type: " << it.region_cmd_type() << ", error code: " << it.error().errcode()
-                         << ", error message: " << it.error().errmsg();
+    // wait all rpcs
+    std::vector<size_t> failed_indexes;
+    for (size_t j = 0; j < pending_indexes.size(); ++j) {
+      if (cntls[j] == nullptr) {
+        continue;
+      }
+
+      auto index = pending_indexes[j];
+      brpc::Join(cntls[j]->call_id());
+
+      const auto& request = requests[index];
+      const auto& response = responses[index];
+      if (cntls[j]->Failed()) {
+        DINGO_LOG(ERROR) << "... rpc failed, will retry, store_id: " << request.store_operation().id()
+                         << ", error code: " << cntls[j]->ErrorCode() << ", error message: " << cntls[j]->ErrorText();
+        failed_indexes.push_back(index);
+        continue;
+      }
+
+      auto errcode = response.error().errcode();
+      if (errcode == pb::error::Errno::OK) {
+        DINGO_LOG(INFO) << "... rpc success, will not retry, store_id: " << request.store_operation().id()
+                        << ", region_cmd_count: " << request.store_operation().region_cmds_size()
+                        << ", latency_us: " << cntls[j]->latency_us();
+        statuses[index] = butil::Status::OK();
+      } else {
+        DINGO_LOG(ERROR) << "... rpc failed, error code: " << response.error().errcode()
+                         << ", error message: " << response.error().errmsg()
+                         << ", store_id: " << request.store_operation().id()
+                         << ", region_cmd_count: " << request.store_operation().region_cmds_size()
+                         << ", region_cmd_result_count: " << response.region_cmd_results_size();
+        for (const auto& it : response.region_cmd_results()) {
+          DINGO_LOG(ERROR) << "... rpc failed, region_cmd_id: " << it.region_cmd_id()
+                           << ", region_cmd_type: " << it.region_cmd_type() << ", error code: " << it.error().errcode()
+                           << ", error message: " << it.error().errmsg();
+        }
+        statuses[index] = butil::Status(response.error().errcode(), response.error().errmsg());
       }
-      return butil::Status(response.error().errcode(), response.error().errmsg());
     }
-  } while (++retry_times < max_retry_times);
 
-  return butil::Status(pb::error::Errno::ESEND_STORE_OPERATION_FAIL,
-                       "connect with store server fail, no leader found or connect timeout, retry count: %d",
-                       retry_times);
+    pending_indexes.swap(failed_indexes);
+  }
+
+  // the rpc of pending store is failed, clear the partial response
+  for (auto index : pending_indexes) {
+    responses[index].Clear();
+  }
 }
 
 butil::Status CoordinatorControl::UpdateRegionCmdStatus(int64_t task_list_id, int64_t region_cmd_id,
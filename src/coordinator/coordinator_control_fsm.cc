@@ -131,6 +131,10 @@ void CoordinatorControl::OnLeaderStart(int64_t term) {
   // build id_epoch, schema_name, table_name, index_name maps
   BuildTempMaps();
 
+  // store liveness is soft state of leader, the last_seen_timestamp in state machine may be stale,
+  // so give every store a grace period of one heartbeat timeout after leader change
+  ResetStoreLiveness();
+
   coordinator_bvar_.SetValue(1);
   DINGO_LOG(INFO) << "OnLeaderStart finished, term=" << term;
 }
@@ -150,6 +154,7 @@ void CoordinatorControl::OnLeaderStop() {
 
   // clear all region_metrcs on follower
   region_metrics_map_.Clear();
+  entity_metrics_aggregator_.Clear();
 
   // clear all store_metrics on follower
   DeleteStoreRegionMetrics(0);
@@ -1590,6 +1595,7 @@ void CoordinatorControl::ApplyMetaIncrement(pb::coordinator_internal::MetaIncrem
 
         // remove region from region_metrics_map
         region_metrics_map_.Erase(region->id());
+        entity_metrics_aggregator_.RemoveRegion(region->id());
 
         // update range_region_map_
         // range_region_map_.Erase(region.region().definition().range().start_key());
@@ -53,6 +53,8 @@ DEFINE_int64(max_index_count, 10000, "max index num of dingo");
 DEFINE_int64(max_tenant_count, 1024, "max tenant num of dingo");
 DEFINE_uint32(default_replica_num, 3, "default replica number");
 DEFINE_bool(enable_lite, false, "enable lite");
+DEFINE_int64(coordinator_entity_metrics_rebuild_interval_s, 600,
+             "interval of full rebuild table/index metrics aggregator from region metrics");
 butil::Status CoordinatorControl::GenerateTableIdAndPartIds(int64_t schema_id, int64_t part_count,
                                                             pb::meta::EntityType entity_type,
                                                             pb::coordinator_internal::MetaIncrement& meta_increment,
@@ -2268,7 +2270,12 @@ butil::Status CoordinatorControl::GetTableMetrics(int64_t schema_id, int64_t tab
   }
 
   pb::coordinator_internal::TableMetricsInternal table_metrics_internal;
-  {
+  if (GetTableMetricsFromAggregator(table_id, *table_metrics_internal.mutable_table_metrics()) >= 0) {
+    // metrics aggregated by heartbeat delta, no need to walk regions
+    table_metrics_internal.set_id(table_id);
+    // keep the table in table_metrics_map_, so crontab will refresh its bvar
+    table_metrics_map_.Put(table_id, table_metrics_internal);
+  } else {
     // BAIDU_SCOPED_LOCK(table_metrics_map_mutex_);
     int ret = table_metrics_map_.Get(table_id, table_metrics_internal);
 
@@ -2337,7 +2344,12 @@ butil::Status CoordinatorControl::GetIndexMetrics(int64_t schema_id, int64_t ind
   }
 
   pb::coordinator_internal::IndexMetricsInternal index_metrics_internal;
-  {
+  if (GetIndexMetricsFromAggregator(index_id, *index_metrics_internal.mutable_index_metrics()) >= 0) {
+    // metrics aggregated by heartbeat delta, no need to walk regions
+    index_metrics_internal.set_id(index_id);
+    // keep the index in index_metrics_map_, so crontab will refresh its bvar
+    index_metrics_map_.Put(index_id, index_metrics_internal);
+  } else {
     // BAIDU_SCOPED_LOCK(index_metrics_map_mutex_);
     int ret = index_metrics_map_.Get(index_id, index_metrics_internal);
 
@@ -2614,21 +2626,72 @@ int64_t CoordinatorControl::CalculateIndexMetricsSingle(int64_t index_id, pb::me
   return 0;
 }
 
+// GetTableMetricsFromAggregator
+// get table metrics from the aggregator, part_count is from table definition
+int64_t CoordinatorControl::GetTableMetricsFromAggregator(int64_t table_id, pb::meta::TableMetrics& table_metrics) {
+  pb::coordinator_internal::TableInternal table_internal;
+  if (table_map_.Get(table_id, table_internal) < 0) {
+    return -1;
+  }
+
+  if (!entity_metrics_aggregator_.GetTableMetrics(table_id, table_metrics)) {
+    return -1;
+  }
+
+  table_metrics.set_part_count(table_internal.definition().table_partition().partitions_size());
+  return 0;
+}
+
+// GetIndexMetricsFromAggregator
+// get index metrics from the aggregator, part_count is from index definition
+int64_t CoordinatorControl::GetIndexMetricsFromAggregator(int64_t index_id, pb::meta::IndexMetrics& index_metrics) {
+  pb::coordinator_internal::TableInternal index_internal;
+  if (index_map_.Get(index_id, index_internal) < 0) {
+    return -1;
+  }
+
+  if (!entity_metrics_aggregator_.GetIndexMetrics(index_id, index_metrics)) {
+    return -1;
+  }
+
+  index_metrics.set_part_count(index_internal.definition().table_partition().partitions_size());
+  return 0;
+}
+
+// RebuildEntityMetricsIfNeeded
+// full reconciliation of the aggregator from region metrics, as a safety net of the heartbeat delta
+void CoordinatorControl::RebuildEntityMetricsIfNeeded() {
+  auto now_ms = Helper::TimestampMs();
+  if (last_entity_metrics_rebuild_ms_ > 0 &&
+      now_ms - last_entity_metrics_rebuild_ms_ < FLAGS_coordinator_entity_metrics_rebuild_interval_s * 1000) {
+    return;
+  }
+  last_entity_metrics_rebuild_ms_ = now_ms;
+
+  auto region_count = entity_metrics_aggregator_.Rebuild(region_metrics_map_);
+
+  DINGO_LOG(INFO) << fmt::format("rebuild entity metrics, region_count={} cost={}ms", region_count,
+                                 Helper::TimestampMs() - now_ms);
+}
+
 // CalculateTableMetrics
 // calculate table metrics using region metrics
 // only recalculate when table_metrics_map_ does contain table_id
 // if the table_id is not in table_map_, remove it from table_metrics_map_
+// the metrics is from the aggregator, only fallback to walk regions when no region metrics is reported
 void CoordinatorControl::CalculateTableMetrics() {
   // BAIDU_SCOPED_LOCK(table_metrics_map_mutex_);
 
-  butil::FlatMap<int64_t, pb::coordinator_internal::TableMetricsInternal> temp_table_metrics_map;
-  temp_table_metrics_map.init(10000);
-  table_metrics_map_.GetRawMapCopy(temp_table_metrics_map);
+  RebuildEntityMetricsIfNeeded();
+
+  // only the ids is needed, the metrics is recalculated below
+  std::vector<int64_t> table_ids;
+  table_metrics_map_.GetAllKeys(table_ids);
 
-  for (auto& table_metrics_internal : temp_table_metrics_map) {
-    int64_t table_id = table_metrics_internal.first;
+  for (auto table_id : table_ids) {
     pb::meta::TableMetrics table_metrics;
-    if (CalculateTableMetricsSingle(table_id, table_metrics) < 0) {
+    if (GetTableMetricsFromAggregator(table_id, table_metrics) < 0 &&
+        CalculateTableMetricsSingle(table_id, table_metrics) < 0) {
       DINGO_LOG(ERROR) << "ERRROR: CalculateTableMetricsSingle failed, remove metrics from map" << table_id;
       table_metrics_map_.Erase(table_id);
 
@@ -2636,10 +2699,12 @@ void CoordinatorControl::CalculateTableMetrics() {
       coordinator_bvar_metrics_table_.DeleteTableBvar(table_id);
 
     } else {
-      *(table_metrics_internal.second.mutable_table_metrics()) = table_metrics;
+      pb::coordinator_internal::TableMetricsInternal table_metrics_internal;
+      table_metrics_internal.set_id(table_id);
+      *(table_metrics_internal.mutable_table_metrics()) = table_metrics;
 
       // update table_metrics_map_ in memory
-      table_metrics_map_.PutIfExists(table_id, table_metrics_internal.second);
+      table_metrics_map_.PutIfExists(table_id, table_metrics_internal);
 
       // mbvar table
       coordinator_bvar_metrics_table_.UpdateTableBvar(table_id, table_metrics.rows_count(), table_metrics.part_count());
@@ -2651,17 +2716,18 @@ void CoordinatorControl::CalculateTableMetrics() {
 // calculate index metrics using region metrics
 // only recalculate when index_metrics_map_ does contain index_id
 // if the index_id is not in index_map_, remove it from index_metrics_map_
+// the metrics is from the aggregator, only fallback to walk regions when no region metrics is reported
 void CoordinatorControl::CalculateIndexMetrics() {
   // BAIDU_SCOPED_LOCK(index_metrics_map_mutex_);
 
-  butil::FlatMap<int64_t, pb::coordinator_internal::IndexMetricsInternal> temp_index_metrics_map;
-  temp_index_metrics_map.init(10000);
-  index_metrics_map_.GetRawMapCopy(temp_index_metrics_map);
+  // only the ids is needed, the metrics is recalculated below
+  std::vector<int64_t> index_ids;
+  index_metrics_map_.GetAllKeys(index_ids);
 
-  for (auto& index_metrics_internal : temp_index_metrics_map) {
-    int64_t index_id = index_metrics_internal.first;
+  for (auto index_id : index_ids) {
     pb::meta::IndexMetrics index_metrics;
-    if (CalculateIndexMetricsSingle(index_id, index_metrics) < 0) {
+    if (GetIndexMetricsFromAggregator(index_id, index_metrics) < 0 &&
+        CalculateIndexMetricsSingle(index_id, index_metrics) < 0) {
       DINGO_LOG(ERROR) << "ERRROR: CalculateIndexMetricsSingle failed, remove metrics from map" << index_id;
       index_metrics_map_.Erase(index_id);
 
@@ -2669,10 +2735,12 @@ void CoordinatorControl::CalculateIndexMetrics() {
       coordinator_bvar_metrics_index_.DeleteIndexBvar(index_id);
 
     } else {
-      *(index_metrics_internal.second.mutable_index_metrics()) = index_metrics;
+      pb::coordinator_internal::IndexMetricsInternal index_metrics_internal;
+      index_metrics_internal.set_id(index_id);
+      *(index_metrics_internal.mutable_index_metrics()) = index_metrics;
 
       // update index_metrics_map_ in memory
-      index_metrics_map_.PutIfExists(index_id, index_metrics_internal.second);
+      index_metrics_map_.PutIfExists(index_id, index_metrics_internal);
 
       // mbvar index
       coordinator_bvar_metrics_index_.UpdateIndexBvar(index_id, index_metrics.rows_count(), index_metrics.part_count());
@@ -0,0 +1,224 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "coordinator/entity_metrics_aggregator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "bthread/mutex.h"
+#include "butil/scoped_lock.h"
+
+namespace dingodb {
+
+EntityMetricsAggregator::EntityMetricsAggregator() { bthread_mutex_init(&mutex_, nullptr); }
+
+EntityMetricsAggregator::~EntityMetricsAggregator() { bthread_mutex_destroy(&mutex_); }
+
+EntityMetricsAggregator::Contribution EntityMetricsAggregator::ToContribution(
+    const pb::common::RegionMetrics &region_metrics) {
+  Contribution contribution;
+  contribution.table_id = region_metrics.region_definition().table_id();
+  contribution.index_id = region_metrics.region_definition().index_id();
+  contribution.rows_count = region_metrics.row_count();
+  contribution.region_size = region_metrics.region_size();
+  contribution.min_key = region_metrics.min_key();
+  contribution.max_key = region_metrics.max_key();
+
+  if (region_metrics.has_vector_index_metrics()) {
+    const auto &vector_index_metrics = region_metrics.vector_index_metrics();
+    contribution.has_vector_index_metrics = true;
+    contribution.vector_index_type = vector_index_metrics.vector_index_type();
+    contribution.current_count = vector_index_metrics.current_count();
+    contribution.deleted_count = vector_index_metrics.deleted_count();
+    contribution.memory_bytes = vector_index_metrics.memory_bytes();
+    contribution.min_id = vector_index_metrics.min_id();
+    contribution.max_id = vector_index_metrics.max_id();
+  }
+
+  return contribution;
+}
+
+std::unordered_map<int64_t, EntityMetricsAggregator::Aggregate> *EntityMetricsAggregator::AggregatesOf(
+    const Contribution &contribution) {
+  if (contribution.index_id > 0) {
+    return &index_aggregates_;
+  } else if (contribution.table_id > 0) {
+    return &table_aggregates_;
+  }
+
+  return nullptr;
+}
+
+void EntityMetricsAggregator::AddContribution(const Contribution &contribution) {
+  auto *aggregates = AggregatesOf(contribution);
+  if (aggregates == nullptr) {
+    return;
+  }
+
+  auto &aggregate = (*aggregates)[contribution.index_id > 0 ? contribution.index_id : contribution.table_id];
+  ++aggregate.region_count;
+  aggregate.rows_count += contribution.rows_count;
+  aggregate.region_size += contribution.region_size;
+  if (aggregate.min_key.compare(contribution.min_key) > 0) {
+    aggregate.min_key = contribution.min_key;
+  }
+  if (aggregate.max_key.compare(contribution.max_key) < 0) {
+    aggregate.max_key = contribution.max_key;
+  }
+
+  if (contribution.has_vector_index_metrics) {
+    aggregate.vector_index_type = contribution.vector_index_type;
+    aggregate.current_count += contribution.current_count;
+    aggregate.deleted_count += contribution.deleted_count;
+    aggregate.memory_bytes += contribution.memory_bytes;
+    aggregate.min_id = aggregate.min_id < 0 ? contribution.min_id : std::min(aggregate.min_id, contribution.min_id);
+    aggregate.max_id = aggregate.max_id < 0 ? contribution.max_id : std::max(aggregate.max_id, contribution.max_id);
+  }
+}
+
+void EntityMetricsAggregator::SubtractContribution(const Contribution &contribution) {
+  auto *aggregates = AggregatesOf(contribution);
+  if (aggregates == nullptr) {
+    return;
+  }
+
+  auto it = aggregates->find(contribution.index_id > 0 ? contribution.index_id : contribution.table_id);
+  if (it == aggregates->end()) {
+    return;
+  }
+
+  auto &aggregate = it->second;
+  if (--aggregate.region_count <= 0) {
+    aggregates->erase(it);
+    return;
+  }
+
+  aggregate.rows_count -= contribution.rows_count;
+  aggregate.region_size -= contribution.region_size;
+  if (contribution.has_vector_index_metrics) {
+    aggregate.current_count -= contribution.current_count;
+    aggregate.deleted_count -= contribution.deleted_count;
+    aggregate.memory_bytes -= contribution.memory_bytes;
+  }
+}
+
+void EntityMetricsAggregator::UpdateRegion(const pb::common::RegionMetrics &region_metrics) {
+  auto contribution = ToContribution(region_metrics);
+
+  BAIDU_SCOPED_LOCK(mutex_);
+
+  auto it = region_contributions_.find(region_metrics.id());
+  if (it != region_contributions_.end()) {
+    SubtractContribution(it->second);
+    it->second = std::move(contribution);
+    AddContribution(it->second);
+  } else {
+    AddContribution(contribution);
+    region_contributions_.emplace(region_metrics.id(), std::move(contribution));
+  }
+}
+
+void EntityMetricsAggregator::RemoveRegion(int64_t region_id) {
+  BAIDU_SCOPED_LOCK(mutex_);
+
+  auto it = region_contributions_.find(region_id);
+  if (it == region_contributions_.end()) {
+    return;
+  }
+
+  SubtractContribution(it->second);
+  region_contributions_.erase(it);
+}
+
+void EntityMetricsAggregator::Clear() {
+  BAIDU_SCOPED_LOCK(mutex_);
+
+  region_contributions_.clear();
+  table_aggregates_.clear();
+  index_aggregates_.clear();
+}
+
+int64_t EntityMetricsAggregator::Rebuild(DingoSafeMap<int64_t, pb::common::RegionMetrics> &region_metrics_map) {
+  std::unordered_map<int64_t, Contribution> region_contributions;
+  region_contributions.reserve(region_metrics_map.Size());
+  region_metrics_map.Traverse(
+      [&region_contributions](const int64_t &region_id, const pb::common::RegionMetrics &region_metrics) {
+        region_contributions[region_id] = ToContribution(region_metrics);
+        return true;
+      });
+
+  BAIDU_SCOPED_LOCK(mutex_);
+
+  region_contributions_.swap(region_contributions);
+  table_aggregates_.clear();
+  index_aggregates_.clear();
+  for (const auto &[region_id, contribution] : region_contributions_) {
+    AddContribution(contribution);
+  }
+
+  return region_contributions_.size();
+}
+
+bool EntityMetricsAggregator::GetTableMetrics(int64_t table_id, pb::meta::TableMetrics &table_metrics) {
+  BAIDU_SCOPED_LOCK(mutex_);
+
+  auto it = table_aggregates_.find(table_id);
+  if (it == table_aggregates_.end()) {
+    return false;
+  }
+
+  const auto &aggregate = it->second;
+  table_metrics.set_rows_count(aggregate.rows_count);
+  table_metrics.set_table_size(aggregate.region_size);
+  table_metrics.set_min_key(aggregate.min_key);
+  table_metrics.set_max_key(aggregate.max_key);
+
+  return true;
+}
+
+bool EntityMetricsAggregator::GetIndexMetrics(int64_t index_id, pb::meta::IndexMetrics &index_metrics) {
+  BAIDU_SCOPED_LOCK(mutex_);
+
+  auto it = index_aggregates_.find(index_id);
+  if (it == index_aggregates_.end()) {
+    return false;
+  }
+
+  const auto &aggregate = it->second;
+  index_metrics.set_rows_count(aggregate.rows_count);
+  index_metrics.set_min_key(aggregate.min_key);
+  index_metrics.set_max_key(aggregate.max_key);
+
+  if (aggregate.vector_index_type != pb::common::VectorIndexType::VECTOR_INDEX_TYPE_NONE) {
+    index_metrics.set_vector_index_type(aggregate.vector_index_type);
+    index_metrics.set_current_count(aggregate.current_count);
+    index_metrics.set_deleted_count(aggregate.deleted_count);
+    index_metrics.set_max_id(aggregate.max_id);
+    index_metrics.set_min_id(aggregate.min_id);
+    index_metrics.set_memory_bytes(aggregate.memory_bytes);
+  }
+
+  return true;
+}
+
+int64_t EntityMetricsAggregator::RegionCount() {
+  BAIDU_SCOPED_LOCK(mutex_);
+  return region_contributions_.size();
+}
+
+}  // namespace dingodb
@@ -0,0 +1,105 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGODB_COORDINATOR_ENTITY_METRICS_AGGREGATOR_H_
+#define DINGODB_COORDINATOR_ENTITY_METRICS_AGGREGATOR_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bthread/types.h"
+#include "common/safe_map.h"
+#include "proto/common.pb.h"
+#include "proto/meta.pb.h"
+
+namespace dingodb {
+
+// Table and index metrics aggregated from region metrics incrementally.
+// Every region metrics update replace the old contribution of the region by the new one,
+// so the metrics of table/index is O(1) to get, and the cost is proportional to heartbeat churn.
+// The region of index has index_id, the region of table has table_id only.
+// The min/max key and min/max vector id only widen by delta, they are exact after Rebuild.
+class EntityMetricsAggregator {
+ public:
+  EntityMetricsAggregator();
+  ~EntityMetricsAggregator();
+
+  EntityMetricsAggregator(const EntityMetricsAggregator &) = delete;
+  EntityMetricsAggregator &operator=(const EntityMetricsAggregator &) = delete;
+
+  void UpdateRegion(const pb::common::RegionMetrics &region_metrics);
+  void RemoveRegion(int64_t region_id);
+  void Clear();
+
+  // Full reconciliation from all region metrics, the map is traversed in place.
+  // Return the region count.
+  int64_t Rebuild(DingoSafeMap<int64_t, pb::common::RegionMetrics> &region_metrics_map);
+
+  // Return false if no region of the table/index is reported.
+  // part_count is not set, it is decided by the definition.
+  bool GetTableMetrics(int64_t table_id, pb::meta::TableMetrics &table_metrics);
+  bool GetIndexMetrics(int64_t index_id, pb::meta::IndexMetrics &index_metrics);
+
+  int64_t RegionCount();
+
+ private:
+  struct Contribution {
+    int64_t table_id{0};
+    int64_t index_id{0};
+    int64_t rows_count{0};
+    int64_t region_size{0};
+    std::string min_key;
+    std::string max_key;
+
+    bool has_vector_index_metrics{false};
+    pb::common::VectorIndexType vector_index_type{pb::common::VectorIndexType::VECTOR_INDEX_TYPE_NONE};
+    int64_t current_count{0};
+    int64_t deleted_count{0};
+    int64_t memory_bytes{0};
+    int64_t min_id{0};
+    int64_t max_id{0};
+  };
+
+  struct Aggregate {
+    int64_t region_count{0};
+    int64_t rows_count{0};
+    int64_t region_size{0};
+    std::string min_key{std::string(10, '\x00')};
+    std::string max_key{std::string(10, '\xFF')};
+
+    pb::common::VectorIndexType vector_index_type{pb::common::VectorIndexType::VECTOR_INDEX_TYPE_NONE};
+    int64_t current_count{0};
+    int64_t deleted_count{0};
+    int64_t memory_bytes{0};
+    int64_t min_id{-1};
+    int64_t max_id{-1};
+  };
+
+  static Contribution ToContribution(const pb::common::RegionMetrics &region_metrics);
+
+  void AddContribution(const Contribution &contribution);
+  void SubtractContribution(const Contribution &contribution);
+  std::unordered_map<int64_t, Aggregate> *AggregatesOf(const Contribution &contribution);
+
+  bthread_mutex_t mutex_;
+  std::unordered_map<int64_t, Contribution> region_contributions_;
+  std::unordered_map<int64_t, Aggregate> table_aggregates_;
+  std::unordered_map<int64_t, Aggregate> index_aggregates_;
+};
+
+}  // namespace dingodb
+
+#endif  // DINGODB_COORDINATOR_ENTITY_METRICS_AGGREGATOR_H_
@@ -42,6 +42,7 @@ KvControl::KvControl(std::shared_ptr<MetaReader> meta_reader, std::shared_ptr<Me
   // init bthread mutex
   bthread_mutex_init(&lease_to_key_map_temp_mutex_, nullptr);
   bthread_mutex_init(&one_time_watch_map_mutex_, nullptr);
+  bthread_mutex_init(&kv_compaction_mutex_, nullptr);
   leader_term_.store(-1, butil::memory_order_release);
 
   // the data structure below will write to raft
@@ -148,6 +149,10 @@ bool KvControl::Recover() {
   BuildLeaseToKeyMap();
   DINGO_LOG(INFO) << "Recover lease_to_key_map_temp, count=" << lease_to_key_map_temp_.size();
 
+  // build kv_compaction_index_
+  BuildKvCompactionIndex();
+  RecoverKvCompactRevision();
+
   std::map<std::string, pb::coordinator_internal::KvRevInternal> kv_rev_map;
   kv_rev_meta_->GetAllIdElements(kv_rev_map);
   for (auto& kv : kv_rev_map) {
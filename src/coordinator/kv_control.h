@@ -19,16 +19,22 @@
 
 #include <atomic>
 #include <cstdint>
+#include <list>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "bthread/types.h"
 #include "butil/status.h"
+#include "bvar/bvar.h"
 #include "common/meta_control.h"
 #include "common/safe_map.h"
 #include "coordinator/coordinator_meta_storage.h"
+#include "coordinator/lease_timer_wheel.h"
 #include "engine/engine.h"
 #include "engine/snapshot.h"
 #include "google/protobuf/stubs/callback.h"
@@ -128,6 +134,39 @@ struct KvLeaseWithKeys {
   std::set<std::string> keys;
 };
 
+// Bounded LRU cache of the latest kv_rev of key, maintained by KvPutApply/KvDeleteApply.
+// The cached kv_rev is checked with the mod_revision of kv_index when read, so never return stale value.
+class KvLatestValueCache {
+ public:
+  KvLatestValueCache();
+  ~KvLatestValueCache();
+
+  KvLatestValueCache(const KvLatestValueCache &) = delete;
+  KvLatestValueCache &operator=(const KvLatestValueCache &) = delete;
+
+  bool Get(const std::string &key, const pb::coordinator_internal::RevisionInternal &mod_revision,
+           pb::coordinator_internal::KvRevInternal &kv_rev);
+  void Put(const std::string &key, const pb::coordinator_internal::KvRevInternal &kv_rev);
+  void Erase(const std::string &key);
+  void Clear();
+
+  int64_t Size();
+
+ private:
+  struct Entry {
+    pb::coordinator_internal::KvRevInternal kv_rev;
+    std::list<std::string>::iterator lru_iter;
+  };
+
+  bthread_mutex_t mutex_;
+  // Front is the most recently used.
+  std::list<std::string> lru_list_;
+  std::unordered_map<std::string, Entry> entries_;
+
+  bvar::Adder<int64_t> bvar_hit_count_;
+  bvar::Adder<int64_t> bvar_miss_count_;
+};
+
 class KvControl : public MetaControl {
  public:
   KvControl(std::shared_ptr<MetaReader> meta_reader, std::shared_ptr<MetaWriter> meta_writer,
@@ -220,12 +259,23 @@ class KvControl : public MetaControl {
   // lease timeout/revoke task
   void LeaseTask();
 
-  // lease timeout/revoke task
+  // compaction task, leader propose compact to revision command
   void CompactionTask();
 
+  // compact a batch of keys to the replicated compact revision, run on every replica
+  void KvCompactionStep();
+
+  // build kv_compaction_index_ from kv_index_map_
+  void BuildKvCompactionIndex(bool has_mutex_locked = false);
+  // load the persisted compact revision from id_epoch_map_
+  void RecoverKvCompactRevision();
+  int64_t GetKvCompactRevision() { return kv_compact_revision_.load(std::memory_order_acquire); }
+
   // lease
   butil::Status LeaseGrant(int64_t lease_id, int64_t ttl_seconds, int64_t &granted_id, int64_t &granted_ttl_seconds,
                            pb::coordinator_internal::MetaIncrement &meta_increment);
+  // renew is leader local, only update memory, the last renew time is checkpointed by LeaseTask,
+  // meta_increment is not empty only when need to write raft
   butil::Status LeaseRenew(int64_t lease_id, int64_t &ttl_seconds,
                            pb::coordinator_internal::MetaIncrement &meta_increment);
   butil::Status LeaseRevoke(int64_t lease_id, pb::coordinator_internal::MetaIncrement &meta_increment,
@@ -253,6 +303,9 @@ class KvControl : public MetaControl {
   butil::Status PutRawKvRev(const pb::coordinator_internal::RevisionInternal &revision,
                             const pb::coordinator_internal::KvRevInternal &kv_rev);
   butil::Status DeleteRawKvRev(const pb::coordinator_internal::RevisionInternal &revision);
+  // get the latest kv_rev of key by its mod_revision, try the latest value cache first
+  butil::Status GetLatestKvRev(const std::string &key, const pb::coordinator_internal::RevisionInternal &mod_revision,
+                               pb::coordinator_internal::KvRevInternal &kv_rev);
 
   // kv functions for api
   // KvRange is the get function
@@ -314,6 +367,14 @@ class KvControl : public MetaControl {
   butil::Status KvCompactApply(const std::string &key,
                                const pb::coordinator_internal::RevisionInternal &compact_revision);
 
+  // KvCompactToRevision submit one compact to revision command, the garbage is deleted by KvCompactionStep
+  butil::Status KvCompactToRevision(const pb::coordinator_internal::RevisionInternal &compact_revision);
+  void GenKvCompactToRevisionIncrement(const pb::coordinator_internal::RevisionInternal &compact_revision,
+                                       pb::coordinator_internal::MetaIncrement &meta_increment);
+
+  // KvCompactToRevisionApply is the apply function for compact to revision
+  void KvCompactToRevisionApply(const pb::coordinator_internal::RevisionInternal &compact_revision);
+
   // watch functions for api
   butil::Status OneTimeWatch(const std::string &watch_key, int64_t start_revision, bool no_put_event,
                              bool no_delete_event, bool need_prev_kv, bool wait_on_not_exist_key,
@@ -334,6 +395,13 @@ class KvControl : public MetaControl {
                                 pb::version::Kv &new_kv, pb::version::Kv &prev_kv);
 
  private:
+  // compact one key, the caller must hold kv_compaction_mutex_
+  butil::Status DoKvCompact(const std::string &key, const pb::coordinator_internal::RevisionInternal &compact_revision,
+                            int64_t &deleted_rev_count);
+  // add key to kv_compaction_index_ if it has compactable revision, the caller must hold kv_compaction_mutex_
+  void AddKvCompactionIndex(const std::string &key, const pb::coordinator_internal::KvIndexInternal &kv_index);
+  void EraseKvCompactionIndex(const std::string &key);
+
   // deprecated, will removed in the future
   // ids_epochs_temp (out of state machine, only for leader use)
   // DingoSafeIdEpochMap id_epoch_map_safe_temp_;
@@ -349,6 +417,11 @@ class KvControl : public MetaControl {
   std::map<int64_t, KvLeaseWithKeys>
       lease_to_key_map_temp_;  // storage lease_id to key map, this map is built in on_leader_start
   bthread_mutex_t lease_to_key_map_temp_mutex_;
+  // lease expiry timer, protected by lease_to_key_map_temp_mutex_
+  LeaseTimerWheel lease_timer_wheel_{0};
+  // leases renewed after last checkpoint, protected by lease_to_key_map_temp_mutex_
+  std::set<int64_t> lease_checkpoint_dirty_ids_;
+  int64_t last_lease_checkpoint_ts_seconds_{0};
 
   // 15.version kv with lease
   DingoSafeStdMap<std::string, pb::coordinator_internal::KvIndexInternal> kv_index_map_;
@@ -356,6 +429,18 @@ class KvControl : public MetaControl {
 
   // 16.version kv multi revision
   MetaDiskMap<pb::coordinator_internal::KvRevInternal> *kv_rev_meta_;
+  // latest kv_rev of key, avoid read kv_rev_meta_ from raw engine for hot key
+  KvLatestValueCache kv_latest_value_cache_;
+
+  // kv compaction, this is out of state machine
+  // the oldest compactable revision to key, only the key has superseded revision is in this index
+  std::set<std::pair<int64_t, std::string>> kv_compaction_index_;
+  std::unordered_map<std::string, int64_t> kv_compaction_key_revisions_;
+  // protect kv_compaction_index_, and serialize the kv_index update of apply and local compaction
+  bthread_mutex_t kv_compaction_mutex_;
+  // replicated compact revision, revisions less than it are deleted by KvCompactionStep,
+  // it is persisted as ID_GC_SAFE_POINT of id_epoch_map_
+  std::atomic<int64_t> kv_compact_revision_{0};
 
   // one time watch map
   // this map on work on leader, is out of state machine
@@ -112,6 +112,9 @@ void KvControl::OnLeaderStop() {
 
 std::shared_ptr<Snapshot> KvControl::PrepareRaftSnapshot() {
   DINGO_LOG(INFO) << "PrepareRaftSnapshot";
+  // local compaction update kv_index and delete kv_revs of one key under the mutex,
+  // so the snapshot never see a half compacted key
+  BAIDU_SCOPED_LOCK(kv_compaction_mutex_);
   return raw_engine_of_meta_->GetSnapshot();
 }
 
@@ -234,59 +237,69 @@ bool KvControl::LoadMetaFromSnapshotFile(pb::coordinator_internal::MetaSnapshotF
   DINGO_LOG(INFO) << "LoadSnapshot version_lease_meta, count=" << kvs.size();
   kvs.clear();
 
-  // 15.kv_index_map_
-  kvs.reserve(meta_snapshot_file.kv_index_map_kvs_size());
-  for (int i = 0; i < meta_snapshot_file.kv_index_map_kvs_size(); i++) {
-    kvs.push_back(meta_snapshot_file.kv_index_map_kvs(i));
-  }
+  // 15.kv_index_map_ and 16.kv_rev_map_
+  // local compaction is stopped when load snapshot, then rebuild compaction index
   {
-    if (!kv_index_meta_->Recover(kvs)) {
-      return false;
-    }
+    BAIDU_SCOPED_LOCK(kv_compaction_mutex_);
 
-    // remove data in rocksdb
-    if (!meta_writer_->DeletePrefix(kv_index_meta_->internal_prefix)) {
-      DINGO_LOG(ERROR) << "Coordinator delete kv_index_meta_ range failed in LoadMetaFromSnapshotFile";
-      return false;
+    // 15.kv_index_map_
+    kv_latest_value_cache_.Clear();
+    kvs.reserve(meta_snapshot_file.kv_index_map_kvs_size());
+    for (int i = 0; i < meta_snapshot_file.kv_index_map_kvs_size(); i++) {
+      kvs.push_back(meta_snapshot_file.kv_index_map_kvs(i));
     }
-    DINGO_LOG(INFO) << "Coordinator delete range kv_index_meta_ success in LoadMetaFromSnapshotFile";
+    {
+      if (!kv_index_meta_->Recover(kvs)) {
+        return false;
+      }
 
-    // write data to rocksdb
-    if (!meta_writer_->Put(kvs)) {
-      DINGO_LOG(ERROR) << "Coordinator write kv_index_meta_ failed in LoadMetaFromSnapshotFile";
-      return false;
-    }
-    DINGO_LOG(INFO) << "Coordinator put kv_index_meta_ success in LoadMetaFromSnapshotFile";
-  }
-  DINGO_LOG(INFO) << "LoadSnapshot version_kv_meta, count=" << kvs.size();
-  kvs.clear();
+      // remove data in rocksdb
+      if (!meta_writer_->DeletePrefix(kv_index_meta_->internal_prefix)) {
+        DINGO_LOG(ERROR) << "Coordinator delete kv_index_meta_ range failed in LoadMetaFromSnapshotFile";
+        return false;
+      }
+      DINGO_LOG(INFO) << "Coordinator delete range kv_index_meta_ success in LoadMetaFromSnapshotFile";
 
-  // 16.kv_rev_map_
-  kvs.reserve(meta_snapshot_file.kv_rev_map_kvs_size());
-  for (int i = 0; i < meta_snapshot_file.kv_rev_map_kvs_size(); i++) {
-    kvs.push_back(meta_snapshot_file.kv_rev_map_kvs(i));
-  }
-  {
-    // if (!kv_rev_meta_->Recover(kvs)) {
-    //   return false;
-    // }
+      // write data to rocksdb
+      if (!meta_writer_->Put(kvs)) {
+        DINGO_LOG(ERROR) << "Coordinator write kv_index_meta_ failed in LoadMetaFromSnapshotFile";
+        return false;
+      }
+      DINGO_LOG(INFO) << "Coordinator put kv_index_meta_ success in LoadMetaFromSnapshotFile";
+    }
+    DINGO_LOG(INFO) << "LoadSnapshot version_kv_meta, count=" << kvs.size();
+    kvs.clear();
 
-    // remove data in rocksdb
-    if (!meta_writer_->DeletePrefix(kv_rev_meta_->internal_prefix)) {
-      DINGO_LOG(ERROR) << "Coordinator delete kv_rev_meta_ range failed in LoadMetaFromSnapshotFile";
-      return false;
+    // 16.kv_rev_map_
+    kvs.reserve(meta_snapshot_file.kv_rev_map_kvs_size());
+    for (int i = 0; i < meta_snapshot_file.kv_rev_map_kvs_size(); i++) {
+      kvs.push_back(meta_snapshot_file.kv_rev_map_kvs(i));
     }
-    DINGO_LOG(INFO) << "Coordinator delete range kv_rev_meta_ success in LoadMetaFromSnapshotFile";
+    {
+      // if (!kv_rev_meta_->Recover(kvs)) {
+      //   return false;
+      // }
+
+      // remove data in rocksdb
+      if (!meta_writer_->DeletePrefix(kv_rev_meta_->internal_prefix)) {
+        DINGO_LOG(ERROR) << "Coordinator delete kv_rev_meta_ range failed in LoadMetaFromSnapshotFile";
+        return false;
+      }
+      DINGO_LOG(INFO) << "Coordinator delete range kv_rev_meta_ success in LoadMetaFromSnapshotFile";
 
-    // write data to rocksdb
-    if (!meta_writer_->Put(kvs)) {
-      DINGO_LOG(ERROR) << "Coordinator write kv_rev_meta_ failed in LoadMetaFromSnapshotFile";
-      return false;
+      // write data to rocksdb
+      if (!meta_writer_->Put(kvs)) {
+        DINGO_LOG(ERROR) << "Coordinator write kv_rev_meta_ failed in LoadMetaFromSnapshotFile";
+        return false;
+      }
+      DINGO_LOG(INFO) << "Coordinator put kv_rev_meta_ success in LoadMetaFromSnapshotFile";
     }
-    DINGO_LOG(INFO) << "Coordinator put kv_rev_meta_ success in LoadMetaFromSnapshotFile";
+    DINGO_LOG(INFO) << "LoadSnapshot version_kv_rev_meta, count=" << kvs.size();
+    kvs.clear();
+
+    BuildKvCompactionIndex(true);
+    RecoverKvCompactRevision();
   }
-  DINGO_LOG(INFO) << "LoadSnapshot version_kv_rev_meta, count=" << kvs.size();
-  kvs.clear();
 
   // build id_epoch, schema_name, table_name, index_name maps
   BuildTempMaps();
@@ -369,7 +382,8 @@ void KvControl::ApplyMetaIncrement(pb::coordinator_internal::MetaIncrement& meta
         }
 
       } else if (version_lease.op_type() == pb::coordinator_internal::MetaIncrementOpType::UPDATE) {
-        auto ret = kv_lease_meta_->Put(version_lease.id(), version_lease.lease());
+        // lease checkpoint is submitted out of lease mutex, not recreate the revoked lease
+        auto ret = kv_lease_meta_->PutIfExists(version_lease.id(), version_lease.lease());
         if (!ret.ok()) {
           DINGO_LOG(FATAL) << "ApplyMetaIncrement version_lease UPDATE, [id=" << version_lease.id()
                            << "] failed, set errcode=" << ret.error_code() << ", error_str=" << ret.error_str();
@@ -500,6 +514,14 @@ void KvControl::ApplyMetaIncrement(pb::coordinator_internal::MetaIncrement& meta
           }
         } else if (kv_index.event_type() ==
                    pb::coordinator_internal::KvIndexEventType::KV_INDEX_EVENT_TYPE_COMPACTION) {
+          // empty key is the compact to revision command, replicas compact locally
+          if (kv_index.id().empty()) {
+            KvCompactToRevisionApply(kv_index.op_revision());
+            DINGO_LOG(INFO) << "ApplyMetaIncrement kv_index UPDATE,COMPACT_TO_REVISION revision="
+                            << kv_index.op_revision().ShortDebugString() << " success";
+            continue;
+          }
+
           // call KvCompactApply
           auto ret = KvCompactApply(kv_index.id(), kv_index.op_revision());
           if (ret.ok()) {
@@ -16,9 +16,12 @@
 
 #include <atomic>
 #include <cstdint>
+#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "bthread/mutex.h"
 #include "butil/status.h"
 #include "common/helper.h"
 #include "common/logging.h"
@@ -37,6 +40,9 @@ DEFINE_int64(max_kv_value_size, 8192, "max kv put count");
 DEFINE_int64(compaction_retention_rev_count, 1000, "max revision count retention for compaction");
 DEFINE_bool(auto_compaction, false, "auto compaction on/off");
 DEFINE_int64(version_kv_max_count, 100000, "max kv count for version kv");
+DEFINE_int64(kv_latest_value_cache_capacity, 20000, "max key count of version kv latest value cache");
+DEFINE_int64(kv_compaction_max_keys_per_step, 1000, "max key count of version kv compaction in one step");
+DEFINE_int64(kv_compaction_max_revs_per_step, 10000, "max deleted kv_rev count of version kv compaction in one step");
 
 DEFINE_bool(dingo_log_switch_coor_kv, false, "log switch for kv control");
 
@@ -67,6 +73,82 @@ pb::coordinator_internal::RevisionInternal KvControl::StringToRevision(const std
   return revision;
 }
 
+KvLatestValueCache::KvLatestValueCache()
+    : bvar_hit_count_("dingo_coordinator_kv_latest_value_cache_hit_count"),
+      bvar_miss_count_("dingo_coordinator_kv_latest_value_cache_miss_count") {
+  bthread_mutex_init(&mutex_, nullptr);
+}
+
+KvLatestValueCache::~KvLatestValueCache() { bthread_mutex_destroy(&mutex_); }
+
+bool KvLatestValueCache::Get(const std::string &key, const pb::coordinator_internal::RevisionInternal &mod_revision,
+                             pb::coordinator_internal::KvRevInternal &kv_rev) {
+  BAIDU_SCOPED_LOCK(mutex_);
+
+  auto iter = entries_.find(key);
+  if (iter == entries_.end()) {
+    bvar_miss_count_ << 1;
+    return false;
+  }
+
+  const auto &cached_revision = iter->second.kv_rev.kv().mod_revision();
+  if (cached_revision.main() != mod_revision.main() || cached_revision.sub() != mod_revision.sub()) {
+    bvar_miss_count_ << 1;
+    return false;
+  }
+
+  lru_list_.splice(lru_list_.begin(), lru_list_, iter->second.lru_iter);
+  kv_rev = iter->second.kv_rev;
+  bvar_hit_count_ << 1;
+
+  return true;
+}
+
+void KvLatestValueCache::Put(const std::string &key, const pb::coordinator_internal::KvRevInternal &kv_rev) {
+  if (FLAGS_kv_latest_value_cache_capacity <= 0) {
+    return;
+  }
+
+  BAIDU_SCOPED_LOCK(mutex_);
+
+  auto iter = entries_.find(key);
+  if (iter != entries_.end()) {
+    iter->second.kv_rev = kv_rev;
+    lru_list_.splice(lru_list_.begin(), lru_list_, iter->second.lru_iter);
+    return;
+  }
+
+  while (static_cast<int64_t>(entries_.size()) >= FLAGS_kv_latest_value_cache_capacity && !lru_list_.empty()) {
+    entries_.erase(lru_list_.back());
+    lru_list_.pop_back();
+  }
+
+  lru_list_.push_front(key);
+  entries_.emplace(key, Entry{kv_rev, lru_list_.begin()});
+}
+
+void KvLatestValueCache::Erase(const std::string &key) {
+  BAIDU_SCOPED_LOCK(mutex_);
+
+  auto iter = entries_.find(key);
+  if (iter != entries_.end()) {
+    lru_list_.erase(iter->second.lru_iter);
+    entries_.erase(iter);
+  }
+}
+
+void KvLatestValueCache::Clear() {
+  BAIDU_SCOPED_LOCK(mutex_);
+
+  entries_.clear();
+  lru_list_.clear();
+}
+
+int64_t KvLatestValueCache::Size() {
+  BAIDU_SCOPED_LOCK(mutex_);
+  return entries_.size();
+}
+
 butil::Status KvControl::GetRawKvIndex(const std::string &key, pb::coordinator_internal::KvIndexInternal &kv_index) {
   auto ret = kv_index_map_.Get(key, kv_index);
   if (ret < 0) {
@@ -152,6 +234,25 @@ butil::Status KvControl::GetRawKvRev(const pb::coordinator_internal::RevisionInt
   return butil::Status::OK();
 }
 
+butil::Status KvControl::GetLatestKvRev(const std::string &key,
+                                        const pb::coordinator_internal::RevisionInternal &mod_revision,
+                                        pb::coordinator_internal::KvRevInternal &kv_rev) {
+  if (kv_latest_value_cache_.Get(key, mod_revision, kv_rev)) {
+    return butil::Status::OK();
+  }
+
+  auto ret = GetRawKvRev(mod_revision, kv_rev);
+  if (!ret.ok()) {
+    return ret;
+  }
+
+  if (!kv_rev.kv().is_deleted()) {
+    kv_latest_value_cache_.Put(key, kv_rev);
+  }
+
+  return butil::Status::OK();
+}
+
 butil::Status KvControl::PutRawKvRev(const pb::coordinator_internal::RevisionInternal &revision,
                                      const pb::coordinator_internal::KvRevInternal &kv_rev) {
   DINGO_LOG(INFO) << "PutRawKvRev success, revision:[" << revision.ShortDebugString() << "], kv_rev:["
@@ -193,57 +294,68 @@ butil::Status KvControl::KvRange(const std::string &key, const std::string &rang
     limit = INT64_MAX;
   }
 
-  std::vector<pb::coordinator_internal::KvIndexInternal> kv_index_values;
-
+  std::string upper_bound;
   if (range_end.empty()) {
-    pb::coordinator_internal::KvIndexInternal kv_index;
-    auto ret = GetRawKvIndex(key, kv_index);
-    if (!ret.ok()) {
-      return butil::Status::OK();
-    }
-    kv_index_values.push_back(kv_index);
+    // the smallest key greater than key, only get the key
+    upper_bound = key + std::string(1, '\0');
+  } else if (range_end == std::string(1, '\0')) {
+    upper_bound = std::string(FLAGS_max_kv_key_size, '\xff');
   } else {
-    // scan kv_index for legal keys
-    auto ret = RangeRawKvIndex(key, range_end, kv_index_values);
-    if (!ret.ok()) {
-      DINGO_LOG(ERROR) << "KvRange kv_index_map_.RangeRawKvIndex failed, key: " << key << "("
-                       << Helper::StringToHex(key) << "), range_end: " << range_end << "("
-                       << Helper::StringToHex(range_end) << "), error: " << ret.error_str();
-      return ret;
-    }
+    upper_bound = range_end;
   }
 
-  // query kv_rev for values
-  uint32_t limit_count = 0;
-  for (const auto &kv_index_value : kv_index_values) {
-    auto generation_count = kv_index_value.generations_size();
-    if (generation_count == 0) {
-      DINGO_LOG(INFO) << "KvRange generation_count is 0, key: " << key << "(" << Helper::StringToHex(key) << ")";
-      continue;
-    }
-    const auto &latest_generation = kv_index_value.generations(generation_count - 1);
-    if (!latest_generation.has_create_revision() || latest_generation.revisions_size() == 0) {
-      DINGO_LOG(INFO) << "KvRange latest_generation is empty, key: " << key << "(" << Helper::StringToHex(key) << ")";
-      continue;
-    }
+  // scan kv_index with limit, only take the key and latest mod_revision, not copy the generations
+  int64_t count = 0;
+  std::vector<std::pair<std::string, pb::coordinator_internal::RevisionInternal>> key_revisions;
+  auto ret = kv_index_map_.TraverseRange(
+      key, upper_bound,
+      [&](const std::string &index_key, const pb::coordinator_internal::KvIndexInternal &kv_index_value) -> bool {
+        auto generation_count = kv_index_value.generations_size();
+        if (generation_count == 0) {
+          return true;
+        }
+        const auto &latest_generation = kv_index_value.generations(generation_count - 1);
+        if (!latest_generation.has_create_revision() || latest_generation.revisions_size() == 0) {
+          return true;
+        }
 
-    limit_count++;
-    if (limit_count > limit) {
-      has_more = true;
-      break;
-    }
+        if (count >= limit) {
+          has_more = true;
+          return false;
+        }
+        ++count;
 
-    if (count_only) {
-      continue;
-    }
+        if (!count_only) {
+          key_revisions.emplace_back(index_key, kv_index_value.mod_revision());
+        }
+        return true;
+      });
+  if (ret < 0) {
+    DINGO_LOG(ERROR) << "KvRange kv_index_map_.TraverseRange failed, key: " << key << "(" << Helper::StringToHex(key)
+                     << "), range_end: " << range_end << "(" << Helper::StringToHex(range_end) << ")";
+    return butil::Status(EINVAL, "KvRange TraverseRange failed");
+  }
+
+  if (count_only) {
+    return_count = count;
+
+    DINGO_LOG_IF(INFO, FLAGS_dingo_log_switch_coor_kv)
+        << "KvRange count_only finish, key: " << key << "(" << Helper::StringToHex(key) << "), range_end: " << range_end
+        << "(" << Helper::StringToHex(range_end) << "), limit: " << limit << ", count: " << count
+        << ", has_more: " << has_more;
+    return butil::Status::OK();
+  }
 
-    DINGO_LOG(DEBUG) << "KvRange will query kv_rev, revision: " << kv_index_value.mod_revision().ShortDebugString()
-                     << ", key: " << key << "(" << Helper::StringToHex(key) << ")";
+  // query kv_rev for values, prefer the latest value cache
+  kv.reserve(key_revisions.size());
+  for (const auto &[index_key, mod_revision] : key_revisions) {
+    DINGO_LOG(DEBUG) << "KvRange will query kv_rev, revision: " << mod_revision.ShortDebugString() << ", key: " << key
+                     << "(" << Helper::StringToHex(key) << ")";
 
     pb::coordinator_internal::KvRevInternal kv_rev;
-    auto ret = GetRawKvRev(kv_index_value.mod_revision(), kv_rev);
+    auto ret = GetLatestKvRev(index_key, mod_revision, kv_rev);
     if (!ret.ok()) {
-      DINGO_LOG(ERROR) << "GetRawKvRev failed, revision: " << kv_index_value.mod_revision().ShortDebugString()
+      DINGO_LOG(ERROR) << "GetRawKvRev failed, revision: " << mod_revision.ShortDebugString()
                        << ", error: " << ret.error_str();
       continue;
     }
@@ -265,14 +377,13 @@ butil::Status KvControl::KvRange(const std::string &key, const std::string &rang
     if (kv_temp.kv().key().empty()) {
       DINGO_LOG(ERROR) << "KvRange will return null kv: " << kv_temp.ShortDebugString()
                        << ", kv_rev: " << kv_rev.ShortDebugString()
-                       << ", mod_revision: " << kv_index_value.mod_revision().ShortDebugString()
-                       << ", original key: " << key << "(" << Helper::StringToHex(key)
-                       << "), original range_end : " << range_end << "(" << Helper::StringToHex(range_end)
-                       << "), kv_index_internal: " << kv_index_value.ShortDebugString();
+                       << ", mod_revision: " << mod_revision.ShortDebugString() << ", original key: " << key << "("
+                       << Helper::StringToHex(key) << "), original range_end : " << range_end << "("
+                       << Helper::StringToHex(range_end) << "), index key: " << Helper::StringToHex(index_key);
     }
 
     // add to output
-    kv.push_back(kv_temp);
+    kv.push_back(std::move(kv_temp));
   }
 
   return_count = kv.size();
@@ -554,6 +665,8 @@ butil::Status KvControl::KvDeleteRange(const std::string &key, const std::string
 butil::Status KvControl::KvPutApply(const std::string &key,
                                     const pb::coordinator_internal::RevisionInternal &op_revision, bool ignore_lease,
                                     int64_t lease_id, bool ignore_value, const std::string &value) {
+  BAIDU_SCOPED_LOCK(kv_compaction_mutex_);
+
   DINGO_LOG(INFO) << "KvPutApply, key: " << key << "(" << Helper::StringToHex(key)
                   << "), op_revision: " << op_revision.ShortDebugString() << ", ignore_lease: " << ignore_lease
                   << ", lease_id: " << lease_id << ", ignore_value: " << ignore_value << ", value: " << value << "("
@@ -643,7 +756,7 @@ butil::Status KvControl::KvPutApply(const std::string &key,
   // generate new kv_rev
   pb::coordinator_internal::KvRevInternal kv_rev_last;
   pb::coordinator_internal::KvRevInternal kv_rev;
-  GetRawKvRev(last_mod_revision, kv_rev_last);
+  GetLatestKvRev(key, last_mod_revision, kv_rev_last);
 
   kv_rev.set_id(RevisionToString(op_revision));
 
@@ -694,6 +807,7 @@ butil::Status KvControl::KvPutApply(const std::string &key,
   DINGO_LOG_IF(INFO, FLAGS_dingo_log_switch_coor_kv)
       << "KvPutApply PutRawKvRev success, revision: " << op_revision.ShortDebugString()
       << ", kv_rev: " << kv_rev.ShortDebugString();
+  kv_latest_value_cache_.Put(key, kv_rev);
 
   ret = PutRawKvIndex(key, kv_index);
   if (!ret.ok()) {
@@ -703,6 +817,7 @@ butil::Status KvControl::KvPutApply(const std::string &key,
   DINGO_LOG_IF(INFO, FLAGS_dingo_log_switch_coor_kv)
       << "KvPutApply PutRawKvIndex success, key: " << key << "(" << Helper::StringToHex(key)
       << "), kv_index: " << kv_index.ShortDebugString();
+  AddKvCompactionIndex(key, kv_index);
 
   // trigger watch
   if (!one_time_watch_map_.empty()) {
@@ -734,6 +849,8 @@ butil::Status KvControl::KvPutApply(const std::string &key,
 
 butil::Status KvControl::KvDeleteApply(const std::string &key,
                                        const pb::coordinator_internal::RevisionInternal &op_revision) {
+  BAIDU_SCOPED_LOCK(kv_compaction_mutex_);
+
   DINGO_LOG(INFO) << "KvDeleteApply, key: " << key << "(" << Helper::StringToHex(key)
                   << "), revision: " << op_revision.ShortDebugString();
 
@@ -806,7 +923,7 @@ butil::Status KvControl::KvDeleteApply(const std::string &key,
   // generate new kv_rev
   pb::coordinator_internal::KvRevInternal kv_rev_last;
   pb::coordinator_internal::KvRevInternal kv_rev;
-  GetRawKvRev(last_mod_revision, kv_rev_last);
+  GetLatestKvRev(key, last_mod_revision, kv_rev_last);
 
   kv_rev.set_id(RevisionToString(op_revision));
 
@@ -826,6 +943,9 @@ butil::Status KvControl::KvDeleteApply(const std::string &key,
   // is_deleted
   kv->set_is_deleted(true);
 
+  // deleted key is not read by range, release the cache
+  kv_latest_value_cache_.Erase(key);
+
   // do real write to state machine
   // CAUTION: When deleting kv, we must do PutRawKvRev before put RawKvIndex
   ret = PutRawKvIndex(key, kv_index);
@@ -833,6 +953,7 @@ butil::Status KvControl::KvDeleteApply(const std::string &key,
     DINGO_LOG(ERROR) << "KvDeleteApply PutRawKvIndex failed, key: " << key << "(" << Helper::StringToHex(key)
                      << "), kv_index: " << kv_index.ShortDebugString() << ", error: " << ret.error_str();
   }
+  AddKvCompactionIndex(key, kv_index);
 
   ret = PutRawKvRev(op_revision, kv_rev);
   if (!ret.ok()) {
@@ -881,14 +1002,6 @@ void KvControl::CompactionTask() {
     return;
   }
 
-  // get all keys in kv_index_map_
-  std::vector<std::string> keys;
-  auto ret = kv_index_map_.GetAllKeys(keys);
-  if (ret < 0) {
-    DINGO_LOG(ERROR) << "kv_index_map_ GetAllKeys failed";
-    return;
-  }
-
   // build revision struct
   pb::coordinator_internal::RevisionInternal compact_revision;
 
@@ -903,33 +1016,180 @@ void KvControl::CompactionTask() {
 
   compact_revision.set_sub(0);
 
-  // do compaction for each key
-  std::vector<std::string> keys_to_compact;
-  for (const auto &key : keys) {
-    if (keys_to_compact.size() < 50) {
-      keys_to_compact.push_back(key);
-    } else {
-      auto ret = KvCompact(keys_to_compact, compact_revision);
-      if (!ret.ok()) {
-        DINGO_LOG(ERROR) << "KvCompact failed, error: " << ret.error_str() << ", keys size: " << keys_to_compact.size();
-        for (const auto &key : keys_to_compact) {
-          DINGO_LOG(ERROR) << "KvCompact failed, key: " << key << "(" << Helper::StringToHex(key) << ")";
-        }
-      }
-      keys_to_compact.clear();
-    }
+  if (compact_revision.main() <= kv_compact_revision_.load(std::memory_order_acquire)) {
+    DINGO_LOG(INFO) << "compaction task skip, compact_revision: " << compact_revision.main()
+                    << " is not greater than last compact_revision: " << kv_compact_revision_.load();
+    return;
+  }
+
+  // only propose one command, every replica compact the keys which have garbage revisions locally
+  auto ret = KvCompactToRevision(compact_revision);
+  if (!ret.ok()) {
+    DINGO_LOG(ERROR) << "KvCompactToRevision failed, error: " << ret.error_str()
+                     << ", compact_revision: " << compact_revision.ShortDebugString();
+    return;
   }
-  if (!keys_to_compact.empty()) {
-    auto ret = KvCompact(keys_to_compact, compact_revision);
+
+  DINGO_LOG(INFO) << "compaction task end, compact_revision: " << compact_revision.ShortDebugString();
+}
+
+void KvControl::GenKvCompactToRevisionIncrement(const pb::coordinator_internal::RevisionInternal &compact_revision,
+                                                pb::coordinator_internal::MetaIncrement &meta_increment) {
+  // the empty key is not allowed by kv api, so use it as the compact to revision command
+  auto *kv_index_increment = meta_increment.add_kv_indexes();
+  kv_index_increment->set_id(std::string());
+  kv_index_increment->set_op_type(::dingodb::pb::coordinator_internal::MetaIncrementOpType::UPDATE);
+  kv_index_increment->set_event_type(
+      ::dingodb::pb::coordinator_internal::KvIndexEventType::KV_INDEX_EVENT_TYPE_COMPACTION);
+  *(kv_index_increment->mutable_op_revision()) = compact_revision;
+
+  // persist the compact revision in id_epoch_map_, the gc safe point of version kv
+  UpdatePresentId(pb::coordinator::IdEpochType::ID_GC_SAFE_POINT, compact_revision.main(), meta_increment);
+}
+
+butil::Status KvControl::KvCompactToRevision(const pb::coordinator_internal::RevisionInternal &compact_revision) {
+  DINGO_LOG(INFO) << "KvCompactToRevision, revision: " << compact_revision.ShortDebugString();
+
+  pb::coordinator_internal::MetaIncrement meta_increment;
+  GenKvCompactToRevisionIncrement(compact_revision, meta_increment);
+
+  auto ret = SubmitMetaIncrementSync(meta_increment);
+  if (!ret.ok()) {
+    DINGO_LOG(ERROR) << "KvCompactToRevision SubmitMetaIncrement failed, error: " << ret.error_str();
+    return ret;
+  }
+
+  return butil::Status::OK();
+}
+
+void KvControl::KvCompactToRevisionApply(const pb::coordinator_internal::RevisionInternal &compact_revision) {
+  int64_t old_revision = kv_compact_revision_.load(std::memory_order_acquire);
+  while (compact_revision.main() > old_revision &&
+         !kv_compact_revision_.compare_exchange_weak(old_revision, compact_revision.main(), std::memory_order_acq_rel)) {
+  }
+
+  DINGO_LOG(INFO) << "KvCompactToRevisionApply, revision: " << compact_revision.ShortDebugString()
+                  << ", kv_compact_revision: " << kv_compact_revision_.load();
+}
+
+void KvControl::RecoverKvCompactRevision() {
+  kv_compact_revision_.store(GetPresentId(pb::coordinator::IdEpochType::ID_GC_SAFE_POINT), std::memory_order_release);
+
+  DINGO_LOG(INFO) << "RecoverKvCompactRevision, kv_compact_revision: " << kv_compact_revision_.load();
+}
+
+void KvControl::KvCompactionStep() {
+  int64_t compact_revision_main = kv_compact_revision_.load(std::memory_order_acquire);
+  if (compact_revision_main <= 0) {
+    return;
+  }
+
+  pb::coordinator_internal::RevisionInternal compact_revision;
+  compact_revision.set_main(compact_revision_main);
+  compact_revision.set_sub(0);
+
+  auto start_time_ms = Helper::TimestampMs();
+
+  // the mutex is released between keys, so apply is not blocked by a long compaction
+  int64_t compacted_key_count = 0;
+  int64_t deleted_rev_count = 0;
+  while (compacted_key_count < FLAGS_kv_compaction_max_keys_per_step &&
+         deleted_rev_count < FLAGS_kv_compaction_max_revs_per_step) {
+    BAIDU_SCOPED_LOCK(kv_compaction_mutex_);
+
+    if (kv_compaction_index_.empty() || kv_compaction_index_.begin()->first >= compact_revision_main) {
+      break;
+    }
+
+    std::string key = kv_compaction_index_.begin()->second;
+
+    int64_t key_deleted_rev_count = 0;
+    auto ret = DoKvCompact(key, compact_revision, key_deleted_rev_count);
     if (!ret.ok()) {
-      DINGO_LOG(ERROR) << "KvCompact failed, error: " << ret.error_str() << ", keys size: " << keys_to_compact.size();
-      for (const auto &key : keys_to_compact) {
-        DINGO_LOG(ERROR) << "KvCompact failed, key: " << key << "(" << Helper::StringToHex(key) << ")";
-      }
+      DINGO_LOG(WARNING) << "KvCompactionStep compact key failed, key: " << key << "(" << Helper::StringToHex(key)
+                         << "), error: " << ret.error_str();
+    }
+
+    ++compacted_key_count;
+    deleted_rev_count += key_deleted_rev_count;
+  }
+
+  DINGO_LOG_IF(INFO, compacted_key_count > 0)
+      << "KvCompactionStep finish, compact_revision: " << compact_revision_main
+      << ", compacted_key_count: " << compacted_key_count << ", deleted_rev_count: " << deleted_rev_count
+      << ", cost: " << Helper::TimestampMs() - start_time_ms << "ms";
+}
+
+// the oldest revision which can be deleted by compaction, return 0 if no such revision
+// the latest revision of the latest put generation is never compacted
+static int64_t OldestCompactableRevision(const pb::coordinator_internal::KvIndexInternal &kv_index) {
+  for (int i = 0; i < kv_index.generations_size(); ++i) {
+    const auto &generation = kv_index.generations(i);
+    int revisions_size = generation.revisions_size();
+    if (i == kv_index.generations_size() - 1 && generation.has_create_revision()) {
+      --revisions_size;
     }
+
+    if (revisions_size > 0) {
+      return generation.revisions(0).main();
+    }
+  }
+
+  // only deleted generation left, the kv_index itself is garbage
+  if (kv_index.generations_size() > 0 &&
+      !kv_index.generations(kv_index.generations_size() - 1).has_create_revision()) {
+    return kv_index.mod_revision().main();
   }
 
-  DINGO_LOG(INFO) << "compaction task end, keys_count=" << keys.size();
+  return 0;
+}
+
+void KvControl::AddKvCompactionIndex(const std::string &key,
+                                     const pb::coordinator_internal::KvIndexInternal &kv_index) {
+  // the oldest compactable revision is not changed by new revision
+  if (kv_compaction_key_revisions_.find(key) != kv_compaction_key_revisions_.end()) {
+    return;
+  }
+
+  int64_t revision = OldestCompactableRevision(kv_index);
+  if (revision <= 0) {
+    return;
+  }
+
+  kv_compaction_key_revisions_.emplace(key, revision);
+  kv_compaction_index_.emplace(revision, key);
+}
+
+void KvControl::EraseKvCompactionIndex(const std::string &key) {
+  auto iter = kv_compaction_key_revisions_.find(key);
+  if (iter == kv_compaction_key_revisions_.end()) {
+    return;
+  }
+
+  kv_compaction_index_.erase(std::make_pair(iter->second, key));
+  kv_compaction_key_revisions_.erase(iter);
+}
+
+void KvControl::BuildKvCompactionIndex(bool has_mutex_locked) {
+  if (!has_mutex_locked) {
+    bthread_mutex_lock(&kv_compaction_mutex_);
+  }
+
+  kv_compaction_index_.clear();
+  kv_compaction_key_revisions_.clear();
+  // traverse kv_index_map_ in place, not copy all kv index out
+  auto kv_index_count = kv_index_map_.Traverse(
+      [this](const std::string &key, const pb::coordinator_internal::KvIndexInternal &kv_index) -> bool {
+        AddKvCompactionIndex(key, kv_index);
+        return true;
+      });
+
+  DINGO_LOG(INFO) << "BuildKvCompactionIndex, kv_index count: " << kv_index_count
+                  << ", compactable key count: " << kv_compaction_index_.size();
+
+  if (!has_mutex_locked) {
+    bthread_mutex_unlock(&kv_compaction_mutex_);
+  }
 }
 
 static void Done(std::atomic<bool> *done) { done->store(true, std::memory_order_release); }
@@ -974,6 +1234,22 @@ butil::Status KvControl::KvCompactApply(const std::string &key,
   DINGO_LOG(INFO) << "KvCompactApply, key: " << key << "(" << Helper::StringToHex(key)
                   << "), revision: " << compact_revision.ShortDebugString();
 
+  BAIDU_SCOPED_LOCK(kv_compaction_mutex_);
+
+  int64_t deleted_rev_count = 0;
+  return DoKvCompact(key, compact_revision, deleted_rev_count);
+}
+
+butil::Status KvControl::DoKvCompact(const std::string &key,
+                                     const pb::coordinator_internal::RevisionInternal &compact_revision,
+                                     int64_t &deleted_rev_count) {
+  DINGO_LOG_IF(INFO, FLAGS_dingo_log_switch_coor_kv)
+      << "DoKvCompact, key: " << key << "(" << Helper::StringToHex(key)
+      << "), revision: " << compact_revision.ShortDebugString();
+
+  // re-add by the new kv_index after compaction
+  EraseKvCompactionIndex(key);
+
   // get kv_index
   pb::coordinator_internal::KvIndexInternal kv_index;
   auto ret = GetRawKvIndex(key, kv_index);
@@ -1077,6 +1353,7 @@ butil::Status KvControl::KvCompactApply(const std::string &key,
         << "KvCompactApply new_kv_index has generations, put it, key: " << key << "(" << Helper::StringToHex(key)
         << "), new_kv_index: " << new_kv_index.ShortDebugString();
     PutRawKvIndex(key, new_kv_index);
+    AddKvCompactionIndex(key, new_kv_index);
   }
 
   // delete revisions in kv_rev
@@ -1084,12 +1361,13 @@ butil::Status KvControl::KvCompactApply(const std::string &key,
     pb::coordinator_internal::KvRevInternal kv_rev;
     kv_rev.set_id(RevisionToString(kv_revision));
 
-    DINGO_LOG(INFO) << "KvCompactApply delete kv_rev, kv_revision: " << kv_revision.ShortDebugString()
-                    << ", key: " << key << "(" << Helper::StringToHex(key)
-                    << "), kv_rev: " << kv_rev.ShortDebugString();
+    DINGO_LOG_IF(INFO, FLAGS_dingo_log_switch_coor_kv)
+        << "KvCompactApply delete kv_rev, kv_revision: " << kv_revision.ShortDebugString() << ", key: " << key << "("
+        << Helper::StringToHex(key) << "), kv_rev: " << kv_rev.ShortDebugString();
 
     DeleteRawKvRev(kv_revision);
   }
+  deleted_rev_count = revisions_to_delete.size();
 
   return butil::Status::OK();
 }
@@ -15,6 +15,7 @@
 #include <sys/types.h>
 
 #include <cstdint>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -36,6 +37,7 @@ DEFINE_int64(version_lease_max_ttl_seconds, 300, "max ttl seconds for version le
 DEFINE_int64(version_lease_min_ttl_seconds, 3, "min ttl seconds for version lease");
 DEFINE_int64(version_lease_max_count, 50000, "max lease count");
 DEFINE_int64(version_lease_print_ttl_remaining_seconds, 10, "print ttl remaining seconds if value is less than this");
+DEFINE_int64(version_lease_checkpoint_interval_s, 30, "checkpoint interval seconds of lease last renew time");
 
 DEFINE_bool(dingo_log_switch_coor_lease, false, "switch for dingo log of kv control lease");
 
@@ -95,42 +97,38 @@ butil::Status KvControl::LeaseGrant(int64_t lease_id, int64_t ttl_seconds, int64
   {
     BAIDU_SCOPED_LOCK(lease_to_key_map_temp_mutex_);
     lease_to_key_map_temp_.emplace(lease_with_keys.lease.id(), lease_with_keys);
+    lease_timer_wheel_.Add(granted_id,
+                           lease_with_keys.lease.last_renew_ts_seconds() + lease_with_keys.lease.ttl_seconds() + 1);
   }
 
   return butil::Status::OK();
 }  // namespace dingodb
 
 butil::Status KvControl::LeaseRenew(int64_t lease_id, int64_t &ttl_seconds,
-                                    pb::coordinator_internal::MetaIncrement &meta_increment) {
-  pb::coordinator_internal::LeaseInternal lease;
-
+                                    pb::coordinator_internal::MetaIncrement & /*meta_increment*/) {
   BAIDU_SCOPED_LOCK(lease_to_key_map_temp_mutex_);
 
   auto now_time_seconds = butil::gettimeofday_s();
 
   auto iter = lease_to_key_map_temp_.find(lease_id);
-  if (iter != lease_to_key_map_temp_.end()) {
-    iter->second.lease.set_last_renew_ts_seconds(now_time_seconds);
-  } else {
+  if (iter == lease_to_key_map_temp_.end()) {
     DINGO_LOG(WARNING) << "lease id " << lease_id << " not found, cannot renew";
     return butil::Status(pb::error::Errno::ELEASE_NOT_EXISTS_OR_EXPIRED, "lease id %lu not found", lease_id);
   }
 
-  auto ret = kv_lease_map_.Get(lease_id, lease);
-  if (ret < 0) {
+  if (!kv_lease_map_.Exists(lease_id)) {
     DINGO_LOG(WARNING) << "lease id " << lease_id << " not found";
     return butil::Status(pb::error::Errno::ELEASE_NOT_EXISTS_OR_EXPIRED, "lease id %lu not found", lease_id);
   }
 
-  ttl_seconds = lease.ttl_seconds();
+  // keepalive is leader local, not write raft, the last renew time is checkpointed by LeaseTask,
+  // and all leases are re-granted with their ttl when leader change
+  auto &lease = iter->second.lease;
   lease.set_last_renew_ts_seconds(now_time_seconds);
+  ttl_seconds = lease.ttl_seconds();
 
-  // generate meta_increment
-  auto *lease_increment = meta_increment.add_leases();
-  lease_increment->set_id(lease_id);
-  lease_increment->set_op_type(::dingodb::pb::coordinator_internal::MetaIncrementOpType::UPDATE);
-  auto *increment_lease = lease_increment->mutable_lease();
-  increment_lease->Swap(&lease);
+  lease_timer_wheel_.Add(lease_id, now_time_seconds + lease.ttl_seconds() + 1);
+  lease_checkpoint_dirty_ids_.insert(lease_id);
 
   return butil::Status::OK();
 }
@@ -187,6 +185,7 @@ butil::Status KvControl::LeaseRevoke(int64_t lease_id, pb::coordinator_internal:
     // delete lease from map
     lease_to_key_map_temp_.erase(lease_id);
   }
+  lease_checkpoint_dirty_ids_.erase(lease_id);
 
   if (!has_mutex_locked) {
     bthread_mutex_unlock(&lease_to_key_map_temp_mutex_);
@@ -195,16 +194,20 @@ butil::Status KvControl::LeaseRevoke(int64_t lease_id, pb::coordinator_internal:
   return butil::Status::OK();
 }
 
+// the renew of lease only update lease_to_key_map_temp_ of leader, kv_lease_map_ is checkpointed periodically,
+// so list leases from lease_to_key_map_temp_ to get the latest last_renew_ts_seconds
 butil::Status KvControl::ListLeases(std::vector<pb::coordinator_internal::LeaseInternal> &leases) {
-  butil::FlatMap<int64_t, pb::coordinator_internal::LeaseInternal> version_lease_map;
-  kv_lease_map_.GetRawMapCopy(version_lease_map);
-  for (auto &it : version_lease_map) {
-    leases.emplace_back(std::move(it.second));
+  BAIDU_SCOPED_LOCK(lease_to_key_map_temp_mutex_);
+
+  leases.reserve(lease_to_key_map_temp_.size());
+  for (const auto &[lease_id, lease_with_keys] : lease_to_key_map_temp_) {
+    leases.push_back(lease_with_keys.lease);
   }
 
   return butil::Status::OK();
 }
 
+// the remaining ttl is computed from the in-memory renew state of leader, not the checkpointed kv_lease_map_
 butil::Status KvControl::LeaseQuery(int64_t lease_id, bool get_keys, int64_t &granted_ttl_seconds,
                                     int64_t &remaining_ttl_seconds, std::set<std::string> &keys) {
   BAIDU_SCOPED_LOCK(lease_to_key_map_temp_mutex_);
@@ -232,34 +235,42 @@ butil::Status KvControl::LeaseQuery(int64_t lease_id, bool get_keys, int64_t &gr
 
 void KvControl::LeaseTask() {
   auto lease_task_start_time_ms = Helper::TimestampMs();
-  DINGO_LOG(INFO) << "lease task start, start_time: " << lease_task_start_time_ms;
+  DINGO_LOG(DEBUG) << "lease task start, start_time: " << lease_task_start_time_ms;
 
-  std::vector<int64_t> lease_ids_to_revoke;
-  pb::coordinator_internal::MetaIncrement meta_increment;
+  auto now_time_seconds = butil::gettimeofday_s();
+
+  int64_t revoke_count = 0;
+  pb::coordinator_internal::MetaIncrement checkpoint_meta_increment;
   {
     BAIDU_SCOPED_LOCK(lease_to_key_map_temp_mutex_);
     if (lease_to_key_map_temp_.empty()) {
       return;
     }
 
-    for (const auto &it : lease_to_key_map_temp_) {
-      const auto &lease = it.second.lease;
-      if (lease.ttl_seconds() + lease.last_renew_ts_seconds() < butil::gettimeofday_s()) {
-        DINGO_LOG(INFO) << "lease id " << lease.id() << " expired, will revoke";
-        lease_ids_to_revoke.emplace_back(lease.id());
-      } else {
-        auto remaining_ttl_seconds = lease.ttl_seconds() - (butil::gettimeofday_s() - lease.last_renew_ts_seconds());
-        if (remaining_ttl_seconds < FLAGS_version_lease_print_ttl_remaining_seconds) {
-          DINGO_LOG(INFO) << "lease id " << lease.id() << " is ok, last_renew_ts_seconds "
-                          << lease.last_renew_ts_seconds() << ", ttl_seconds " << lease.ttl_seconds()
-                          << ", remaining ttl_seconds " << remaining_ttl_seconds;
-        }
+    // only touch the leases which are due, the stale entry of renewed lease is skipped
+    std::vector<LeaseTimerWheel::Entry> due_entries;
+    lease_timer_wheel_.Advance(now_time_seconds, due_entries);
+
+    std::set<int64_t> lease_ids_to_revoke;
+    for (const auto &entry : due_entries) {
+      auto iter = lease_to_key_map_temp_.find(entry.lease_id);
+      if (iter == lease_to_key_map_temp_.end()) {
+        continue;
+      }
+
+      const auto &lease = iter->second.lease;
+      if (lease.ttl_seconds() + lease.last_renew_ts_seconds() < now_time_seconds) {
+        DINGO_LOG(INFO) << "lease id " << lease.id() << " expired, will revoke, last_renew_ts_seconds "
+                        << lease.last_renew_ts_seconds() << ", ttl_seconds " << lease.ttl_seconds();
+        lease_ids_to_revoke.insert(lease.id());
       }
     }
 
+    pb::coordinator_internal::MetaIncrement meta_increment;
     for (const auto &lease_id : lease_ids_to_revoke) {
       LeaseRevoke(lease_id, meta_increment, true);
     }
+    revoke_count = lease_ids_to_revoke.size();
 
     // submit meta_increment with mutex locked
     // if we do this without lock, there maybe KvPut before LeaseRevoke, which will cause data inconsistency
@@ -269,53 +280,75 @@ void KvControl::LeaseTask() {
         DINGO_LOG(ERROR) << "SubmitMetaIncrementSync failed, status: " << ret;
       }
     }
+
+    // checkpoint the last renew time of renewed leases by one raft write
+    if (now_time_seconds - last_lease_checkpoint_ts_seconds_ >= FLAGS_version_lease_checkpoint_interval_s &&
+        !lease_checkpoint_dirty_ids_.empty()) {
+      for (const auto &lease_id : lease_checkpoint_dirty_ids_) {
+        auto iter = lease_to_key_map_temp_.find(lease_id);
+        if (iter == lease_to_key_map_temp_.end()) {
+          continue;
+        }
+
+        auto *lease_increment = checkpoint_meta_increment.add_leases();
+        lease_increment->set_id(lease_id);
+        lease_increment->set_op_type(::dingodb::pb::coordinator_internal::MetaIncrementOpType::UPDATE);
+        *(lease_increment->mutable_lease()) = iter->second.lease;
+      }
+      lease_checkpoint_dirty_ids_.clear();
+      last_lease_checkpoint_ts_seconds_ = now_time_seconds;
+    }
+  }
+
+  // lease UPDATE is applied only if the lease exists, so submit without mutex is safe
+  if (checkpoint_meta_increment.leases_size() > 0) {
+    auto ret = SubmitMetaIncrementSync(checkpoint_meta_increment);
+    if (!ret.ok()) {
+      DINGO_LOG(ERROR) << "SubmitMetaIncrementSync lease checkpoint failed, status: " << ret;
+    }
   }
 
   auto lease_task_end_time_ms = Helper::TimestampMs();
-  DINGO_LOG(INFO) << "lease task finish, start_time: " << lease_task_start_time_ms
-                  << ", end_time: " << lease_task_end_time_ms
-                  << ", cost: " << lease_task_end_time_ms - lease_task_start_time_ms << "ms";
+  DINGO_LOG_IF(INFO, revoke_count > 0 || checkpoint_meta_increment.leases_size() > 0)
+      << "lease task finish, start_time: " << lease_task_start_time_ms << ", end_time: " << lease_task_end_time_ms
+      << ", cost: " << lease_task_end_time_ms - lease_task_start_time_ms << "ms, revoke_count: " << revoke_count
+      << ", checkpoint_count: " << checkpoint_meta_increment.leases_size();
 }
 
 void KvControl::BuildLeaseToKeyMap() {
   // build lease_to_key_map_temp_
   std::map<int64_t, KvLeaseWithKeys> t_lease_to_key;
 
-  butil::FlatMap<int64_t, pb::coordinator_internal::LeaseInternal> version_lease_to_key_map_copy;
-  version_lease_to_key_map_copy.init(10000);
-  kv_lease_map_.GetRawMapCopy(version_lease_to_key_map_copy);
-
-  t_lease_to_key.clear();
-  for (auto lease : version_lease_to_key_map_copy) {
-    KvLeaseWithKeys lease_with_keys;
-    lease_with_keys.lease.Swap(&lease.second);
-    t_lease_to_key.insert(std::make_pair(lease.first, lease_with_keys));
-  }
-
-  // read all keys from version_kv to construct lease list
-  std::vector<pb::coordinator_internal::KvIndexInternal> kv_index_values;
-
-  if (kv_index_map_.GetAllValues(kv_index_values, [](pb::coordinator_internal::KvIndexInternal version_kv) -> bool {
+  kv_lease_map_.Traverse(
+      [&t_lease_to_key](const int64_t &lease_id, const pb::coordinator_internal::LeaseInternal &lease) {
+        KvLeaseWithKeys lease_with_keys;
+        lease_with_keys.lease = lease;
+        t_lease_to_key.insert(std::make_pair(lease_id, lease_with_keys));
+        return true;
+      });
+
+  // read all keys from version_kv to construct lease list, only the mod revision of alive key is projected out
+  std::vector<pb::coordinator_internal::RevisionInternal> mod_revisions;
+  if (kv_index_map_.Traverse([&mod_revisions](const std::string & /*key*/,
+                                              const pb::coordinator_internal::KvIndexInternal &version_kv) -> bool {
         auto generation_count = version_kv.generations_size();
         if (generation_count == 0) {
-          return false;
+          return true;
         }
         const auto &latest_generation = version_kv.generations(generation_count - 1);
-        return latest_generation.has_create_revision();
+        if (latest_generation.has_create_revision()) {
+          mod_revisions.push_back(version_kv.mod_revision());
+        }
+        return true;
       }) < 0) {
-    DINGO_LOG(FATAL) << "OnLeaderStart kv_index_map_.GetAllValues failed";
+    DINGO_LOG(FATAL) << "OnLeaderStart kv_index_map_.Traverse failed";
   }
 
-  for (const auto &kv_index_value : kv_index_values) {
-    auto generation_count = kv_index_value.generations_size();
-    if (generation_count == 0) {
-      continue;
-    }
-    const auto &latest_generation = kv_index_value.generations(generation_count - 1);
+  for (const auto &mod_revision : mod_revisions) {
     pb::coordinator_internal::KvRevInternal kv_rev;
-    auto ret = GetRawKvRev(kv_index_value.mod_revision(), kv_rev);
+    auto ret = GetRawKvRev(mod_revision, kv_rev);
     if (!ret.ok()) {
-      DINGO_LOG(ERROR) << "GetRawKvRev failed, revision: " << kv_index_value.mod_revision().ShortDebugString();
+      DINGO_LOG(ERROR) << "GetRawKvRev failed, revision: " << mod_revision.ShortDebugString();
       continue;
     }
 
@@ -330,8 +363,20 @@ void KvControl::BuildLeaseToKeyMap() {
     }
   }
 
+  // re-grant all leases with their ttl, the last renew time in state machine is only the checkpoint,
+  // so the new leader must not expire the leases which are kept alive by the old leader
+  auto now_time_seconds = butil::gettimeofday_s();
+
   BAIDU_SCOPED_LOCK(lease_to_key_map_temp_mutex_);
   lease_to_key_map_temp_.swap(t_lease_to_key);
+
+  lease_timer_wheel_.Clear(now_time_seconds);
+  lease_checkpoint_dirty_ids_.clear();
+  last_lease_checkpoint_ts_seconds_ = now_time_seconds;
+  for (auto &[lease_id, lease_with_keys] : lease_to_key_map_temp_) {
+    lease_with_keys.lease.set_last_renew_ts_seconds(now_time_seconds);
+    lease_timer_wheel_.Add(lease_id, now_time_seconds + lease_with_keys.lease.ttl_seconds() + 1);
+  }
 }
 
 butil::Status KvControl::LeaseAddKeys(int64_t lease_id, std::set<std::string> &keys) {
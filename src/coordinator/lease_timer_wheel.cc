@@ -0,0 +1,118 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "coordinator/lease_timer_wheel.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace dingodb {
+
+void LeaseTimerWheel::Add(int64_t lease_id, int64_t expire_ts_seconds) {
+  AddEntry({lease_id, expire_ts_seconds});
+  ++size_;
+}
+
+void LeaseTimerWheel::AddEntry(const Entry &entry) {
+  int64_t expire_ts_seconds = entry.expire_ts_seconds;
+  // Already due, fire at current tick.
+  if (expire_ts_seconds < current_seconds_) {
+    expire_ts_seconds = current_seconds_;
+  }
+
+  int64_t delta = expire_ts_seconds - current_seconds_;
+  if (delta > kMaxDeltaSeconds) {
+    expire_ts_seconds = current_seconds_ + kMaxDeltaSeconds;
+    delta = kMaxDeltaSeconds;
+  }
+
+  int level = 0;
+  while (level < kLevelCount - 1 && delta >= (int64_t{1} << (kSlotBits * (level + 1)))) {
+    ++level;
+  }
+
+  int64_t slot = (expire_ts_seconds >> (kSlotBits * level)) & kSlotMask;
+  wheels_[level][slot].push_back(entry);
+}
+
+void LeaseTimerWheel::Cascade(int level) {
+  int64_t slot = (current_seconds_ >> (kSlotBits * level)) & kSlotMask;
+  std::vector<Entry> entries;
+  entries.swap(wheels_[level][slot]);
+  for (const auto &entry : entries) {
+    AddEntry(entry);
+  }
+}
+
+void LeaseTimerWheel::Advance(int64_t now_seconds, std::vector<Entry> &due_entries) {
+  // Clock jump too far, rebuild the wheel instead of tick one by one.
+  if (now_seconds - current_seconds_ > kMaxDeltaSeconds) {
+    std::vector<Entry> entries;
+    for (auto &wheel : wheels_) {
+      for (auto &slot_entries : wheel) {
+        entries.insert(entries.end(), slot_entries.begin(), slot_entries.end());
+        slot_entries.clear();
+      }
+    }
+
+    current_seconds_ = now_seconds;
+    size_ = 0;
+    for (const auto &entry : entries) {
+      if (entry.expire_ts_seconds <= now_seconds) {
+        due_entries.push_back(entry);
+      } else {
+        Add(entry.lease_id, entry.expire_ts_seconds);
+      }
+    }
+    ++current_seconds_;
+    return;
+  }
+
+  while (current_seconds_ <= now_seconds) {
+    // Cascade from the highest level, when lower level wrap.
+    for (int level = kLevelCount - 1; level > 0; --level) {
+      if ((current_seconds_ & ((int64_t{1} << (kSlotBits * level)) - 1)) == 0) {
+        Cascade(level);
+      }
+    }
+
+    auto &slot_entries = wheels_[0][current_seconds_ & kSlotMask];
+    std::vector<Entry> entries;
+    entries.swap(slot_entries);
+    for (const auto &entry : entries) {
+      if (entry.expire_ts_seconds <= current_seconds_) {
+        due_entries.push_back(entry);
+        --size_;
+      } else {
+        // Capped by max delta, add again.
+        AddEntry(entry);
+      }
+    }
+
+    ++current_seconds_;
+  }
+}
+
+void LeaseTimerWheel::Clear(int64_t now_seconds) {
+  for (auto &wheel : wheels_) {
+    for (auto &slot_entries : wheel) {
+      std::vector<Entry>().swap(slot_entries);
+    }
+  }
+  current_seconds_ = now_seconds;
+  size_ = 0;
+}
+
+}  // namespace dingodb
@@ -0,0 +1,71 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGODB_COORDINATOR_LEASE_TIMER_WHEEL_H_
+#define DINGODB_COORDINATOR_LEASE_TIMER_WHEEL_H_
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace dingodb {
+
+// Hierarchical timer wheel for lease expiry, the tick is one second.
+// level 0 slot is 1s, level 1 slot is 64s, level 2 slot is 4096s, entries of upper level are cascaded
+// to lower level when the lower level wrap, so advance one tick only touch the due slot.
+// Renew just add a new entry, the stale entry is dropped by caller when it is due,
+// by compare with the latest expire time of lease.
+// Not thread safe, protected by the caller.
+class LeaseTimerWheel {
+ public:
+  struct Entry {
+    int64_t lease_id;
+    int64_t expire_ts_seconds;
+  };
+
+  explicit LeaseTimerWheel(int64_t now_seconds) : current_seconds_(now_seconds) {}
+  ~LeaseTimerWheel() = default;
+
+  LeaseTimerWheel(const LeaseTimerWheel &) = delete;
+  LeaseTimerWheel &operator=(const LeaseTimerWheel &) = delete;
+
+  // Lease is due when now >= expire_ts_seconds.
+  void Add(int64_t lease_id, int64_t expire_ts_seconds);
+
+  // Advance to now, output the due entries.
+  void Advance(int64_t now_seconds, std::vector<Entry> &due_entries);
+
+  void Clear(int64_t now_seconds);
+
+  int64_t Size() const { return size_; }
+
+ private:
+  static constexpr int kSlotBits = 6;
+  static constexpr int64_t kSlotCount = 1 << kSlotBits;
+  static constexpr int64_t kSlotMask = kSlotCount - 1;
+  static constexpr int kLevelCount = 3;
+  // Max delta of the wheel, the farther entry is put into the last slot and re-cascaded.
+  static constexpr int64_t kMaxDeltaSeconds = (int64_t{1} << (kSlotBits * kLevelCount)) - 1;
+
+  void AddEntry(const Entry &entry);
+  void Cascade(int level);
+
+  int64_t current_seconds_;
+  int64_t size_{0};
+  std::array<std::array<std::vector<Entry>, kSlotCount>, kLevelCount> wheels_;
+};
+
+}  // namespace dingodb
+
+#endif  // DINGODB_COORDINATOR_LEASE_TIMER_WHEEL_H_
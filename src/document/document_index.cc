@@ -34,6 +34,9 @@
 
 namespace dingodb {
 
+// Dirty document index id, filled by write/apply and consumed by scrub.
+static DirtySet g_document_index_dirty_set;
+
 butil::Status DocumentIndex::RemoveIndexFiles(int64_t id, const std::string& index_path) {
   DINGO_LOG(INFO) << fmt::format("[document_index.raw][id({})] remove index files, path: {}", id, index_path);
   Helper::RemoveAllFileOrDirectory(index_path);
@@ -50,6 +53,13 @@ DocumentIndex::DocumentIndex(int64_t id, const std::string& index_path,
       document_index_parameter(document_index_parameter),
       epoch(epoch),
       range(range) {
+  std::string error_message;
+  if (!DocumentCodec::IsValidTokenizerJsonParameter(document_index_parameter.json_parameter(), column_types_,
+                                                    error_message)) {
+    DINGO_LOG(WARNING) << fmt::format("[document_index.raw][id({})] parse json parameter failed, error: {}", id,
+                                      error_message);
+  }
+
   DINGO_LOG(DEBUG) << fmt::format("[new.DocumentIndex][id({})]", id);
 }
 
@@ -557,7 +567,18 @@ int64_t DocumentIndexWrapper::LastBuildEpochVersion() { return 0; }  // NOLINT
 
 int64_t DocumentIndexWrapper::ApplyLogId() { return apply_log_id_.load(); }
 
-void DocumentIndexWrapper::SetApplyLogId(int64_t apply_log_id) { apply_log_id_.store(apply_log_id); }
+void DocumentIndexWrapper::SetApplyLogId(int64_t apply_log_id) {
+  apply_log_id_.store(apply_log_id);
+  MarkDirty();
+}
+
+void DocumentIndexWrapper::MarkDirty() {
+  if (dirty_flag_.Mark()) {
+    g_document_index_dirty_set.Add(Id());
+  }
+}
+
+std::vector<int64_t> DocumentIndexWrapper::TakeDirtyIds() { return g_document_index_dirty_set.Take(); }
 
 void DocumentIndexWrapper::SaveApplyLogId(int64_t apply_log_id) {
   SetApplyLogId(apply_log_id);
@@ -611,6 +632,7 @@ void DocumentIndexWrapper::UpdateDocumentIndex(DocumentIndexPtr document_index,
     ++version_;
 
     ready_.store(true);
+    MarkDirty();
 
     int64_t apply_log_id = ApplyLogId();
     int64_t snapshot_log_id = SnapshotLogId();
@@ -928,12 +950,15 @@ butil::Status DocumentIndexWrapper::Upsert(const std::vector<pb::common::Documen
 
     write_key_count_ += document_with_ids.size();
 
+    MarkDirty();
+
     return status;
   }
 
   auto status = document_index->Upsert(document_with_ids, true);
   if (status.ok()) {
     write_key_count_ += document_with_ids.size();
+    MarkDirty();
   }
   return status;
 }
@@ -975,12 +1000,15 @@ butil::Status DocumentIndexWrapper::Add(const std::vector<pb::common::DocumentWi
 
     write_key_count_ += document_with_ids.size();
 
+    MarkDirty();
+
     return status;
   }
 
   auto status = document_index->Add(document_with_ids, true);
   if (status.ok()) {
     write_key_count_ += document_with_ids.size();
+    MarkDirty();
   }
   return status;
 }
@@ -1016,6 +1044,7 @@ butil::Status DocumentIndexWrapper::Delete(const std::vector<int64_t>& delete_id
     status = document_index->Delete(FilterDocumentId(delete_ids, document_index->Range()));
     if (status.ok()) {
       write_key_count_ += delete_ids.size();
+      MarkDirty();
     }
     return status;
   }
@@ -1023,6 +1052,7 @@ butil::Status DocumentIndexWrapper::Delete(const std::vector<int64_t>& delete_id
   auto status = document_index->Delete(delete_ids);
   if (status.ok()) {
     write_key_count_ += delete_ids.size();
+    MarkDirty();
   }
   return status;
 }
@@ -1075,6 +1105,33 @@ static void MergeSearchResult(uint32_t topk, std::vector<pb::common::DocumentWit
 butil::Status DocumentIndexWrapper::Search(const pb::common::Range& region_range,
                                            const pb::common::DocumentSearchParameter& parameter,
                                            std::vector<pb::common::DocumentWithScore>& results) {
+  return Search(region_range, parameter, {}, false, {}, results);
+}
+
+// Search one document index with the pushed down filter.
+static butil::Status SearchWithFilter(DocumentIndexPtr document_index, uint32_t topk, const std::string& query_string,
+                                      bool use_range_filter, int64_t start_id, int64_t end_id, bool use_id_filter,
+                                      const std::vector<int64_t>& alive_ids,
+                                      std::vector<pb::common::DocumentWithScore>& results) {
+  std::vector<uint64_t> compact_alive_ids;
+  if (use_id_filter) {
+    compact_alive_ids.assign(alive_ids.begin(), alive_ids.end());
+    if (!DocumentSearchFilter::CompactAllowIds(compact_alive_ids, use_range_filter, start_id, end_id,
+                                               use_id_filter)) {
+      // Not exist alive id, result is empty.
+      return butil::Status::OK();
+    }
+  }
+
+  return document_index->Search(topk, query_string, use_range_filter, start_id, end_id, use_id_filter,
+                                compact_alive_ids, {}, results);
+}
+
+butil::Status DocumentIndexWrapper::Search(const pb::common::Range& region_range,
+                                           const pb::common::DocumentSearchParameter& parameter,
+                                           const std::vector<DocumentScalarPredicate>& scalar_predicates,
+                                           bool use_id_filter, const std::vector<int64_t>& alive_ids,
+                                           std::vector<pb::common::DocumentWithScore>& results) {
   if (!IsReady()) {
     DINGO_LOG(WARNING) << fmt::format("[document_index.wrapper][index_id({})] document index is not ready.", Id());
     return butil::Status(pb::error::EDOCUMENT_INDEX_NOT_FOUND, "document index %lu is not ready.", Id());
@@ -1085,21 +1142,31 @@ butil::Status DocumentIndexWrapper::Search(const pb::common::Range& region_range
     return butil::Status(pb::error::EDOCUMENT_INDEX_NOT_FOUND, "document index %lu is not ready.", Id());
   }
 
+  // Push down scalar predicates as required query clauses.
+  std::string query_string;
+  auto status = DocumentSearchFilter::BuildQueryString(parameter.query_string(), scalar_predicates,
+                                                       document_index->ColumnTypes(), query_string);
+  if (!status.ok()) {
+    DINGO_LOG(WARNING) << fmt::format("[document_index.wrapper][index_id({})] build query string failed, error: {}",
+                                      Id(), status.error_str());
+    return status;
+  }
+
   // Exist sibling document index, so need to separate search document.
   auto sibling_document_index = SiblingDocumentIndex();
   if (sibling_document_index != nullptr) {
     DINGO_LOG(INFO) << fmt::format("[document_index.wrapper][index_id({})] search document in sibling document index.",
                                    Id());
     std::vector<pb::common::DocumentWithScore> results_1;
-    auto status = sibling_document_index->Search(parameter.top_n(), parameter.query_string(), false, 0, INT64_MAX,
-                                                 false, {}, {}, results_1);
+    status = SearchWithFilter(sibling_document_index, parameter.top_n(), query_string, false, 0, INT64_MAX,
+                              use_id_filter, alive_ids, results_1);
     if (!status.ok()) {
       return status;
     }
 
     std::vector<pb::common::DocumentWithScore> results_2;
-    status = document_index->Search(parameter.top_n(), parameter.query_string(), false, 0, INT64_MAX, false, {}, {},
-                                    results_2);
+    status = SearchWithFilter(document_index, parameter.top_n(), query_string, false, 0, INT64_MAX, use_id_filter,
+                              alive_ids, results_2);
     if (!status.ok()) {
       return status;
     }
@@ -1117,30 +1184,20 @@ butil::Status DocumentIndexWrapper::Search(const pb::common::Range& region_range
         "[document_index.wrapper][index_id({})] search document in document index with range_filter, range({}) "
         "query_string({}) "
         "top_n({}) min_document_id({}) max_document_id({})",
-        Id(), DocumentCodec::DecodeRangeToString(region_range), parameter.query_string(), parameter.top_n(),
-        min_document_id, max_document_id);
+        Id(), DocumentCodec::DecodeRangeToString(region_range), query_string, parameter.top_n(), min_document_id,
+        max_document_id);
 
     // use range filter
-    return document_index->Search(parameter.top_n(), parameter.query_string(), true, min_document_id, max_document_id,
-                                  false, {}, {}, results);
-
-    // auto ret =
-    //     DocumentIndexWrapper::SetDocumentIndexRangeFilter(document_index, filters, min_document_id,
-    //     max_document_id);
-    // if (!ret.ok()) {
-    //   DINGO_LOG(ERROR) << fmt::format(
-    //       "[document_index.wrapper][index_id({})] set document index filter failed, error: {}", Id(),
-    //       ret.error_str());
-    //   return ret;
-    // }
+    return SearchWithFilter(document_index, parameter.top_n(), query_string, true, min_document_id, max_document_id,
+                            use_id_filter, alive_ids, results);
   }
 
   DINGO_LOG(INFO) << fmt::format(
       "[document_index.wrapper][index_id({})] search document in document index, range({}) query_string({}) top_n({})",
-      Id(), DocumentCodec::DecodeRangeToString(region_range), parameter.query_string(), parameter.top_n());
+      Id(), DocumentCodec::DecodeRangeToString(region_range), query_string, parameter.top_n());
 
-  return document_index->Search(parameter.top_n(), parameter.query_string(), false, 0, INT64_MAX, false, {}, {},
-                                results);
+  return SearchWithFilter(document_index, parameter.top_n(), query_string, false, 0, INT64_MAX, use_id_filter,
+                          alive_ids, results);
 }
 
 // butil::Status DocumentIndexWrapper::SetDocumentIndexRangeFilter(
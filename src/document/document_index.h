@@ -17,15 +17,19 @@
 
 #include <atomic>
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "bthread/types.h"
 #include "butil/status.h"
+#include "common/dirty_set.h"
 #include "common/runnable.h"
 #include "common/synchronization.h"
+#include "document/codec.h"
 #include "document/document_index_snapshot.h"
+#include "document/document_search_filter.h"
 #include "proto/common.pb.h"
 
 namespace dingodb {
@@ -86,6 +90,9 @@ class DocumentIndex {
 
   pb::common::DocumentIndexParameter DocumentIndexParameter() { return document_index_parameter; }
 
+  // Indexed column and its type, for push down scalar predicate.
+  const std::map<std::string, TokenizerType>& ColumnTypes() const { return column_types_; }
+
   int64_t ApplyLogId() const;
   void SetApplyLogId(int64_t apply_log_id);
 
@@ -128,6 +135,8 @@ class DocumentIndex {
  private:
   RWLock rw_lock_;
   bool is_destroyed_{false};
+
+  std::map<std::string, TokenizerType> column_types_;
 };
 
 using DocumentIndexPtr = std::shared_ptr<DocumentIndex>;
@@ -249,11 +258,22 @@ class DocumentIndexWrapper : public std::enable_shared_from_this<DocumentIndexWr
   bool NeedToSave(std::string& reason);
   bool SupportSave();
 
+  // Mark dirty when write or apply log id advance, scrub only check the dirty document index.
+  void MarkDirty();
+  void ClearDirty() { dirty_flag_.Clear(); }
+  bool IsDirty() const { return dirty_flag_.IsDirty(); }
+  // Take all dirty document index id.
+  static std::vector<int64_t> TakeDirtyIds();
+
   butil::Status Add(const std::vector<pb::common::DocumentWithId>& document_with_ids);
   butil::Status Upsert(const std::vector<pb::common::DocumentWithId>& document_with_ids);
   butil::Status Delete(const std::vector<int64_t>& delete_ids);
   butil::Status Search(const pb::common::Range& region_range, const pb::common::DocumentSearchParameter& parameter,
                        std::vector<pb::common::DocumentWithScore>& results);
+  // Search with scalar predicates and id allow list, both are pushed down into tantivy.
+  butil::Status Search(const pb::common::Range& region_range, const pb::common::DocumentSearchParameter& parameter,
+                       const std::vector<DocumentScalarPredicate>& scalar_predicates, bool use_id_filter,
+                       const std::vector<int64_t>& alive_ids, std::vector<pb::common::DocumentWithScore>& results);
 
   // static butil::Status SetDocumentIndexRangeFilter(
   //     DocumentIndexPtr document_index,
@@ -314,6 +334,9 @@ class DocumentIndexWrapper : public std::enable_shared_from_this<DocumentIndexWr
 
   // need hold document index
   // std::atomic<bool> is_hold_document_index_;
+
+  // Dirty for scrub
+  DirtyFlag dirty_flag_;
 };
 
 using DocumentIndexWrapperPtr = std::shared_ptr<DocumentIndexWrapper>;
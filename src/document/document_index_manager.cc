@@ -14,11 +14,13 @@
 
 #include "document/document_index_manager.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "bthread/bthread.h"
@@ -48,6 +50,12 @@ DEFINE_int32(document_fast_background_worker_num, 8, "document index fast backgr
 DEFINE_int64(document_fast_build_log_gap, 50, "document index fast build log gap");
 DEFINE_int64(document_pull_snapshot_min_log_gap, 66, "document index pull snapshot min log gap");
 DEFINE_int64(document_max_background_task_count, 32, "document index max background task count");
+DEFINE_int32(document_index_scrub_full_interval_round, 10,
+             "scrub all document index every some round, other round only scrub dirty document index");
+DEFINE_int64(document_index_scrub_round_time_budget_ms, 1000,
+             "scrub document index time budget per round, the rest dirty document index is left to next round");
+
+static std::atomic<int64_t> g_document_index_scrub_round{0};
 
 std::string RebuildDocumentIndexTask::Trace() {
   return fmt::format("[document_index.rebuild][id({}).start_time({}).job_id({})] {}", document_index_wrapper_->Id(),
@@ -329,13 +337,12 @@ void LoadOrBuildDocumentIndexTask::Run() {
     applied_index = raft_meta->AppliedId();
   }
 
-  // if (region->Epoch().version() > 1 || applied_index > FLAGS_document_pull_snapshot_min_log_gap) {
-  //   auto snapshot_set = document_index_wrapper_->SnapshotSet();
-  //   auto status = DocumentIndexSnapshotManager::PullLastSnapshotFromPeers(snapshot_set, region->Epoch());
-  //   DINGO_LOG(INFO) << fmt::format(
-  //       "[document_index.loadorbuild][region({})][trace({})] pull document index last snapshot done, error: {}",
-  //       document_index_wrapper_->Id(), trace_, Helper::PrintStatus(status));
-  // }
+  if (region->Epoch().version() > 1 || applied_index > FLAGS_document_pull_snapshot_min_log_gap) {
+    auto status = DocumentIndexSnapshotManager::PullLastSnapshotFromPeers(document_index_wrapper_, region->Epoch());
+    DINGO_LOG(INFO) << fmt::format(
+        "[document_index.loadorbuild][region({})][trace({})] pull document index last snapshot done, error: {}",
+        document_index_wrapper_->Id(), trace_, Helper::PrintStatus(status));
+  }
 
   ADD_REGION_CHANGE_RECORD_TIMEPOINT(job_id_, fmt::format("Loadorbuilding document index {}", region->Id()));
 
@@ -453,21 +460,18 @@ void LoadAsyncBuildDocumentIndexTask::Run() {
     return;
   }
 
-  // if (region->Epoch().version() > 1 || applied_index > FLAGS_document_pull_snapshot_min_log_gap) {
-  //   auto snapshot_set = document_index_wrapper_->SnapshotSet();
-  //   auto status = DocumentIndexSnapshotManager::PullLastSnapshotFromPeers(snapshot_set, region->Epoch());
-  //   DINGO_LOG(INFO) << fmt::format(
-  //       "[document_index.loadasyncbuild][region({})][trace({})] pull document index last snapshot done, error: {} "
-  //       "version: "
-  //       "{} applied_index {}",
-  //       document_index_wrapper_->Id(), trace_, Helper::PrintStatus(status), region->Epoch().version(),
-  //       applied_index);
-  // } else {
-  //   DINGO_LOG(INFO) << fmt::format(
-  //       "[document_index.loadasyncbuild][region({})][trace({})] skip pull document index last snapshot for new create
-  //       " "region, version: {} applied_index {}", document_index_wrapper_->Id(), trace_, region->Epoch().version(),
-  //       applied_index);
-  // }
+  if (region->Epoch().version() > 1 || applied_index > FLAGS_document_pull_snapshot_min_log_gap) {
+    auto status = DocumentIndexSnapshotManager::PullLastSnapshotFromPeers(document_index_wrapper_, region->Epoch());
+    DINGO_LOG(INFO) << fmt::format(
+        "[document_index.loadasyncbuild][region({})][trace({})] pull document index last snapshot done, error: {} "
+        "version: {} applied_index {}",
+        document_index_wrapper_->Id(), trace_, Helper::PrintStatus(status), region->Epoch().version(), applied_index);
+  } else {
+    DINGO_LOG(INFO) << fmt::format(
+        "[document_index.loadasyncbuild][region({})][trace({})] skip pull document index last snapshot for new create "
+        "region, version: {} applied_index {}",
+        document_index_wrapper_->Id(), trace_, region->Epoch().version(), applied_index);
+  }
 
   ADD_REGION_CHANGE_RECORD_TIMEPOINT(job_id_, fmt::format("Loadasyncbuilding document index {}", region->Id()));
 
@@ -1586,23 +1590,55 @@ void DocumentIndexManager::LaunchSaveDocumentIndex(DocumentIndexWrapperPtr docum
 }
 
 butil::Status DocumentIndexManager::ScrubDocumentIndex() {
-  auto regions = Server::GetInstance().GetAllAliveRegion();
+  int64_t start_time = Helper::TimestampMs();
+
+  // Full scrub at first round and every some round, other round only scrub dirty document index.
+  int64_t round = g_document_index_scrub_round.fetch_add(1, std::memory_order_relaxed);
+  bool is_full_scrub = FLAGS_document_index_scrub_full_interval_round <= 1 ||
+                       round % FLAGS_document_index_scrub_full_interval_round == 0;
+
+  auto dirty_ids = DocumentIndexWrapper::TakeDirtyIds();
+  std::vector<store::RegionPtr> regions;
+  if (is_full_scrub) {
+    regions = Server::GetInstance().GetAllAliveRegion();
+  } else {
+    regions.reserve(dirty_ids.size());
+    for (auto document_index_id : dirty_ids) {
+      auto region = Server::GetInstance().GetRegion(document_index_id);
+      if (region != nullptr) {
+        regions.push_back(region);
+      }
+    }
+  }
+
   if (regions.empty()) {
-    DINGO_LOG(INFO) << "[document_index.scrub][index_id()] No alive region, skip scrub document index";
+    DINGO_LOG(INFO) << fmt::format("[document_index.scrub][index_id()] No {} region, skip scrub document index",
+                                   is_full_scrub ? "alive" : "dirty");
     return butil::Status::OK();
   }
 
-  DINGO_LOG(INFO) << "[document_index.scrub][index_id()] Scrub document index start, alive region_count is "
-                  << regions.size();
+  DINGO_LOG(INFO) << fmt::format(
+      "[document_index.scrub][index_id()] Scrub document index start, full({}) region_count({}) dirty_count({})",
+      is_full_scrub, regions.size(), dirty_ids.size());
 
+  // Scrub urgency is the raft log gap since last save.
+  std::vector<std::pair<int64_t, DocumentIndexWrapperPtr>> scrub_wrappers;
+  scrub_wrappers.reserve(regions.size());
   for (const auto& region : regions) {
     int64_t document_index_id = region->Id();
+    auto document_index_wrapper = region->DocumentIndexWrapper();
+    if (document_index_wrapper == nullptr) {
+      continue;
+    }
+    // Clear before check, the write after here will mark dirty again.
+    document_index_wrapper->ClearDirty();
+
     if (region->State() != pb::common::NORMAL) {
       DINGO_LOG(INFO) << fmt::format("[document_index.scrub][index_id({})] region state is not normal, dont't scrub.",
                                      document_index_id);
+      document_index_wrapper->MarkDirty();
       continue;
     }
-    auto document_index_wrapper = region->DocumentIndexWrapper();
     if (!document_index_wrapper->IsReady()) {
       DINGO_LOG(INFO) << fmt::format("[document_index.scrub][index_id({})] document index is not ready, dont't scrub.",
                                      document_index_id);
@@ -1614,24 +1650,55 @@ butil::Status DocumentIndexManager::ScrubDocumentIndex() {
       continue;
     }
 
+    int64_t log_gap = document_index_wrapper->ApplyLogId() - document_index_wrapper->SnapshotLogId();
+    scrub_wrappers.emplace_back(log_gap, document_index_wrapper);
+  }
+
+  // Most urgent first.
+  std::sort(scrub_wrappers.begin(), scrub_wrappers.end(),
+            [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+
+  int scrub_count = 0;
+  for (auto& [log_gap, document_index_wrapper] : scrub_wrappers) {
+    int64_t document_index_id = document_index_wrapper->Id();
+    if (Helper::TimestampMs() - start_time > FLAGS_document_index_scrub_round_time_budget_ms) {
+      // Out of time budget, left to next round.
+      document_index_wrapper->MarkDirty();
+      continue;
+    }
+    ++scrub_count;
+
     bool need_rebuild = document_index_wrapper->NeedToRebuild();
-    if (need_rebuild && document_index_wrapper->RebuildingNum() == 0) {
-      DINGO_LOG(INFO) << fmt::format("[document_index.scrub][index_id({})] need rebuild, do rebuild document index.",
-                                     document_index_id);
-      LaunchRebuildDocumentIndex(document_index_wrapper, 0, true, false, false, "from scrub");
+    if (need_rebuild) {
+      if (document_index_wrapper->RebuildingNum() == 0) {
+        DINGO_LOG(INFO) << fmt::format(
+            "[document_index.scrub][index_id({})] need rebuild, log_gap({}), do rebuild document index.",
+            document_index_id, log_gap);
+        LaunchRebuildDocumentIndex(document_index_wrapper, 0, true, false, false, "from scrub");
+      } else {
+        document_index_wrapper->MarkDirty();
+      }
       continue;
     }
 
     std::string trace;
     bool need_save = document_index_wrapper->NeedToSave(trace);
-    if (need_save && document_index_wrapper->RebuildingNum() == 0 && document_index_wrapper->SavingNum() < 128) {
-      DINGO_LOG(INFO) << fmt::format("[document_index.scrub][index_id({})] need save, trace: {}.", document_index_id,
-                                     trace);
-
-      LaunchSaveDocumentIndex(document_index_wrapper, fmt::format("scrub-{}", trace));
+    if (need_save) {
+      if (document_index_wrapper->RebuildingNum() == 0 && document_index_wrapper->SavingNum() < 128) {
+        DINGO_LOG(INFO) << fmt::format("[document_index.scrub][index_id({})] need save, log_gap({}) trace: {}.",
+                                       document_index_id, log_gap, trace);
+
+        LaunchSaveDocumentIndex(document_index_wrapper, fmt::format("scrub-{}", trace));
+      } else {
+        document_index_wrapper->MarkDirty();
+      }
     }
   }
 
+  DINGO_LOG(INFO) << fmt::format(
+      "[document_index.scrub][index_id()] Scrub document index finish, scrub_count({}/{}) elapsed time {}ms",
+      scrub_count, scrub_wrappers.size(), Helper::TimestampMs() - start_time);
+
   return butil::Status::OK();
 }
 
@@ -28,22 +28,43 @@
 
 #include "braft/protobuf_file.h"
 #include "butil/endpoint.h"
+#include "butil/iobuf.h"
 #include "butil/status.h"
 #include "butil/strings/string_split.h"
 #include "common/helper.h"
 #include "common/logging.h"
 #include "common/service_access.h"
+#include "common/synchronization.h"
 #include "config/config_manager.h"
 #include "document/document_index_factory.h"
 #include "fmt/core.h"
 #include "proto/common.pb.h"
 #include "proto/error.pb.h"
+#include "proto/file_service.pb.h"
 #include "proto/node.pb.h"
+#include "server/file_service.h"
 #include "server/server.h"
 
 namespace dingodb {
 
 DEFINE_bool(document_index_snapshot_use_fork, true, "Use fork to save vector index snapshot.");
+DEFINE_int64(document_index_checkpoint_expire_s, 3600, "document index checkpoint for peer pull expire time");
+DEFINE_int64(document_index_snapshot_catchup_margin, 4000,
+             "local document index snapshot is fresh enough if behind peer within the margin");
+
+static const std::string kCheckpointPrefix = "checkpoint_";
+static const std::string kSnapshotMetaFileName = "meta";
+
+// Tantivy segment files are immutable and named by segment uuid(delete file also with opstamp),
+// only these files is mutable.
+static bool IsMutableIndexFile(const std::string& filename) {
+  return filename == kSnapshotMetaFileName || filename == "meta.json" || filename == ".managed.json";
+}
+
+// Tantivy lock files is not part of index.
+static bool IsLockFile(const std::string& filename) {
+  return filename.size() >= 5 && filename.compare(filename.size() - 5, 5, ".lock") == 0;
+}
 
 // Get all snapshot path, except tmp dir.
 static std::vector<std::string> GetSnapshotPaths(std::string path) {
@@ -310,6 +331,382 @@ butil::Status DocumentIndexSnapshotManager::SaveDocumentIndexSnapshot(DocumentIn
   return butil::Status::OK();
 }
 
+std::string DocumentIndexSnapshotManager::GetCheckpointPath(int64_t document_index_id) {
+  return fmt::format("{}/{}{}", GetSnapshotParentPath(document_index_id), kCheckpointPrefix, Helper::TimestampNs());
+}
+
+// Remove the checkpoint which peer never clean, e.g. peer crash when pulling.
+void DocumentIndexSnapshotManager::CleanExpiredCheckpoint(int64_t document_index_id) {
+  std::string parent_path = GetSnapshotParentPath(document_index_id);
+  auto dir_names = Helper::TraverseDirectory(parent_path, kCheckpointPrefix, false, true);
+
+  int64_t now_ns = Helper::TimestampNs();
+  for (const auto& dir_name : dir_names) {
+    int64_t create_time_ns = std::strtoll(dir_name.c_str() + kCheckpointPrefix.size(), nullptr, 10);
+    if (now_ns - create_time_ns > FLAGS_document_index_checkpoint_expire_s * 1000 * 1000 * 1000) {
+      DINGO_LOG(INFO) << fmt::format("[document_index.snapshot][index_id({})] clean expired checkpoint {}",
+                                     document_index_id, dir_name);
+      Helper::RemoveAllFileOrDirectory(fmt::format("{}/{}", parent_path, dir_name));
+    }
+  }
+}
+
+butil::Status DocumentIndexSnapshotManager::HandleGetSnapshotMeta(DocumentIndexWrapperPtr document_index_wrapper,
+                                                                  pb::node::GetVectorIndexSnapshotResponse* response) {
+  assert(document_index_wrapper != nullptr);
+
+  auto document_index = document_index_wrapper->GetOwnDocumentIndex();
+  if (document_index == nullptr) {
+    return butil::Status(pb::error::EDOCUMENT_INDEX_NOT_FOUND, "Not found document index.");
+  }
+
+  auto* response_meta = response->mutable_meta();
+  response_meta->set_vector_index_id(document_index->Id());
+  response_meta->set_snapshot_log_index(document_index_wrapper->ApplyLogId());
+  *response_meta->mutable_epoch() = document_index->Epoch();
+  *response_meta->mutable_range() = document_index->Range();
+
+  return butil::Status::OK();
+}
+
+butil::Status DocumentIndexSnapshotManager::HandlePullSnapshot(DocumentIndexWrapperPtr document_index_wrapper,
+                                                               pb::node::GetVectorIndexSnapshotResponse* response) {
+  assert(document_index_wrapper != nullptr);
+
+  auto document_index = document_index_wrapper->GetOwnDocumentIndex();
+  if (document_index == nullptr) {
+    return butil::Status(pb::error::EDOCUMENT_INDEX_NOT_FOUND, "Not found document index.");
+  }
+
+  int64_t document_index_id = document_index->Id();
+  int64_t start_time = Helper::TimestampMs();
+
+  CleanExpiredCheckpoint(document_index_id);
+
+  std::string checkpoint_path = GetCheckpointPath(document_index_id);
+  auto status = Helper::CreateDirectories(checkpoint_path);
+  if (!status.ok()) {
+    return status;
+  }
+
+  pb::store_internal::DocumentIndexSnapshotMeta meta;
+  std::vector<std::string> filenames;
+  {
+    // Hard link the committed files under write lock, so the checkpoint is consistent with the apply log id,
+    // and not affected by the later merge and garbage collect of tantivy.
+    document_index->LockWrite();
+    DEFER(document_index->UnlockWrite());
+
+    status = document_index->Save(checkpoint_path);
+    if (!status.ok()) {
+      Helper::RemoveAllFileOrDirectory(checkpoint_path);
+      return status;
+    }
+
+    meta.set_document_index_id(document_index_id);
+    meta.set_snapshot_log_id(document_index_wrapper->ApplyLogId());
+    *(meta.mutable_range()) = document_index->Range();
+    *(meta.mutable_epoch()) = document_index->Epoch();
+
+    for (const auto& filename : Helper::TraverseDirectory(document_index->IndexPath(), true)) {
+      if (filename == kSnapshotMetaFileName || IsLockFile(filename)) {
+        continue;
+      }
+
+      std::error_code ec;
+      std::filesystem::create_hard_link(fmt::format("{}/{}", document_index->IndexPath(), filename),
+                                        fmt::format("{}/{}", checkpoint_path, filename), ec);
+      if (ec) {
+        Helper::RemoveAllFileOrDirectory(checkpoint_path);
+        return butil::Status(pb::error::EINTERNAL, "Hard link file %s failed, error: %s", filename.c_str(),
+                             ec.message().c_str());
+      }
+      filenames.push_back(filename);
+    }
+  }
+
+  braft::ProtoBufFile pb_file_meta(fmt::format("{}/{}", checkpoint_path, kSnapshotMetaFileName));
+  if (pb_file_meta.save(&meta, true) != 0) {
+    Helper::RemoveAllFileOrDirectory(checkpoint_path);
+    return butil::Status(pb::error::EINTERNAL, "Save checkpoint meta failed.");
+  }
+  filenames.push_back(kSnapshotMetaFileName);
+
+  // Build response meta
+  auto* response_meta = response->mutable_meta();
+  response_meta->set_vector_index_id(document_index_id);
+  response_meta->set_snapshot_log_index(meta.snapshot_log_id());
+  *response_meta->mutable_epoch() = meta.epoch();
+  *response_meta->mutable_range() = meta.range();
+  for (const auto& filename : filenames) {
+    response_meta->add_filenames(filename);
+  }
+
+  // Build response uri
+  auto config = ConfigManager::GetInstance().GetRoleConfig();
+  auto host = config->GetString("server.host");
+  int port = config->GetInt("server.port");
+  if (host.empty() || port == 0) {
+    Helper::RemoveAllFileOrDirectory(checkpoint_path);
+    return butil::Status(pb::error::EILLEGAL_PARAMTETERS, "Parse server host or port error.");
+  }
+
+  auto reader = std::make_shared<FileReaderWrapper>(checkpoint_path, true);
+  int64_t reader_id = FileServiceReaderManager::GetInstance().AddReader(reader);
+  response->set_uri(fmt::format("remote://{}:{}/{}", host, port, reader_id));
+
+  DINGO_LOG(INFO) << fmt::format(
+      "[document_index.snapshot][index_id({})] make checkpoint {} file_count({}) snapshot_log_id({}) elapsed time {}ms",
+      document_index_id, checkpoint_path, filenames.size(), meta.snapshot_log_id(), Helper::TimestampMs() - start_time);
+
+  return butil::Status::OK();
+}
+
+butil::Status DocumentIndexSnapshotManager::PullLastSnapshotFromPeers(DocumentIndexWrapperPtr document_index_wrapper,
+                                                                      const pb::common::RegionEpoch& epoch) {
+  assert(document_index_wrapper != nullptr);
+
+  int64_t start_time = Helper::TimestampMs();
+
+  int64_t document_index_id = document_index_wrapper->Id();
+  auto engine = Server::GetInstance().GetRaftStoreEngine();
+  if (engine == nullptr) {
+    return butil::Status(pb::error::EINTERNAL, "Not raft store engine.");
+  }
+  auto raft_node = engine->GetNode(document_index_id);
+  if (raft_node == nullptr) {
+    return butil::Status(pb::error::ERAFT_NOT_FOUND, "Not found raft node.");
+  }
+
+  // Find max document index snapshot peer.
+  pb::node::GetVectorIndexSnapshotRequest request;
+  request.set_vector_index_id(document_index_id);
+
+  int64_t peer_max_snapshot_log_index = 0;
+  int64_t peer_snapshot_version = 0;
+  butil::EndPoint endpoint;
+
+  auto self_peer = raft_node->GetPeerId();
+  std::vector<braft::PeerId> peers;
+  if (raft_node->IsLeader()) {
+    raft_node->ListPeers(&peers);
+  } else {
+    peers.push_back(raft_node->GetLeaderId());
+  }
+  for (const auto& peer : peers) {
+    if (peer == self_peer) {
+      continue;
+    }
+
+    // Only probe the meta, the checkpoint is made by the chosen peer when pulling.
+    pb::node::GetVectorIndexSnapshotResponse response;
+    auto status = ServiceAccess::GetVectorIndexSnapshotMeta(request, peer.addr, response);
+    if (!status.ok()) {
+      DINGO_LOG(WARNING) << fmt::format(
+          "[document_index.snapshot][index_id({})] get peer document index snapshot meta failed, peer({}) error: {}.",
+          document_index_id, Helper::EndPointToString(peer.addr), Helper::PrintStatus(status));
+      continue;
+    }
+
+    if (response.meta().epoch().version() < epoch.version()) {
+      DINGO_LOG(WARNING) << fmt::format(
+          "[document_index.snapshot][index_id({})] document index snapshot epoch({}) not match region version({}).",
+          document_index_id, response.meta().epoch().version(), epoch.version());
+      continue;
+    }
+
+    if (peer_max_snapshot_log_index < response.meta().snapshot_log_index()) {
+      peer_max_snapshot_log_index = response.meta().snapshot_log_index();
+      peer_snapshot_version = response.meta().epoch().version();
+      endpoint = peer.addr;
+    }
+  }
+
+  if (peer_max_snapshot_log_index == 0) {
+    DINGO_LOG(INFO) << fmt::format(
+        "[document_index.snapshot][index_id({})] other peers not exist document index snapshot.", document_index_id);
+    return butil::Status(pb::error::EDOCUMENT_INDEX_LOAD_SNAPSHOT, "Not found peer snapshot");
+  }
+
+  pb::store_internal::DocumentIndexSnapshotMeta local_meta;
+  GetLatestSnapshotMeta(document_index_id, local_meta);
+  if (local_meta.epoch().version() > peer_snapshot_version ||
+      (local_meta.epoch().version() == peer_snapshot_version &&
+       local_meta.snapshot_log_id() + FLAGS_document_index_snapshot_catchup_margin >= peer_max_snapshot_log_index)) {
+    DINGO_LOG(INFO) << fmt::format(
+        "[document_index.snapshot][index_id({})] local snapshot is enough fresh, version({}/{}) log_id({}/{}).",
+        document_index_id, local_meta.epoch().version(), peer_snapshot_version, local_meta.snapshot_log_id(),
+        peer_max_snapshot_log_index);
+    return butil::Status::OK();
+  }
+
+  auto status = LaunchPullSnapshot(endpoint, document_index_wrapper);
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << fmt::format(
+        "[document_index.snapshot][index_id({})] pull document index snapshot {} from {} failed, error: {}",
+        document_index_id, peer_max_snapshot_log_index, Helper::EndPointToString(endpoint), status.error_str());
+    return status;
+  }
+
+  DINGO_LOG(INFO) << fmt::format(
+      "[document_index.snapshot][index_id({})] pull document index snapshot {} {} finish, elapsed time {}ms",
+      document_index_id, peer_snapshot_version, peer_max_snapshot_log_index, Helper::TimestampMs() - start_time);
+
+  return butil::Status::OK();
+}
+
+butil::Status DocumentIndexSnapshotManager::LaunchPullSnapshot(const butil::EndPoint& endpoint,
+                                                               DocumentIndexWrapperPtr document_index_wrapper) {
+  pb::node::GetVectorIndexSnapshotRequest request;
+  request.set_vector_index_id(document_index_wrapper->Id());
+
+  pb::node::GetVectorIndexSnapshotResponse response;
+  auto status = ServiceAccess::GetVectorIndexSnapshot(request, endpoint, response);
+  if (!status.ok()) {
+    return status;
+  }
+
+  status = DownloadSnapshotFile(response.uri(), response.meta(), document_index_wrapper);
+
+  // Clean corresponding reader id, the checkpoint is removed with it.
+  int64_t reader_id = ParseReaderId(response.uri());
+  if (reader_id > 0) {
+    pb::fileservice::CleanFileReaderRequest clean_request;
+    clean_request.set_reader_id(reader_id);
+    ServiceAccess::CleanFileReader(clean_request, ParseHost(response.uri()));
+  }
+
+  return status;
+}
+
+butil::Status DocumentIndexSnapshotManager::DownloadSnapshotFile(const std::string& uri,
+                                                                 const pb::node::VectorIndexSnapshotMeta& meta,
+                                                                 DocumentIndexWrapperPtr document_index_wrapper) {
+  // Parse reader_id and endpoint
+  int64_t reader_id = ParseReaderId(uri);
+  butil::EndPoint endpoint = ParseHost(uri);
+  if (reader_id == 0 || endpoint.port == 0) {
+    return butil::Status(pb::error::EINTERNAL, "Parse uri to reader_id and endpoint error");
+  }
+
+  int64_t document_index_id = meta.vector_index_id();
+
+  // Local index which the segment file can reuse, prefer the same epoch.
+  std::string local_path = GetSnapshotPath(document_index_id, meta.epoch());
+  if (local_path.empty()) {
+    local_path = GetLatestSnapshotPath(document_index_id);
+  }
+
+  std::string tmp_snapshot_path = GetSnapshotTmpPath(document_index_id);
+  auto status = Helper::CreateDirectories(tmp_snapshot_path);
+  if (!status.ok()) {
+    return status;
+  }
+  bool is_installed = false;
+  DEFER(if (!is_installed) { Helper::RemoveAllFileOrDirectory(tmp_snapshot_path); });
+
+  int64_t reuse_file_count = 0;
+  int64_t transfer_bytes = 0;
+  for (const auto& filename : meta.filenames()) {
+    std::string filepath = fmt::format("{}/{}", tmp_snapshot_path, filename);
+
+    if (!local_path.empty() && !IsMutableIndexFile(filename)) {
+      std::string local_filepath = fmt::format("{}/{}", local_path, filename);
+      std::error_code ec;
+      if (std::filesystem::exists(local_filepath, ec)) {
+        std::filesystem::create_hard_link(local_filepath, filepath, ec);
+        if (!ec) {
+          ++reuse_file_count;
+          continue;
+        }
+      }
+    }
+
+    int64_t offset = 0;
+    std::ofstream ofile;
+    ofile.open(filepath, std::ofstream::out | std::ofstream::binary);
+    if (!ofile.is_open()) {
+      return butil::Status(pb::error::EINTERNAL, "Open file %s failed", filepath.c_str());
+    }
+
+    for (;;) {
+      pb::fileservice::GetFileRequest request;
+      request.set_reader_id(reader_id);
+      request.set_filename(filename);
+      request.set_offset(offset);
+      request.set_size(Constant::kFileTransportChunkSize);
+
+      butil::IOBuf buf;
+      auto response = ServiceAccess::GetFile(request, endpoint, &buf);
+      if (response == nullptr) {
+        return butil::Status(pb::error::EINTERNAL, "Get file %s failed", filename.c_str());
+      }
+
+      // Write local file, the broken file must not be installed.
+      ofile << buf;
+      if (ofile.fail()) {
+        return butil::Status(pb::error::EINTERNAL, "Write file %s failed, offset %ld", filepath.c_str(), offset);
+      }
+
+      offset += response->read_size();
+      if (response->eof()) {
+        break;
+      }
+    }
+
+    ofile.close();
+    if (ofile.fail()) {
+      return butil::Status(pb::error::EINTERNAL, "Close file %s failed", filepath.c_str());
+    }
+    transfer_bytes += offset;
+  }
+
+  pb::store_internal::DocumentIndexSnapshotMeta snapshot_meta;
+  braft::ProtoBufFile pb_file_meta(fmt::format("{}/{}", tmp_snapshot_path, kSnapshotMetaFileName));
+  if (pb_file_meta.load(&snapshot_meta) != 0 || snapshot_meta.document_index_id() != document_index_id) {
+    return butil::Status(pb::error::EDOCUMENT_INDEX_LOAD_SNAPSHOT, "Parse pulled snapshot meta failed.");
+  }
+
+  // Own document index hold the index dir, not install.
+  if (document_index_wrapper->IsOwnReady()) {
+    return butil::Status(pb::error::EDOCUMENT_INDEX_LOAD_SNAPSHOT, "Already own document index, not install.");
+  }
+
+  // Install, replace the index dir of the epoch by rename.
+  std::string snapshot_path = GetSnapshotPath(document_index_id, snapshot_meta.epoch().version());
+  std::string old_snapshot_path;
+  if (std::filesystem::exists(snapshot_path)) {
+    old_snapshot_path = GetSnapshotTmpPath(document_index_id);
+    status = Helper::Rename(snapshot_path, old_snapshot_path);
+    if (!status.ok()) {
+      return status;
+    }
+  }
+
+  status = Helper::Rename(tmp_snapshot_path, snapshot_path);
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << fmt::format(
+        "[document_index.snapshot][index_id({})] rename document index snapshot failed, {} -> {} error: {}",
+        document_index_id, tmp_snapshot_path, snapshot_path, status.error_str());
+    if (!old_snapshot_path.empty()) {
+      Helper::Rename(old_snapshot_path, snapshot_path);
+    }
+    return status;
+  }
+  is_installed = true;
+
+  if (!old_snapshot_path.empty()) {
+    Helper::RemoveAllFileOrDirectory(old_snapshot_path);
+  }
+
+  DINGO_LOG(INFO) << fmt::format(
+      "[document_index.snapshot][index_id({})] install document index snapshot {} file_count({}) reuse_file_count({}) "
+      "transfer_bytes({}).",
+      document_index_id, snapshot_path, meta.filenames_size(), reuse_file_count, transfer_bytes);
+
+  return butil::Status::OK();
+}
+
 // Load document index for already exist document index at bootstrap.
 std::shared_ptr<DocumentIndex> DocumentIndexSnapshotManager::LoadDocumentIndexSnapshot(
     DocumentIndexWrapperPtr document_index_wrapper, const pb::common::RegionEpoch& epoch) {
@@ -364,6 +761,10 @@ std::shared_ptr<DocumentIndex> DocumentIndexSnapshotManager::LoadDocumentIndexSn
     return nullptr;
   }
 
+  // Catch up raft log from the snapshot log id.
+  document_index->SetApplyLogId(meta.snapshot_log_id());
+  document_index->SetSnapshotLogId(meta.snapshot_log_id());
+
   DINGO_LOG(INFO) << fmt::format(
       "[document_index.load_snapshot][index_id({})] Load vector index snapshot snapshot_{:020} elapsed(2) time {}ms",
       document_index_id, meta.snapshot_log_id(), Helper::TimestampMs() - start_time_ms);
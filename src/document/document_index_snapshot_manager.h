@@ -20,9 +20,11 @@
 #include <string>
 #include <vector>
 
+#include "butil/endpoint.h"
 #include "butil/status.h"
 #include "document/document_index.h"
 #include "proto/common.pb.h"
+#include "proto/node.pb.h"
 #include "proto/store_internal.pb.h"
 
 namespace dingodb {
@@ -56,7 +58,30 @@ class DocumentIndexSnapshotManager {
   static butil::Status GetLatestSnapshotMeta(int64_t document_index_id,
                                              pb::store_internal::DocumentIndexSnapshotMeta& meta);
 
+  // Pull the last document index snapshot from peers instead of rebuild.
+  // Only the tantivy files which local lack are transferred, segment files is immutable,
+  // so the same name segment file is reused by hard link.
+  static butil::Status PullLastSnapshotFromPeers(DocumentIndexWrapperPtr document_index_wrapper,
+                                                 const pb::common::RegionEpoch& epoch);
+
+  // Get the meta of checkpoint which would be made now, for peer choose the freshest one before pull.
+  static butil::Status HandleGetSnapshotMeta(DocumentIndexWrapperPtr document_index_wrapper,
+                                             pb::node::GetVectorIndexSnapshotResponse* response);
+
+  // Make a hard link checkpoint of document index for peer pull, the checkpoint is removed with the file reader.
+  static butil::Status HandlePullSnapshot(DocumentIndexWrapperPtr document_index_wrapper,
+                                          pb::node::GetVectorIndexSnapshotResponse* response);
+
  private:
+  static butil::Status LaunchPullSnapshot(const butil::EndPoint& endpoint,
+                                          DocumentIndexWrapperPtr document_index_wrapper);
+  // Download the snapshot files into tmp dir, then install it as the snapshot of the epoch.
+  static butil::Status DownloadSnapshotFile(const std::string& uri, const pb::node::VectorIndexSnapshotMeta& meta,
+                                            DocumentIndexWrapperPtr document_index_wrapper);
+
+  static std::string GetCheckpointPath(int64_t document_index_id);
+  static void CleanExpiredCheckpoint(int64_t document_index_id);
+
   static std::string GetSnapshotTmpPath(int64_t document_index_id);
   static std::string GetSnapshotNewPath(int64_t document_index_id, int64_t snapshot_log_id);
 };
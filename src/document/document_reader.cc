@@ -75,6 +75,8 @@ butil::Status DocumentReader::QueryDocumentWithId(const pb::common::Range& regio
 butil::Status DocumentReader::SearchDocument(int64_t partition_id, DocumentIndexWrapperPtr document_index,
                                              pb::common::Range region_range,
                                              const pb::common::DocumentSearchParameter& parameter,
+                                             const std::vector<DocumentScalarPredicate>& scalar_predicates,
+                                             bool use_id_filter, const std::vector<int64_t>& alive_ids,
                                              std::vector<pb::common::DocumentWithScore>& document_with_score_results) {
   bool with_scalar_data = !(parameter.without_scalar_data());
   std::vector<std::string> selected_scalar_keys;
@@ -85,7 +87,11 @@ butil::Status DocumentReader::SearchDocument(int64_t partition_id, DocumentIndex
     }
   }
 
-  auto ret = document_index->Search(region_range, parameter, document_with_score_results);
+  auto ret = document_index->Search(region_range, parameter, scalar_predicates, use_id_filter, alive_ids,
+                                    document_with_score_results);
+  if (!ret.ok()) {
+    return ret;
+  }
 
   // document index does not support restruct document, we restruct it using kv store
   if (with_scalar_data) {
@@ -107,7 +113,8 @@ butil::Status DocumentReader::SearchDocument(int64_t partition_id, DocumentIndex
 butil::Status DocumentReader::DocumentSearch(std::shared_ptr<Engine::DocumentReader::Context> ctx,
                                              std::vector<pb::common::DocumentWithScore>& results) {
   // Search documents by documents
-  auto status = SearchDocument(ctx->partition_id, ctx->document_index, ctx->region_range, ctx->parameter, results);
+  auto status = SearchDocument(ctx->partition_id, ctx->document_index, ctx->region_range, ctx->parameter,
+                               ctx->scalar_predicates, ctx->use_id_filter, ctx->alive_ids, results);
   if (!status.ok()) {
     return status;
   }
@@ -61,6 +61,8 @@ class DocumentReader {
                                     pb::common::DocumentWithId& document_with_id);
   butil::Status SearchDocument(int64_t partition_id, DocumentIndexWrapperPtr document_index,
                                pb::common::Range region_range, const pb::common::DocumentSearchParameter& parameter,
+                               const std::vector<DocumentScalarPredicate>& scalar_predicates, bool use_id_filter,
+                               const std::vector<int64_t>& alive_ids,
                                std::vector<pb::common::DocumentWithScore>& document_with_score_results);
 
   butil::Status GetBorderId(const pb::common::Range& region_range, bool get_min, int64_t& document_id);
@@ -0,0 +1,238 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "document/document_search_filter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "butil/base64.h"
+#include "butil/status.h"
+#include "fmt/core.h"
+#include "proto/error.pb.h"
+
+namespace dingodb {
+
+DocumentScalarPredicate DocumentScalarPredicate::Term(const std::string& column_name,
+                                                      const pb::common::DocumentValue& value) {
+  DocumentScalarPredicate predicate;
+  predicate.type = kTerm;
+  predicate.column_name = column_name;
+  predicate.value = value;
+  return predicate;
+}
+
+DocumentScalarPredicate DocumentScalarPredicate::Range(const std::string& column_name,
+                                                       const pb::common::DocumentValue* lower, bool lower_inclusive,
+                                                       const pb::common::DocumentValue* upper, bool upper_inclusive) {
+  DocumentScalarPredicate predicate;
+  predicate.type = kRange;
+  predicate.column_name = column_name;
+  if (lower != nullptr) {
+    predicate.has_lower = true;
+    predicate.lower = *lower;
+  }
+  predicate.lower_inclusive = lower_inclusive;
+  if (upper != nullptr) {
+    predicate.has_upper = true;
+    predicate.upper = *upper;
+  }
+  predicate.upper_inclusive = upper_inclusive;
+  return predicate;
+}
+
+// Escape the literal in quote for tantivy query parser.
+static std::string QuoteLiteral(const std::string& literal) {
+  std::string result;
+  result.reserve(literal.size() + 2);
+  result.push_back('"');
+  for (char c : literal) {
+    if (c == '"' || c == '\\') {
+      result.push_back('\\');
+    }
+    result.push_back(c);
+  }
+  result.push_back('"');
+  return result;
+}
+
+butil::Status DocumentSearchFilter::ValueToQueryString(const std::string& column_name,
+                                                       const pb::common::DocumentValue& value,
+                                                       TokenizerType column_type, std::string& result) {
+  const auto& field_value = value.field_value();
+  switch (column_type) {
+    case TokenizerType::kTokenizerTypeI64:
+      if (value.field_type() != pb::common::ScalarFieldType::INT64) {
+        break;
+      }
+      result = fmt::format("{}", field_value.long_data());
+      return butil::Status::OK();
+
+    case TokenizerType::kTokenizerTypeF64: {
+      double double_value = 0;
+      if (value.field_type() == pb::common::ScalarFieldType::DOUBLE) {
+        double_value = field_value.double_data();
+      } else if (value.field_type() == pb::common::ScalarFieldType::INT64) {
+        double_value = static_cast<double>(field_value.long_data());
+      } else {
+        break;
+      }
+      if (!std::isfinite(double_value)) {
+        return butil::Status(pb::error::EILLEGAL_PARAMTETERS, "column %s value is not finite", column_name.c_str());
+      }
+      result = fmt::format("{}", double_value);
+      return butil::Status::OK();
+    }
+
+    case TokenizerType::kTokenizerTypeBytes: {
+      if (value.field_type() != pb::common::ScalarFieldType::BYTES) {
+        break;
+      }
+      // Tantivy query parser decode bytes term by base64.
+      std::string base64_value;
+      butil::Base64Encode(field_value.bytes_data(), &base64_value);
+      result = QuoteLiteral(base64_value);
+      return butil::Status::OK();
+    }
+
+    case TokenizerType::kTokenizerTypeText:
+      if (value.field_type() != pb::common::ScalarFieldType::STRING) {
+        break;
+      }
+      result = QuoteLiteral(field_value.string_data());
+      return butil::Status::OK();
+
+    default:
+      break;
+  }
+
+  return butil::Status(pb::error::EILLEGAL_PARAMTETERS, "column %s value type %s not match column type %d",
+                       column_name.c_str(), pb::common::ScalarFieldType_Name(value.field_type()).c_str(),
+                       static_cast<int>(column_type));
+}
+
+butil::Status DocumentSearchFilter::PredicateToQueryString(const DocumentScalarPredicate& predicate,
+                                                           TokenizerType column_type, std::string& result) {
+  if (predicate.type == DocumentScalarPredicate::kTerm) {
+    std::string value;
+    auto status = ValueToQueryString(predicate.column_name, predicate.value, column_type, value);
+    if (!status.ok()) {
+      return status;
+    }
+
+    result = fmt::format("{}:{}", predicate.column_name, value);
+    return butil::Status::OK();
+  }
+
+  if (column_type != TokenizerType::kTokenizerTypeI64 && column_type != TokenizerType::kTokenizerTypeF64) {
+    return butil::Status(pb::error::EILLEGAL_PARAMTETERS, "column %s not support range predicate",
+                         predicate.column_name.c_str());
+  }
+  if (!predicate.has_lower && !predicate.has_upper) {
+    return butil::Status(pb::error::EILLEGAL_PARAMTETERS, "column %s range predicate miss bound",
+                         predicate.column_name.c_str());
+  }
+
+  std::string lower = "*";
+  if (predicate.has_lower) {
+    auto status = ValueToQueryString(predicate.column_name, predicate.lower, column_type, lower);
+    if (!status.ok()) {
+      return status;
+    }
+  }
+
+  std::string upper = "*";
+  if (predicate.has_upper) {
+    auto status = ValueToQueryString(predicate.column_name, predicate.upper, column_type, upper);
+    if (!status.ok()) {
+      return status;
+    }
+  }
+
+  result = fmt::format("{}:{}{} TO {}{}", predicate.column_name, predicate.lower_inclusive ? "[" : "{", lower, upper,
+                       predicate.upper_inclusive ? "]" : "}");
+  return butil::Status::OK();
+}
+
+butil::Status DocumentSearchFilter::BuildQueryString(const std::string& query_string,
+                                                     const std::vector<DocumentScalarPredicate>& predicates,
+                                                     const std::map<std::string, TokenizerType>& column_types,
+                                                     std::string& result) {
+  if (predicates.empty()) {
+    result = query_string;
+    return butil::Status::OK();
+  }
+
+  // Only filter by predicates if no query string, "+()" is illegal for tantivy query parser.
+  bool is_blank_query = std::all_of(query_string.begin(), query_string.end(),
+                                    [](unsigned char c) { return std::isspace(c) != 0; });
+  result = is_blank_query ? "" : fmt::format("+({})", query_string);
+  for (const auto& predicate : predicates) {
+    auto iter = column_types.find(predicate.column_name);
+    if (iter == column_types.end()) {
+      return butil::Status(pb::error::EILLEGAL_PARAMTETERS, "column %s is not indexed", predicate.column_name.c_str());
+    }
+
+    std::string predicate_query_string;
+    auto status = PredicateToQueryString(predicate, iter->second, predicate_query_string);
+    if (!status.ok()) {
+      return status;
+    }
+
+    if (!result.empty()) {
+      result += " ";
+    }
+    result += fmt::format("+({})^0", predicate_query_string);
+  }
+
+  return butil::Status::OK();
+}
+
+bool DocumentSearchFilter::CompactAllowIds(std::vector<uint64_t>& alive_ids, bool& use_range_filter,
+                                           int64_t& start_id, int64_t& end_id, bool& use_id_filter) {
+  if (!use_id_filter) {
+    return true;
+  }
+
+  uint64_t min_id = use_range_filter ? static_cast<uint64_t>(std::max(start_id, static_cast<int64_t>(1))) : 1;
+  uint64_t max_id = use_range_filter ? static_cast<uint64_t>(std::max(end_id, static_cast<int64_t>(0))) : INT64_MAX;
+
+  alive_ids.erase(std::remove_if(alive_ids.begin(), alive_ids.end(),
+                                 [min_id, max_id](uint64_t id) { return id < min_id || id >= max_id; }),
+                  alive_ids.end());
+  if (alive_ids.empty()) {
+    return false;
+  }
+
+  std::sort(alive_ids.begin(), alive_ids.end());
+  alive_ids.erase(std::unique(alive_ids.begin(), alive_ids.end()), alive_ids.end());
+
+  // Continuous ids is equivalent to range filter.
+  if (alive_ids.back() - alive_ids.front() + 1 == alive_ids.size()) {
+    use_range_filter = true;
+    start_id = static_cast<int64_t>(alive_ids.front());
+    end_id = static_cast<int64_t>(alive_ids.back()) + 1;
+    use_id_filter = false;
+    std::vector<uint64_t>().swap(alive_ids);
+  }
+
+  return true;
+}
+
+}  // namespace dingodb
@@ -0,0 +1,84 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGODB_DOCUMENT_SEARCH_FILTER_H_
+#define DINGODB_DOCUMENT_SEARCH_FILTER_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "butil/status.h"
+#include "document/codec.h"
+#include "proto/common.pb.h"
+
+namespace dingodb {
+
+// Predicate on the indexed scalar column(i64/f64/bytes/text) of document index.
+struct DocumentScalarPredicate {
+  enum Type {
+    kTerm = 0,
+    kRange = 1,
+  };
+
+  Type type{kTerm};
+  std::string column_name;
+
+  // Term equality value.
+  pb::common::DocumentValue value;
+
+  // Range bound, only i64/f64 column support range, not set bound is unbounded.
+  bool has_lower{false};
+  bool lower_inclusive{true};
+  pb::common::DocumentValue lower;
+  bool has_upper{false};
+  bool upper_inclusive{false};
+  pb::common::DocumentValue upper;
+
+  static DocumentScalarPredicate Term(const std::string& column_name, const pb::common::DocumentValue& value);
+  static DocumentScalarPredicate Range(const std::string& column_name, const pb::common::DocumentValue* lower,
+                                       bool lower_inclusive, const pb::common::DocumentValue* upper,
+                                       bool upper_inclusive);
+};
+
+// Push down the search filter into tantivy, so the collector only score the matched document,
+// and return the exact top-k instead of over fetch and filter by caller.
+class DocumentSearchFilter {
+ public:
+  // Rewrite query string with the scalar predicates as required clauses,
+  // the predicate clause is boosted by zero, so not affect bm25 score.
+  // Blank query string with predicates is pure filter, every matched document score zero.
+  static butil::Status BuildQueryString(const std::string& query_string,
+                                        const std::vector<DocumentScalarPredicate>& predicates,
+                                        const std::map<std::string, TokenizerType>& column_types,
+                                        std::string& result);
+
+  // Compact the id allow list before cross ffi.
+  // Sort and dedup the ids, drop the ids out of range filter,
+  // and the continuous ids is converted to range filter, so no need to copy ids.
+  // Return false if no id left, then search result must be empty.
+  static bool CompactAllowIds(std::vector<uint64_t>& alive_ids, bool& use_range_filter, int64_t& start_id,
+                              int64_t& end_id, bool& use_id_filter);
+
+ private:
+  static butil::Status PredicateToQueryString(const DocumentScalarPredicate& predicate, TokenizerType column_type,
+                                             std::string& result);
+  static butil::Status ValueToQueryString(const std::string& column_name, const pb::common::DocumentValue& value,
+                                          TokenizerType column_type, std::string& result);
+};
+
+}  // namespace dingodb
+
+#endif  // DINGODB_DOCUMENT_SEARCH_FILTER_H_
@@ -17,11 +17,13 @@
 #include <gflags/gflags.h>
 #include <sys/types.h>
 
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <memory>
+#include <mutex>
 #include <random>
 #include <string>
 #include <string_view>
@@ -31,6 +33,7 @@
 
 #include "bdb_raw_engine.h"
 #include "butil/compiler_specific.h"
+#include "bvar/latency_recorder.h"
 #include "bvar/reducer.h"
 #include "common/constant.h"
 #include "common/helper.h"
@@ -50,6 +53,10 @@
 
 bvar::Adder<uint64_t> bdb_snapshot_alive_count("bdb_snapshot_alive_count");
 bvar::Adder<uint64_t> bdb_transaction_alive_count("bdb_transaction_alive_count");
+bvar::Adder<uint64_t> bdb_deadlock_retry_count("bdb_deadlock_retry_count");
+bvar::LatencyRecorder bdb_txn_commit_latency("bdb_txn_commit_latency");
+bvar::LatencyRecorder bdb_group_commit_latency("bdb_group_commit_latency");
+bvar::LatencyRecorder bdb_group_commit_batch_count("bdb_group_commit_batch_count");
 
 namespace bthread {
 DECLARE_int32(bthread_concurrency);
@@ -82,6 +89,11 @@ DEFINE_int32(bdb_stat_time_s, 60, "bdb stat time interval(s)");
 DEFINE_bool(bdb_use_db_pool, false, "bdb use db pool");
 DEFINE_int32(bdb_db_pool_size, 4096, "bdb db pool size, must bigger than bthread_connecurrency");
 
+DEFINE_bool(bdb_enable_group_commit, true, "bdb merge concurrent multi-cf write batch into one txn");
+DEFINE_int32(bdb_group_commit_max_batch_count, 64, "bdb max write batch count in one group commit");
+DEFINE_bool(bdb_partition_by_cf, false,
+            "bdb use a separate db file for every column family, can not be changed after data is written");
+
 namespace bdb {
 
 #define DB_MAXIMUM_PAGESIZE (64 * 1024) /* Maximum database page size */
@@ -110,6 +122,8 @@ std::unordered_map<char, std::string> BdbHelper::cf_id_to_name = {
 };
 
 static void DelayBeforeNextRetry(int32_t retry_count) {
+  bdb_deadlock_retry_count << 1;
+
   if (retry_count <= (FLAGS_bdb_max_retries / 3)) {
     return;
   } else {
@@ -203,11 +217,13 @@ int BdbHelper::TxnCommit(DbTxn** txn_ptr) {
     return 0;
   }
 
+  int64_t start_time_us = Helper::TimestampUs();
   auto ret = (*txn_ptr)->commit(0);
   if (ret == 0) {
     *txn_ptr = nullptr;
   }
 
+  bdb_txn_commit_latency << Helper::TimestampUs() - start_time_us;
   bdb_transaction_alive_count << -1;
 
   return ret;
@@ -705,9 +721,9 @@ butil::Status Reader::KvGet(const std::string& cf_name, dingodb::SnapshotPtr sna
         DINGO_LOG(ERROR) << "[bdb] snapshot pointer cast error.";
         return butil::Status(pb::error::EINTERNAL, "snapshot pointer cast error.");
       }
-      ret = ss->GetDb()->get(ss->GetDbTxn(), &bdb_key, &bdb_value, 0);
+      ret = GetDb(cf_name, ss)->get(ss->GetDbTxn(), &bdb_key, &bdb_value, 0);
     } else {
-      Db* db = GetDb();
+      Db* db = GetDb(cf_name);
       DEFER(PutDb(db));
       ret = db->get(nullptr, &bdb_key, &bdb_value, 0);
     }
@@ -835,7 +851,7 @@ std::shared_ptr<dingodb::Iterator> Reader::NewIterator(const std::string& cf_nam
     if (snapshot != nullptr) {
       std::shared_ptr<bdb::BdbSnapshot> ss = std::dynamic_pointer_cast<bdb::BdbSnapshot>(snapshot);
       if (ss != nullptr) {
-        ret = ss->GetDb()->cursor(ss->GetDbTxn(), &cursorp, DB_CURSOR_BULK | DB_TXN_SNAPSHOT);
+        ret = GetDb(cf_name, ss)->cursor(ss->GetDbTxn(), &cursorp, DB_CURSOR_BULK | DB_TXN_SNAPSHOT);
         if (ret == 0) {
           return std::make_shared<Iterator>(cf_name, options, cursorp, ss);
         }
@@ -843,7 +859,7 @@ std::shared_ptr<dingodb::Iterator> Reader::NewIterator(const std::string& cf_nam
         DINGO_LOG(ERROR) << "[bdb] snapshot pointer cast error.";
       }
     } else {
-      Db* db = GetDb();
+      Db* db = GetDb(cf_name);
       DEFER(PutDb(db));
       ret = db->cursor(nullptr, &cursorp, DB_READ_COMMITTED);
       if (ret == 0) {
@@ -958,6 +974,12 @@ std::shared_ptr<BdbRawEngine> Reader::GetRawEngine() {
 }
 
 Db* Reader::GetDb() { return GetRawEngine()->GetDb(); }
+Db* Reader::GetDb(const std::string& cf_name) { return GetRawEngine()->GetDb(cf_name); }
+Db* Reader::GetDb(const std::string& cf_name, std::shared_ptr<bdb::BdbSnapshot> snapshot) {
+  // the snapshot txn is env level, so it can be used with the db of any cf.
+  auto raw_engine = GetRawEngine();
+  return raw_engine->IsPartitionByCf() ? raw_engine->GetDb(cf_name) : snapshot->GetDb();
+}
 void Reader::PutDb(Db* db) { return GetRawEngine()->PutDb(db); }
 
 dingodb::SnapshotPtr Reader::GetSnapshot() { return GetRawEngine()->GetSnapshot(); }
@@ -987,7 +1009,7 @@ butil::Status Reader::RetrieveByCursor(const std::string& cf_name, DbTxn* txn, c
 
   try {
     // Get the cursor
-    Db* db = GetDb();
+    Db* db = GetDb(cf_name);
     DEFER(PutDb(db));
     db->cursor(txn, &cursorp, DB_READ_COMMITTED);
 
@@ -1020,6 +1042,60 @@ butil::Status Reader::RetrieveByCursor(const std::string& cf_name, DbTxn* txn, c
   return butil::Status(pb::error::EBDB_UNKNOW, "unknown error.");
 }
 
+// GroupCommitter
+butil::Status GroupCommitter::Write(const PutsWithCf& kv_puts_with_cf, const DeletesWithCf& kv_deletes_with_cf) {
+  WriteBatch batch;
+  batch.kv_puts_with_cf = &kv_puts_with_cf;
+  batch.kv_deletes_with_cf = &kv_deletes_with_cf;
+
+  std::unique_lock<bthread::Mutex> lock(mutex_);
+  pending_batches_.push_back(&batch);
+
+  // wait until the batch is committed by other leader, or become the leader.
+  while (!batch.done && pending_batches_.front() != &batch) {
+    cond_.wait(lock);
+  }
+
+  if (batch.done) {
+    return batch.status;
+  }
+
+  size_t batch_count = std::min(pending_batches_.size(),
+                                static_cast<size_t>(std::max(1, FLAGS_bdb_group_commit_max_batch_count)));
+  std::vector<WriteBatch*> group(pending_batches_.begin(), pending_batches_.begin() + batch_count);
+
+  // new batches can be queued while leader is committing.
+  lock.unlock();
+  int64_t start_time_us = Helper::TimestampUs();
+  auto status = commit_func_(group);
+  for (auto* committed_batch : group) {
+    committed_batch->status = status;
+  }
+
+  // the group txn is aborted as a whole, commit every batch alone, so a bad batch only fail itself.
+  if (!status.ok() && group.size() > 1) {
+    DINGO_LOG(WARNING) << fmt::format("[bdb] group commit failed, commit {} batches one by one, error: {} {}",
+                                      group.size(), status.error_code(), status.error_str());
+    for (auto* committed_batch : group) {
+      committed_batch->status = commit_func_({committed_batch});
+    }
+  }
+  bdb_group_commit_latency << Helper::TimestampUs() - start_time_us;
+  bdb_group_commit_batch_count << batch_count;
+  lock.lock();
+
+  for (auto* committed_batch : group) {
+    CHECK(pending_batches_.front() == committed_batch) << "[bdb] group commit queue is out of order.";
+    pending_batches_.pop_front();
+    committed_batch->done = true;
+  }
+
+  // wake up followers and the next leader.
+  cond_.notify_all();
+
+  return batch.status;
+}
+
 // Writer
 butil::Status Writer::KvPut(const std::string& cf_name, const pb::common::KeyValue& kv) {
   if (BAIDU_UNLIKELY(kv.key().empty())) {
@@ -1027,7 +1103,7 @@ butil::Status Writer::KvPut(const std::string& cf_name, const pb::common::KeyVal
     return butil::Status(pb::error::EKEY_EMPTY, "Key is empty");
   }
 
-  Db* db = GetDb();
+  Db* db = GetDb(cf_name);
   DEFER(PutDb(db));
 
   DbEnv* envp = db->get_env();
@@ -1127,7 +1203,7 @@ butil::Status Writer::KvBatchPutAndDelete(const std::string& cf_name,
   DINGO_LOG(DEBUG) << fmt::format("[bdb] batch put and delete, cf_name: {}, put size: {}, delete size: {}.", cf_name,
                                   kvs_to_put.size(), keys_to_delete.size());
 
-  Db* db = GetDb();
+  Db* db = GetDb(cf_name);
   DEFER(PutDb(db));
 
   DbEnv* envp = db->get_env();
@@ -1242,6 +1318,49 @@ butil::Status Writer::KvBatchPutAndDelete(const std::string& cf_name,
 butil::Status Writer::KvBatchPutAndDelete(
     const std::map<std::string, std::vector<pb::common::KeyValue>>& kv_puts_with_cf,
     const std::map<std::string, std::vector<std::string>>& kv_deletes_with_cf) {
+  // check before commit, so an illegal batch will not fail the other batches in the same group.
+  for (const auto& [cf_name, kv_puts] : kv_puts_with_cf) {
+    if (BAIDU_UNLIKELY(kv_puts.empty())) {
+      DINGO_LOG(ERROR) << fmt::format("[bdb] keys empty not support");
+      return butil::Status(pb::error::EKEY_EMPTY, "Key is empty");
+    }
+
+    for (const auto& kv : kv_puts) {
+      if (BAIDU_UNLIKELY(kv.key().empty())) {
+        DINGO_LOG(ERROR) << fmt::format("[bdb] key empty not support");
+        return butil::Status(pb::error::EKEY_EMPTY, "Key is empty");
+      }
+    }
+  }
+
+  for (const auto& [cf_name, kv_deletes] : kv_deletes_with_cf) {
+    if (BAIDU_UNLIKELY(kv_deletes.empty())) {
+      DINGO_LOG(ERROR) << fmt::format("[bdb] keys empty not support");
+      return butil::Status(pb::error::EKEY_EMPTY, "Key is empty");
+    }
+
+    for (const auto& key : kv_deletes) {
+      if (BAIDU_UNLIKELY(key.empty())) {
+        DINGO_LOG(ERROR) << fmt::format("[bdb] key empty not support");
+        return butil::Status(pb::error::EKEY_EMPTY, "Key is empty");
+      }
+    }
+  }
+
+  if (FLAGS_bdb_enable_group_commit) {
+    return group_committer_.Write(kv_puts_with_cf, kv_deletes_with_cf);
+  }
+
+  GroupCommitter::WriteBatch batch;
+  batch.kv_puts_with_cf = &kv_puts_with_cf;
+  batch.kv_deletes_with_cf = &kv_deletes_with_cf;
+
+  return CommitBatches({&batch});
+}
+
+butil::Status Writer::CommitBatches(const std::vector<GroupCommitter::WriteBatch*>& batches) {
+  auto raw_engine = GetRawEngine();
+
   Db* db = GetDb();
   DEFER(PutDb(db));
 
@@ -1264,64 +1383,48 @@ butil::Status Writer::KvBatchPutAndDelete(
 
       bdb_transaction_alive_count << 1;
 
-      // put
-      for (const auto& [cf_name, kv_puts] : kv_puts_with_cf) {
-        if (BAIDU_UNLIKELY(kv_puts.empty())) {
-          DINGO_LOG(ERROR) << fmt::format("[bdb] keys empty not support");
-          return butil::Status(pb::error::EKEY_EMPTY, "Key is empty");
-        }
-
-        for (const auto& kv : kv_puts) {
-          if (BAIDU_UNLIKELY(kv.key().empty())) {
-            DINGO_LOG(ERROR) << fmt::format("[bdb] key empty not support");
-            return butil::Status(pb::error::EKEY_EMPTY, "Key is empty");
-          }
-
-          std::string store_key = BdbHelper::EncodeKey(cf_name, kv.key());
-          Dbt bdb_key;
-          BdbHelper::StringToDbt(store_key, bdb_key);
-          Dbt bdb_value;
-          BdbHelper::StringToDbt(kv.value(), bdb_value);
-          ret = db->put(txn, &bdb_key, &bdb_value, DB_OVERWRITE_DUP);
-          if (ret != 0) {
-            DINGO_LOG(ERROR) << fmt::format("[bdb] put failed, ret: {}.", ret);
-            return butil::Status(pb::error::EINTERNAL, "Internal put error.");
+      for (const auto* batch : batches) {
+        // put
+        for (const auto& [cf_name, kv_puts] : *batch->kv_puts_with_cf) {
+          Db* cf_db = raw_engine->IsPartitionByCf() ? raw_engine->GetDb(cf_name) : db;
+          for (const auto& kv : kv_puts) {
+            std::string store_key = BdbHelper::EncodeKey(cf_name, kv.key());
+            Dbt bdb_key;
+            BdbHelper::StringToDbt(store_key, bdb_key);
+            Dbt bdb_value;
+            BdbHelper::StringToDbt(kv.value(), bdb_value);
+            ret = cf_db->put(txn, &bdb_key, &bdb_value, DB_OVERWRITE_DUP);
+            if (ret != 0) {
+              DINGO_LOG(ERROR) << fmt::format("[bdb] put failed, ret: {}.", ret);
+              return butil::Status(pb::error::EINTERNAL, "Internal put error.");
+            }
           }
         }
-      }
-
-      // delete
-      for (const auto& [cf_name, kv_deletes] : kv_deletes_with_cf) {
-        if (BAIDU_UNLIKELY(kv_deletes.empty())) {
-          DINGO_LOG(ERROR) << fmt::format("[bdb] keys empty not support");
-          return butil::Status(pb::error::EKEY_EMPTY, "Key is empty");
-        }
-
-        for (const auto& key : kv_deletes) {
-          if (BAIDU_UNLIKELY(key.empty())) {
-            DINGO_LOG(ERROR) << fmt::format("[bdb] key empty not support");
-            return butil::Status(pb::error::EKEY_EMPTY, "Key is empty");
-          }
 
-          std::string store_key = BdbHelper::EncodeKey(cf_name, key);
-          Dbt bdb_key;
-          BdbHelper::StringToDbt(store_key, bdb_key);
-          db->del(txn, &bdb_key, 0);
-          if (ret != 0 && ret != DB_NOTFOUND) {
-            DINGO_LOG(ERROR) << fmt::format("[bdb] delete failed, ret: {}.", ret);
-            return butil::Status(pb::error::EINTERNAL, "Internal put error.");
+        // delete
+        for (const auto& [cf_name, kv_deletes] : *batch->kv_deletes_with_cf) {
+          Db* cf_db = raw_engine->IsPartitionByCf() ? raw_engine->GetDb(cf_name) : db;
+          for (const auto& key : kv_deletes) {
+            std::string store_key = BdbHelper::EncodeKey(cf_name, key);
+            Dbt bdb_key;
+            BdbHelper::StringToDbt(store_key, bdb_key);
+            ret = cf_db->del(txn, &bdb_key, 0);
+            if (ret != 0 && ret != DB_NOTFOUND) {
+              DINGO_LOG(ERROR) << fmt::format("[bdb] delete failed, ret: {}.", ret);
+              return butil::Status(pb::error::EINTERNAL, "Internal put error.");
+            }
           }
         }
       }
 
-      // commit
+      // commit, all batches share one log flush.
       try {
         ret = BdbHelper::TxnCommit(&txn);
         if (ret == 0) {
           return butil::Status::OK();
         }
       } catch (DbException& db_exception) {
-        BdbHelper::PrintEnvStat(GetRawEngine()->GetEnv());
+        BdbHelper::PrintEnvStat(raw_engine->GetEnv());
         DINGO_LOG(ERROR) << fmt::format("[bdb] error on txn commit: {} {}.", db_exception.get_errno(),
                                         db_exception.what());
         ret = BdbHelper::kCommitException;
@@ -1341,7 +1444,8 @@ butil::Status Writer::KvBatchPutAndDelete(
         BdbHelper::TxnAbort(&txn);
 
         DINGO_LOG(WARNING) << fmt::format(
-            "[bdb] writer got DB_LOCK_DEADLOCK. retrying write operation, retry_count: {}.", retry_count);
+            "[bdb] writer got DB_LOCK_DEADLOCK. retrying write operation, retry_count: {}, batch_count: {}.",
+            retry_count, batches.size());
         retry_count++;
         DelayBeforeNextRetry(retry_count);
         retry = true;
@@ -1352,7 +1456,7 @@ butil::Status Writer::KvBatchPutAndDelete(
         return butil::Status(pb::error::EBDB_DEADLOCK, "writer got DeadLockException and out of retries. giving up.");
       }
     } catch (DbException& db_exception) {
-      BdbHelper::PrintEnvStat(GetRawEngine()->GetEnv());
+      BdbHelper::PrintEnvStat(raw_engine->GetEnv());
       DINGO_LOG(ERROR) << fmt::format("[bdb] db put failed, exception: {} {}.", db_exception.get_errno(),
                                       db_exception.what());
       return butil::Status(pb::error::EBDB_EXCEPTION, fmt::format("db put failed, {}.", db_exception.what()));
@@ -1381,7 +1485,7 @@ butil::Status Writer::KvBatchDelete(const std::string& cf_name, const std::vecto
 
   DINGO_LOG(DEBUG) << " raw_keys.size: " << raw_keys.size() << ", keys.size: " << keys.size() << ".";
 
-  Db* db = GetDb();
+  Db* db = GetDb(cf_name);
   DEFER(PutDb(db));
 
   DbEnv* envp = db->get_env();
@@ -1530,7 +1634,7 @@ butil::Status Writer::KvDelete(const std::string& cf_name, const std::string& ke
     return butil::Status(pb::error::EKEY_EMPTY, "Key is empty");
   }
 
-  Db* db = GetDb();
+  Db* db = GetDb(cf_name);
   DEFER(PutDb(db));
 
   DbEnv* envp = db->get_env();
@@ -1819,7 +1923,7 @@ butil::Status Writer::DeleteRangeByCursor(const std::string& cf_name, const pb::
         }
       });
 
-  Db* db = GetDb();
+  Db* db = GetDb(cf_name);
   DEFER(PutDb(db));
 
   db->cursor(txn, &cursorp, DB_CURSOR_BULK | DB_TXN_SNAPSHOT);
@@ -1874,6 +1978,7 @@ std::shared_ptr<BdbRawEngine> Writer::GetRawEngine() {
 }
 
 Db* Writer::GetDb() { return GetRawEngine()->GetDb(); }
+Db* Writer::GetDb(const std::string& cf_name) { return GetRawEngine()->GetDb(cf_name); }
 void Writer::PutDb(Db* db) { return GetRawEngine()->PutDb(db); }
 
 }  // namespace bdb
@@ -1957,6 +2062,19 @@ Db* BdbRawEngine::GetDb() {
   }
 }
 
+Db* BdbRawEngine::GetDb(const std::string& cf_name) {
+  if (cf_dbs_.empty()) {
+    return GetDb();
+  }
+
+  auto it = cf_dbs_.find(bdb::BdbHelper::GetCfId(cf_name));
+  if (BAIDU_UNLIKELY(it == cf_dbs_.end())) {
+    DINGO_LOG(FATAL) << fmt::format("[bdb] not found db of cf: {}.", cf_name);
+  }
+
+  return it->second;
+}
+
 void BdbRawEngine::PutDb(Db* db) {
   if (FLAGS_bdb_use_db_pool && !db_handles_.empty()) {
     db_pool_.Put(db);
@@ -2100,7 +2218,27 @@ bool BdbRawEngine::Init(std::shared_ptr<Config> config, const std::vector<std::s
       return false;
     }
 
-    if (FLAGS_bdb_use_db_pool) {
+    if (FLAGS_bdb_partition_by_cf) {
+      // every cf has its own db file, so write of different cf will not contend on the same pages.
+      for (const auto& [cf_name, cf_id] : bdb::BdbHelper::cf_name_to_id) {
+        std::string cf_file_name = fmt::format("dingo_{}.db", cf_name);
+        Db* cf_db = nullptr;
+        ret = OpenDb(&cf_db, cf_file_name.c_str(), envp_, 0);
+        if (ret < 0) {
+          DINGO_LOG(ERROR) << fmt::format("[bdb] error opening database: {}/{}, ret: {}.", bdb_path, cf_file_name,
+                                          ret);
+          return false;
+        }
+
+        cf_dbs_[cf_id] = cf_db;
+      }
+
+      DINGO_LOG(INFO) << fmt::format("[bdb] partition by cf, db count: {}.", cf_dbs_.size());
+
+      if (FLAGS_bdb_use_db_pool) {
+        DINGO_LOG(WARNING) << "[bdb] db pool is not used when partition by cf.";
+      }
+    } else if (FLAGS_bdb_use_db_pool) {
       for (int i = 0; i < FLAGS_bdb_db_pool_size; i++) {
         Db* db_in_pool = nullptr;
         ret = OpenDb(&db_in_pool, file_name, envp_, 0);
@@ -2157,6 +2295,13 @@ void BdbRawEngine::Close() {
     }
     DINGO_LOG(INFO) << "[bdb] db handles closed.";
 
+    for (auto& [cf_id, cf_db] : cf_dbs_) {
+      if (cf_db != nullptr) {
+        cf_db->close(0);
+      }
+    }
+    DINGO_LOG(INFO) << "[bdb] cf dbs closed.";
+
     // Close our environment if it was opened.
     if (envp_ != nullptr) {
       envp_->close(0);
@@ -2318,6 +2463,13 @@ butil::Status BdbRawEngine::IngestExternalFile(const std::string& cf_name, const
 void BdbRawEngine::Flush(const std::string& /*cf_name*/) {
   try {
     int ret = db_->sync(0);
+    for (auto& [cf_id, cf_db] : cf_dbs_) {
+      if (ret != 0) {
+        break;
+      }
+      ret = cf_db->sync(0);
+    }
+
     if (ret == 0) {
       DINGO_LOG(INFO) << fmt::format("[bdb] flush done!");
     } else {
@@ -2345,7 +2497,8 @@ butil::Status BdbRawEngine::Compact(const std::string& cf_name) {
     memset(&compact_data, 0, sizeof(DB_COMPACT));
     compact_data.compact_fillpercent = 80;
 
-    int ret = db_->compact(nullptr, &start, &stop, &compact_data, 0, nullptr);
+    Db* db = IsPartitionByCf() ? GetDb(cf_name) : db_;
+    int ret = db->compact(nullptr, &start, &stop, &compact_data, 0, nullptr);
     if (ret == 0) {
       DINGO_LOG(INFO) << fmt::format(
           "[bdb] compact done! number of pages freed: {}, number of pages examine: {}, "
@@ -2419,7 +2572,8 @@ std::vector<int64_t> BdbRawEngine::GetApproximateSizes(const std::string& cf_nam
         });
 
     // use DB_FAST_STAT, Don't traverse the database
-    int ret = db_->stat(nullptr, &bdb_stat, DB_FAST_STAT);
+    Db* db = IsPartitionByCf() ? GetDb(cf_name) : db_;
+    int ret = db->stat(nullptr, &bdb_stat, DB_FAST_STAT);
     // int ret = db_->stat(nullptr, &bdb_stat, DB_READ_UNCOMMITTED);
     if (BAIDU_UNLIKELY(ret != 0)) {
       DINGO_LOG(ERROR) << fmt::format("[bdb] stat failed, cf_name: {}.", cf_name);
@@ -2447,7 +2601,7 @@ std::vector<int64_t> BdbRawEngine::GetApproximateSizes(const std::string& cf_nam
 
       DB_KEY_RANGE range_start;
       memset(&range_start, 0, sizeof(range_start));
-      ret = db_->key_range(nullptr, &bdb_start_key, &range_start, 0);
+      ret = db->key_range(nullptr, &bdb_start_key, &range_start, 0);
       if (BAIDU_UNLIKELY(ret != 0)) {
         DINGO_LOG(ERROR) << fmt::format("[bdb] start key_range failed, cf_name: {}.", cf_name);
         return std::vector<int64_t>();
@@ -2455,7 +2609,7 @@ std::vector<int64_t> BdbRawEngine::GetApproximateSizes(const std::string& cf_nam
 
       DB_KEY_RANGE range_end;
       memset(&range_end, 0, sizeof(range_end));
-      ret = db_->key_range(nullptr, &bdb_end_key, &range_end, 0);
+      ret = db->key_range(nullptr, &bdb_end_key, &range_end, 0);
       if (BAIDU_UNLIKELY(ret != 0)) {
         DINGO_LOG(ERROR) << fmt::format("[bdb] end key_range failed, cf_name: {}.", cf_name);
         return std::vector<int64_t>();
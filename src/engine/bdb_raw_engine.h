@@ -19,10 +19,16 @@
 
 #include <atomic>
 #include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
 #include <memory>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "bthread/condition_variable.h"
+#include "bthread/mutex.h"
 #include "common/synchronization.h"
 #include "config/config.h"
 #include "db_cxx.h"
@@ -159,6 +165,38 @@ class Iterator : public dingodb::Iterator {
 
 using IteratorPtr = std::shared_ptr<Iterator>;
 
+// GroupCommitter merge concurrent multi-cf write batches(e.g. raft apply of different regions) into one bdb txn.
+// The first waiting writer become the leader, it take all pending batches, write them in one txn and commit with a
+// single log flush, then wake up the followers with the result.
+// If the group txn fail, every batch of the group is committed alone, so each batch get its own status.
+class GroupCommitter {
+ public:
+  using PutsWithCf = std::map<std::string, std::vector<pb::common::KeyValue>>;
+  using DeletesWithCf = std::map<std::string, std::vector<std::string>>;
+
+  struct WriteBatch {
+    const PutsWithCf* kv_puts_with_cf{nullptr};
+    const DeletesWithCf* kv_deletes_with_cf{nullptr};
+
+    butil::Status status;
+    bool done{false};
+  };
+
+  using CommitFunc = std::function<butil::Status(const std::vector<WriteBatch*>& batches)>;
+
+  explicit GroupCommitter(CommitFunc commit_func) : commit_func_(std::move(commit_func)) {}
+  ~GroupCommitter() = default;
+
+  butil::Status Write(const PutsWithCf& kv_puts_with_cf, const DeletesWithCf& kv_deletes_with_cf);
+
+ private:
+  CommitFunc commit_func_;
+
+  bthread::Mutex mutex_;
+  bthread::ConditionVariable cond_;
+  std::deque<WriteBatch*> pending_batches_;
+};
+
 class Reader : public RawEngine::Reader {
  public:
   Reader(std::shared_ptr<BdbRawEngine> raw_engine) : raw_engine_(raw_engine) {}
@@ -192,6 +230,9 @@ class Reader : public RawEngine::Reader {
  private:
   std::shared_ptr<BdbRawEngine> GetRawEngine();
   Db* GetDb();
+  Db* GetDb(const std::string& cf_name);
+  // Get the db handle of cf for read with snapshot txn.
+  Db* GetDb(const std::string& cf_name, std::shared_ptr<bdb::BdbSnapshot> snapshot);
   void PutDb(Db* db);
   dingodb::SnapshotPtr GetSnapshot();
   butil::Status RetrieveByCursor(const std::string& cf_name, DbTxn* txn, const std::string& key, std::string& value);
@@ -201,7 +242,11 @@ class Reader : public RawEngine::Reader {
 
 class Writer : public RawEngine::Writer {
  public:
-  Writer(std::shared_ptr<BdbRawEngine> raw_engine) : raw_engine_(raw_engine) {}
+  Writer(std::shared_ptr<BdbRawEngine> raw_engine)
+      : raw_engine_(raw_engine),
+        group_committer_([this](const std::vector<GroupCommitter::WriteBatch*>& batches) {
+          return CommitBatches(batches);
+        }) {}
   ~Writer() override = default;
 
   butil::Status KvPut(const std::string& cf_name, const pb::common::KeyValue& kv) override;
@@ -222,11 +267,17 @@ class Writer : public RawEngine::Writer {
   butil::Status KvBatchDelete(const std::string& cf_name, const std::vector<std::string>& keys);
   butil::Status DeleteRangeByCursor(const std::string& cf_name, const pb::common::Range& range, DbTxn* txn);
 
+  // Write all batches in one txn, retry on dead lock.
+  butil::Status CommitBatches(const std::vector<GroupCommitter::WriteBatch*>& batches);
+
   std::shared_ptr<BdbRawEngine> GetRawEngine();
   Db* GetDb();
+  Db* GetDb(const std::string& cf_name);
   void PutDb(Db* db);
 
   std::weak_ptr<BdbRawEngine> raw_engine_;
+
+  GroupCommitter group_committer_;
 };
 
 }  // namespace bdb
@@ -244,7 +295,10 @@ class BdbRawEngine : public RawEngine {
   // Open a DB database
   static int32_t OpenDb(Db** dbpp, const char* file_name, DbEnv* envp, u_int32_t extra_flags);
   Db* GetDb();
+  // When partition by cf, every cf has its own db, otherwise same as GetDb().
+  Db* GetDb(const std::string& cf_name);
   void PutDb(Db* db);
+  bool IsPartitionByCf() const { return !cf_dbs_.empty(); }
   DbEnv* GetEnv() { return envp_; }
   std::shared_ptr<BdbRawEngine> GetSelfPtr() { return std::dynamic_pointer_cast<BdbRawEngine>(shared_from_this()); }
 
@@ -279,6 +333,9 @@ class BdbRawEngine : public RawEngine {
   ResourcePool<Db*> db_pool_{"bdb_db_handles"};
   std::vector<Db*> db_handles_;
 
+  // cf_id -> db, only used when FLAGS_bdb_partition_by_cf is true.
+  std::unordered_map<char, Db*> cf_dbs_;
+
   RawEngine::ReaderPtr reader_;
   RawEngine::WriterPtr writer_;
 
@@ -176,6 +176,11 @@ class Engine : public std::enable_shared_from_this<Engine> {
       bool is_reverse{};
       bool use_scalar_filter{};
 
+      // Push down into document index when search.
+      std::vector<DocumentScalarPredicate> scalar_predicates;
+      bool use_id_filter{};
+      std::vector<int64_t> alive_ids;
+
       DocumentIndexWrapperPtr document_index;
       pb::common::ScalarSchema scalar_schema;
     };
@@ -50,8 +50,51 @@
 
 namespace dingodb {
 DEFINE_bool(enable_rocksdb_sync, false, "enable rocksdb sync ");
+DEFINE_bool(enable_rocksdb_key_layout_prefix_extractor, true,
+            "use txn/vector key layout prefix extractor for txn and vector column family");
+DEFINE_double(rocksdb_memtable_prefix_bloom_size_ratio, 0.1,
+              "memtable prefix bloom size ratio of column family with key layout prefix extractor");
 namespace rocks {
 
+// txn key: padding user key + 8 bytes ts, padding user key is groups of 8 bytes data and 1 byte mark,
+// the mark is 0xff except the last group, which is 0xff - padding_num(1~8).
+static constexpr size_t kTxnKeyGroupSize = 9;
+static constexpr size_t kTxnKeyTsSize = 8;
+
+rocksdb::Slice TxnKeyPrefixTransform::Transform(const rocksdb::Slice& key) const {
+  return rocksdb::Slice(key.data(), key.size() - kTxnKeyTsSize);
+}
+
+bool TxnKeyPrefixTransform::InDomain(const rocksdb::Slice& key) const {
+  if (key.size() < kTxnKeyGroupSize + kTxnKeyTsSize || (key.size() - kTxnKeyTsSize) % kTxnKeyGroupSize != 0) {
+    return false;
+  }
+
+  size_t padding_key_size = key.size() - kTxnKeyTsSize;
+  const auto* data = reinterpret_cast<const uint8_t*>(key.data());
+  for (size_t pos = kTxnKeyGroupSize - 1; pos + 1 < padding_key_size; pos += kTxnKeyGroupSize) {
+    if (data[pos] != 0xff) {
+      return false;
+    }
+  }
+
+  uint8_t last_mark = data[padding_key_size - 1];
+  return last_mark >= 0xff - 8 && last_mark < 0xff;
+}
+
+rocksdb::Slice VectorKeyPrefixTransform::Transform(const rocksdb::Slice& key) const {
+  return rocksdb::Slice(key.data(), Constant::kVectorKeyMaxLenWithPrefix);
+}
+
+bool VectorKeyPrefixTransform::InDomain(const rocksdb::Slice& key) const {
+  return key.size() >= Constant::kVectorKeyMaxLenWithPrefix;
+}
+
+bool VectorKeyPrefixTransform::FullLengthEnabled(size_t* len) const {
+  *len = Constant::kVectorKeyMaxLenWithPrefix;
+  return true;
+}
+
 ColumnFamily::ColumnFamily(const std::string& cf_name, const ColumnFamilyConfig& config,
                            rocksdb::ColumnFamilyHandle* handle)
     : name_(cf_name), config_(config), handle_(handle) {}
@@ -804,7 +847,17 @@ static rocksdb::ColumnFamilyOptions GenRocksDBColumnFamilyOptions(rocks::ColumnF
             family_options.max_bytes_for_level_multiplier);
 
   // prefix_extractor
-  {
+  const auto& cf_name = column_family->Name();
+  if (FLAGS_enable_rocksdb_key_layout_prefix_extractor &&
+      (cf_name == Constant::kTxnDataCF || cf_name == Constant::kTxnLockCF || cf_name == Constant::kTxnWriteCF)) {
+    family_options.prefix_extractor = std::make_shared<rocks::TxnKeyPrefixTransform>();
+    family_options.memtable_prefix_bloom_size_ratio = FLAGS_rocksdb_memtable_prefix_bloom_size_ratio;
+  } else if (FLAGS_enable_rocksdb_key_layout_prefix_extractor &&
+             (cf_name == Constant::kVectorScalarCF || cf_name == Constant::kVectorScalarKeySpeedUpCF ||
+              cf_name == Constant::kVectorTableCF)) {
+    family_options.prefix_extractor = std::make_shared<rocks::VectorKeyPrefixTransform>();
+    family_options.memtable_prefix_bloom_size_ratio = FLAGS_rocksdb_memtable_prefix_bloom_size_ratio;
+  } else {
     size_t value = 0;
     CastValue(column_family->GetConfItem(Constant::kPrefixExtractor), value);
 
@@ -76,6 +76,26 @@ class ColumnFamily {
 using ColumnFamilyPtr = std::shared_ptr<ColumnFamily>;
 using ColumnFamilyMap = std::map<std::string, ColumnFamilyPtr>;
 
+// Prefix of txn key(padding user key + 8 bytes ts) is the padding user key,
+// so all versions of a key share one prefix and mvcc seek can use prefix bloom.
+class TxnKeyPrefixTransform : public rocksdb::SliceTransform {
+ public:
+  const char* Name() const override { return "dingodb.TxnKeyPrefix"; }
+  rocksdb::Slice Transform(const rocksdb::Slice& key) const override;
+  bool InDomain(const rocksdb::Slice& key) const override;
+};
+
+// Prefix of vector/document key is prefix(1) + partition_id(8) + id(8),
+// so all scalar of a vector/document share one prefix.
+class VectorKeyPrefixTransform : public rocksdb::SliceTransform {
+ public:
+  const char* Name() const override { return "dingodb.VectorKeyPrefix"; }
+  rocksdb::Slice Transform(const rocksdb::Slice& key) const override;
+  bool InDomain(const rocksdb::Slice& key) const override;
+  bool SameResultWhenAppended(const rocksdb::Slice& prefix) const override { return InDomain(prefix); }
+  bool FullLengthEnabled(size_t* len) const override;
+};
+
 class Iterator : public dingodb::Iterator {
  public:
   explicit Iterator(IteratorOptions options, rocksdb::Iterator* iter)
@@ -732,7 +732,8 @@ butil::Status Storage::VectorCalcDistance(const ::dingodb::pb::index::VectorCalc
     return status;
   }
 
-  status = VectorIndexUtils::CalcDistanceEntry(request, distances, result_op_left_vectors, result_op_right_vectors);
+  status = VectorIndexUtils::CalcDistanceEntry(request, distances, result_op_left_vectors, result_op_right_vectors,
+                                               Server::GetInstance().GetVectorIndexThreadPool());
   if (!status.ok()) {
     DINGO_LOG(ERROR) << fmt::format("VectorIndexUtils::CalcDistanceEntry failed : {}", status.error_cstr());
   }
@@ -1160,17 +1160,15 @@ int VectorAddHandler::Handle(std::shared_ptr<Context> ctx, store::RegionPtr regi
           vector_with_ids.push_back(vector_with_id);
         }
 
+        // Apply log id is set with the write together, so online save snapshot see them consistent.
+        int64_t apply_log_id = region->GetStoreEngineType() == pb::common::STORE_ENG_RAFT_STORE ? log_id : 0;
         auto start_time = Helper::TimestampNs();
-        auto status = request.is_update() ? vector_index_wrapper->Upsert(vector_with_ids)
-                                          : vector_index_wrapper->Add(vector_with_ids);
+        auto status = request.is_update() ? vector_index_wrapper->Upsert(vector_with_ids, apply_log_id)
+                                          : vector_index_wrapper->Add(vector_with_ids, apply_log_id);
         if (tracker) tracker->SetVectorIndexWriteTime(Helper::TimestampNs() - start_time);
         DINGO_LOG(DEBUG) << fmt::format("[raft.apply][region({})] upsert vector, count: {} cost: {}us", vector_index_id,
                                         vector_with_ids.size(), Helper::TimestampNs() - start_time);
-        if (status.ok()) {
-          if (region->GetStoreEngineType() == pb::common::STORE_ENG_RAFT_STORE) {
-            vector_index_wrapper->SetApplyLogId(log_id);
-          }
-        } else {
+        if (!status.ok()) {
           DINGO_LOG(WARNING) << fmt::format("[raft.apply][region({})] upsert vector failed, count: {} err: {}",
                                             vector_index_id, vector_with_ids.size(), Helper::PrintStatus(status));
         }
@@ -1294,14 +1292,12 @@ int VectorDeleteHandler::Handle(std::shared_ptr<Context> ctx, store::RegionPtr r
     if (log_id > vector_index_wrapper->ApplyLogId() ||
         region->GetStoreEngineType() == pb::common::STORE_ENG_MONO_STORE) {
       try {
+        // Apply log id is set with the write together, so online save snapshot see them consistent.
+        int64_t apply_log_id = region->GetStoreEngineType() == pb::common::STORE_ENG_RAFT_STORE ? log_id : 0;
         auto start_time = Helper::TimestampNs();
-        auto status = vector_index_wrapper->Delete(delete_ids);
+        auto status = vector_index_wrapper->Delete(delete_ids, apply_log_id);
         if (tracker) tracker->SetVectorIndexWriteTime(Helper::TimestampNs() - start_time);
-        if (status.ok()) {
-          if (region->GetStoreEngineType() == pb::common::STORE_ENG_RAFT_STORE) {
-            vector_index_wrapper->SetApplyLogId(log_id);
-          }
-        } else {
+        if (!status.ok()) {
           DINGO_LOG(WARNING) << fmt::format("[raft.apply][region({})] delete vector failed, count: {}, error: {}",
                                             vector_index_id, delete_ids.size(), Helper::PrintStatus(status));
         }
@@ -271,7 +271,8 @@ class StoreServerMeta {
   pb::node::NodeInfo GetNodeInfoByServerEndPoint(const butil::EndPoint& endpoint);
 
  private:
-  int64_t epoch_;
+  // store map epoch of coordinator, 0 means not synced
+  int64_t epoch_{0};
   bthread_mutex_t mutex_;
   std::map<int64_t, std::shared_ptr<pb::common::Store>> stores_;
 };
@@ -675,7 +675,7 @@ void DoStoreHeartbeat(google::protobuf::RpcController * /*controller*/,
   pb::coordinator_internal::MetaIncrement meta_increment;
 
   // update store map
-  int const new_storemap_epoch = coordinator_control->UpdateStoreMap(request->store(), meta_increment);
+  int64_t const new_storemap_epoch = coordinator_control->UpdateStoreMap(request->store(), meta_increment);
 
   // update store metrics
   if (request->has_store_metrics()) {
@@ -723,8 +723,11 @@ void DoStoreHeartbeat(google::protobuf::RpcController * /*controller*/,
     }
   }
 
-  auto *new_storemap = response->mutable_storemap();
-  coordinator_control->GetStoreMap(*new_storemap);
+  // only return the full store map when the store map epoch of caller is stale
+  if (request->self_storemap_epoch() != new_storemap_epoch) {
+    auto *new_storemap = response->mutable_storemap();
+    coordinator_control->GetStoreMap(*new_storemap);
+  }
 
   response->set_storemap_epoch(new_storemap_epoch);
 }
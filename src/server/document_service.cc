@@ -265,6 +265,11 @@ void DoDocumentSearch(StoragePtr storage, google::protobuf::RpcController* contr
   ctx->parameter.Swap(mut_request->mutable_parameter());
   ctx->raw_engine_type = region->GetRawEngineType();
   ctx->store_engine_type = region->GetStoreEngineType();
+  // Push down id allow list into document index.
+  ctx->use_id_filter = ctx->parameter.use_id_filter();
+  if (ctx->use_id_filter) {
+    ctx->alive_ids = Helper::PbRepeatedToVector(ctx->parameter.document_ids());
+  }
 
   std::vector<pb::common::DocumentWithScore> document_results;
   status = storage->DocumentSearch(ctx, document_results);
@@ -17,6 +17,7 @@
 #include <cstdint>
 #include <vector>
 
+#include "common/helper.h"
 #include "fmt/core.h"
 #include "server/service_helper.h"
 
@@ -77,6 +78,12 @@ void FileServiceImpl::CleanFileReader(google::protobuf::RpcController* controlle
   }
 }
 
+FileReaderWrapper::~FileReaderWrapper() {
+  if (is_temp_path_) {
+    Helper::RemoveAllFileOrDirectory(path_);
+  }
+}
+
 FileServiceReaderManager::FileServiceReaderManager() {
   bthread_mutex_init(&mutex_, nullptr);
   next_id_ = ((int64_t)getpid() << 45) | (butil::gettimeofday_us() << 17 >> 17);
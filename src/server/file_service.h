@@ -44,18 +44,26 @@ class FileReaderWrapper {
  public:
   FileReaderWrapper(vector_index::SnapshotMetaPtr snapshot)
       : snapshot_(snapshot),
+        path_(snapshot->Path()),
         file_reader_(std::make_shared<LocalDirReader>(new braft::PosixFileSystemAdaptor(), snapshot->Path())) {}
-  ~FileReaderWrapper() = default;
+  // Read a plain directory, e.g. document index checkpoint, the temp path is removed when destroy.
+  FileReaderWrapper(const std::string& path, bool is_temp_path)
+      : path_(path),
+        is_temp_path_(is_temp_path),
+        file_reader_(std::make_shared<LocalDirReader>(new braft::PosixFileSystemAdaptor(), path)) {}
+  ~FileReaderWrapper();
 
   int ReadFile(butil::IOBuf* out, const std::string& filename, off_t offset, size_t max_count, size_t* read_count,
                bool* is_eof) {
     return file_reader_->ReadFile(out, filename, offset, max_count, read_count, is_eof);
   }
 
-  std::string Path() { return snapshot_->Path(); }
+  std::string Path() { return path_; }
 
  private:
   vector_index::SnapshotMetaPtr snapshot_;
+  std::string path_;
+  bool is_temp_path_{false};
   std::shared_ptr<FileReader> file_reader_;
 };
 
@@ -22,10 +22,12 @@
 #include "brpc/controller.h"
 #include "butil/endpoint.h"
 #include "butil/status.h"
+#include "common/constant.h"
 #include "common/failpoint.h"
 #include "common/helper.h"
 #include "common/logging.h"
 #include "common/role.h"
+#include "document/document_index_snapshot_manager.h"
 #include "fmt/core.h"
 #include "metrics/dingo_bvar.h"
 #include "proto/common.pb.h"
@@ -451,6 +453,22 @@ void NodeServiceImpl::GetVectorIndexSnapshot(google::protobuf::RpcController* co
                             fmt::format("Not found region {}.", request->vector_index_id()));
     return;
   }
+
+  // Document index region reuse the rpc, ship the tantivy index checkpoint.
+  // The meta only request is for choosing peer, so not make checkpoint for it.
+  auto document_index_wrapper = region->DocumentIndexWrapper();
+  if (document_index_wrapper != nullptr) {
+    bool meta_only = cntl->request_attachment().to_string() == Constant::kSnapshotMetaOnlyAttachment;
+    auto status = meta_only ? DocumentIndexSnapshotManager::HandleGetSnapshotMeta(document_index_wrapper, response)
+                            : DocumentIndexSnapshotManager::HandlePullSnapshot(document_index_wrapper, response);
+    if (!status.ok()) {
+      ServiceHelper::SetError(response->mutable_error(), status.error_code(), status.error_str());
+    }
+
+    DINGO_LOG(INFO) << fmt::format("response: {}", response->ShortDebugString());
+    return;
+  }
+
   auto vector_index_wrapper = region->VectorIndexWrapper();
   if (vector_index_wrapper == nullptr) {
     ServiceHelper::SetError(response->mutable_error(), Errno::EVECTOR_INDEX_NOT_FOUND,
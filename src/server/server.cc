@@ -52,6 +52,7 @@
 #include "scan/scan_manager.h"
 #include "store/heartbeat.h"
 #include "store/region_controller.h"
+#include "vector/vector_range_search_cursor.h"
 
 DEFINE_string(coor_url, "",
               "coor service name, e.g. file://<path>, list://<addr1>,<addr2>..., bns://<bns-name>, "
@@ -61,6 +62,7 @@ namespace dingodb {
 
 DECLARE_int64(compaction_retention_rev_count);
 DECLARE_bool(auto_compaction);
+DECLARE_int64(vector_range_search_cursor_clean_interval_s);
 
 DEFINE_bool(ip2hostname, false, "resolve ip to hostname for get map api");
 DEFINE_bool(enable_ip2hostname_cache, true, "enable ip2hostname cache");
@@ -90,6 +92,7 @@ DEFINE_int32(coordinator_meta_watch_clean_interval_s, 60, "coordinator meta watc
 DEFINE_int32(coordinator_remove_watch_interval_s, 10, "coordinator remove watch interval seconds");
 DEFINE_int32(coordinator_lease_interval_s, 1, "coordinator lease interval seconds");
 DEFINE_int32(coordinator_compaction_interval_s, 300, "coordinator compaction interval seconds");
+DEFINE_int32(coordinator_kv_compaction_step_interval_s, 1, "coordinator kv compaction step interval seconds");
 DEFINE_int32(server_scrub_vector_index_interval_s, 60, "scrub vector index interval seconds");
 DEFINE_int32(raft_snapshot_interval_s, 120, "raft snapshot interval seconds");
 DEFINE_int32(gc_update_safe_point_interval_s, 60, "gc update safe point interval seconds");
@@ -653,6 +656,17 @@ bool Server::InitCrontabManager() {
       [](void*) { Heartbeat::TriggerCompactionTask(nullptr); },
   });
 
+  // Add kv compaction step crontab
+  FLAGS_coordinator_kv_compaction_step_interval_s = GetInterval(
+      config, "coordinator.kv_compaction_step_interval_s", FLAGS_coordinator_kv_compaction_step_interval_s);
+  crontab_configs_.push_back({
+      "KV_COMPACTION_STEP",
+      {pb::common::COORDINATOR},
+      FLAGS_coordinator_kv_compaction_step_interval_s * 1000,
+      true,
+      [](void*) { Heartbeat::TriggerKvCompactionStepTask(nullptr); },
+  });
+
   // Add scrub vector index crontab
   FLAGS_server_scrub_vector_index_interval_s =
       GetInterval(config, "server.scrub_vector_index_interval_s", FLAGS_server_scrub_vector_index_interval_s);
@@ -675,6 +689,15 @@ bool Server::InitCrontabManager() {
       [](void*) { Heartbeat::TriggerScrubVectorIndex(nullptr); },
   });
 
+  // Add vector range search cursor cleaning crontab
+  crontab_configs_.push_back({
+      "VECTOR_RANGE_SEARCH_CURSOR",
+      {pb::common::INDEX},
+      FLAGS_vector_range_search_cursor_clean_interval_s * 1000,
+      true,
+      [](void*) { VectorRangeSearchCursorManager::RegularCleaningHandler(nullptr); },
+  });
+
   auto raft_store_engine = GetRaftStoreEngine();
   if (raft_store_engine != nullptr) {
     // Add raft snapshot controller crontab
@@ -255,16 +255,19 @@ void DoLeaseRenew(google::protobuf::RpcController* /*controller*/, const pb::ver
     return;
   }
 
-  std::shared_ptr<Context> ctx = std::make_shared<Context>();
-  ctx->SetRegionId(Constant::kKvRegionId);
-  ctx->SetTracker(done->Tracker());
-
-  // this is a async operation will be block by closure
-  auto ret2 = raft_engine->Write(ctx, WriteDataBuilder::BuildWrite(ctx->CfName(), meta_increment));
-  if (!ret2.ok()) {
-    DINGO_LOG(ERROR) << "LeaseRenew failed:  lease_id=" << request->id() << ", error=" << ret2.error_str();
-    ServiceHelper::SetError(response->mutable_error(), ret2.error_code(), ret2.error_str());
-    return;
+  // keepalive is leader local, only write raft when there is meta_increment
+  if (meta_increment.ByteSizeLong() > 0) {
+    std::shared_ptr<Context> ctx = std::make_shared<Context>();
+    ctx->SetRegionId(Constant::kKvRegionId);
+    ctx->SetTracker(done->Tracker());
+
+    // this is a async operation will be block by closure
+    auto ret2 = raft_engine->Write(ctx, WriteDataBuilder::BuildWrite(ctx->CfName(), meta_increment));
+    if (!ret2.ok()) {
+      DINGO_LOG(ERROR) << "LeaseRenew failed:  lease_id=" << request->id() << ", error=" << ret2.error_str();
+      ServiceHelper::SetError(response->mutable_error(), ret2.error_code(), ret2.error_str());
+      return;
+    }
   }
 
   response->set_id(request->id());
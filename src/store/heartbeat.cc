@@ -242,7 +242,8 @@ static std::vector<std::shared_ptr<pb::common::Store>> GetChangedStore(
     auto it = local_stores.find(remote_store.id());
     if (it != local_stores.end()) {
       if (it->second->raft_location().host() != remote_store.raft_location().host() ||
-          it->second->raft_location().port() != remote_store.raft_location().port()) {
+          it->second->raft_location().port() != remote_store.raft_location().port() ||
+          it->second->state() != remote_store.state()) {
         changed_stores.push_back(std::make_shared<pb::common::Store>(remote_store));
       }
     }
@@ -278,31 +279,36 @@ void HeartbeatTask::HandleStoreHeartbeatResponse(std::shared_ptr<dingodb::StoreM
     return;
   }
 
-  // Handle store meta data.
+  // Handle store meta data, the store map is only returned when the local store map epoch is stale.
   auto store_server_meta = store_meta_manager->GetStoreServerMeta();
-  auto local_stores = store_server_meta->GetAllStore();
-  auto remote_stores = response.storemap().stores();
+  if (response.has_storemap()) {
+    auto local_stores = store_server_meta->GetAllStore();
+    auto remote_stores = response.storemap().stores();
 
-  auto new_stores = GetNewStore(local_stores, remote_stores);
-  for (const auto& store : new_stores) {
-    store_server_meta->AddStore(store);
-  }
+    auto new_stores = GetNewStore(local_stores, remote_stores);
+    for (const auto& store : new_stores) {
+      store_server_meta->AddStore(store);
+    }
 
-  auto changed_stores = GetChangedStore(local_stores, remote_stores);
-  for (const auto& store : changed_stores) {
-    store_server_meta->UpdateStore(store);
-  }
+    auto changed_stores = GetChangedStore(local_stores, remote_stores);
+    for (const auto& store : changed_stores) {
+      store_server_meta->UpdateStore(store);
+    }
 
-  auto deleted_stores = GetDeletedStore(local_stores, remote_stores);
-  DINGO_LOG(INFO) << fmt::format("[heartbeat.store] store stats new({}) change({}) delete({}) local({})",
-                                 new_stores.size(), changed_stores.size(), deleted_stores.size(), local_stores.size());
-  for (const auto& store : deleted_stores) {
-    // if deleted store is self, skip, else will coredump in next heartbeat.
-    if (store->id() == Server::GetInstance().Id()) {
-      DINGO_LOG(ERROR) << fmt::format("[heartbeat.store] deleted store id({}) is self, skip", store->id());
-      continue;
+    auto deleted_stores = GetDeletedStore(local_stores, remote_stores);
+    DINGO_LOG(INFO) << fmt::format("[heartbeat.store] store stats new({}) change({}) delete({}) local({}) epoch({})",
+                                   new_stores.size(), changed_stores.size(), deleted_stores.size(), local_stores.size(),
+                                   response.storemap_epoch());
+    for (const auto& store : deleted_stores) {
+      // if deleted store is self, skip, else will coredump in next heartbeat.
+      if (store->id() == Server::GetInstance().Id()) {
+        DINGO_LOG(ERROR) << fmt::format("[heartbeat.store] deleted store id({}) is self, skip", store->id());
+        continue;
+      }
+      store_server_meta->DeleteStore(store->id());
     }
-    store_server_meta->DeleteStore(store->id());
+
+    store_server_meta->SetEpoch(response.storemap_epoch());
   }
 
   // set up read-only
@@ -531,6 +537,19 @@ void CompactionTask::ExecCompactionTask(std::shared_ptr<KvControl> kv_control) {
   kv_control->CompactionTask();
 }
 
+// this is for coordinator, run on every replica
+static std::atomic<bool> g_coordinator_kv_compaction_step_running(false);
+void KvCompactionStepTask::ExecKvCompactionStepTask(std::shared_ptr<KvControl> kv_control) {
+  if (g_coordinator_kv_compaction_step_running.load(std::memory_order_relaxed)) {
+    DINGO_LOG(INFO) << "ExecKvCompactionStepTask... g_coordinator_kv_compaction_step_running is true, return";
+    return;
+  }
+
+  AtomicGuard guard(g_coordinator_kv_compaction_step_running);
+
+  kv_control->KvCompactionStep();
+}
+
 // this is for index
 void VectorIndexScrubTask::ScrubVectorIndex() {
   auto status = VectorIndexManager::ScrubVectorIndex();
@@ -671,6 +690,12 @@ void Heartbeat::TriggerCompactionTask(void*) {
   Server::GetInstance().GetHeartbeat()->Execute(task);
 }
 
+void Heartbeat::TriggerKvCompactionStepTask(void*) {
+  // Free at ExecuteRoutine()
+  auto task = std::make_shared<KvCompactionStepTask>(Server::GetInstance().GetKvControl());
+  Server::GetInstance().GetHeartbeat()->Execute(task);
+}
+
 void Heartbeat::TriggerScrubVectorIndex(void*) {
   // Free at ExecuteRoutine()
   auto task = std::make_shared<VectorIndexScrubTask>();
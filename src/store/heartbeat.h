@@ -215,6 +215,23 @@ class CompactionTask : public TaskRunnable {
   std::shared_ptr<KvControl> kv_control_;
 };
 
+class KvCompactionStepTask : public TaskRunnable {
+ public:
+  KvCompactionStepTask(std::shared_ptr<KvControl> kv_control) : kv_control_(kv_control) {}
+  ~KvCompactionStepTask() override = default;
+
+  std::string Type() override { return "KV_COMPACTION_STEP"; }
+
+  void Run() override {
+    DINGO_LOG(DEBUG) << "start process KvCompactionStepTask";
+    ExecKvCompactionStepTask(kv_control_);
+  }
+
+ private:
+  static void ExecKvCompactionStepTask(std::shared_ptr<KvControl> kv_control);
+  std::shared_ptr<KvControl> kv_control_;
+};
+
 class VectorIndexScrubTask : public TaskRunnable {
  public:
   VectorIndexScrubTask() = default;
@@ -274,6 +291,7 @@ class Heartbeat {
   static void TriggerScrubDocumentIndex(void*);
   static void TriggerLeaseTask(void*);
   static void TriggerCompactionTask(void*);
+  static void TriggerKvCompactionStepTask(void*);
   static void TriggerBalanceLeader(void*);
 
  private:
@@ -14,10 +14,12 @@
 
 #include "vector/vector_index.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -53,6 +55,15 @@ DEFINE_uint32(vector_read_batch_size_per_task, 1, "vector read batch size per ta
 
 DEFINE_uint32(parallel_log_threshold_time_ms, 5000, "parallel log elapsed time");
 
+DEFINE_double(vector_index_search_recall_target, 0.0,
+              "adaptive search recall target, calibrate hnsw ef/ivf nprobe when build, 0 means disable");
+DEFINE_bool(vector_index_enable_fuse_filter, true, "fuse range and ids filters into one check before search");
+DEFINE_int32(vector_index_calibrate_sample_count, 100, "sample vector count for calibrate adaptive search");
+DEFINE_uint32(vector_index_calibrate_topk, 10, "topk for calibrate adaptive search");
+
+// Dirty vector index id, filled by write/apply and consumed by scrub.
+static DirtySet g_vector_index_dirty_set;
+
 // split VectorWithId set to multi batch
 static void SplitVectorWithId(const std::vector<pb::common::VectorWithId>& vector_with_ids, int batch_size,
                               std::vector<std::vector<pb::common::VectorWithId>>& vector_with_id_batchs) {
@@ -117,6 +128,92 @@ VectorIndex::VectorIndex(int64_t id, const pb::common::VectorIndexParameter& vec
 
 VectorIndex::~VectorIndex() { DINGO_LOG(DEBUG) << fmt::format("[delete.VectorIndex][id({})]", id); }
 
+VectorIndex::FusedFilterFunctor::FusedFilterFunctor(int64_t min_vector_id, int64_t max_vector_id, bool has_ids,
+                                                    const std::vector<int64_t>& vector_ids, bool is_negation)
+    : min_vector_id_(min_vector_id), max_vector_id_(max_vector_id), has_ids_(has_ids), is_negation_(is_negation) {
+  if (!has_ids_) {
+    return;
+  }
+
+  auto begin = std::lower_bound(vector_ids.begin(), vector_ids.end(), min_vector_id_);
+  auto end = std::lower_bound(begin, vector_ids.end(), max_vector_id_);
+  id_count_ = end - begin;
+  if (id_count_ == 0) {
+    // Exclude nothing, only range check.
+    if (is_negation_) {
+      has_ids_ = false;
+    }
+    return;
+  }
+
+  // Bitmap take one bit per id of span, sorted list take 64 bits per id.
+  uint64_t span = static_cast<uint64_t>(*(end - 1) - *begin) + 1;
+  if (span <= static_cast<uint64_t>(id_count_) * 64) {
+    bitmap_base_ = *begin;
+    bitmap_bits_ = span;
+    bitmap_.resize((span + 63) / 64, 0);
+    for (auto it = begin; it != end; ++it) {
+      uint64_t offset = static_cast<uint64_t>(*it - bitmap_base_);
+      bitmap_[offset >> 6] |= uint64_t{1} << (offset & 63);
+    }
+  } else {
+    vector_ids_.assign(begin, end);
+  }
+}
+
+std::shared_ptr<VectorIndex::FusedFilterFunctor> VectorIndex::FusedFilterFunctor::Compile(
+    const std::vector<std::shared_ptr<FilterFunctor>>& filters) {
+  if (filters.empty()) {
+    return nullptr;
+  }
+
+  int64_t min_vector_id = INT64_MIN;
+  int64_t max_vector_id = INT64_MAX;
+  const SortFilterFunctor* sort_filter = nullptr;
+  for (const auto& filter : filters) {
+    const auto* range_filter = dynamic_cast<const RangeFilterFunctor*>(filter.get());
+    if (range_filter != nullptr) {
+      min_vector_id = std::max(min_vector_id, range_filter->MinVectorId());
+      max_vector_id = std::min(max_vector_id, range_filter->MaxVectorId());
+      continue;
+    }
+
+    const auto* ids_filter = dynamic_cast<const SortFilterFunctor*>(filter.get());
+    if (ids_filter != nullptr && sort_filter == nullptr) {
+      sort_filter = ids_filter;
+      continue;
+    }
+
+    return nullptr;
+  }
+
+  if (sort_filter == nullptr) {
+    return std::make_shared<FusedFilterFunctor>(min_vector_id, max_vector_id, false, std::vector<int64_t>{}, false);
+  }
+
+  return std::make_shared<FusedFilterFunctor>(min_vector_id, max_vector_id, true, sort_filter->VectorIds(),
+                                              sort_filter->IsNegation());
+}
+
+void VectorIndex::FusedFilterFunctor::GetAllowedIds(std::vector<int64_t>& vector_ids) const {
+  vector_ids.clear();
+  if (!has_ids_ || is_negation_) {
+    return;
+  }
+
+  if (bitmap_.empty()) {
+    vector_ids = vector_ids_;
+    return;
+  }
+
+  vector_ids.reserve(id_count_);
+  for (uint64_t offset = 0; offset < bitmap_bits_; ++offset) {
+    if (((bitmap_[offset >> 6] >> (offset & 63)) & 1) != 0) {
+      vector_ids.push_back(bitmap_base_ + static_cast<int64_t>(offset));
+    }
+  }
+}
+
 void VectorIndex::SetSnapshotLogId(int64_t snapshot_log_id) {
   this->snapshot_log_id.store(snapshot_log_id, std::memory_order_relaxed);
 }
@@ -235,6 +332,106 @@ butil::Status VectorIndex::DeleteByParallel(const std::vector<int64_t>& delete_i
   }
 }
 
+butil::Status VectorIndex::CalibrateSearchParameter(const std::vector<pb::common::VectorWithId>& samples,
+                                                    float recall_target) {
+  auto candidates = AdaptiveSearchCandidates();
+  if (candidates.empty()) {
+    return butil::Status(pb::error::EVECTOR_NOT_SUPPORT, "not support adaptive search");
+  }
+  if (samples.empty()) {
+    return butil::Status::OK();
+  }
+
+  int64_t start_time = Helper::TimestampMs();
+  uint32_t topk = FLAGS_vector_index_calibrate_topk;
+  std::vector<std::shared_ptr<FilterFunctor>> filters;
+
+  // The sample is in the index, so search topk+1 and drop the sample itself, otherwise the self-match inflate recall.
+  auto search_exclude_self = [&](const pb::common::VectorSearchParameter& parameter,
+                                 std::vector<std::vector<int64_t>>& result_ids) -> butil::Status {
+    std::vector<pb::index::VectorWithDistanceResult> results;
+    auto status = Search(samples, topk + 1, filters, false, parameter, results);
+    if (!status.ok()) {
+      return status;
+    }
+
+    result_ids.resize(results.size());
+    for (size_t row = 0; row < results.size() && row < samples.size(); ++row) {
+      for (const auto& vector_with_distance : results[row].vector_with_distances()) {
+        int64_t vector_id = vector_with_distance.vector_with_id().id();
+        if (vector_id != samples[row].id() && result_ids[row].size() < topk) {
+          result_ids[row].push_back(vector_id);
+        }
+      }
+    }
+
+    return butil::Status::OK();
+  };
+
+  pb::common::VectorSearchParameter truth_parameter;
+  FillAdaptiveSearchParameter(candidates.back(), truth_parameter);
+  std::vector<std::vector<int64_t>> truth_results;
+  auto status = search_exclude_self(truth_parameter, truth_results);
+  if (!status.ok()) {
+    return status;
+  }
+
+  std::vector<std::unordered_set<int64_t>> truth_ids(truth_results.size());
+  for (size_t i = 0; i < truth_results.size(); ++i) {
+    truth_ids[i].insert(truth_results[i].begin(), truth_results[i].end());
+  }
+
+  // Pick the min candidate which reach the recall target.
+  int32_t adaptive_value = candidates.back();
+  double recall = 1.0;
+  for (size_t i = 0; i + 1 < candidates.size(); ++i) {
+    pb::common::VectorSearchParameter parameter;
+    FillAdaptiveSearchParameter(candidates[i], parameter);
+    std::vector<std::vector<int64_t>> results;
+    status = search_exclude_self(parameter, results);
+    if (!status.ok()) {
+      return status;
+    }
+
+    int64_t hit_count = 0, total_count = 0;
+    for (size_t row = 0; row < results.size() && row < truth_ids.size(); ++row) {
+      total_count += truth_ids[row].size();
+      for (auto vector_id : results[row]) {
+        if (truth_ids[row].count(vector_id) > 0) {
+          ++hit_count;
+        }
+      }
+    }
+
+    double candidate_recall = total_count > 0 ? static_cast<double>(hit_count) / total_count : 1.0;
+    if (candidate_recall >= recall_target) {
+      adaptive_value = candidates[i];
+      recall = candidate_recall;
+      break;
+    }
+  }
+
+  adaptive_search_parameter.store(adaptive_value);
+
+  DINGO_LOG(INFO) << fmt::format(
+      "[vector_index.raw][id({})] calibrate adaptive search parameter({}) recall({:.4f}/{:.4f}) samples({}) elapsed "
+      "time {}ms",
+      Id(), adaptive_value, recall, recall_target, samples.size(), Helper::TimestampMs() - start_time);
+
+  return butil::Status::OK();
+}
+
+int32_t VectorIndex::AdaptiveSearchParameter(uint32_t topk) const {
+  int32_t value = adaptive_search_parameter.load(std::memory_order_relaxed);
+  uint32_t calibrate_topk = FLAGS_vector_index_calibrate_topk;
+  if (value <= 0 || calibrate_topk == 0 || topk <= calibrate_topk) {
+    return value;
+  }
+
+  // Calibrate at calibrate_topk, larger topk need more candidate.
+  return value * static_cast<int32_t>((topk + calibrate_topk - 1) / calibrate_topk);
+}
+
 butil::Status VectorIndex::SearchByParallel(const std::vector<pb::common::VectorWithId>& vector_with_ids, uint32_t topk,
                                             const std::vector<std::shared_ptr<FilterFunctor>>& filters,
                                             bool reconstruct, const pb::common::VectorSearchParameter& parameter,
@@ -293,6 +490,38 @@ butil::Status VectorIndex::RangeSearchByParallel(
   }
 }
 
+butil::Status VectorIndex::RangeSearchHits(const std::vector<pb::common::VectorWithId>& vector_with_ids, float radius,
+                                           const std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters,
+                                           const pb::common::VectorSearchParameter& parameter,
+                                           std::vector<std::vector<RangeSearchHit>>& hits) {
+  hits.resize(vector_with_ids.size());
+
+  // Convert batch by batch, so the temporary protobuf result is bounded by batch size.
+  std::vector<std::vector<pb::common::VectorWithId>> vector_with_id_batchs;
+  SplitVectorWithId(vector_with_ids, FLAGS_vector_read_batch_size_per_task, vector_with_id_batchs);
+
+  uint32_t offset = 0;
+  for (const auto& vector_with_id_batch : vector_with_id_batchs) {
+    std::vector<pb::index::VectorWithDistanceResult> part_results;
+    auto status = RangeSearch(vector_with_id_batch, radius, filters, false, parameter, part_results);
+    if (!status.ok()) {
+      return status;
+    }
+
+    for (uint32_t i = 0; i < part_results.size() && offset + i < hits.size(); ++i) {
+      auto& row_hits = hits[offset + i];
+      row_hits.reserve(part_results[i].vector_with_distances_size());
+      for (const auto& vector_with_distance : part_results[i].vector_with_distances()) {
+        row_hits.push_back({vector_with_distance.vector_with_id().id(), vector_with_distance.distance()});
+      }
+    }
+
+    offset += vector_with_id_batch.size();
+  }
+
+  return butil::Status::OK();
+}
+
 butil::Status VectorIndex::TrainByParallel(std::vector<float>& train_datas) {
   butil::Status status;
 
@@ -316,6 +545,10 @@ butil::Status VectorIndex::Save(const std::string& /*path*/) {
   return butil::Status(pb::error::Errno::EVECTOR_NOT_SUPPORT, "this vector index do not implement save");
 }
 
+butil::Status VectorIndex::SaveToBuffer(const std::string& /*path*/, VectorIndexSaveBuffer& /*save_buffer*/) {
+  return butil::Status(pb::error::Errno::EVECTOR_NOT_SUPPORT, "this vector index do not implement save to buffer");
+}
+
 butil::Status VectorIndex::Load(const std::string& /*path*/) {
   return butil::Status(pb::error::Errno::EVECTOR_NOT_SUPPORT, "this vector index do not implement load");
 }
@@ -527,7 +760,10 @@ int64_t VectorIndexWrapper::LastBuildEpochVersion() {
 
 int64_t VectorIndexWrapper::ApplyLogId() { return apply_log_id_.load(); }
 
-void VectorIndexWrapper::SetApplyLogId(int64_t apply_log_id) { apply_log_id_.store(apply_log_id); }
+void VectorIndexWrapper::SetApplyLogId(int64_t apply_log_id) {
+  apply_log_id_.store(apply_log_id);
+  MarkDirty();
+}
 
 void VectorIndexWrapper::SaveApplyLogId(int64_t apply_log_id) {
   SetApplyLogId(apply_log_id);
@@ -589,6 +825,7 @@ void VectorIndexWrapper::UpdateVectorIndex(VectorIndexPtr vector_index, const st
     ++version_;
 
     ready_.store(true);
+    MarkDirty();
 
     int64_t apply_log_id = ApplyLogId();
     int64_t snapshot_log_id = SnapshotLogId();
@@ -792,6 +1029,27 @@ bool VectorIndexWrapper::NeedToRebuild() {
   return vector_index->NeedToRebuild();
 }
 
+bool VectorIndexWrapper::NeedToRebalance() {
+  auto vector_index = GetOwnVectorIndex();
+  if (vector_index == nullptr) {
+    return false;
+  }
+
+  return vector_index->NeedToRebalance();
+}
+
+butil::Status VectorIndexWrapper::Rebalance() {
+  // Rebalance move vector between lists, it is a write, so not run while online save snapshot.
+  RWLockReadGuard guard(&write_freeze_lock_);
+
+  auto vector_index = GetOwnVectorIndex();
+  if (vector_index == nullptr) {
+    return butil::Status::OK();
+  }
+
+  return vector_index->Rebalance();
+}
+
 bool VectorIndexWrapper::SupportSave() {
   auto vector_index = GetOwnVectorIndex();
   if (vector_index == nullptr) {
@@ -801,6 +1059,14 @@ bool VectorIndexWrapper::SupportSave() {
   return vector_index->SupportSave();
 }
 
+void VectorIndexWrapper::MarkDirty() {
+  if (dirty_flag_.Mark()) {
+    g_vector_index_dirty_set.Add(Id());
+  }
+}
+
+std::vector<int64_t> VectorIndexWrapper::TakeDirtyIds() { return g_vector_index_dirty_set.Take(); }
+
 bool VectorIndexWrapper::NeedToSave(std::string& reason) {
   auto vector_index = GetOwnVectorIndex();
   if (vector_index == nullptr) {
@@ -896,7 +1162,69 @@ static std::vector<pb::common::VectorWithId> FilterVectorWithId(
   return result;
 }
 
+int64_t VectorIndexWrapper::FreezeWrite() {
+  bool expect = false;
+  if (!is_write_frozen_.compare_exchange_strong(expect, true)) {
+    return -1;
+  }
+
+  // Wait in-flight write finish and block new write until unfreeze, the write set apply log id in lock,
+  // so the apply log id is consistent with vector index.
+  write_freeze_lock_.LockWrite();
+  return ApplyLogId();
+}
+
+void VectorIndexWrapper::UnfreezeWrite() {
+  if (!is_write_frozen_.load()) {
+    return;
+  }
+
+  write_freeze_lock_.UnlockWrite();
+  is_write_frozen_.store(false);
+}
+
 butil::Status VectorIndexWrapper::Add(const std::vector<pb::common::VectorWithId>& vector_with_ids) {
+  return Add(vector_with_ids, 0);
+}
+
+butil::Status VectorIndexWrapper::Add(const std::vector<pb::common::VectorWithId>& vector_with_ids, int64_t log_id) {
+  RWLockReadGuard guard(&write_freeze_lock_);
+
+  auto status = DoAdd(vector_with_ids);
+  if (status.ok() && log_id > 0) {
+    SetApplyLogId(log_id);
+  }
+  return status;
+}
+
+butil::Status VectorIndexWrapper::Upsert(const std::vector<pb::common::VectorWithId>& vector_with_ids) {
+  return Upsert(vector_with_ids, 0);
+}
+
+butil::Status VectorIndexWrapper::Upsert(const std::vector<pb::common::VectorWithId>& vector_with_ids,
+                                         int64_t log_id) {
+  RWLockReadGuard guard(&write_freeze_lock_);
+
+  auto status = DoUpsert(vector_with_ids);
+  if (status.ok() && log_id > 0) {
+    SetApplyLogId(log_id);
+  }
+  return status;
+}
+
+butil::Status VectorIndexWrapper::Delete(const std::vector<int64_t>& delete_ids) { return Delete(delete_ids, 0); }
+
+butil::Status VectorIndexWrapper::Delete(const std::vector<int64_t>& delete_ids, int64_t log_id) {
+  RWLockReadGuard guard(&write_freeze_lock_);
+
+  auto status = DoDelete(delete_ids);
+  if (status.ok() && log_id > 0) {
+    SetApplyLogId(log_id);
+  }
+  return status;
+}
+
+butil::Status VectorIndexWrapper::DoAdd(const std::vector<pb::common::VectorWithId>& vector_with_ids) {
   if (!IsReady()) {
     DINGO_LOG(WARNING) << fmt::format("[vector_index.wrapper][index_id({})] vector index is not ready.", Id());
     return butil::Status(pb::error::EVECTOR_INDEX_NOT_FOUND, "vector index %lu is not ready.", Id());
@@ -932,6 +1260,7 @@ butil::Status VectorIndexWrapper::Add(const std::vector<pb::common::VectorWithId
     }
 
     write_key_count_ += vector_with_ids.size();
+    MarkDirty();
 
     return status;
   }
@@ -939,11 +1268,12 @@ butil::Status VectorIndexWrapper::Add(const std::vector<pb::common::VectorWithId
   auto status = vector_index->AddByParallel(vector_with_ids);
   if (status.ok()) {
     write_key_count_ += vector_with_ids.size();
+    MarkDirty();
   }
   return status;
 }
 
-butil::Status VectorIndexWrapper::Upsert(const std::vector<pb::common::VectorWithId>& vector_with_ids) {
+butil::Status VectorIndexWrapper::DoUpsert(const std::vector<pb::common::VectorWithId>& vector_with_ids) {
   if (!IsReady()) {
     DINGO_LOG(WARNING) << fmt::format("[vector_index.wrapper][index_id({})] vector index is not ready.", Id());
     return butil::Status(pb::error::EVECTOR_INDEX_NOT_FOUND, "vector index %lu is not ready.", Id());
@@ -979,6 +1309,7 @@ butil::Status VectorIndexWrapper::Upsert(const std::vector<pb::common::VectorWit
     }
 
     write_key_count_ += vector_with_ids.size();
+    MarkDirty();
 
     return status;
   }
@@ -986,11 +1317,12 @@ butil::Status VectorIndexWrapper::Upsert(const std::vector<pb::common::VectorWit
   auto status = vector_index->UpsertByParallel(vector_with_ids);
   if (status.ok()) {
     write_key_count_ += vector_with_ids.size();
+    MarkDirty();
   }
   return status;
 }
 
-butil::Status VectorIndexWrapper::Delete(const std::vector<int64_t>& delete_ids) {
+butil::Status VectorIndexWrapper::DoDelete(const std::vector<int64_t>& delete_ids) {
   if (!IsReady()) {
     DINGO_LOG(WARNING) << fmt::format("[vector_index.wrapper][index_id({})] vector index is not ready.", Id());
     return butil::Status(pb::error::EVECTOR_INDEX_NOT_FOUND, "vector index %lu is not ready.", Id());
@@ -1022,6 +1354,7 @@ butil::Status VectorIndexWrapper::Delete(const std::vector<int64_t>& delete_ids)
     status = vector_index->DeleteByParallel(FilterVectorId(delete_ids, vector_index->Range()), true);
     if (status.ok()) {
       write_key_count_ += delete_ids.size();
+      MarkDirty();
     }
     return status;
   }
@@ -1029,6 +1362,7 @@ butil::Status VectorIndexWrapper::Delete(const std::vector<int64_t>& delete_ids)
   auto status = vector_index->DeleteByParallel(delete_ids, true);
   if (status.ok()) {
     write_key_count_ += delete_ids.size();
+    MarkDirty();
   }
   return status;
 }
@@ -1087,6 +1421,24 @@ static void MergeSearchResults(uint32_t topk, std::vector<pb::index::VectorWithD
   }
 }
 
+// Replace the filter chain with one fused filter, keep the origin chain when can't fuse.
+static std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> FuseFilters(
+    const std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters) {
+  if (!FLAGS_vector_index_enable_fuse_filter || filters.empty()) {
+    return filters;
+  }
+  if (filters.size() == 1 && dynamic_cast<VectorIndex::SortFilterFunctor*>(filters[0].get()) == nullptr) {
+    return filters;
+  }
+
+  auto fused_filter = VectorIndex::FusedFilterFunctor::Compile(filters);
+  if (fused_filter == nullptr) {
+    return filters;
+  }
+
+  return {fused_filter};
+}
+
 butil::Status VectorIndexWrapper::Search(std::vector<pb::common::VectorWithId> vector_with_ids, uint32_t topk,
                                          const pb::common::Range& region_range,
                                          std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters,
@@ -1106,14 +1458,15 @@ butil::Status VectorIndexWrapper::Search(std::vector<pb::common::VectorWithId> v
   auto sibling_vector_index = SiblingVectorIndex();
   if (sibling_vector_index != nullptr) {
     std::vector<pb::index::VectorWithDistanceResult> results_1;
+    auto fused_filters = FuseFilters(filters);
     auto status =
-        sibling_vector_index->SearchByParallel(vector_with_ids, topk, filters, reconstruct, parameter, results_1);
+        sibling_vector_index->SearchByParallel(vector_with_ids, topk, fused_filters, reconstruct, parameter, results_1);
     if (!status.ok()) {
       return status;
     }
 
     std::vector<pb::index::VectorWithDistanceResult> results_2;
-    status = vector_index->SearchByParallel(vector_with_ids, topk, filters, reconstruct, parameter, results_2);
+    status = vector_index->SearchByParallel(vector_with_ids, topk, fused_filters, reconstruct, parameter, results_2);
     if (!status.ok()) {
       return status;
     }
@@ -1134,7 +1487,7 @@ butil::Status VectorIndexWrapper::Search(std::vector<pb::common::VectorWithId> v
     }
   }
 
-  return vector_index->SearchByParallel(vector_with_ids, topk, filters, reconstruct, parameter, results);
+  return vector_index->SearchByParallel(vector_with_ids, topk, FuseFilters(filters), reconstruct, parameter, results);
 }
 
 static void MergeRangeSearchResults(std::vector<pb::index::VectorWithDistanceResult>& input_1,
@@ -1167,14 +1520,16 @@ butil::Status VectorIndexWrapper::RangeSearch(std::vector<pb::common::VectorWith
   auto sibling_vector_index = SiblingVectorIndex();
   if (sibling_vector_index != nullptr) {
     std::vector<pb::index::VectorWithDistanceResult> results_1;
-    auto status = sibling_vector_index->RangeSearchByParallel(vector_with_ids, radius, filters, reconstruct, parameter,
-                                                              results_1);
+    auto fused_filters = FuseFilters(filters);
+    auto status = sibling_vector_index->RangeSearchByParallel(vector_with_ids, radius, fused_filters, reconstruct,
+                                                              parameter, results_1);
     if (!status.ok()) {
       return status;
     }
 
     std::vector<pb::index::VectorWithDistanceResult> results_2;
-    status = vector_index->RangeSearchByParallel(vector_with_ids, radius, filters, reconstruct, parameter, results_2);
+    status =
+        vector_index->RangeSearchByParallel(vector_with_ids, radius, fused_filters, reconstruct, parameter, results_2);
     if (!status.ok()) {
       return status;
     }
@@ -1195,7 +1550,64 @@ butil::Status VectorIndexWrapper::RangeSearch(std::vector<pb::common::VectorWith
     }
   }
 
-  return vector_index->RangeSearchByParallel(vector_with_ids, radius, filters, reconstruct, parameter, results);
+  return vector_index->RangeSearchByParallel(vector_with_ids, radius, FuseFilters(filters), reconstruct, parameter,
+                                             results);
+}
+
+butil::Status VectorIndexWrapper::RangeSearchHits(const std::vector<pb::common::VectorWithId>& vector_with_ids,
+                                                  float radius, const pb::common::Range& region_range,
+                                                  std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> filters,
+                                                  const pb::common::VectorSearchParameter& parameter,
+                                                  std::vector<std::vector<VectorIndex::RangeSearchHit>>& hits) {
+  if (!IsReady()) {
+    DINGO_LOG(WARNING) << fmt::format("[vector_index.wrapper][index_id({})] vector index is not ready.", Id());
+    return butil::Status(pb::error::EVECTOR_INDEX_NOT_FOUND, "vector index %lu is not ready.", Id());
+  }
+  auto vector_index = GetVectorIndex();
+  if (vector_index == nullptr) {
+    DINGO_LOG(WARNING) << fmt::format("[vector_index.wrapper][index_id({})] vector index is not ready.", Id());
+    return butil::Status(pb::error::EVECTOR_INDEX_NOT_FOUND, "vector index %lu is not ready.", Id());
+  }
+
+  // Exist sibling vector index, so need to separate search vector.
+  auto sibling_vector_index = SiblingVectorIndex();
+  if (sibling_vector_index != nullptr) {
+    auto fused_filters = FuseFilters(filters);
+    auto status = sibling_vector_index->RangeSearchHits(vector_with_ids, radius, fused_filters, parameter, hits);
+    if (!status.ok()) {
+      return status;
+    }
+
+    std::vector<std::vector<VectorIndex::RangeSearchHit>> hits_2;
+    status = vector_index->RangeSearchHits(vector_with_ids, radius, fused_filters, parameter, hits_2);
+    if (!status.ok()) {
+      return status;
+    }
+
+    // Merge the hits of two index by distance.
+    for (size_t i = 0; i < hits.size() && i < hits_2.size(); ++i) {
+      std::sort(hits[i].begin(), hits[i].end());
+      std::sort(hits_2[i].begin(), hits_2[i].end());
+      size_t middle = hits[i].size();
+      hits[i].insert(hits[i].end(), hits_2[i].begin(), hits_2[i].end());
+      std::inplace_merge(hits[i].begin(), hits[i].begin() + middle, hits[i].end());
+    }
+    return status;
+  }
+
+  const auto& index_range = vector_index->Range();
+  if (region_range.start_key() != index_range.start_key() || region_range.end_key() != index_range.end_key()) {
+    int64_t min_vector_id = 0, max_vector_id = 0;
+    VectorCodec::DecodeRangeToVectorId(region_range, min_vector_id, max_vector_id);
+    auto ret = VectorIndexWrapper::SetVectorIndexRangeFilter(vector_index, filters, min_vector_id, max_vector_id);
+    if (!ret.ok()) {
+      DINGO_LOG(ERROR) << fmt::format("[vector_index.wrapper][index_id({})] set vector index filter failed, error: {}",
+                                      Id(), ret.error_str());
+      return ret;
+    }
+  }
+
+  return vector_index->RangeSearchHits(vector_with_ids, radius, FuseFilters(filters), parameter, hits);
 }
 
 bool VectorIndexWrapper::IsPermanentHoldVectorIndex(store::RegionPtr region) {
@@ -15,6 +15,7 @@
 #ifndef DINGODB_VECTOR_INDEX_H_
 #define DINGODB_VECTOR_INDEX_H_
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
@@ -26,8 +27,10 @@
 #include "bthread/types.h"
 #include "butil/compiler_specific.h"
 #include "butil/status.h"
+#include "common/dirty_set.h"
 #include "common/helper.h"
 #include "common/runnable.h"
+#include "common/synchronization.h"
 #include "common/threadpool.h"
 #include "faiss/MetricType.h"
 #include "faiss/impl/IDSelector.h"
@@ -43,6 +46,8 @@ class Region;
 using RegionPtr = std::shared_ptr<Region>;
 }  // namespace store
 
+class VectorIndexSaveBuffer;
+
 // Vector index abstract base class.
 // One region own one vector index(region_id==vector_index_id)
 // But one region can refer other vector index when region split.
@@ -71,6 +76,9 @@ class VectorIndex {
         : min_vector_id_(min_vector_id), max_vector_id_(max_vector_id) {}
     bool Check(int64_t vector_id) override { return vector_id >= min_vector_id_ && vector_id < max_vector_id_; }
 
+    int64_t MinVectorId() const { return min_vector_id_; }
+    int64_t MaxVectorId() const { return max_vector_id_; }
+
    private:
     int64_t min_vector_id_;
     int64_t max_vector_id_;
@@ -116,6 +124,9 @@ class VectorIndex {
       return !is_negation_ ? exist : !exist;
     }
 
+    bool IsNegation() const { return is_negation_; }
+    const std::vector<int64_t>& VectorIds() const { return vector_ids_; }
+
    private:
     bool IsExist(int64_t vector_id) const {
       int64_t begin = 0, end = vector_ids_.size() - 1;
@@ -138,6 +149,64 @@ class VectorIndex {
     std::vector<int64_t> vector_ids_;
   };
 
+  // Fuse the range filters and sorted id filter into one check, so index make one virtual call per candidate.
+  // The ids are kept as bitmap when they are dense in range, else as sorted list.
+  class FusedFilterFunctor : public FilterFunctor {
+   public:
+    FusedFilterFunctor(const FusedFilterFunctor&) = delete;
+    FusedFilterFunctor(FusedFilterFunctor&&) = delete;
+    FusedFilterFunctor& operator=(const FusedFilterFunctor&) = delete;
+    FusedFilterFunctor& operator=(FusedFilterFunctor&&) = delete;
+
+    // vector_ids must be sorted, has_ids is false means only range filter.
+    FusedFilterFunctor(int64_t min_vector_id, int64_t max_vector_id, bool has_ids, const std::vector<int64_t>& vector_ids,
+                       bool is_negation);
+    ~FusedFilterFunctor() override = default;
+
+    // Compile the filter chain, return nullptr when exist filter can't be fused.
+    static std::shared_ptr<FusedFilterFunctor> Compile(const std::vector<std::shared_ptr<FilterFunctor>>& filters);
+
+    bool Check(int64_t vector_id) override {
+      if (vector_id < min_vector_id_ || vector_id >= max_vector_id_) {
+        return false;
+      }
+      if (!has_ids_) {
+        return true;
+      }
+
+      bool exist = false;
+      if (!bitmap_.empty()) {
+        uint64_t offset = static_cast<uint64_t>(vector_id - bitmap_base_);
+        exist = offset < bitmap_bits_ && ((bitmap_[offset >> 6] >> (offset & 63)) & 1) != 0;
+      } else {
+        exist = std::binary_search(vector_ids_.begin(), vector_ids_.end(), vector_id);
+      }
+      return exist != is_negation_;
+    }
+
+    bool HasIds() const { return has_ids_; }
+    bool IsNegation() const { return is_negation_; }
+    // Count of ids in range, for negation it is the excluded count.
+    int64_t IdCount() const { return id_count_; }
+    // Only valid when not negation and not use bitmap.
+    const std::vector<int64_t>& VectorIds() const { return vector_ids_; }
+    // Output the allowed ids, only valid when has ids and not negation.
+    void GetAllowedIds(std::vector<int64_t>& vector_ids) const;
+
+   private:
+    int64_t min_vector_id_;
+    int64_t max_vector_id_;
+    bool has_ids_{false};
+    bool is_negation_{false};
+    int64_t id_count_{0};
+
+    std::vector<int64_t> vector_ids_;
+
+    int64_t bitmap_base_{0};
+    uint64_t bitmap_bits_{0};
+    std::vector<uint64_t> bitmap_;
+  };
+
   virtual int32_t GetDimension() = 0;
   virtual pb::common::MetricType GetMetricType() = 0;
   virtual butil::Status GetCount(int64_t& count);
@@ -159,6 +228,8 @@ class VectorIndex {
   virtual butil::Status DeleteByParallel(const std::vector<int64_t>& delete_ids, bool is_priority);
 
   virtual butil::Status Save(const std::string& path);
+  // Save the files of path to memory, the caller write them to disk later, need write is frozen.
+  virtual butil::Status SaveToBuffer(const std::string& path, VectorIndexSaveBuffer& save_buffer);
 
   virtual butil::Status Load(const std::string& path);
 
@@ -182,12 +253,35 @@ class VectorIndex {
                                       bool reconstruct, const pb::common::VectorSearchParameter& parameter,
                                       std::vector<pb::index::VectorWithDistanceResult>& results);
 
+  // Compact range search hit, only id and distance, used by range search cursor.
+  struct RangeSearchHit {
+    int64_t id;
+    float distance;
+
+    // Order by distance, then by id, so the hits are in a total order for paging.
+    bool operator<(const RangeSearchHit& other) const {
+      return distance < other.distance || (distance == other.distance && id < other.id);
+    }
+  };
+
+  // Range search and output compact hits without count limit.
+  // The default implement convert from RangeSearch result, index which can do better should override it.
+  virtual butil::Status RangeSearchHits(const std::vector<pb::common::VectorWithId>& vector_with_ids, float radius,
+                                        const std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters,
+                                        const pb::common::VectorSearchParameter& parameter,
+                                        std::vector<std::vector<RangeSearchHit>>& hits);
+
   virtual void LockWrite() = 0;
   virtual void UnlockWrite() = 0;
   virtual butil::Status Train(std::vector<float>& train_datas) = 0;
   virtual butil::Status TrainByParallel(std::vector<float>& train_datas);
   virtual butil::Status Train(const std::vector<pb::common::VectorWithId>& vectors) = 0;
   virtual bool NeedToRebuild() = 0;
+  // Online maintain the index structure in background, cheaper than rebuild, e.g. rebalance ivf lists.
+  virtual bool NeedToRebalance() { return false; }
+  virtual butil::Status Rebalance() { return butil::Status::OK(); }
+  // Optimize memory layout and warm up cache after load or build, before the index is published.
+  virtual void WarmUp() {}
   virtual bool NeedTrain() { return false; }
   virtual bool IsTrained() { return true; }
   virtual bool NeedToSave(int64_t last_save_log_behind) = 0;
@@ -195,6 +289,17 @@ class VectorIndex {
 
   virtual uint32_t WriteOpParallelNum() { return 1; }
 
+  // Adaptive search, calibrate search parameter(e.g. hnsw ef/ivf nprobe) against the recall target.
+  // The sample vectors are used as query(excluding itself), and the result of the max candidate is regarded as
+  // ground truth.
+  virtual butil::Status CalibrateSearchParameter(const std::vector<pb::common::VectorWithId>& samples,
+                                                 float recall_target);
+  // Calibrated search parameter scaled by topk, 0 means not calibrated.
+  int32_t AdaptiveSearchParameter(uint32_t topk) const;
+  // Raw calibrated search parameter, persisted with snapshot.
+  virtual int32_t CalibratedSearchParameter() { return adaptive_search_parameter.load(std::memory_order_relaxed); }
+  virtual void SetCalibratedSearchParameter(int32_t value) { adaptive_search_parameter.store(value); }
+
   int64_t Id() const { return id; }
 
   pb::common::VectorIndexType VectorIndexType() { return vector_index_type; }
@@ -223,6 +328,10 @@ class VectorIndex {
   static void SetSimdHookForHnswlib();
 
  protected:
+  // Candidates of adaptive search parameter in ascending order, empty means not support adaptive search.
+  virtual std::vector<int32_t> AdaptiveSearchCandidates() { return {}; }
+  virtual void FillAdaptiveSearchParameter(int32_t /*value*/, pb::common::VectorSearchParameter& /*parameter*/) {}
+
   // vector index id
   int64_t id;
   // vector index type, e.g. hnsw/flat
@@ -240,6 +349,9 @@ class VectorIndex {
 
   // vector index thread pool
   ThreadPoolPtr thread_pool;
+
+  // calibrated search parameter for adaptive search
+  std::atomic<int32_t> adaptive_search_parameter{0};
 };
 
 using VectorIndexPtr = std::shared_ptr<VectorIndex>;
@@ -374,12 +486,31 @@ class VectorIndexWrapper : public std::enable_shared_from_this<VectorIndexWrappe
   bool IsExceedsMaxElements();
 
   bool NeedToRebuild();
+  bool NeedToRebalance();
+  butil::Status Rebalance();
   bool NeedToSave(std::string& reason);
   bool SupportSave();
 
+  // Mark dirty when write or apply log id advance, scrub only check the dirty vector index.
+  void MarkDirty();
+  void ClearDirty() { dirty_flag_.Clear(); }
+  bool IsDirty() const { return dirty_flag_.IsDirty(); }
+  // Take all dirty vector index id.
+  static std::vector<int64_t> TakeDirtyIds();
+
+  // Freeze write for online save snapshot, the write after freeze wait until unfreeze, search is not blocked.
+  // Return the apply log id at the freeze point, or -1 if already frozen.
+  int64_t FreezeWrite();
+  void UnfreezeWrite();
+  bool IsWriteFrozen() { return is_write_frozen_.load(); }
+
   butil::Status Add(const std::vector<pb::common::VectorWithId>& vector_with_ids);
   butil::Status Upsert(const std::vector<pb::common::VectorWithId>& vector_with_ids);
   butil::Status Delete(const std::vector<int64_t>& delete_ids);
+  // Write and set apply log id to log_id if success, log_id 0 means not set.
+  butil::Status Add(const std::vector<pb::common::VectorWithId>& vector_with_ids, int64_t log_id);
+  butil::Status Upsert(const std::vector<pb::common::VectorWithId>& vector_with_ids, int64_t log_id);
+  butil::Status Delete(const std::vector<int64_t>& delete_ids, int64_t log_id);
   butil::Status Search(std::vector<pb::common::VectorWithId> vector_with_ids, uint32_t topk,
                        const pb::common::Range& region_range,
                        std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters, bool reconstruct,
@@ -391,6 +522,11 @@ class VectorIndexWrapper : public std::enable_shared_from_this<VectorIndexWrappe
                             std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> filters, bool reconstruct,
                             const pb::common::VectorSearchParameter& parameter,
                             std::vector<pb::index::VectorWithDistanceResult>& results);
+  butil::Status RangeSearchHits(const std::vector<pb::common::VectorWithId>& vector_with_ids, float radius,
+                                const pb::common::Range& region_range,
+                                std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> filters,
+                                const pb::common::VectorSearchParameter& parameter,
+                                std::vector<std::vector<VectorIndex::RangeSearchHit>>& hits);
 
   static butil::Status SetVectorIndexRangeFilter(
       VectorIndexPtr vector_index,
@@ -398,6 +534,10 @@ class VectorIndexWrapper : public std::enable_shared_from_this<VectorIndexWrappe
       int64_t min_vector_id, int64_t max_vector_id);
 
  private:
+  butil::Status DoAdd(const std::vector<pb::common::VectorWithId>& vector_with_ids);
+  butil::Status DoUpsert(const std::vector<pb::common::VectorWithId>& vector_with_ids);
+  butil::Status DoDelete(const std::vector<int64_t>& delete_ids);
+
   // vector index id
   int64_t id_;
   // vector index version
@@ -455,6 +595,13 @@ class VectorIndexWrapper : public std::enable_shared_from_this<VectorIndexWrappe
 
   // need hold vector index
   std::atomic<bool> is_hold_vector_index_;
+
+  // Write hold read lock, online save hold write lock from freeze to unfreeze.
+  RWLock write_freeze_lock_;
+  std::atomic<bool> is_write_frozen_{false};
+
+  // Dirty for scrub
+  DirtyFlag dirty_flag_;
 };
 
 using VectorIndexWrapperPtr = std::shared_ptr<VectorIndexWrapper>;
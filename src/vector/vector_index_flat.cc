@@ -115,8 +115,7 @@ butil::Status VectorIndexFlat::AddOrUpsert(const std::vector<pb::common::VectorW
     std::vector<faiss::idx_t> internal_ids = GetExistVectorIds(ids, vector_with_ids.size());
 
     if (!internal_ids.empty()) {
-      faiss::IDSelectorBatch sel(internal_ids.size(), internal_ids.data());
-      index_id_map2_->remove_ids(sel);
+      VectorIndexUtils::RemoveIdMapVectorIds(index_id_map2_.get(), internal_ids.data(), internal_ids.size());
     }
   }
   index_id_map2_->add_with_ids(vector_with_ids.size(), vector_values.get(), ids.get());
@@ -148,8 +147,8 @@ butil::Status VectorIndexFlat::Delete(const std::vector<int64_t>& delete_ids) {
       std::vector<faiss::idx_t> internal_ids = GetExistVectorIds(delete_ids, delete_ids.size());
 
       if (!internal_ids.empty()) {
-        faiss::IDSelectorBatch sel(internal_ids.size(), internal_ids.data());
-        auto remove_count = index_id_map2_->remove_ids(sel);
+        auto remove_count =
+            VectorIndexUtils::RemoveIdMapVectorIds(index_id_map2_.get(), internal_ids.data(), internal_ids.size());
         if (0 == remove_count) {
           DINGO_LOG(WARNING) << fmt::format("[vector_index.flat][id({})] remove not found vector id.", Id());
           return butil::Status(pb::error::Errno::EVECTOR_INVALID, "remove not found vector id");
@@ -206,8 +205,42 @@ butil::Status VectorIndexFlat::Search(const std::vector<pb::common::VectorWithId
 
 butil::Status VectorIndexFlat::RangeSearch(const std::vector<pb::common::VectorWithId>& vector_with_ids, float radius,
                                            const std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters,
-                                           bool /*reconstruct*/, const pb::common::VectorSearchParameter& /*parameter*/,
+                                           bool /*reconstruct*/, const pb::common::VectorSearchParameter& parameter,
                                            std::vector<pb::index::VectorWithDistanceResult>& results) {
+  std::unique_ptr<faiss::RangeSearchResult> range_search_result;
+  auto status = DoRangeSearch(vector_with_ids, radius, filters, parameter, range_search_result);
+  if (!status.ok()) {
+    return status;
+  }
+
+  VectorIndexUtils::FillRangeSearchResult(range_search_result, metric_type_, dimension_, results);
+
+  DINGO_LOG(DEBUG) << fmt::format("[vector_index.flat][id({})] result size {}", Id(), results.size());
+
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexFlat::RangeSearchHits(const std::vector<pb::common::VectorWithId>& vector_with_ids,
+                                               float radius,
+                                               const std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters,
+                                               const pb::common::VectorSearchParameter& parameter,
+                                               std::vector<std::vector<RangeSearchHit>>& hits) {
+  std::unique_ptr<faiss::RangeSearchResult> range_search_result;
+  auto status = DoRangeSearch(vector_with_ids, radius, filters, parameter, range_search_result);
+  if (!status.ok()) {
+    return status;
+  }
+
+  VectorIndexUtils::FillRangeSearchHits(range_search_result, metric_type_, hits);
+
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexFlat::DoRangeSearch(const std::vector<pb::common::VectorWithId>& vector_with_ids,
+                                             float radius,
+                                             const std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters,
+                                             const pb::common::VectorSearchParameter& /*parameter*/,
+                                             std::unique_ptr<faiss::RangeSearchResult>& range_search_result) {
   if (vector_with_ids.empty()) {
     return butil::Status(pb::error::EILLEGAL_PARAMTETERS, "vector_with_ids is empty");
   }
@@ -218,37 +251,30 @@ butil::Status VectorIndexFlat::RangeSearch(const std::vector<pb::common::VectorW
 
   const auto& vector_values = VectorIndexUtils::ExtractVectorValue(vector_with_ids, dimension_, normalize_);
 
-  std::unique_ptr<faiss::RangeSearchResult> range_search_result =
-      std::make_unique<faiss::RangeSearchResult>(vector_with_ids.size());
+  range_search_result = std::make_unique<faiss::RangeSearchResult>(vector_with_ids.size());
 
   if (metric_type_ == pb::common::MetricType::METRIC_TYPE_COSINE ||
       metric_type_ == pb::common::MetricType::METRIC_TYPE_INNER_PRODUCT) {
     radius = 1.0F - radius;
   }
 
-  {
-    BvarLatencyGuard bvar_guard(&g_flat_range_search_latency);
-    RWLockReadGuard guard(&rw_lock_);
+  BvarLatencyGuard bvar_guard(&g_flat_range_search_latency);
+  RWLockReadGuard guard(&rw_lock_);
 
-    try {
-      std::unique_ptr<faiss::SearchParameters> params;
-      std::unique_ptr<FlatIDSelector> flat_filter;
-      if (!filters.empty()) {
-        params = std::make_unique<faiss::SearchParameters>();
-        flat_filter = std::make_unique<FlatIDSelector>(filters);
-        params->sel = flat_filter.get();
-      }
-      index_id_map2_->range_search(vector_with_ids.size(), vector_values.get(), radius, range_search_result.get(),
-                                   params.get());
-    } catch (std::exception& e) {
-      return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("range search exception, {}", e.what()));
+  try {
+    std::unique_ptr<faiss::SearchParameters> params;
+    std::unique_ptr<FlatIDSelector> flat_filter;
+    if (!filters.empty()) {
+      params = std::make_unique<faiss::SearchParameters>();
+      flat_filter = std::make_unique<FlatIDSelector>(filters);
+      params->sel = flat_filter.get();
     }
+    index_id_map2_->range_search(vector_with_ids.size(), vector_values.get(), radius, range_search_result.get(),
+                                 params.get());
+  } catch (std::exception& e) {
+    return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("range search exception, {}", e.what()));
   }
 
-  VectorIndexUtils::FillRangeSearchResult(range_search_result, metric_type_, dimension_, results);
-
-  DINGO_LOG(DEBUG) << fmt::format("[vector_index.flat][id({})] result size {}", Id(), results.size());
-
   return butil::Status::OK();
 }
 
@@ -270,7 +296,21 @@ butil::Status VectorIndexFlat::Save(const std::string& path) {
 
   // The outside has been locked. Remove the locking operation here.
   try {
-    faiss::write_index(index_id_map2_.get(), path.c_str());
+    VectorIndexUtils::WriteIndex(index_id_map2_.get(), path);
+  } catch (std::exception& e) {
+    return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("write index exception: {}", e.what()));
+  }
+
+  return butil::Status();
+}
+
+butil::Status VectorIndexFlat::SaveToBuffer(const std::string& path, VectorIndexSaveBuffer& save_buffer) {
+  if (path.empty()) {
+    return butil::Status(pb::error::EILLEGAL_PARAMTETERS, "path is empty");
+  }
+
+  try {
+    VectorIndexUtils::WriteIndex(index_id_map2_.get(), path, save_buffer);
   } catch (std::exception& e) {
     return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("write index exception: {}", e.what()));
   }
@@ -68,6 +68,7 @@ class VectorIndexFlat : public VectorIndex {
   VectorIndexFlat& operator=(VectorIndexFlat&& rhs) = delete;
 
   butil::Status Save(const std::string& path) override;
+  butil::Status SaveToBuffer(const std::string& path, VectorIndexSaveBuffer& save_buffer) override;
   butil::Status Load(const std::string& path) override;
 
   // in FLAT index, add two vector with same id will cause data conflict
@@ -92,6 +93,11 @@ class VectorIndexFlat : public VectorIndex {
                             const pb::common::VectorSearchParameter& parameter,
                             std::vector<pb::index::VectorWithDistanceResult>& results) override;
 
+  butil::Status RangeSearchHits(const std::vector<pb::common::VectorWithId>& vector_with_ids, float radius,
+                                const std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters,
+                                const pb::common::VectorSearchParameter& parameter,
+                                std::vector<std::vector<RangeSearchHit>>& hits) override;
+
   void LockWrite() override;
   void UnlockWrite() override;
   bool SupportSave() override;
@@ -115,6 +121,11 @@ class VectorIndexFlat : public VectorIndex {
   template <typename T>
   std::vector<faiss::idx_t> GetExistVectorIds(const T& ids, size_t size);
 
+  butil::Status DoRangeSearch(const std::vector<pb::common::VectorWithId>& vector_with_ids, float radius,
+                              const std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters,
+                              const pb::common::VectorSearchParameter& parameter,
+                              std::unique_ptr<faiss::RangeSearchResult>& range_search_result);
+
   // Dimension of the elements
   faiss::idx_t dimension_;
 
@@ -15,17 +15,26 @@
 #include "vector/vector_index_hnsw.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <queue>
 #include <stdexcept>
 #include <string>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "butil/status.h"
 #include "bvar/latency_recorder.h"
+#include "bvar/reducer.h"
 #include "common/constant.h"
 #include "common/helper.h"
 #include "common/logging.h"
@@ -51,6 +60,17 @@ DEFINE_uint32(hnsw_max_elements_amplification_multiple, 1, "hnsw max elements am
 DECLARE_int64(vector_max_batch_count);
 
 DEFINE_uint32(hnsw_vector_write_batch_size_per_task, 16, "hnsw vector write batch size per task");
+DEFINE_uint32(hnsw_range_search_seed_count, 64, "hnsw range search seed count, the base layer is expanded from seeds");
+DEFINE_bool(hnsw_enable_reuse_deleted_slot, true, "hnsw new vector reuse the slot of deleted vector");
+DEFINE_bool(hnsw_enable_repair_deleted_neighbor, true, "hnsw re-link the neighbors of deleted vector");
+DEFINE_uint32(hnsw_parallel_search_max_batch_size, 4,
+              "hnsw search one query by parallel beam when batch size not exceed it, 0 means disable");
+DEFINE_int64(hnsw_parallel_search_min_count, 100000, "hnsw search by parallel beam when vector count exceed it");
+DEFINE_uint32(hnsw_parallel_search_beam_width, 16, "hnsw parallel beam search expand candidate count per round");
+DEFINE_uint32(hnsw_parallel_search_expand_per_task, 4, "hnsw parallel beam search expand candidate count per task");
+DEFINE_bool(hnsw_enable_reorder, false, "hnsw reorder element by graph order after load or build");
+DEFINE_bool(hnsw_enable_warmup, true, "hnsw warm up memory after load or build");
+DEFINE_int64(hnsw_warmup_max_element_count, 100000, "hnsw max element count of base layer to warm up");
 DECLARE_uint32(vector_read_batch_size_per_task);
 DECLARE_uint32(parallel_log_threshold_time_ms);
 
@@ -59,6 +79,7 @@ bvar::LatencyRecorder g_hnsw_search_latency("dingo_hnsw_search_latency");
 bvar::LatencyRecorder g_hnsw_range_search_latency("dingo_hnsw_range_search_latency");
 bvar::LatencyRecorder g_hnsw_delete_latency("dingo_hnsw_delete_latency");
 bvar::LatencyRecorder g_hnsw_load_latency("dingo_hnsw_load_latency");
+bvar::Adder<uint64_t> g_hnsw_parallel_search_count("dingo_hnsw_parallel_search_count");
 
 // Filter vecotr id used by region range.
 class HnswRangeFilterFunctor : public hnswlib::BaseFilterFunctor {
@@ -173,7 +194,7 @@ VectorIndexHnsw::VectorIndexHnsw(int64_t id, const pb::common::VectorIndexParame
 
     hnsw_index_ =
         new hnswlib::HierarchicalNSW<float>(hnsw_space_, FLAGS_hnsw_max_init_max_elements, hnsw_parameter.nlinks(),
-                                            hnsw_parameter.efconstruction(), 100, false);
+                                            hnsw_parameter.efconstruction(), 100, FLAGS_hnsw_enable_reuse_deleted_slot);
   }
 }
 
@@ -182,6 +203,126 @@ VectorIndexHnsw::~VectorIndexHnsw() {
   delete hnsw_space_;
 }
 
+// hnswlib keep the element data and base layer links in one continuous memory, so it can't be grown by chunk.
+// resizeIndex realloc and copy the whole memory under write lock, so double the capacity to amortize the stall.
+void VectorIndexHnsw::ExpandIfNeeded(int64_t batch_count) {
+  if (hnsw_index_->cur_element_count + batch_count * 2 <= hnsw_index_->max_elements_) {
+    return;
+  }
+
+  auto new_max_elements = std::max(hnsw_index_->max_elements_ * 2, hnsw_index_->cur_element_count + batch_count * 2);
+  DINGO_LOG(INFO) << fmt::format("[vector_index.hnsw][id({})] expand max element, {} -> {}.", Id(),
+                                 hnsw_index_->max_elements_, new_max_elements);
+
+  hnsw_index_->resizeIndex(new_max_elements);
+}
+
+void VectorIndexHnsw::RouteUpsert(const std::vector<pb::common::VectorWithId>& vector_with_ids,
+                                  std::vector<uint8_t>& replace_deleteds) {
+  replace_deleteds.assign(vector_with_ids.size(), 0);
+  if (!hnsw_index_->allow_replace_deleted_ || hnsw_index_->getDeletedCount() <= 0) {
+    return;
+  }
+
+  std::unordered_set<int64_t> seen_ids;
+  std::unordered_set<int64_t> duplicated_ids;
+  for (const auto& vector_with_id : vector_with_ids) {
+    if (!seen_ids.insert(vector_with_id.id()).second) {
+      duplicated_ids.insert(vector_with_id.id());
+    }
+  }
+
+  std::unordered_set<int64_t> deleted_labels;
+  std::vector<size_t> new_rows;
+  {
+    std::unique_lock<std::mutex> lock(hnsw_index_->label_lookup_lock);
+    for (size_t row = 0; row < vector_with_ids.size(); ++row) {
+      auto it = hnsw_index_->label_lookup_.find(vector_with_ids[row].id());
+      if (it != hnsw_index_->label_lookup_.end()) {
+        if (hnsw_index_->isMarkedDeleted(it->second)) {
+          deleted_labels.insert(vector_with_ids[row].id());
+        }
+      } else if (duplicated_ids.find(vector_with_ids[row].id()) == duplicated_ids.end()) {
+        new_rows.push_back(row);
+      }
+    }
+  }
+
+  // hnswlib refuse to update a deleted label when replace deleted is enabled, so unmark it first,
+  // the label is updated in place and its slot is not reused.
+  for (int64_t label : deleted_labels) {
+    hnsw_index_->unmarkDelete(label);
+  }
+
+  // Replace deleted slot must only be used for the label not exist, otherwise the label is duplicated.
+  int64_t reuse_budget = hnsw_index_->getDeletedCount();
+  for (size_t row : new_rows) {
+    if (reuse_budget <= 0) {
+      break;
+    }
+
+    replace_deleteds[row] = 1;
+    --reuse_budget;
+  }
+}
+
+// Re-link the live in-neighbors of deleted vector by the hnsw heuristic, the candidates are their own neighbors
+// and the neighbors of deleted vector, so the graph keep connected and search not walk through the tombstone.
+// The links of deleted vector is kept, it is used when the slot is reused.
+// hnswlib has no reverse links, so only the in-neighbors which are also out-neighbors of deleted vector are
+// repaired. Most links of hnsw are bidirectional, the rest one-way in-links still pass through the tombstone,
+// which is traversed by search but not returned, so the graph keep connected without a full scan.
+void VectorIndexHnsw::RepairDeletedNeighbor(hnswlib::HierarchicalNSW<float>* hnsw_index, hnswlib::tableint deleted_id) {
+  using Candidates =
+      std::priority_queue<std::pair<float, hnswlib::tableint>, std::vector<std::pair<float, hnswlib::tableint>>,
+                          hnswlib::HierarchicalNSW<float>::CompareByFirst>;
+
+  int max_level = hnsw_index->element_levels_[deleted_id];
+  for (int level = 0; level <= max_level; ++level) {
+    std::vector<hnswlib::tableint> deleted_neighbors = hnsw_index->getConnectionsWithLock(deleted_id, level);
+    for (auto neighbor : deleted_neighbors) {
+      if (hnsw_index->isMarkedDeleted(neighbor)) {
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(hnsw_index->link_list_locks_[neighbor]);
+      auto* link_list = hnsw_index->get_linklist_at_level(neighbor, level);
+      auto* links = reinterpret_cast<hnswlib::tableint*>(link_list + 1);
+      size_t link_size = hnsw_index->getListCount(link_list);
+      if (std::find(links, links + link_size, deleted_id) == links + link_size) {
+        continue;
+      }
+
+      std::unordered_set<hnswlib::tableint> candidate_ids;
+      for (size_t i = 0; i < link_size; ++i) {
+        if (links[i] != deleted_id && !hnsw_index->isMarkedDeleted(links[i])) {
+          candidate_ids.insert(links[i]);
+        }
+      }
+      for (auto candidate_id : deleted_neighbors) {
+        if (candidate_id != neighbor && !hnsw_index->isMarkedDeleted(candidate_id)) {
+          candidate_ids.insert(candidate_id);
+        }
+      }
+
+      Candidates candidates;
+      const char* neighbor_data = hnsw_index->getDataByInternalId(neighbor);
+      for (auto candidate_id : candidate_ids) {
+        float distance = hnsw_index->fstdistfunc_(neighbor_data, hnsw_index->getDataByInternalId(candidate_id),
+                                               hnsw_index->dist_func_param_);
+        candidates.emplace(distance, candidate_id);
+      }
+      hnsw_index->getNeighborsByHeuristic2(candidates, level == 0 ? hnsw_index->maxM0_ : hnsw_index->maxM_);
+
+      hnsw_index->setListCount(link_list, candidates.size());
+      for (size_t i = 0; !candidates.empty(); ++i) {
+        links[i] = candidates.top().second;
+        candidates.pop();
+      }
+    }
+  }
+}
+
 butil::Status VectorIndexHnsw::Add(const std::vector<pb::common::VectorWithId>& vector_with_ids) {
   return Upsert(vector_with_ids, true);
 }
@@ -205,25 +346,23 @@ butil::Status VectorIndexHnsw::Upsert(const std::vector<pb::common::VectorWithId
   }
 
   BvarLatencyGuard bvar_guard(&g_hnsw_upsert_latency);
+
   RWLockWriteGuard guard(&rw_lock_);
 
   // Add data to index
   try {
     // check if we need to expand the max_elements
     auto batch_count = std::max(FLAGS_vector_max_batch_count, static_cast<int64_t>(vector_with_ids.size()));
-    if (hnsw_index_->cur_element_count + batch_count * 2 > hnsw_index_->max_elements_) {
-      auto new_max_elements = hnsw_index_->max_elements_ * 2;
-      DINGO_LOG(INFO) << fmt::format("[vector_index.hnsw][id({})] expand max element, {} -> {}.", Id(),
-                                     hnsw_index_->max_elements_, new_max_elements);
+    ExpandIfNeeded(batch_count);
 
-      hnsw_index_->resizeIndex(new_max_elements);
-    }
+    std::vector<uint8_t> replace_deleteds;
+    RouteUpsert(vector_with_ids, replace_deleteds);
 
     if (!normalize_) {
       ParallelFor(thread_pool, Id(), 0, vector_with_ids.size(), FLAGS_hnsw_vector_write_batch_size_per_task,
                   is_priority, [&](size_t row) {
-                    this->hnsw_index_->addPoint((void*)vector_with_ids[row].vector().float_values().data(),
-                                                vector_with_ids[row].id(), false);
+                    hnsw_index_->addPoint((void*)vector_with_ids[row].vector().float_values().data(),
+                                          vector_with_ids[row].id(), replace_deleteds[row] != 0);
                   });
     } else {
       ParallelFor(thread_pool, Id(), 0, vector_with_ids.size(), FLAGS_hnsw_vector_write_batch_size_per_task,
@@ -233,7 +372,8 @@ butil::Status VectorIndexHnsw::Upsert(const std::vector<pb::common::VectorWithId
                     VectorIndexUtils::NormalizeVectorForHnsw(
                         (float*)vector_with_ids[row].vector().float_values().data(), dimension_, norm_array.data());
 
-                    this->hnsw_index_->addPoint((void*)norm_array.data(), vector_with_ids[row].id(), false);
+                    hnsw_index_->addPoint((void*)norm_array.data(), vector_with_ids[row].id(),
+                                          replace_deleteds[row] != 0);
                   });
     }
     return butil::Status();
@@ -263,6 +403,26 @@ butil::Status VectorIndexHnsw::Delete(const std::vector<int64_t>& delete_ids, bo
   try {
     ParallelFor(thread_pool, Id(), 0, delete_ids.size(), FLAGS_hnsw_vector_write_batch_size_per_task, is_priority,
                 [&](size_t row) { hnsw_index_->markDelete(delete_ids[row]); });
+
+    // Repair after all marked, so the new links not point to the deleted vector of the same batch.
+    if (FLAGS_hnsw_enable_repair_deleted_neighbor) {
+      ParallelFor(thread_pool, Id(), 0, delete_ids.size(), FLAGS_hnsw_vector_write_batch_size_per_task, is_priority,
+                  [&](size_t row) {
+                    hnswlib::tableint internal_id = 0;
+                    {
+                      std::unique_lock<std::mutex> lock(hnsw_index_->label_lookup_lock);
+                      auto it = hnsw_index_->label_lookup_.find(delete_ids[row]);
+                      if (it == hnsw_index_->label_lookup_.end()) {
+                        return;
+                      }
+                      internal_id = it->second;
+                    }
+
+                    if (hnsw_index_->isMarkedDeleted(internal_id)) {
+                      RepairDeletedNeighbor(hnsw_index_, internal_id);
+                    }
+                  });
+    }
   } catch (std::runtime_error& e) {
     std::string s = fmt::format("delete vector failed, error: {}", e.what());
     DINGO_LOG(ERROR) << fmt::format("[vector_index.hnsw][id({})] {}", Id(), s);
@@ -272,8 +432,61 @@ butil::Status VectorIndexHnsw::Delete(const std::vector<int64_t>& delete_ids, bo
   return ret;
 }
 
+std::vector<int32_t> VectorIndexHnsw::AdaptiveSearchCandidates() {
+  std::vector<int32_t> candidates;
+  for (int32_t efsearch = 16; efsearch <= kMaxEfSearch; efsearch *= 2) {
+    candidates.push_back(efsearch);
+  }
+  return candidates;
+}
+
+void VectorIndexHnsw::FillAdaptiveSearchParameter(int32_t value, pb::common::VectorSearchParameter& parameter) {
+  parameter.mutable_hnsw()->set_efsearch(value);
+}
+
 bool VectorIndexHnsw::SupportSave() { return true; }
 
+// Write hnsw index in the same format as hnswlib saveIndex, piece by piece, so the write can be rate limited or
+// go to memory. Return the written size, which is checked with indexFileSize by the caller.
+static size_t WriteHnswIndex(hnswlib::HierarchicalNSW<float>* hnsw_index,
+                             const std::function<void(const char* data, size_t size)>& write) {
+  size_t written_size = 0;
+  auto write_data = [&](const char* data, size_t size) {
+    write(data, size);
+    written_size += size;
+  };
+  auto write_pod = [&](const auto& value) { write_data(reinterpret_cast<const char*>(&value), sizeof(value)); };
+
+  size_t cur_element_count = hnsw_index->cur_element_count;
+  write_pod(hnsw_index->offsetLevel0_);
+  write_pod(hnsw_index->max_elements_);
+  write_pod(cur_element_count);
+  write_pod(hnsw_index->size_data_per_element_);
+  write_pod(hnsw_index->label_offset_);
+  write_pod(hnsw_index->offsetData_);
+  write_pod(hnsw_index->maxlevel_);
+  write_pod(hnsw_index->enterpoint_node_);
+  write_pod(hnsw_index->maxM_);
+  write_pod(hnsw_index->maxM0_);
+  write_pod(hnsw_index->M_);
+  write_pod(hnsw_index->mult_);
+  write_pod(hnsw_index->ef_construction_);
+
+  write_data(hnsw_index->data_level0_memory_, cur_element_count * hnsw_index->size_data_per_element_);
+
+  for (size_t i = 0; i < cur_element_count; ++i) {
+    unsigned int link_list_size = hnsw_index->element_levels_[i] > 0
+                                      ? hnsw_index->size_links_per_element_ * hnsw_index->element_levels_[i]
+                                      : 0;
+    write_pod(link_list_size);
+    if (link_list_size > 0) {
+      write_data(hnsw_index->linkLists_[i], link_list_size);
+    }
+  }
+
+  return written_size;
+}
+
 butil::Status VectorIndexHnsw::Save(const std::string& path) {
   if (path.empty()) {
     return butil::Status(pb::error::EILLEGAL_PARAMTETERS, "path is empty");
@@ -281,34 +494,235 @@ butil::Status VectorIndexHnsw::Save(const std::string& path) {
 
   // Save need the caller to do LockWrite() and UnlockWrite()
   if (vector_index_type == pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW) {
-    hnsw_index_->saveIndex(path);
+    if (VectorIndexUtils::SaveRateLimit() <= 0) {
+      hnsw_index_->saveIndex(path);
+      return butil::Status::OK();
+    }
+
+    // hnswlib write file by itself, so write the same format here with rate limit on every piece.
+    RateLimitedFileWriter writer(path, VectorIndexUtils::SaveRateLimit());
+    if (!writer.IsOpen()) {
+      return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("open file failed, path: {}", path));
+    }
+
+    bool ok = true;
+    size_t written_size = WriteHnswIndex(hnsw_index_, [&](const char* data, size_t size) {
+      ok = ok && writer.Write(data, size);
+    });
+    if (!writer.Close() || !ok) {
+      return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("write file failed, path: {}", path));
+    }
+    if (written_size != hnsw_index_->indexFileSize()) {
+      return butil::Status(pb::error::Errno::EINTERNAL,
+                           fmt::format("write size({}) not match index file size({})", written_size,
+                                       hnsw_index_->indexFileSize()));
+    }
+
     return butil::Status::OK();
   } else {
     return butil::Status(pb::error::Errno::EINTERNAL, "vector index type is not supported");
   }
 }
 
+butil::Status VectorIndexHnsw::SaveToBuffer(const std::string& path, VectorIndexSaveBuffer& save_buffer) {
+  if (path.empty()) {
+    return butil::Status(pb::error::EILLEGAL_PARAMTETERS, "path is empty");
+  }
+
+  // Write is frozen, the read lock only exclude the write not go through the wrapper.
+  RWLockReadGuard guard(&rw_lock_);
+
+  auto& data = save_buffer.AddFile(path);
+  data.reserve(hnsw_index_->indexFileSize());
+  size_t written_size = WriteHnswIndex(hnsw_index_, [&data](const char* piece, size_t size) {
+    data.insert(data.end(), piece, piece + size);
+  });
+  if (written_size != hnsw_index_->indexFileSize()) {
+    return butil::Status(pb::error::Errno::EINTERNAL,
+                         fmt::format("write size({}) not match index file size({})", written_size,
+                                     hnsw_index_->indexFileSize()));
+  }
+
+  return butil::Status::OK();
+}
+
 butil::Status VectorIndexHnsw::Load(const std::string& path) {
   if (path.empty()) {
     return butil::Status(pb::error::EILLEGAL_PARAMTETERS, "path is empty");
   }
 
   BvarLatencyGuard bvar_guard(&g_hnsw_load_latency);
-  // RWLockWriteGuard guard(&rw_lock_);
-
-  // FIXME: need to prevent SEGV when delete old_hnsw_index
   if (vector_index_type == pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW) {
-    auto* old_hnsw_index = hnsw_index_;
-    uint32_t actual_max_elements =
-        vector_index_parameter.hnsw_parameter().max_elements() + Constant::kHnswMaxElementsExpandNum;
-    hnsw_index_ = new hnswlib::HierarchicalNSW<float>(hnsw_space_, path, false, actual_max_elements, true);
-    delete old_hnsw_index;
+    // load with its saved max elements, more capacity will be expanded on demand.
+    auto* new_hnsw_index = new hnswlib::HierarchicalNSW<float>(hnsw_space_, path, false, 0, true);
+
+    RWLockWriteGuard guard(&rw_lock_);
+
+    delete hnsw_index_;
+    hnsw_index_ = new_hnsw_index;
+
+    DINGO_LOG(INFO) << fmt::format("[vector_index.hnsw][id({})] load max elements({}).", Id(),
+                                   hnsw_index_->getMaxElements());
     return butil::Status::OK();
   } else {
     return butil::Status(pb::error::Errno::EINTERNAL, "vector index type is not supported");
   }
 }
 
+bool VectorIndexHnsw::IsParallelSearch(size_t batch_size) {
+  if (thread_pool == nullptr || batch_size > FLAGS_hnsw_parallel_search_max_batch_size ||
+      FLAGS_hnsw_parallel_search_beam_width <= 1) {
+    return false;
+  }
+
+  // Batch parallelism leave cores idle only when no task is queued.
+  if (thread_pool->PendingTaskCount() > 0) {
+    return false;
+  }
+
+  return static_cast<int64_t>(hnsw_index_->getCurrentElementCount()) >= FLAGS_hnsw_parallel_search_min_count;
+}
+
+// Same as hnswlib searchKnn, greedy descent the upper levels, then beam search the base layer. Every round pop
+// the best beam width candidates and expand their neighbors by thread pool, the visited set is a atomic bitmap
+// shared by all tasks, the new candidates are merged in caller thread, so the heaps need no lock.
+// The exception can't cross thread, it is thrown in caller thread.
+std::priority_queue<std::pair<float, hnswlib::labeltype>> VectorIndexHnsw::ParallelSearchKnn(
+    const float* query, size_t topk, size_t ef, hnswlib::BaseFilterFunctor* filter) {
+  using DistanceId = std::pair<float, hnswlib::tableint>;
+
+  std::priority_queue<std::pair<float, hnswlib::labeltype>> result;
+  auto* hnsw_index = hnsw_index_;
+  if (hnsw_index->cur_element_count == 0) {
+    return result;
+  }
+
+  auto distance = [hnsw_index, query](hnswlib::tableint internal_id) {
+    return hnsw_index->fstdistfunc_(query, hnsw_index->getDataByInternalId(internal_id),
+                                    hnsw_index->dist_func_param_);
+  };
+
+  hnswlib::tableint cur_obj = hnsw_index->enterpoint_node_;
+  float cur_distance = distance(cur_obj);
+  for (int level = hnsw_index->maxlevel_; level > 0; --level) {
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      auto* link_list = hnsw_index->get_linklist(cur_obj, level);
+      auto* links = reinterpret_cast<hnswlib::tableint*>(link_list + 1);
+      int link_size = hnsw_index->getListCount(link_list);
+      for (int i = 0; i < link_size; ++i) {
+        if (links[i] > hnsw_index->max_elements_) {
+          throw std::runtime_error("cand error");
+        }
+        float d = distance(links[i]);
+        if (d < cur_distance) {
+          cur_distance = d;
+          cur_obj = links[i];
+          changed = true;
+        }
+      }
+    }
+  }
+
+  size_t element_count = hnsw_index->cur_element_count;
+  std::unique_ptr<std::atomic<uint64_t>[]> visited(new std::atomic<uint64_t>[(element_count + 63) / 64]());
+  auto try_visit = [&visited](hnswlib::tableint internal_id) {
+    uint64_t bit = 1ULL << (internal_id % 64);
+    return (visited[internal_id / 64].fetch_or(bit, std::memory_order_relaxed) & bit) == 0;
+  };
+
+  bool has_deletions = hnsw_index->getDeletedCount() > 0;
+  auto is_allowed = [hnsw_index, filter, has_deletions](hnswlib::tableint internal_id) {
+    return (!has_deletions || !hnsw_index->isMarkedDeleted(internal_id)) &&
+           (filter == nullptr || (*filter)(hnsw_index->getExternalLabel(internal_id)));
+  };
+
+  ef = std::max(ef, topk);
+  // top_candidates is max heap, candidates is min heap.
+  std::priority_queue<DistanceId, std::vector<DistanceId>, hnswlib::HierarchicalNSW<float>::CompareByFirst>
+      top_candidates;
+  std::priority_queue<DistanceId, std::vector<DistanceId>, std::greater<DistanceId>> candidates;
+  float lower_bound = std::numeric_limits<float>::max();
+
+  try_visit(cur_obj);
+  candidates.emplace(cur_distance, cur_obj);
+  if (is_allowed(cur_obj)) {
+    top_candidates.emplace(cur_distance, cur_obj);
+    lower_bound = cur_distance;
+  }
+
+  bool bare_search = !has_deletions && filter == nullptr;
+  size_t beam_width = FLAGS_hnsw_parallel_search_beam_width;
+  uint32_t expand_per_task = std::max(FLAGS_hnsw_parallel_search_expand_per_task, 1U);
+  std::vector<hnswlib::tableint> beam;
+  std::vector<std::vector<DistanceId>> expanded(beam_width);
+  std::vector<std::string> errors(beam_width);
+  while (!candidates.empty()) {
+    beam.clear();
+    while (!candidates.empty() && beam.size() < beam_width) {
+      const auto& candidate = candidates.top();
+      if (candidate.first > lower_bound && (top_candidates.size() >= ef || bare_search)) {
+        break;
+      }
+      beam.push_back(candidate.second);
+      candidates.pop();
+    }
+    if (beam.empty()) {
+      break;
+    }
+
+    ParallelFor(thread_pool, Id(), 0, beam.size(), expand_per_task, true, [&](size_t i) {
+      expanded[i].clear();
+      try {
+        auto* link_list = hnsw_index->get_linklist0(beam[i]);
+        auto* links = reinterpret_cast<hnswlib::tableint*>(link_list + 1);
+        size_t link_size = hnsw_index->getListCount(link_list);
+        for (size_t j = 0; j < link_size; ++j) {
+          if (links[j] < element_count && try_visit(links[j])) {
+            expanded[i].emplace_back(distance(links[j]), links[j]);
+          }
+        }
+      } catch (std::exception& e) {
+        errors[i] = e.what();
+      }
+    });
+
+    for (size_t i = 0; i < beam.size(); ++i) {
+      if (!errors[i].empty()) {
+        throw std::runtime_error(errors[i]);
+      }
+
+      for (const auto& [d, internal_id] : expanded[i]) {
+        if (top_candidates.size() >= ef && d >= lower_bound) {
+          continue;
+        }
+
+        candidates.emplace(d, internal_id);
+        if (is_allowed(internal_id)) {
+          top_candidates.emplace(d, internal_id);
+          if (top_candidates.size() > ef) {
+            top_candidates.pop();
+          }
+          lower_bound = top_candidates.top().first;
+        }
+      }
+    }
+  }
+
+  while (top_candidates.size() > topk) {
+    top_candidates.pop();
+  }
+  while (!top_candidates.empty()) {
+    const auto& top = top_candidates.top();
+    result.emplace(top.first, hnsw_index->getExternalLabel(top.second));
+    top_candidates.pop();
+  }
+
+  g_hnsw_parallel_search_count << 1;
+  return result;
+}
+
 butil::Status VectorIndexHnsw::Search(const std::vector<pb::common::VectorWithId>& vector_with_ids, uint32_t topk,
                                       const std::vector<std::shared_ptr<FilterFunctor>>& filters, bool reconstruct,
                                       const pb::common::VectorSearchParameter& search_parameter,
@@ -323,8 +737,9 @@ butil::Status VectorIndexHnsw::Search(const std::vector<pb::common::VectorWithId
     return butil::Status(pb::error::Errno::EINTERNAL, "vector index type is not supported");
   }
 
-  if (search_parameter.hnsw().efsearch() < 0 || search_parameter.hnsw().efsearch() > 1024) {
-    std::string s = fmt::format("efsearch is illegal, {}, must between 0 and 1024", search_parameter.hnsw().efsearch());
+  if (search_parameter.hnsw().efsearch() < 0 || search_parameter.hnsw().efsearch() > kMaxEfSearch) {
+    std::string s = fmt::format("efsearch is illegal, {}, must between 0 and {}", search_parameter.hnsw().efsearch(),
+                                kMaxEfSearch);
     DINGO_LOG(ERROR) << fmt::format("[vector_index.hnsw][id({})] {}", Id(), s);
     return butil::Status(pb::error::Errno::EILLEGAL_PARAMTETERS, s);
   }
@@ -417,17 +832,32 @@ butil::Status VectorIndexHnsw::Search(const std::vector<pb::common::VectorWithId
   BvarLatencyGuard bvar_guard(&g_hnsw_search_latency);
   RWLockReadGuard guard(&rw_lock_);
 
-  if (search_parameter.hnsw().efsearch() > 0) {
-    hnsw_index_->setEf(search_parameter.hnsw().efsearch());
+  // Not specify efsearch, use the calibrated one if exist.
+  int32_t efsearch = search_parameter.hnsw().efsearch();
+  if (efsearch == 0) {
+    efsearch = std::min(AdaptiveSearchParameter(topk), kMaxEfSearch);
   }
+  if (efsearch > 0) {
+    hnsw_index_->setEf(efsearch);
+  }
+
+  // Small batch of big index, the rows run in place and the beam of every row is expanded by thread pool,
+  // so not wait for thread pool in thread pool task.
+  bool is_parallel_search = IsParallelSearch(vector_with_ids.size());
+  ThreadPoolPtr row_thread_pool = is_parallel_search ? nullptr : thread_pool;
+  size_t ef = efsearch > 0 ? efsearch : hnsw_index_->ef_;
+  auto search_knn = [&](const float* query) {
+    return is_parallel_search ? ParallelSearchKnn(query, topk, ef, hnsw_filter.get())
+                              : hnsw_index_->searchKnn(query, topk, hnsw_filter.get());
+  };
 
   if (!normalize_) {
-    ParallelFor(thread_pool, Id(), 0, vector_with_ids.size(), FLAGS_vector_read_batch_size_per_task, true,
+    ParallelFor(row_thread_pool, Id(), 0, vector_with_ids.size(), FLAGS_vector_read_batch_size_per_task, true,
                 [&](size_t row) {
                   std::priority_queue<std::pair<float, hnswlib::labeltype>> result;
 
                   try {
-                    result = hnsw_index_->searchKnn(data.get() + dimension_ * row, topk, hnsw_filter.get());
+                    result = search_knn(data.get() + dimension_ * row);
                   } catch (std::runtime_error& e) {
                     std::string s = fmt::format("parallel search vector failed, error: {}", e.what());
                     LOG(ERROR) << fmt::format("[vector_index.hnsw][id({})] {}", Id(), s);
@@ -442,7 +872,7 @@ butil::Status VectorIndexHnsw::Search(const std::vector<pb::common::VectorWithId
                 });
   } else {  // normalize_
     ParallelFor(
-        thread_pool, Id(), 0, vector_with_ids.size(), FLAGS_vector_read_batch_size_per_task, true, [&](size_t row) {
+        row_thread_pool, Id(), 0, vector_with_ids.size(), FLAGS_vector_read_batch_size_per_task, true, [&](size_t row) {
           std::vector<float> norm_array(dimension_);
           VectorIndexUtils::NormalizeVectorForHnsw((float*)(data.get() + dimension_ * row), dimension_,  // NOLINT
                                                    norm_array.data());
@@ -450,7 +880,7 @@ butil::Status VectorIndexHnsw::Search(const std::vector<pb::common::VectorWithId
           std::priority_queue<std::pair<float, hnswlib::labeltype>> result;
 
           try {
-            result = hnsw_index_->searchKnn(norm_array.data(), topk, hnsw_filter.get());
+            result = search_knn(norm_array.data());
           } catch (std::runtime_error& e) {
             std::string s = fmt::format("parallel search vector failed, error: {}", e.what());
             LOG(ERROR) << fmt::format("[vector_index.hnsw][id({})] {}", Id(), s);
@@ -486,6 +916,116 @@ butil::Status VectorIndexHnsw::RangeSearch(const std::vector<pb::common::VectorW
   return butil::Status(pb::error::Errno::EVECTOR_NOT_SUPPORT, "RangeSearch not support in Hnsw!!!");
 }
 
+// Hnsw graph has no native range search, so search knn for the seeds, then expand the base layer from the seeds
+// which are in radius, only the vector in radius is expanded, so the cost is linear to the hit count.
+// The seeds are searched without filter, so the region of radius is found even if the filter is selective,
+// the deleted and filtered vector is only skipped in hits, they are still expanded to keep the graph connected.
+butil::Status VectorIndexHnsw::RangeSearchBaseLayer(const float* query, float radius,
+                                                    hnswlib::BaseFilterFunctor* filter,
+                                                    std::vector<RangeSearchHit>& hits) {
+  auto* hnsw_index = hnsw_index_;
+  size_t element_count = hnsw_index->cur_element_count;
+  if (element_count == 0) {
+    return butil::Status::OK();
+  }
+
+  auto distance = [hnsw_index, query](hnswlib::tableint internal_id) {
+    return hnsw_index->fstdistfunc_(query, hnsw_index->getDataByInternalId(internal_id),
+                                    hnsw_index->dist_func_param_);
+  };
+  auto is_allowed = [hnsw_index, filter](hnswlib::tableint internal_id) {
+    return !hnsw_index->isMarkedDeleted(internal_id) &&
+           (filter == nullptr || (*filter)(hnsw_index->getExternalLabel(internal_id)));
+  };
+
+  size_t seed_count = std::max(FLAGS_hnsw_range_search_seed_count, 1U);
+  auto seeds = hnsw_index->searchKnn(query, seed_count);
+
+  std::vector<bool> visited(element_count, false);
+  std::vector<hnswlib::tableint> expanding;
+  {
+    std::unique_lock<std::mutex> lock(hnsw_index->label_lookup_lock);
+    while (!seeds.empty()) {
+      auto it = hnsw_index->label_lookup_.find(seeds.top().second);
+      if (seeds.top().first < radius && it != hnsw_index->label_lookup_.end()) {
+        expanding.push_back(it->second);
+        visited[it->second] = true;
+      }
+      seeds.pop();
+    }
+  }
+
+  while (!expanding.empty()) {
+    auto internal_id = expanding.back();
+    expanding.pop_back();
+
+    if (is_allowed(internal_id)) {
+      hits.push_back({static_cast<int64_t>(hnsw_index->getExternalLabel(internal_id)), distance(internal_id)});
+    }
+
+    auto* link_list = hnsw_index->get_linklist0(internal_id);
+    auto* links = reinterpret_cast<hnswlib::tableint*>(link_list + 1);
+    size_t link_size = hnsw_index->getListCount(link_list);
+    for (size_t i = 0; i < link_size; ++i) {
+      if (links[i] >= element_count || visited[links[i]]) {
+        continue;
+      }
+      visited[links[i]] = true;
+      if (distance(links[i]) < radius) {
+        expanding.push_back(links[i]);
+      }
+    }
+  }
+
+  std::sort(hits.begin(), hits.end());
+
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexHnsw::RangeSearchHits(const std::vector<pb::common::VectorWithId>& vector_with_ids,
+                                               float radius,
+                                               const std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters,
+                                               const pb::common::VectorSearchParameter& /*parameter*/,
+                                               std::vector<std::vector<RangeSearchHit>>& hits) {
+  if (vector_with_ids.empty()) {
+    return butil::Status(pb::error::EILLEGAL_PARAMTETERS, "vector_with_ids is empty");
+  }
+
+  auto status = VectorIndexUtils::CheckVectorDimension(vector_with_ids, dimension_);
+  if (!status.ok()) {
+    return status;
+  }
+
+  auto hnsw_filter = filters.empty() ? nullptr : std::make_shared<HnswRangeFilterFunctor>(filters);
+
+  BvarLatencyGuard bvar_guard(&g_hnsw_range_search_latency);
+  RWLockReadGuard guard(&rw_lock_);
+
+  hits.clear();
+  hits.resize(vector_with_ids.size());
+  std::vector<float> query(dimension_);
+  for (size_t row = 0; row < vector_with_ids.size(); ++row) {
+    const float* data = vector_with_ids[row].vector().float_values().data();
+    if (normalize_) {
+      VectorIndexUtils::NormalizeVectorForHnsw(data, dimension_, query.data());
+    } else {
+      memcpy(query.data(), data, dimension_ * sizeof(float));
+    }
+
+    try {
+      status = RangeSearchBaseLayer(query.data(), radius, hnsw_filter.get(), hits[row]);
+    } catch (std::runtime_error& e) {
+      status = butil::Status(pb::error::Errno::EINTERNAL, fmt::format("range search failed, error: {}", e.what()));
+    }
+    if (!status.ok()) {
+      DINGO_LOG(ERROR) << fmt::format("[vector_index.hnsw][id({})] {}", Id(), status.error_str());
+      return status;
+    }
+  }
+
+  return butil::Status::OK();
+}
+
 void VectorIndexHnsw::LockWrite() { rw_lock_.LockWrite(); }
 
 void VectorIndexHnsw::UnlockWrite() { rw_lock_.UnlockWrite(); }
@@ -560,9 +1100,8 @@ butil::Status VectorIndexHnsw::GetMemorySize(int64_t& memory_size) {
 bool VectorIndexHnsw::NeedToRebuild() {
   int64_t element_count = 0, deleted_count = 0;
 
-  element_count = this->hnsw_index_->getCurrentElementCount();
-
-  deleted_count = this->hnsw_index_->getDeletedCount();
+  GetCount(element_count);
+  GetDeletedCount(deleted_count);
 
   if (element_count == 0 || deleted_count == 0) {
     return false;
@@ -571,13 +1110,173 @@ bool VectorIndexHnsw::NeedToRebuild() {
   return (deleted_count > 0 && deleted_count > element_count / 2);
 }
 
+void VectorIndexHnsw::WarmUp() {
+  if (!FLAGS_hnsw_enable_reorder && !FLAGS_hnsw_enable_warmup) {
+    return;
+  }
+
+  int64_t start_time = Helper::TimestampMs();
+  RWLockWriteGuard guard(&rw_lock_);
+
+  if (FLAGS_hnsw_enable_reorder) {
+    ReorderGraph(hnsw_index_);
+  }
+  if (FLAGS_hnsw_enable_warmup) {
+    WarmUpGraph(hnsw_index_);
+  }
+
+  DINGO_LOG(INFO) << fmt::format(
+      "[vector_index.hnsw][id({})] warm up element count({}) reorder({}), elapsed time: {}ms", Id(),
+      hnsw_index_->getCurrentElementCount(), FLAGS_hnsw_enable_reorder, Helper::TimestampMs() - start_time);
+}
+
+// Visit base layer by bfs from entry point, the unreachable element is appended from itself.
+template <typename Function>
+static void BfsBaseLayer(hnswlib::HierarchicalNSW<float>* hnsw_index, size_t max_count, Function fn) {
+  size_t element_count = hnsw_index->cur_element_count;
+  std::vector<bool> visited(element_count, false);
+  std::queue<hnswlib::tableint> queue;
+  size_t visit_count = 0;
+
+  auto bfs = [&](hnswlib::tableint start) {
+    visited[start] = true;
+    queue.push(start);
+    while (!queue.empty() && visit_count < max_count) {
+      hnswlib::tableint id = queue.front();
+      queue.pop();
+      fn(id);
+      ++visit_count;
+
+      auto* link_list = hnsw_index->get_linklist0(id);
+      auto* links = reinterpret_cast<hnswlib::tableint*>(link_list + 1);
+      size_t link_size = hnsw_index->getListCount(link_list);
+      for (size_t i = 0; i < link_size; ++i) {
+        if (links[i] < element_count && !visited[links[i]]) {
+          visited[links[i]] = true;
+          queue.push(links[i]);
+        }
+      }
+    }
+  };
+
+  if (hnsw_index->enterpoint_node_ < element_count) {
+    bfs(hnsw_index->enterpoint_node_);
+  }
+  for (size_t id = 0; id < element_count && visit_count < max_count; ++id) {
+    if (!visited[id]) {
+      bfs(static_cast<hnswlib::tableint>(id));
+    }
+  }
+}
+
+void VectorIndexHnsw::ReorderGraph(hnswlib::HierarchicalNSW<float>* hnsw_index) {
+  size_t element_count = hnsw_index->cur_element_count;
+  if (element_count < 2) {
+    return;
+  }
+
+  std::vector<hnswlib::tableint> old_ids;
+  old_ids.reserve(element_count);
+  BfsBaseLayer(hnsw_index, element_count, [&](hnswlib::tableint id) { old_ids.push_back(id); });
+  if (old_ids.size() != element_count) {
+    return;
+  }
+
+  std::vector<hnswlib::tableint> new_ids(element_count);
+  for (size_t i = 0; i < element_count; ++i) {
+    new_ids[old_ids[i]] = static_cast<hnswlib::tableint>(i);
+  }
+
+  // Skip reorder if no memory, the layout is only for speed.
+  size_t element_size = hnsw_index->size_data_per_element_;
+  char* new_data_memory = static_cast<char*>(malloc(hnsw_index->max_elements_ * element_size));
+  if (new_data_memory == nullptr) {
+    return;
+  }
+
+  auto remap_links = [&](hnswlib::linklistsizeint* link_list) {
+    auto* links = reinterpret_cast<hnswlib::tableint*>(link_list + 1);
+    size_t link_size = hnsw_index->getListCount(link_list);
+    for (size_t i = 0; i < link_size; ++i) {
+      links[i] = new_ids[links[i]];
+    }
+  };
+
+  std::vector<char*> new_link_lists(element_count);
+  std::vector<int> new_element_levels(element_count);
+  for (size_t new_id = 0; new_id < element_count; ++new_id) {
+    hnswlib::tableint old_id = old_ids[new_id];
+    char* element = new_data_memory + new_id * element_size;
+    memcpy(element, hnsw_index->data_level0_memory_ + old_id * element_size, element_size);
+    remap_links(reinterpret_cast<hnswlib::linklistsizeint*>(element + hnsw_index->offsetLevel0_));
+
+    int level = hnsw_index->element_levels_[old_id];
+    new_element_levels[new_id] = level;
+    new_link_lists[new_id] = hnsw_index->linkLists_[old_id];
+    for (int i = 1; i <= level; ++i) {
+      remap_links(reinterpret_cast<hnswlib::linklistsizeint*>(new_link_lists[new_id] +
+                                                              (i - 1) * hnsw_index->size_links_per_element_));
+    }
+  }
+
+  free(hnsw_index->data_level0_memory_);
+  hnsw_index->data_level0_memory_ = new_data_memory;
+  for (size_t new_id = 0; new_id < element_count; ++new_id) {
+    hnsw_index->linkLists_[new_id] = new_link_lists[new_id];
+    hnsw_index->element_levels_[new_id] = new_element_levels[new_id];
+  }
+
+  for (auto& [label, id] : hnsw_index->label_lookup_) {
+    id = new_ids[id];
+  }
+
+  std::unordered_set<hnswlib::tableint> deleted_elements;
+  for (auto id : hnsw_index->deleted_elements) {
+    deleted_elements.insert(new_ids[id]);
+  }
+  hnsw_index->deleted_elements.swap(deleted_elements);
+
+  hnsw_index->enterpoint_node_ = new_ids[hnsw_index->enterpoint_node_];
+}
+
+void VectorIndexHnsw::WarmUpGraph(hnswlib::HierarchicalNSW<float>* hnsw_index) {
+  static constexpr size_t kCacheLineSize = 64;
+
+  uint64_t checksum = 0;
+  auto touch = [&checksum](const char* data, size_t size) {
+    for (size_t offset = 0; offset < size; offset += kCacheLineSize) {
+      checksum += static_cast<uint8_t>(data[offset]);
+    }
+  };
+
+  // Upper layers are visited by every search.
+  size_t element_count = hnsw_index->cur_element_count;
+  for (size_t id = 0; id < element_count; ++id) {
+    int level = hnsw_index->element_levels_[id];
+    if (level > 0) {
+      touch(hnsw_index->linkLists_[id], level * hnsw_index->size_links_per_element_);
+      touch(hnsw_index->data_level0_memory_ + id * hnsw_index->size_data_per_element_,
+            hnsw_index->size_data_per_element_);
+    }
+  }
+
+  // Base layer near entry point.
+  BfsBaseLayer(hnsw_index, FLAGS_hnsw_warmup_max_element_count, [&](hnswlib::tableint id) {
+    touch(hnsw_index->data_level0_memory_ + id * hnsw_index->size_data_per_element_,
+          hnsw_index->size_data_per_element_);
+  });
+
+  DINGO_LOG(DEBUG) << fmt::format("[vector_index.hnsw] warm up element count({}) checksum({})",
+                                  element_count, checksum);
+}
+
 bool VectorIndexHnsw::NeedToSave(int64_t last_save_log_behind) {
   RWLockReadGuard guard(&rw_lock_);
 
   int64_t element_count = 0, deleted_count = 0;
 
-  element_count = this->hnsw_index_->getCurrentElementCount();
-  deleted_count = this->hnsw_index_->getDeletedCount();
+  GetCount(element_count);
+  GetDeletedCount(deleted_count);
 
   if (element_count == 0 && deleted_count == 0) {
     return false;
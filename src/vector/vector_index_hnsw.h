@@ -17,7 +17,9 @@
 
 #include <cstdint>
 #include <memory>
+#include <queue>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "butil/status.h"
@@ -30,6 +32,8 @@ namespace dingodb {
 
 class VectorIndexHnsw : public VectorIndex {
  public:
+  static constexpr int32_t kMaxEfSearch = 1024;
+
   explicit VectorIndexHnsw(int64_t id, const pb::common::VectorIndexParameter& vector_index_parameter,
                            const pb::common::RegionEpoch& epoch, const pb::common::Range& range,
                            ThreadPoolPtr thread_pool);
@@ -54,6 +58,7 @@ class VectorIndexHnsw : public VectorIndex {
   butil::Status Delete(const std::vector<int64_t>& delete_ids, bool is_priority) override;
 
   butil::Status Save(const std::string& path) override;
+  butil::Status SaveToBuffer(const std::string& path, VectorIndexSaveBuffer& save_buffer) override;
   butil::Status Load(const std::string& path) override;
 
   void LockWrite() override;
@@ -69,6 +74,11 @@ class VectorIndexHnsw : public VectorIndex {
                             const pb::common::VectorSearchParameter& parameter,
                             std::vector<pb::index::VectorWithDistanceResult>& results) override;
 
+  butil::Status RangeSearchHits(const std::vector<pb::common::VectorWithId>& vector_with_ids, float radius,
+                                const std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters,
+                                const pb::common::VectorSearchParameter& parameter,
+                                std::vector<std::vector<RangeSearchHit>>& hits) override;
+
   int32_t GetDimension() override;
   pb::common::MetricType GetMetricType() override;
   butil::Status GetCount(int64_t& count) override;
@@ -85,6 +95,7 @@ class VectorIndexHnsw : public VectorIndex {
     return butil::Status::OK();
   }
   bool NeedToRebuild() override;
+  void WarmUp() override;
   bool NeedToSave(int64_t last_save_log_behind) override;
   bool SupportSave() override;
 
@@ -92,7 +103,31 @@ class VectorIndexHnsw : public VectorIndex {
 
   // void NormalizeVector(const float* data, float* norm_array) const;
 
+ protected:
+  std::vector<int32_t> AdaptiveSearchCandidates() override;
+  void FillAdaptiveSearchParameter(int32_t value, pb::common::VectorSearchParameter& parameter) override;
+
  private:
+  // Expand max elements if there is no room for batch, must hold write lock.
+  void ExpandIfNeeded(int64_t batch_count);
+
+  // Choose whether every upsert vector reuse a deleted slot, only new label can reuse,
+  // exist label is updated in place, a deleted exist label is unmarked before update.
+  void RouteUpsert(const std::vector<pb::common::VectorWithId>& vector_with_ids,
+                   std::vector<uint8_t>& replace_deleteds);
+  // Search one query by parallel beam when the batch is small, the index is big and thread pool is idle.
+  bool IsParallelSearch(size_t batch_size);
+  std::priority_queue<std::pair<float, hnswlib::labeltype>> ParallelSearchKnn(
+      const float* query, size_t topk, size_t ef, hnswlib::BaseFilterFunctor* filter);
+  // Collect the vectors in radius of one query from base layer, must hold read lock.
+  butil::Status RangeSearchBaseLayer(const float* query, float radius, hnswlib::BaseFilterFunctor* filter,
+                                     std::vector<RangeSearchHit>& hits);
+  static void RepairDeletedNeighbor(hnswlib::HierarchicalNSW<float>* hnsw_index, hnswlib::tableint deleted_id);
+  // Relabel internal id by bfs order of base layer from entry point, so the neighbors are near in memory.
+  static void ReorderGraph(hnswlib::HierarchicalNSW<float>* hnsw_index);
+  // Touch the upper layers and the base layer near entry point.
+  static void WarmUpGraph(hnswlib::HierarchicalNSW<float>* hnsw_index);
+
   // hnsw members
   hnswlib::HierarchicalNSW<float>* hnsw_index_;
   hnswlib::SpaceInterface<float>* hnsw_space_;
@@ -43,6 +43,7 @@
 
 namespace dingodb {
 DEFINE_int64(ivf_flat_need_save_count, 10000, "ivf flat need save count");
+DECLARE_int32(vector_index_ivf_rebalance_max_split_per_round);
 
 bvar::LatencyRecorder g_ivf_flat_upsert_latency("dingo_ivf_flat_upsert_latency");
 bvar::LatencyRecorder g_ivf_flat_search_latency("dingo_ivf_flat_search_latency");
@@ -72,7 +73,7 @@ VectorIndexIvfFlat::VectorIndexIvfFlat(int64_t id, const pb::common::VectorIndex
 VectorIndexIvfFlat::~VectorIndexIvfFlat() = default;
 
 butil::Status VectorIndexIvfFlat::AddOrUpsert(const std::vector<pb::common::VectorWithId>& vector_with_ids,
-                                              bool is_upsert) {
+                                              bool /*is_upsert*/) {
   if (vector_with_ids.empty()) {
     return butil::Status(pb::error::EILLEGAL_PARAMTETERS, "vector_with_ids is empty");
   }
@@ -91,10 +92,9 @@ butil::Status VectorIndexIvfFlat::AddOrUpsert(const std::vector<pb::common::Vect
     return butil::Status(pb::error::Errno::EVECTOR_NOT_TRAIN, fmt::format("not train"));
   }
 
-  if (is_upsert) {
-    faiss::IDSelectorBatch sel(vector_with_ids.size(), ids.get());
-    index_->remove_ids(sel);
-  }
+  // Add exist id will orphan the old entry in hashtable direct map, which can't be removed by id any more,
+  // and raft apply of add not check exist id, so remove it even not upsert, it is O(batch).
+  VectorIndexUtils::RemoveIvfVectorIds(index_.get(), ids.get(), vector_with_ids.size());
   index_->add_with_ids(vector_with_ids.size(), vector_values.get(), ids.get());
 
   return butil::Status::OK();
@@ -133,7 +133,6 @@ butil::Status VectorIndexIvfFlat::Delete(const std::vector<int64_t>& delete_ids)
   }
 
   const auto& ids = VectorIndexUtils::CastVectorId(delete_ids);
-  faiss::IDSelectorBatch sel(delete_ids.size(), ids.get());
 
   {
     BvarLatencyGuard bvar_guard(&g_ivf_flat_delete_latency);
@@ -144,7 +143,7 @@ butil::Status VectorIndexIvfFlat::Delete(const std::vector<int64_t>& delete_ids)
       return butil::Status::OK();
     }
 
-    auto remove_count = index_->remove_ids(sel);
+    auto remove_count = VectorIndexUtils::RemoveIvfVectorIds(index_.get(), ids.get(), delete_ids.size());
     if (0 == remove_count) {
       DINGO_LOG(WARNING) << fmt::format("[vector_index.ivf_flat][id({})] remove not found vector id.", Id());
       return butil::Status(pb::error::Errno::EVECTOR_INVALID, "remove not found vector id");
@@ -169,8 +168,11 @@ butil::Status VectorIndexIvfFlat::Search(const std::vector<pb::common::VectorWit
     return status;
   }
 
-  int32_t nprobe =
-      parameter.ivf_flat().nprobe() > 0 ? parameter.ivf_flat().nprobe() : Constant::kSearchIvfFlatParamNprobe;
+  // Not specify nprobe, use the calibrated one if exist.
+  int32_t nprobe = parameter.ivf_flat().nprobe();
+  if (nprobe <= 0) {
+    nprobe = AdaptiveSearchParameter(topk) > 0 ? AdaptiveSearchParameter(topk) : Constant::kSearchIvfFlatParamNprobe;
+  }
 
   std::vector<faiss::Index::distance_t> distances;
   distances.resize(topk * vector_with_ids.size(), 0.0f);
@@ -224,6 +226,39 @@ butil::Status VectorIndexIvfFlat::RangeSearch(const std::vector<pb::common::Vect
                                               const std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters,
                                               bool /*reconstruct*/, const pb::common::VectorSearchParameter& parameter,
                                               std::vector<pb::index::VectorWithDistanceResult>& results) {
+  std::unique_ptr<faiss::RangeSearchResult> range_search_result;
+  auto status = DoRangeSearch(vector_with_ids, radius, filters, parameter, range_search_result);
+  if (!status.ok()) {
+    return status;
+  }
+
+  VectorIndexUtils ::FillRangeSearchResult(range_search_result, metric_type_, dimension_, results);
+
+  DINGO_LOG(DEBUG) << fmt::format("[vector_index.ivf_flat][id({})] result size {}", Id(), results.size());
+
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexIvfFlat::RangeSearchHits(
+    const std::vector<pb::common::VectorWithId>& vector_with_ids, float radius,
+    const std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters,
+    const pb::common::VectorSearchParameter& parameter, std::vector<std::vector<RangeSearchHit>>& hits) {
+  std::unique_ptr<faiss::RangeSearchResult> range_search_result;
+  auto status = DoRangeSearch(vector_with_ids, radius, filters, parameter, range_search_result);
+  if (!status.ok()) {
+    return status;
+  }
+
+  VectorIndexUtils::FillRangeSearchHits(range_search_result, metric_type_, hits);
+
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexIvfFlat::DoRangeSearch(const std::vector<pb::common::VectorWithId>& vector_with_ids,
+                                                float radius,
+                                                const std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters,
+                                                const pb::common::VectorSearchParameter& parameter,
+                                                std::unique_ptr<faiss::RangeSearchResult>& range_search_result) {
   if (vector_with_ids.empty()) {
     return butil::Status(pb::error::EILLEGAL_PARAMTETERS, "vector_with_ids is empty");
   }
@@ -237,57 +272,50 @@ butil::Status VectorIndexIvfFlat::RangeSearch(const std::vector<pb::common::Vect
 
   const auto& vector_values = VectorIndexUtils::ExtractVectorValue(vector_with_ids, dimension_, normalize_);
 
-  std::unique_ptr<faiss::RangeSearchResult> range_search_result =
-      std::make_unique<faiss::RangeSearchResult>(vector_with_ids.size());
+  // Lims of the result is zero initialized, so the blank result is valid.
+  range_search_result = std::make_unique<faiss::RangeSearchResult>(vector_with_ids.size());
 
   if (metric_type_ == pb::common::MetricType::METRIC_TYPE_COSINE ||
       metric_type_ == pb::common::MetricType::METRIC_TYPE_INNER_PRODUCT) {
     radius = 1.0F - radius;
   }
 
-  {
-    BvarLatencyGuard bvar_guard(&g_ivf_flat_range_search_latency);
-    RWLockReadGuard guard(&rw_lock_);
-
-    // Not trained(no data), direct return blank.
-    if (BAIDU_UNLIKELY(!IsTrainedImpl())) {
-      results.resize(vector_with_ids.size(), pb::index::VectorWithDistanceResult());
-      return butil::Status::OK();
-    }
+  BvarLatencyGuard bvar_guard(&g_ivf_flat_range_search_latency);
+  RWLockReadGuard guard(&rw_lock_);
 
-    if (BAIDU_UNLIKELY(nprobe <= 0)) {
-      nprobe = index_->nprobe;
-    }
+  // Not trained(no data), direct return blank.
+  if (BAIDU_UNLIKELY(!IsTrainedImpl())) {
+    return butil::Status::OK();
+  }
 
-    // Prevent users from passing parameters out of bounds.
-    nprobe = std::min(nprobe, static_cast<int32_t>(index_->nlist));
+  if (BAIDU_UNLIKELY(nprobe <= 0)) {
+    nprobe = index_->nprobe;
+  }
 
-    faiss::IVFSearchParameters ivf_search_parameters;
-    ivf_search_parameters.nprobe = nprobe;
-    ivf_search_parameters.max_codes = 0;
-    ivf_search_parameters.quantizer_params = nullptr;  // search for nlist . ignore
+  // Prevent users from passing parameters out of bounds.
+  nprobe = std::min(nprobe, static_cast<int32_t>(index_->nlist));
 
-    try {
-      if (!filters.empty()) {
-        auto ivf_flat_filter = filters.empty() ? nullptr : std::make_shared<IvfFlatIDSelector>(filters);
-        ivf_search_parameters.sel = ivf_flat_filter.get();
-        index_->range_search(vector_with_ids.size(), vector_values.get(), radius, range_search_result.get(),
-                             &ivf_search_parameters);
-      } else {
-        index_->range_search(vector_with_ids.size(), vector_values.get(), radius, range_search_result.get(),
-                             &ivf_search_parameters);
-      }
+  faiss::IVFSearchParameters ivf_search_parameters;
+  ivf_search_parameters.nprobe = nprobe;
+  ivf_search_parameters.max_codes = 0;
+  ivf_search_parameters.quantizer_params = nullptr;  // search for nlist . ignore
 
-    } catch (std::exception& e) {
-      std::string s = fmt::format("range search exception: {}", e.what());
-      DINGO_LOG(ERROR) << fmt::format("[vector_index.ivf_flat][id({})] {}", Id(), s);
-      return butil::Status(pb::error::Errno::EINTERNAL, s);
+  try {
+    if (!filters.empty()) {
+      auto ivf_flat_filter = filters.empty() ? nullptr : std::make_shared<IvfFlatIDSelector>(filters);
+      ivf_search_parameters.sel = ivf_flat_filter.get();
+      index_->range_search(vector_with_ids.size(), vector_values.get(), radius, range_search_result.get(),
+                           &ivf_search_parameters);
+    } else {
+      index_->range_search(vector_with_ids.size(), vector_values.get(), radius, range_search_result.get(),
+                           &ivf_search_parameters);
     }
-  }
 
-  VectorIndexUtils ::FillRangeSearchResult(range_search_result, metric_type_, dimension_, results);
-
-  DINGO_LOG(DEBUG) << fmt::format("[vector_index.ivf_flat][id({})] result size {}", Id(), results.size());
+  } catch (std::exception& e) {
+    std::string s = fmt::format("range search exception: {}", e.what());
+    DINGO_LOG(ERROR) << fmt::format("[vector_index.ivf_flat][id({})] {}", Id(), s);
+    return butil::Status(pb::error::Errno::EINTERNAL, s);
+  }
 
   return butil::Status::OK();
 }
@@ -296,6 +324,26 @@ void VectorIndexIvfFlat::LockWrite() { rw_lock_.LockWrite(); }
 
 void VectorIndexIvfFlat::UnlockWrite() { rw_lock_.UnlockWrite(); }
 
+std::vector<int32_t> VectorIndexIvfFlat::AdaptiveSearchCandidates() {
+  RWLockReadGuard guard(&rw_lock_);
+  if (!IsTrainedImpl()) {
+    return {};
+  }
+
+  int32_t nlist = static_cast<int32_t>(index_->nlist);
+  std::vector<int32_t> candidates;
+  for (int32_t nprobe = 1; nprobe < nlist; nprobe *= 2) {
+    candidates.push_back(nprobe);
+  }
+  // Search all list as ground truth.
+  candidates.push_back(nlist);
+  return candidates;
+}
+
+void VectorIndexIvfFlat::FillAdaptiveSearchParameter(int32_t value, pb::common::VectorSearchParameter& parameter) {
+  parameter.mutable_ivf_flat()->set_nprobe(value);
+}
+
 bool VectorIndexIvfFlat::SupportSave() { return true; }
 
 butil::Status VectorIndexIvfFlat::Save(const std::string& path) {
@@ -309,7 +357,21 @@ butil::Status VectorIndexIvfFlat::Save(const std::string& path) {
   }
 
   try {
-    faiss::write_index(index_.get(), path.c_str());
+    VectorIndexUtils::WriteIndex(index_.get(), path);
+  } catch (std::exception& e) {
+    return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("write index exception: {}", e.what()));
+  }
+
+  return butil::Status();
+}
+
+butil::Status VectorIndexIvfFlat::SaveToBuffer(const std::string& path, VectorIndexSaveBuffer& save_buffer) {
+  if (path.empty()) {
+    return butil::Status(pb::error::EILLEGAL_PARAMTETERS, "path is empty");
+  }
+
+  try {
+    VectorIndexUtils::WriteIndex(index_.get(), path, save_buffer);
   } catch (std::exception& e) {
     return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("write index exception: {}", e.what()));
   }
@@ -392,6 +454,7 @@ butil::Status VectorIndexIvfFlat::Load(const std::string& path) {
 
   quantizer_.reset();
   index_ = std::move(internal_index_ivf_flat);
+  VectorIndexUtils::EnableIvfDirectMap(index_.get());
 
   nlist_ = index_->nlist;
   train_data_size_ = index_->ntotal;
@@ -554,6 +617,48 @@ bool VectorIndexIvfFlat::NeedToRebuild() {
   return false;
 }
 
+bool VectorIndexIvfFlat::NeedToRebalance() {
+  RWLockReadGuard guard(&rw_lock_);
+
+  if (BAIDU_UNLIKELY(!IsTrainedImpl() || nlist_ <= 1)) {
+    return false;
+  }
+
+  size_t largest_list_no = 0;
+  size_t smallest_list_no = 0;
+  return VectorIndexUtils::NeedToRebalanceIvf(index_.get(), largest_list_no, smallest_list_no);
+}
+
+// Split one list per write lock, so the search and write are not blocked for long time.
+butil::Status VectorIndexIvfFlat::Rebalance() {
+  for (int i = 0; i < FLAGS_vector_index_ivf_rebalance_max_split_per_round; ++i) {
+    RWLockWriteGuard guard(&rw_lock_);
+
+    size_t largest_list_no = 0;
+    size_t smallest_list_no = 0;
+    if (BAIDU_UNLIKELY(!IsTrainedImpl() || nlist_ <= 1) ||
+        !VectorIndexUtils::NeedToRebalanceIvf(index_.get(), largest_list_no, smallest_list_no)) {
+      break;
+    }
+
+    size_t largest_list_size = index_->invlists->list_size(largest_list_no);
+    size_t smallest_list_size = index_->invlists->list_size(smallest_list_no);
+    auto status = VectorIndexUtils::RebalanceIvf(index_.get(), largest_list_no, smallest_list_no);
+    if (!status.ok()) {
+      DINGO_LOG(ERROR) << fmt::format("[vector_index.ivf_flat][id({})] rebalance list({}/{}) failed, error: {}", Id(),
+                                      largest_list_no, smallest_list_no, status.error_str());
+      return status;
+    }
+
+    DINGO_LOG(INFO) << fmt::format(
+        "[vector_index.ivf_flat][id({})] rebalance list({}/{}) size({}/{}) to size({}/{})", Id(), largest_list_no,
+        smallest_list_no, largest_list_size, smallest_list_size, index_->invlists->list_size(largest_list_no),
+        index_->invlists->list_size(smallest_list_no));
+  }
+
+  return butil::Status::OK();
+}
+
 bool VectorIndexIvfFlat::IsTrained() {
   RWLockReadGuard guard(&rw_lock_);
 
@@ -597,6 +702,8 @@ void VectorIndexIvfFlat::Init() {
     quantizer_ = std::make_unique<faiss::IndexFlatL2>(dimension_);
     index_ = std::make_unique<faiss::IndexIVFFlat>(quantizer_.get(), dimension_, nlist_, faiss::MetricType::METRIC_L2);
   }
+
+  VectorIndexUtils::EnableIvfDirectMap(index_.get());
 }
 
 bool VectorIndexIvfFlat::IsTrainedImpl() {
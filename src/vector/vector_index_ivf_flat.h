@@ -68,6 +68,7 @@ class VectorIndexIvfFlat : public VectorIndex {
   VectorIndexIvfFlat& operator=(VectorIndexIvfFlat&& rhs) = delete;
 
   butil::Status Save(const std::string& path) override;
+  butil::Status SaveToBuffer(const std::string& path, VectorIndexSaveBuffer& save_buffer) override;
   butil::Status Load(const std::string& path) override;
   bool SupportSave() override;
 
@@ -91,6 +92,11 @@ class VectorIndexIvfFlat : public VectorIndex {
                             const pb::common::VectorSearchParameter& parameter,
                             std::vector<pb::index::VectorWithDistanceResult>& results) override;
 
+  butil::Status RangeSearchHits(const std::vector<pb::common::VectorWithId>& vector_with_ids, float radius,
+                                const std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters,
+                                const pb::common::VectorSearchParameter& parameter,
+                                std::vector<std::vector<RangeSearchHit>>& hits) override;
+
   void LockWrite() override;
   void UnlockWrite() override;
 
@@ -104,10 +110,16 @@ class VectorIndexIvfFlat : public VectorIndex {
   butil::Status Train(std::vector<float>& train_datas) override;
   butil::Status Train(const std::vector<pb::common::VectorWithId>& vectors) override;
   bool NeedToRebuild() override;
+  bool NeedToRebalance() override;
+  butil::Status Rebalance() override;
   bool NeedTrain() override { return true; }
   bool IsTrained() override;
   bool NeedToSave(int64_t last_save_log_behind) override;
 
+ protected:
+  std::vector<int32_t> AdaptiveSearchCandidates() override;
+  void FillAdaptiveSearchParameter(int32_t value, pb::common::VectorSearchParameter& parameter) override;
+
  private:
   void Init();
 
@@ -118,6 +130,11 @@ class VectorIndexIvfFlat : public VectorIndex {
 
   butil::Status AddOrUpsert(const std::vector<pb::common::VectorWithId>& vector_with_ids, bool is_upsert);
 
+  butil::Status DoRangeSearch(const std::vector<pb::common::VectorWithId>& vector_with_ids, float radius,
+                              const std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters,
+                              const pb::common::VectorSearchParameter& parameter,
+                              std::unique_ptr<faiss::RangeSearchResult>& range_search_result);
+
   // Dimension of the elements
   faiss::idx_t dimension_;
 
@@ -195,6 +195,29 @@ void VectorIndexIvfPq::LockWrite() { rw_lock_.LockWrite(); }
 
 void VectorIndexIvfPq::UnlockWrite() { rw_lock_.UnlockWrite(); }
 
+butil::Status VectorIndexIvfPq::CalibrateSearchParameter(const std::vector<pb::common::VectorWithId>& samples,
+                                                         float recall_target) {
+  return InvokeConcreteFunction("CalibrateSearchParameter", &VectorIndexFlat::CalibrateSearchParameter,
+                                &VectorIndexRawIvfPq::CalibrateSearchParameter, true, samples, recall_target);
+}
+
+// Not lock, may be called in the fork child process when save snapshot, the outside has been locked.
+int32_t VectorIndexIvfPq::CalibratedSearchParameter() {
+  if (inner_index_type_ == IndexTypeInIvfPq::kIvfPq) {
+    return index_raw_ivf_pq_->CalibratedSearchParameter();
+  }
+
+  return 0;
+}
+
+void VectorIndexIvfPq::SetCalibratedSearchParameter(int32_t value) {
+  RWLockReadGuard guard(&rw_lock_);
+
+  if (inner_index_type_ == IndexTypeInIvfPq::kIvfPq) {
+    index_raw_ivf_pq_->SetCalibratedSearchParameter(value);
+  }
+}
+
 bool VectorIndexIvfPq::SupportSave() { return true; }
 
 butil::Status VectorIndexIvfPq::Save(const std::string& path) {
@@ -215,6 +238,11 @@ butil::Status VectorIndexIvfPq::Save(const std::string& path) {
   return butil::Status::OK();
 }
 
+butil::Status VectorIndexIvfPq::SaveToBuffer(const std::string& path, VectorIndexSaveBuffer& save_buffer) {
+  return InvokeConcreteFunction("SaveToBuffer", &VectorIndexFlat::SaveToBuffer, &VectorIndexRawIvfPq::SaveToBuffer,
+                                false, path, save_buffer);
+}
+
 butil::Status VectorIndexIvfPq::Load(const std::string& path) {
   if (path.empty()) {
     return butil::Status(pb::error::EILLEGAL_PARAMTETERS, "path is empty");
@@ -437,6 +465,26 @@ bool VectorIndexIvfPq::NeedToRebuild() {
   return false;
 }
 
+bool VectorIndexIvfPq::NeedToRebalance() {
+  RWLockReadGuard guard(&rw_lock_);
+
+  if (inner_index_type_ == IndexTypeInIvfPq::kIvfPq) {
+    return index_raw_ivf_pq_->NeedToRebalance();
+  }
+
+  return false;
+}
+
+butil::Status VectorIndexIvfPq::Rebalance() {
+  RWLockReadGuard guard(&rw_lock_);
+
+  if (inner_index_type_ == IndexTypeInIvfPq::kIvfPq) {
+    return index_raw_ivf_pq_->Rebalance();
+  }
+
+  return butil::Status::OK();
+}
+
 bool VectorIndexIvfPq::IsTrained() {
   RWLockReadGuard guard(&rw_lock_);
   return IsTrainedImpl();
@@ -44,6 +44,7 @@ class VectorIndexIvfPq : public VectorIndex {
   VectorIndexIvfPq& operator=(VectorIndexIvfPq&& rhs) = delete;
 
   butil::Status Save(const std::string& path) override;
+  butil::Status SaveToBuffer(const std::string& path, VectorIndexSaveBuffer& save_buffer) override;
   butil::Status Load(const std::string& path) override;
   bool SupportSave() override;
 
@@ -80,10 +81,17 @@ class VectorIndexIvfPq : public VectorIndex {
   butil::Status Train(std::vector<float>& train_datas) override;
   butil::Status Train(const std::vector<pb::common::VectorWithId>& vectors) override;
   bool NeedToRebuild() override;
+  bool NeedToRebalance() override;
+  butil::Status Rebalance() override;
   bool NeedTrain() override { return true; }
   bool IsTrained() override;
   bool NeedToSave(int64_t last_save_log_behind) override;
 
+  butil::Status CalibrateSearchParameter(const std::vector<pb::common::VectorWithId>& samples,
+                                         float recall_target) override;
+  int32_t CalibratedSearchParameter() override;
+  void SetCalibratedSearchParameter(int32_t value) override;
+
   pb::common::VectorIndexType VectorIndexSubType() override;
 
  private:
@@ -14,11 +14,14 @@
 
 #include "vector/vector_index_manager.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <memory>
+#include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "bthread/bthread.h"
@@ -49,6 +52,15 @@ DEFINE_int32(vector_fast_background_worker_num, 8, "vector index fast background
 DEFINE_int64(vector_fast_build_log_gap, 50, "vector index fast build log gap");
 DEFINE_int64(vector_pull_snapshot_min_log_gap, 66, "vector index pull snapshot min log gap");
 DEFINE_int64(vector_max_background_task_count, 32, "vector index max background task count");
+DECLARE_double(vector_index_search_recall_target);
+DECLARE_int32(vector_index_calibrate_sample_count);
+
+DEFINE_int32(vector_index_scrub_full_interval_round, 10,
+             "scrub all vector index every some round, other round only scrub dirty vector index");
+DEFINE_int64(vector_index_scrub_round_time_budget_ms, 1000,
+             "scrub vector index time budget per round, the rest dirty vector index is left to next round");
+
+static std::atomic<int64_t> g_vector_index_scrub_round{0};
 
 std::string RebuildVectorIndexTask::Trace() {
   return fmt::format("[vector_index.rebuild][id({}).start_time({}).job_id({})] {}", vector_index_wrapper_->Id(),
@@ -1116,6 +1128,77 @@ butil::Status VectorIndexManager::ReplayWalToVectorIndex(VectorIndexPtr vector_i
 }
 
 // Build vector index with original all data.
+static bool IsNeedCalibrateSearchParameter() {
+  return FLAGS_vector_index_search_recall_target > 0 && FLAGS_vector_index_calibrate_sample_count > 0;
+}
+
+// Reservoir sample vectors for calibrate adaptive search, count is the number of vectors seen before this one.
+static void SampleCalibrateVector(const pb::common::VectorWithId& vector, int64_t count, std::mt19937_64& rng,
+                                  std::vector<pb::common::VectorWithId>& samples) {
+  if (samples.size() < static_cast<size_t>(FLAGS_vector_index_calibrate_sample_count)) {
+    samples.push_back(vector);
+  } else {
+    int64_t pos = std::uniform_int_distribution<int64_t>(0, count)(rng);
+    if (static_cast<size_t>(pos) < samples.size()) {
+      samples[pos] = vector;
+    }
+  }
+}
+
+static void CalibrateSearchParameter(VectorIndexPtr vector_index, const std::vector<pb::common::VectorWithId>& samples,
+                                     const std::string& trace) {
+  if (samples.empty()) {
+    return;
+  }
+
+  auto status = vector_index->CalibrateSearchParameter(samples, FLAGS_vector_index_search_recall_target);
+  if (!status.ok() && status.error_code() != pb::error::EVECTOR_NOT_SUPPORT) {
+    DINGO_LOG(WARNING) << fmt::format("[vector_index.calibrate][index_id({})][trace({})] calibrate failed, error: {}",
+                                      vector_index->Id(), trace, Helper::PrintStatus(status));
+  }
+}
+
+// Calibrate the loaded vector index whose snapshot not carry the calibrated parameter.
+// Sample from the leading part of the region vectors, avoid scan the whole region at load.
+static void CalibrateLoadedVectorIndex(VectorIndexPtr vector_index, const std::string& trace) {
+  if (!IsNeedCalibrateSearchParameter() || vector_index->CalibratedSearchParameter() > 0) {
+    return;
+  }
+
+  auto region = Server::GetInstance().GetRegion(vector_index->Id());
+  if (region == nullptr) {
+    return;
+  }
+
+  const auto& range = vector_index->Range();
+  IteratorOptions options;
+  options.upper_bound = range.end_key();
+
+  auto raw_engine = Server::GetInstance().GetRawEngine(region->GetRawEngineType());
+  auto iter = raw_engine->Reader()->NewIterator(Constant::kVectorDataCF, options);
+  if (iter == nullptr) {
+    return;
+  }
+
+  int64_t scan_limit = static_cast<int64_t>(FLAGS_vector_index_calibrate_sample_count) * 10;
+  std::vector<pb::common::VectorWithId> samples;
+  std::mt19937_64 rng(vector_index->Id());
+
+  int64_t count = 0;
+  for (iter->Seek(range.start_key()); iter->Valid() && count < scan_limit; iter->Next()) {
+    pb::common::VectorWithId vector;
+    vector.set_id(VectorCodec::DecodeVectorId(std::string(iter->Key())));
+    if (!vector.mutable_vector()->ParseFromString(std::string(iter->Value())) ||
+        vector.vector().float_values_size() <= 0) {
+      continue;
+    }
+
+    SampleCalibrateVector(vector, count++, rng, samples);
+  }
+
+  CalibrateSearchParameter(vector_index, samples, trace);
+}
+
 VectorIndexPtr VectorIndexManager::BuildVectorIndex(VectorIndexWrapperPtr vector_index_wrapper,
                                                     const std::string& trace) {
   assert(vector_index_wrapper != nullptr);
@@ -1197,6 +1280,11 @@ VectorIndexPtr VectorIndexManager::BuildVectorIndex(VectorIndexWrapperPtr vector
         vector_index_id, trace, vector_index->NeedTrain(), vector_index->IsTrained());
   }
 
+  // Reservoir sample vectors for calibrate adaptive search.
+  bool is_need_calibrate = IsNeedCalibrateSearchParameter();
+  std::vector<pb::common::VectorWithId> calibrate_samples;
+  std::mt19937_64 rng(vector_index_id);
+
   int64_t count = 0;
   int64_t upsert_use_time = 0;
   std::vector<pb::common::VectorWithId> vectors;
@@ -1221,6 +1309,10 @@ VectorIndexPtr VectorIndexManager::BuildVectorIndex(VectorIndexWrapperPtr vector
       continue;
     }
 
+    if (is_need_calibrate) {
+      SampleCalibrateVector(vector, count, rng, calibrate_samples);
+    }
+
     vectors.push_back(vector);
     if (++count % Constant::kBuildVectorIndexBatchSize == 0) {
       int64_t upsert_start_time = Helper::TimestampMs();
@@ -1248,6 +1340,10 @@ VectorIndexPtr VectorIndexManager::BuildVectorIndex(VectorIndexWrapperPtr vector
     upsert_use_time += (Helper::TimestampMs() - upsert_start_time);
   }
 
+  if (is_need_calibrate) {
+    CalibrateSearchParameter(vector_index, calibrate_samples, trace);
+  }
+
   DINGO_LOG(INFO) << fmt::format(
       "[vector_index.build][index_id({})][trace({})] Build vector index finish, parallel({}) count({}) epoch({}) "
       "range({}) "
@@ -1346,6 +1442,9 @@ butil::Status VectorIndexManager::RebuildVectorIndex(VectorIndexWrapperPtr vecto
       vector_index_id, vector_index_wrapper->Version(), trace, vector_index->ApplyLogId(),
       Helper::TimestampMs() - start_time);
 
+  // Warm up before catch up log, the index is not published yet.
+  vector_index->WarmUp();
+
   bvar_vector_index_rebuild_catchup_total_num << 1;
   bvar_vector_index_rebuild_catchup_running_num << 1;
   DEFER(bvar_vector_index_rebuild_catchup_running_num << -1;);
@@ -1379,6 +1478,12 @@ butil::Status VectorIndexManager::LoadVectorIndex(VectorIndexWrapperPtr vector_i
       "[vector_index.load][index_id({})][trace({})] Load vector index snapshot success, epoch: {} elapsed time: {}ms.",
       vector_index_id, trace, Helper::RegionEpochToString(vector_index->Epoch()), Helper::TimestampMs() - start_time);
 
+  // warm up before catch up wal, the index is not published yet.
+  vector_index->WarmUp();
+
+  // snapshot without calibrated parameter(e.g. saved by old version), calibrate before publish.
+  CalibrateLoadedVectorIndex(vector_index, trace);
+
   // catch up wal
   bvar_vector_index_load_catchup_total_num << 1;
   bvar_vector_index_load_catchup_running_num << 1;
@@ -1517,24 +1622,70 @@ void VectorIndexManager::LaunchSaveVectorIndex(VectorIndexWrapperPtr vector_inde
   }
 }
 
+// Scrub urgency, the larger raft log gap since last save and deleted ratio, the more urgent.
+static double CalcScrubUrgency(VectorIndexWrapperPtr vector_index_wrapper) {
+  int64_t log_gap = std::max(static_cast<int64_t>(0),
+                             vector_index_wrapper->ApplyLogId() - vector_index_wrapper->SnapshotLogId());
+
+  double deleted_ratio = 0.0;
+  int64_t count = 0, deleted_count = 0;
+  if (vector_index_wrapper->GetCount(count).ok() && vector_index_wrapper->GetDeletedCount(deleted_count).ok() &&
+      count > 0) {
+    deleted_ratio = static_cast<double>(deleted_count) / count;
+  }
+
+  return (log_gap + 1) * (1.0 + deleted_ratio);
+}
+
 butil::Status VectorIndexManager::ScrubVectorIndex() {
-  auto regions = Server::GetInstance().GetAllAliveRegion();
+  int64_t start_time = Helper::TimestampMs();
+
+  // Full scrub at first round and every some round, other round only scrub dirty vector index.
+  int64_t round = g_vector_index_scrub_round.fetch_add(1, std::memory_order_relaxed);
+  bool is_full_scrub =
+      FLAGS_vector_index_scrub_full_interval_round <= 1 || round % FLAGS_vector_index_scrub_full_interval_round == 0;
+
+  auto dirty_ids = VectorIndexWrapper::TakeDirtyIds();
+  std::vector<store::RegionPtr> regions;
+  if (is_full_scrub) {
+    regions = Server::GetInstance().GetAllAliveRegion();
+  } else {
+    regions.reserve(dirty_ids.size());
+    for (auto vector_index_id : dirty_ids) {
+      auto region = Server::GetInstance().GetRegion(vector_index_id);
+      if (region != nullptr) {
+        regions.push_back(region);
+      }
+    }
+  }
+
   if (regions.empty()) {
-    DINGO_LOG(INFO) << "[vector_index.scrub][index_id()] No alive region, skip scrub vector index";
+    DINGO_LOG(INFO) << fmt::format("[vector_index.scrub][index_id()] No {} region, skip scrub vector index",
+                                   is_full_scrub ? "alive" : "dirty");
     return butil::Status::OK();
   }
 
-  DINGO_LOG(INFO) << "[vector_index.scrub][index_id()] Scrub vector index start, alive region_count is "
-                  << regions.size();
+  DINGO_LOG(INFO) << fmt::format(
+      "[vector_index.scrub][index_id()] Scrub vector index start, full({}) region_count({}) dirty_count({})",
+      is_full_scrub, regions.size(), dirty_ids.size());
 
+  std::vector<std::pair<double, VectorIndexWrapperPtr>> scrub_wrappers;
+  scrub_wrappers.reserve(regions.size());
   for (const auto& region : regions) {
     int64_t vector_index_id = region->Id();
+    auto vector_index_wrapper = region->VectorIndexWrapper();
+    if (vector_index_wrapper == nullptr) {
+      continue;
+    }
+    // Clear before check, the write after here will mark dirty again.
+    vector_index_wrapper->ClearDirty();
+
     if (region->State() != pb::common::NORMAL) {
       DINGO_LOG(INFO) << fmt::format("[vector_index.scrub][index_id({})] region state is not normal, dont't scrub.",
                                      vector_index_id);
+      vector_index_wrapper->MarkDirty();
       continue;
     }
-    auto vector_index_wrapper = region->VectorIndexWrapper();
     if (!vector_index_wrapper->IsReady()) {
       DINGO_LOG(INFO) << fmt::format("[vector_index.scrub][index_id({})] vector index is not ready, dont't scrub.",
                                      vector_index_id);
@@ -1546,24 +1697,73 @@ butil::Status VectorIndexManager::ScrubVectorIndex() {
       continue;
     }
 
+    scrub_wrappers.emplace_back(CalcScrubUrgency(vector_index_wrapper), vector_index_wrapper);
+  }
+
+  // Most urgent first.
+  std::sort(scrub_wrappers.begin(), scrub_wrappers.end(),
+            [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+
+  int scrub_count = 0;
+  for (auto& [urgency, vector_index_wrapper] : scrub_wrappers) {
+    int64_t vector_index_id = vector_index_wrapper->Id();
+    if (Helper::TimestampMs() - start_time > FLAGS_vector_index_scrub_round_time_budget_ms) {
+      // Out of time budget, left to next round.
+      vector_index_wrapper->MarkDirty();
+      continue;
+    }
+    ++scrub_count;
+
     bool need_rebuild = vector_index_wrapper->NeedToRebuild();
-    if (need_rebuild && vector_index_wrapper->RebuildingNum() == 0) {
-      DINGO_LOG(INFO) << fmt::format("[vector_index.scrub][index_id({})] need rebuild, do rebuild vector index.",
-                                     vector_index_id);
-      LaunchRebuildVectorIndex(vector_index_wrapper, 0, true, false, false, "from scrub");
+    if (need_rebuild) {
+      if (vector_index_wrapper->RebuildingNum() == 0) {
+        DINGO_LOG(INFO) << fmt::format(
+            "[vector_index.scrub][index_id({})] need rebuild, urgency({:.2f}), do rebuild vector index.",
+            vector_index_id, urgency);
+        LaunchRebuildVectorIndex(vector_index_wrapper, 0, true, false, false, "from scrub");
+      } else {
+        vector_index_wrapper->MarkDirty();
+      }
       continue;
     }
 
+    // Skewed ivf lists are rebalanced in place, cheaper than rebuild.
+    // Not rebalance while saving, the saving snapshot must be consistent with apply log id.
+    if (vector_index_wrapper->NeedToRebalance()) {
+      if (vector_index_wrapper->RebuildingNum() > 0 || vector_index_wrapper->SavingNum() > 0 ||
+          vector_index_wrapper->IsWriteFrozen()) {
+        vector_index_wrapper->MarkDirty();
+      } else {
+        auto status = vector_index_wrapper->Rebalance();
+        if (!status.ok()) {
+          DINGO_LOG(ERROR) << fmt::format(
+              "[vector_index.scrub][index_id({})] rebalance vector index failed, error: {}", vector_index_id,
+              status.error_str());
+        } else {
+          DINGO_LOG(INFO) << fmt::format("[vector_index.scrub][index_id({})] rebalance vector index finish.",
+                                         vector_index_id);
+        }
+      }
+    }
+
     std::string trace;
     bool need_save = vector_index_wrapper->NeedToSave(trace);
-    if (need_save && vector_index_wrapper->RebuildingNum() == 0 && vector_index_wrapper->SavingNum() == 0) {
-      DINGO_LOG(INFO) << fmt::format("[vector_index.scrub][index_id({})] need save, trace: {}.", vector_index_id,
-                                     trace);
-
-      LaunchSaveVectorIndex(vector_index_wrapper, fmt::format("scrub-{}", trace));
+    if (need_save) {
+      if (vector_index_wrapper->RebuildingNum() == 0 && vector_index_wrapper->SavingNum() == 0) {
+        DINGO_LOG(INFO) << fmt::format("[vector_index.scrub][index_id({})] need save, urgency({:.2f}) trace: {}.",
+                                       vector_index_id, urgency, trace);
+
+        LaunchSaveVectorIndex(vector_index_wrapper, fmt::format("scrub-{}", trace));
+      } else {
+        vector_index_wrapper->MarkDirty();
+      }
     }
   }
 
+  DINGO_LOG(INFO) << fmt::format(
+      "[vector_index.scrub][index_id()] Scrub vector index finish, scrub_count({}/{}) elapsed time {}ms", scrub_count,
+      scrub_wrappers.size(), Helper::TimestampMs() - start_time);
+
   return butil::Status::OK();
 }
 
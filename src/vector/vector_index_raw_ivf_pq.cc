@@ -29,11 +29,15 @@
 #include "butil/compiler_specific.h"
 #include "butil/status.h"
 #include "common/constant.h"
+#include "common/helper.h"
 #include "common/logging.h"
 #include "faiss/Index.h"
 #include "faiss/IndexFlat.h"
+#include "faiss/IndexFlatCodes.h"
+#include "faiss/IndexScalarQuantizer.h"
 #include "faiss/MetricType.h"
 #include "faiss/impl/AuxIndexStructures.h"
+#include "faiss/impl/DistanceComputer.h"
 #include "faiss/impl/IDSelector.h"
 #include "faiss/index_io.h"
 #include "fmt/core.h"
@@ -46,6 +50,11 @@
 namespace dingodb {
 
 DEFINE_int64(ivf_pq_need_save_count, 10000, "ivf pq need save count");
+DEFINE_bool(ivf_pq_enable_rerank, false,
+            "ivf pq keep vectors in side store, and rerank search result by exact distance");
+DEFINE_bool(ivf_pq_rerank_use_fp16, true, "ivf pq rerank side store use fp16 instead of float");
+DEFINE_int32(ivf_pq_rerank_factor, 4, "ivf pq rerank over fetch topk * factor candidates by pq distance");
+DECLARE_int32(vector_index_ivf_rebalance_max_split_per_round);
 
 VectorIndexRawIvfPq::VectorIndexRawIvfPq(int64_t id, const pb::common::VectorIndexParameter& vector_index_parameter,
                                          const pb::common::RegionEpoch& epoch, const pb::common::Range& range,
@@ -75,7 +84,7 @@ VectorIndexRawIvfPq::VectorIndexRawIvfPq(int64_t id, const pb::common::VectorInd
 VectorIndexRawIvfPq::~VectorIndexRawIvfPq() {}
 
 butil::Status VectorIndexRawIvfPq::AddOrUpsert(const std::vector<pb::common::VectorWithId>& vector_with_ids,
-                                               bool is_upsert) {
+                                               bool /*is_upsert*/) {
   if (vector_with_ids.empty()) {
     return butil::Status(pb::error::EILLEGAL_PARAMTETERS, "vector_with_ids is empty");
   }
@@ -93,11 +102,14 @@ butil::Status VectorIndexRawIvfPq::AddOrUpsert(const std::vector<pb::common::Vec
     return butil::Status(pb::error::Errno::EVECTOR_NOT_TRAIN, "ivf pq not train. train first");
   }
 
-  if (is_upsert) {
-    faiss::IDSelectorBatch sel(vector_with_ids.size(), ids.get());
-    index_->remove_ids(sel);
-  }
+  // Add exist id will orphan the old entry in hashtable direct map, which can't be removed by id any more,
+  // and raft apply of add not check exist id, so remove it even not upsert, it is O(batch).
+  VectorIndexUtils::RemoveIvfVectorIds(index_.get(), ids.get(), vector_with_ids.size());
   index_->add_with_ids(vector_with_ids.size(), vector_values.get(), ids.get());
+  if (rerank_index_ != nullptr) {
+    VectorIndexUtils::RemoveIdMapVectorIds(rerank_index_.get(), ids.get(), vector_with_ids.size());
+    rerank_index_->add_with_ids(vector_with_ids.size(), vector_values.get(), ids.get());
+  }
 
   return butil::Status::OK();
 }
@@ -135,7 +147,6 @@ butil::Status VectorIndexRawIvfPq::Delete(const std::vector<int64_t>& delete_ids
   }
 
   const auto& ids = VectorIndexUtils::CastVectorId(delete_ids);
-  faiss::IDSelectorBatch sel(delete_ids.size(), ids.get());
 
   {
     RWLockWriteGuard guard(&rw_lock_);
@@ -144,7 +155,10 @@ butil::Status VectorIndexRawIvfPq::Delete(const std::vector<int64_t>& delete_ids
       return butil::Status::OK();
     }
 
-    auto remove_count = index_->remove_ids(sel);
+    auto remove_count = VectorIndexUtils::RemoveIvfVectorIds(index_.get(), ids.get(), delete_ids.size());
+    if (rerank_index_ != nullptr) {
+      VectorIndexUtils::RemoveIdMapVectorIds(rerank_index_.get(), ids.get(), delete_ids.size());
+    }
     if (0 == remove_count) {
       DINGO_LOG(WARNING) << fmt::format("[vector_index.raw_ivf_pq][id({})] remove not found vector id.", Id());
       return butil::Status(pb::error::Errno::EVECTOR_INVALID, "remove not found vector id");
@@ -167,7 +181,11 @@ butil::Status VectorIndexRawIvfPq::Search(const std::vector<pb::common::VectorWi
     return status;
   }
 
-  int32_t nprobe = parameter.ivf_pq().nprobe() > 0 ? parameter.ivf_pq().nprobe() : Constant::kSearchIvfPqParamNprobe;
+  // Not specify nprobe, use the calibrated one if exist.
+  int32_t nprobe = parameter.ivf_pq().nprobe();
+  if (nprobe <= 0) {
+    nprobe = AdaptiveSearchParameter(topk) > 0 ? AdaptiveSearchParameter(topk) : Constant::kSearchIvfPqParamNprobe;
+  }
 
   std::vector<faiss::Index::distance_t> distances;
   distances.resize(topk * vector_with_ids.size(), 0.0f);
@@ -191,11 +209,21 @@ butil::Status VectorIndexRawIvfPq::Search(const std::vector<pb::common::VectorWi
     ivf_search_parameters.max_codes = 0;
     ivf_search_parameters.quantizer_params = nullptr;  // search for nlist . ignore
 
-    if (!filters.empty()) {
-      auto ivf_pq_filter = filters.empty() ? nullptr : std::make_shared<RawIvfPqIDSelector>(filters);
-      ivf_search_parameters.sel = ivf_pq_filter.get();
-      index_->search(vector_with_ids.size(), vector_values.get(), topk, distances.data(), labels.data(),
-                     &ivf_search_parameters);
+    auto ivf_pq_filter = filters.empty() ? nullptr : std::make_shared<RawIvfPqIDSelector>(filters);
+    ivf_search_parameters.sel = ivf_pq_filter.get();
+
+    if (FLAGS_ivf_pq_rerank_factor > 1 && IsRerankReady()) {
+      // Over fetch by pq distance, then rerank by exact distance.
+      size_t candidate_size = static_cast<size_t>(topk) * FLAGS_ivf_pq_rerank_factor;
+      std::vector<faiss::Index::distance_t> candidate_distances(candidate_size * vector_with_ids.size());
+      std::vector<faiss::idx_t> candidate_labels(candidate_size * vector_with_ids.size(), -1);
+      index_->search(vector_with_ids.size(), vector_values.get(), candidate_size, candidate_distances.data(),
+                     candidate_labels.data(), &ivf_search_parameters);
+
+      for (size_t row = 0; row < vector_with_ids.size(); ++row) {
+        Rerank(vector_values.get() + row * dimension_, candidate_size, candidate_labels.data() + row * candidate_size,
+               topk, distances.data() + row * topk, labels.data() + row * topk);
+      }
     } else {
       index_->search(vector_with_ids.size(), vector_values.get(), topk, distances.data(), labels.data(),
                      &ivf_search_parameters);
@@ -281,6 +309,26 @@ void VectorIndexRawIvfPq::LockWrite() { rw_lock_.LockWrite(); }
 
 void VectorIndexRawIvfPq::UnlockWrite() { rw_lock_.UnlockWrite(); }
 
+std::vector<int32_t> VectorIndexRawIvfPq::AdaptiveSearchCandidates() {
+  RWLockReadGuard guard(&rw_lock_);
+  if (!IsTrainedImpl()) {
+    return {};
+  }
+
+  int32_t nlist = static_cast<int32_t>(index_->nlist);
+  std::vector<int32_t> candidates;
+  for (int32_t nprobe = 1; nprobe < nlist; nprobe *= 2) {
+    candidates.push_back(nprobe);
+  }
+  // Search all list as ground truth.
+  candidates.push_back(nlist);
+  return candidates;
+}
+
+void VectorIndexRawIvfPq::FillAdaptiveSearchParameter(int32_t value, pb::common::VectorSearchParameter& parameter) {
+  parameter.mutable_ivf_pq()->set_nprobe(value);
+}
+
 bool VectorIndexRawIvfPq::SupportSave() { return true; }
 
 butil::Status VectorIndexRawIvfPq::Save(const std::string& path) {
@@ -295,7 +343,27 @@ butil::Status VectorIndexRawIvfPq::Save(const std::string& path) {
 
   // The outside has been locked. Remove the locking operation here.s
   try {
-    faiss::write_index(index_.get(), path.c_str());
+    VectorIndexUtils::WriteIndex(index_.get(), path);
+    if (IsRerankReady()) {
+      VectorIndexUtils::WriteIndex(rerank_index_.get(), RerankPath(path));
+    }
+  } catch (std::exception& e) {
+    return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("write index exception: {}", e.what()));
+  }
+
+  return butil::Status();
+}
+
+butil::Status VectorIndexRawIvfPq::SaveToBuffer(const std::string& path, VectorIndexSaveBuffer& save_buffer) {
+  if (path.empty()) {
+    return butil::Status(pb::error::EILLEGAL_PARAMTETERS, "path is empty");
+  }
+
+  try {
+    VectorIndexUtils::WriteIndex(index_.get(), path, save_buffer);
+    if (IsRerankReady()) {
+      VectorIndexUtils::WriteIndex(rerank_index_.get(), RerankPath(path), save_buffer);
+    }
   } catch (std::exception& e) {
     return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("write index exception: {}", e.what()));
   }
@@ -390,6 +458,26 @@ butil::Status VectorIndexRawIvfPq::Load(const std::string& path) {
 
   quantizer_.reset();
   index_ = std::move(internal_index_ivf_pq);
+  VectorIndexUtils::EnableIvfDirectMap(index_.get());
+
+  // Side store not exist or not match is rebuilt by rebuild index.
+  InitRerankIndex();
+  std::string rerank_path = RerankPath(path);
+  if (rerank_index_ != nullptr && Helper::IsExistPath(rerank_path)) {
+    try {
+      std::unique_ptr<faiss::Index> rerank_index(faiss::read_index(rerank_path.c_str(), 0));
+      auto* rerank_id_map = dynamic_cast<faiss::IndexIDMap2*>(rerank_index.get());
+      if (rerank_id_map != nullptr && rerank_id_map->d == dimension_ &&
+          rerank_id_map->metric_type == index_->metric_type && rerank_id_map->ntotal == index_->ntotal) {
+        rerank_index.release();
+        rerank_index_.reset(rerank_id_map);
+      }
+    } catch (std::exception& e) {
+      DINGO_LOG(WARNING) << fmt::format(
+          "[vector_index.raw_ivf_pq][id({})] read rerank index failed, path: {} error: {}", Id(), rerank_path,
+          e.what());
+    }
+  }
 
   train_data_size_ = index_->ntotal;
 
@@ -449,6 +537,12 @@ butil::Status VectorIndexRawIvfPq::GetMemorySize(int64_t& memory_size) {
     memory_size += precomputed_table;
   }
 
+  if (rerank_index_ != nullptr) {
+    auto* rerank_codes = dynamic_cast<faiss::IndexFlatCodes*>(rerank_index_->index);
+    size_t code_size = rerank_codes != nullptr ? rerank_codes->code_size : index_->d * sizeof(float);
+    memory_size += rerank_index_->ntotal * (code_size + sizeof(faiss::idx_t) * 2);
+  }
+
   return butil::Status::OK();
 }
 
@@ -522,9 +616,56 @@ bool VectorIndexRawIvfPq::NeedToRebuild() {
     return false;
   }
 
+  // Side store miss vectors, e.g. loaded from old snapshot, rebuild to fill it.
+  if (rerank_index_ != nullptr && rerank_index_->ntotal != index_->ntotal) {
+    return true;
+  }
+
   return (index_->ntotal / 2) >= train_data_size_;
 }
 
+bool VectorIndexRawIvfPq::NeedToRebalance() {
+  RWLockReadGuard guard(&rw_lock_);
+
+  if (BAIDU_UNLIKELY(!IsTrainedImpl() || nlist_ <= 1)) {
+    return false;
+  }
+
+  size_t largest_list_no = 0;
+  size_t smallest_list_no = 0;
+  return VectorIndexUtils::NeedToRebalanceIvf(index_.get(), largest_list_no, smallest_list_no);
+}
+
+// Split one list per write lock, so the search and write are not blocked for long time.
+butil::Status VectorIndexRawIvfPq::Rebalance() {
+  for (int i = 0; i < FLAGS_vector_index_ivf_rebalance_max_split_per_round; ++i) {
+    RWLockWriteGuard guard(&rw_lock_);
+
+    size_t largest_list_no = 0;
+    size_t smallest_list_no = 0;
+    if (BAIDU_UNLIKELY(!IsTrainedImpl() || nlist_ <= 1) ||
+        !VectorIndexUtils::NeedToRebalanceIvf(index_.get(), largest_list_no, smallest_list_no)) {
+      break;
+    }
+
+    size_t largest_list_size = index_->invlists->list_size(largest_list_no);
+    size_t smallest_list_size = index_->invlists->list_size(smallest_list_no);
+    auto status = VectorIndexUtils::RebalanceIvf(index_.get(), largest_list_no, smallest_list_no);
+    if (!status.ok()) {
+      DINGO_LOG(ERROR) << fmt::format("[vector_index.raw_ivf_pq][id({})] rebalance list({}/{}) failed, error: {}", Id(),
+                                      largest_list_no, smallest_list_no, status.error_str());
+      return status;
+    }
+
+    DINGO_LOG(INFO) << fmt::format(
+        "[vector_index.raw_ivf_pq][id({})] rebalance list({}/{}) size({}/{}) to size({}/{})", Id(), largest_list_no,
+        smallest_list_no, largest_list_size, smallest_list_size, index_->invlists->list_size(largest_list_no),
+        index_->invlists->list_size(smallest_list_no));
+  }
+
+  return butil::Status::OK();
+}
+
 bool VectorIndexRawIvfPq::IsTrained() {
   RWLockReadGuard guard(&rw_lock_);
   return IsTrainedImpl();
@@ -568,6 +709,9 @@ void VectorIndexRawIvfPq::Init() {
     index_ = std::make_unique<faiss::IndexIVFPQ>(quantizer_.get(), dimension_, nlist_, nsubvector_, nbits_per_idx_,
                                                  faiss::MetricType::METRIC_L2);
   }
+
+  VectorIndexUtils::EnableIvfDirectMap(index_.get());
+  InitRerankIndex();
 }
 
 bool VectorIndexRawIvfPq::IsTrainedImpl() {
@@ -581,6 +725,69 @@ bool VectorIndexRawIvfPq::IsTrainedImpl() {
 void VectorIndexRawIvfPq::Reset() {
   quantizer_->reset();
   index_->reset();
+  if (rerank_index_ != nullptr) {
+    rerank_index_->reset();
+  }
+}
+
+std::string VectorIndexRawIvfPq::RerankPath(const std::string& path) { return fmt::format("{}.rerank", path); }
+
+void VectorIndexRawIvfPq::InitRerankIndex() {
+  if (!FLAGS_ivf_pq_enable_rerank) {
+    rerank_index_.reset();
+    return;
+  }
+
+  faiss::Index* store_index = nullptr;
+  if (FLAGS_ivf_pq_rerank_use_fp16) {
+    store_index = new faiss::IndexScalarQuantizer(dimension_, faiss::ScalarQuantizer::QT_fp16, index_->metric_type);
+  } else {
+    store_index = new faiss::IndexFlat(dimension_, index_->metric_type);
+  }
+
+  rerank_index_ = std::make_unique<faiss::IndexIDMap2>(store_index);
+  rerank_index_->own_fields = true;
+}
+
+bool VectorIndexRawIvfPq::IsRerankReady() {
+  return rerank_index_ != nullptr && rerank_index_->ntotal == index_->ntotal;
+}
+
+void VectorIndexRawIvfPq::Rerank(const float* query, size_t candidate_size, const faiss::idx_t* candidate_labels,
+                                 uint32_t topk, faiss::Index::distance_t* distances, faiss::idx_t* labels) {
+  std::unique_ptr<faiss::DistanceComputer> distance_computer(rerank_index_->index->get_distance_computer());
+  distance_computer->set_query(query);
+
+  std::vector<std::pair<faiss::Index::distance_t, faiss::idx_t>> candidates;
+  candidates.reserve(candidate_size);
+  for (size_t i = 0; i < candidate_size; ++i) {
+    // faiss fill -1 at tail when not enough result.
+    if (candidate_labels[i] < 0) {
+      break;
+    }
+
+    auto iter = rerank_index_->rev_map.find(candidate_labels[i]);
+    if (iter != rerank_index_->rev_map.end()) {
+      candidates.emplace_back((*distance_computer)(iter->second), candidate_labels[i]);
+    }
+  }
+
+  bool is_inner_product = index_->metric_type == faiss::METRIC_INNER_PRODUCT;
+  size_t size = std::min(static_cast<size_t>(topk), candidates.size());
+  std::partial_sort(candidates.begin(), candidates.begin() + size, candidates.end(),
+                    [is_inner_product](const auto& lhs, const auto& rhs) {
+                      return is_inner_product ? lhs.first > rhs.first : lhs.first < rhs.first;
+                    });
+
+  for (size_t i = 0; i < topk; ++i) {
+    if (i < size) {
+      distances[i] = candidates[i].first;
+      labels[i] = candidates[i].second;
+    } else {
+      distances[i] = 0.0f;
+      labels[i] = -1;
+    }
+  }
 }
 
 }  // namespace dingodb
@@ -24,6 +24,7 @@
 
 #include "butil/status.h"
 #include "faiss/Index.h"
+#include "faiss/IndexIDMap.h"
 #include "faiss/MetricType.h"
 #include "faiss/impl/IDSelector.h"
 #include "faiss/utils/distances.h"
@@ -68,6 +69,7 @@ class VectorIndexRawIvfPq : public VectorIndex {
   VectorIndexRawIvfPq& operator=(VectorIndexRawIvfPq&& rhs) = delete;
 
   butil::Status Save(const std::string& path) override;
+  butil::Status SaveToBuffer(const std::string& path, VectorIndexSaveBuffer& save_buffer) override;
   butil::Status Load(const std::string& path) override;
   bool SupportSave() override;
 
@@ -104,10 +106,16 @@ class VectorIndexRawIvfPq : public VectorIndex {
   butil::Status Train(std::vector<float>& train_datas) override;
   butil::Status Train(const std::vector<pb::common::VectorWithId>& vectors) override;
   bool NeedToRebuild() override;
+  bool NeedToRebalance() override;
+  butil::Status Rebalance() override;
   bool NeedTrain() override { return true; }
   bool IsTrained() override;
   bool NeedToSave(int64_t last_save_log_behind) override;
 
+ protected:
+  std::vector<int32_t> AdaptiveSearchCandidates() override;
+  void FillAdaptiveSearchParameter(int32_t value, pb::common::VectorSearchParameter& parameter) override;
+
  private:
   void Init();
 
@@ -118,6 +126,14 @@ class VectorIndexRawIvfPq : public VectorIndex {
 
   butil::Status AddOrUpsert(const std::vector<pb::common::VectorWithId>& vector_with_ids, bool is_upsert);
 
+  static std::string RerankPath(const std::string& path);
+  void InitRerankIndex();
+  // Rerank is available only when side store hold all vectors of index.
+  bool IsRerankReady();
+  // Recompute the distance of candidates by side store, output the topk order by exact distance.
+  void Rerank(const float* query, size_t candidate_size, const faiss::idx_t* candidate_labels, uint32_t topk,
+              faiss::Index::distance_t* distances, faiss::idx_t* labels);
+
   // Dimension of the elements
   faiss::idx_t dimension_;
 
@@ -136,6 +152,10 @@ class VectorIndexRawIvfPq : public VectorIndex {
 
   std::unique_ptr<faiss::IndexIVFPQ> index_;
 
+  // Side store of vectors for rerank the pq search result, the codes is contiguous float or fp16,
+  // created at train and updated with index, nullptr means rerank disabled.
+  std::unique_ptr<faiss::IndexIDMap2> rerank_index_;
+
   // normalize vector
   bool normalize_;
 
@@ -89,6 +89,8 @@ std::string SnapshotMeta::IndexDataPath() {
   return fmt::format("{}/index_{}_{}.idx", path_, vector_index_id_, snapshot_log_id_);
 }
 
+std::string SnapshotMeta::AdaptiveSearchParameterPath() { return fmt::format("{}/adaptive_search_parameter", path_); }
+
 std::vector<std::string> SnapshotMeta::ListFileNames() { return Helper::TraverseDirectory(path_); }
 
 void SnapshotMeta::Destroy() {
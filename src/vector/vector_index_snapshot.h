@@ -44,6 +44,7 @@ class SnapshotMeta {
   std::string Path() const { return path_; }
   std::string MetaPath();
   std::string IndexDataPath();
+  std::string AdaptiveSearchParameterPath();
   std::vector<std::string> ListFileNames();
 
   pb::common::RegionEpoch Epoch() const { return epoch_; }
@@ -44,10 +44,13 @@
 #include "server/file_service.h"
 #include "server/server.h"
 #include "vector/vector_index_factory.h"
+#include "vector/vector_index_utils.h"
 
 namespace dingodb {
 
 DEFINE_bool(vector_index_snapshot_use_fork, true, "Use fork to save vector index snapshot.");
+DEFINE_bool(vector_index_snapshot_use_online_save, false,
+            "Save vector index snapshot in process without fork, write wait only while copying the index to memory.");
 
 // Get all snapshot path, except tmp dir.
 static std::vector<std::string> GetSnapshotPaths(std::string path) {
@@ -84,6 +87,32 @@ static butil::EndPoint ParseHost(const std::string& uri) {
   return endpoint;
 }
 
+// Save calibrated adaptive search parameter, so load snapshot not need to calibrate again.
+// Caution: may be called in the fork child process, can't do any DINGO_LOG.
+static bool SaveAdaptiveSearchParameter(VectorIndexPtr vector_index, const std::string& filepath) {
+  int32_t value = vector_index->CalibratedSearchParameter();
+  if (value <= 0) {
+    return true;
+  }
+
+  return Helper::SaveFile(filepath, std::to_string(value));
+}
+
+// Load calibrated adaptive search parameter, 0 means not calibrated.
+static int32_t LoadAdaptiveSearchParameter(const std::string& filepath) {
+  std::ifstream file(filepath);
+  if (!file.is_open()) {
+    return 0;
+  }
+
+  int32_t value = 0;
+  if (!(file >> value) || value < 0) {
+    return 0;
+  }
+
+  return value;
+}
+
 // Parse reader id
 static int64_t ParseReaderId(const std::string& uri) {
   std::vector<std::string> strs;
@@ -527,6 +556,10 @@ butil::Status VectorIndexSnapshotManager::SaveVectorIndexSnapshot(VectorIndexWra
     return butil::Status::OK();
   }
 
+  if (FLAGS_vector_index_snapshot_use_online_save) {
+    return SaveVectorIndexSnapshotOnline(vector_index_wrapper, vector_index, snapshot_log_index);
+  }
+
   int64_t vector_index_id = vector_index_wrapper->Id();
 
   int64_t start_time = Helper::TimestampMs();
@@ -572,6 +605,7 @@ butil::Status VectorIndexSnapshotManager::SaveVectorIndexSnapshot(VectorIndexWra
       fmt::format("{}/index_{}_{}.result", tmp_snapshot_path, vector_index_id, apply_log_index);
   std::string log_filepath = fmt::format("{}/index_{}_{}.log", tmp_snapshot_path, vector_index_id, apply_log_index);
   std::string meta_filepath = fmt::format("{}/meta", tmp_snapshot_path);
+  std::string adaptive_search_filepath = fmt::format("{}/adaptive_search_parameter", tmp_snapshot_path);
 
   DINGO_LOG(INFO) << fmt::format("[vector_index.save_snapshot][index_id({})] Save vector index to file {}",
                                  vector_index_id, index_filepath);
@@ -672,6 +706,15 @@ butil::Status VectorIndexSnapshotManager::SaveVectorIndexSnapshot(VectorIndexWra
       _exit(-1);
     }
 
+    // Write calibrated adaptive search parameter, not fatal if failed, just calibrate again after load.
+    if (!SaveAdaptiveSearchParameter(vector_index, adaptive_search_filepath)) {
+      log_file << fmt::format(
+                      "[vector_index.child_save_snapshot][index_id({})] Save adaptive search parameter failed, "
+                      "path: {}",
+                      vector_index_id, adaptive_search_filepath)
+               << '\n';
+    }
+
     // Write meta to meta_file
     pb::store_internal::VectorIndexSnapshotMeta meta;
     meta.set_vector_index_id(vector_index_id);
@@ -787,6 +830,16 @@ butil::Status VectorIndexSnapshotManager::SaveVectorIndexSnapshot(VectorIndexWra
   DINGO_LOG(INFO) << fmt::format(
       "[vector_index.save_snapshot][index_id({})] Save vector index snapshot child process success", vector_index_id);
 
+  return AddSavedSnapshot(vector_index_wrapper, tmp_snapshot_path, apply_log_index, start_time, snapshot_log_index);
+}
+
+butil::Status VectorIndexSnapshotManager::AddSavedSnapshot(VectorIndexWrapperPtr vector_index_wrapper,
+                                                           const std::string& tmp_snapshot_path,
+                                                           int64_t apply_log_index, int64_t start_time,
+                                                           int64_t& snapshot_log_index) {
+  int64_t vector_index_id = vector_index_wrapper->Id();
+  auto snapshot_set = vector_index_wrapper->SnapshotSet();
+
   // If already exist snapshot then give up.
   if (snapshot_set->IsExistSnapshot(apply_log_index)) {
     snapshot_log_index = apply_log_index;
@@ -831,6 +884,113 @@ butil::Status VectorIndexSnapshotManager::SaveVectorIndexSnapshot(VectorIndexWra
   return butil::Status::OK();
 }
 
+// Save vector index snapshot without fork.
+// 1. freeze write at the apply log id, later write wait until unfreeze.
+// 2. save vector index to memory, search is not blocked.
+// 3. unfreeze write.
+// 4. write the memory to tmp dir with save rate limit, so the throttled write not block the vector index write.
+// The vector index not support save to memory is saved to tmp dir before unfreeze.
+butil::Status VectorIndexSnapshotManager::SaveVectorIndexSnapshotOnline(VectorIndexWrapperPtr vector_index_wrapper,
+                                                                        VectorIndexPtr vector_index,
+                                                                        int64_t& snapshot_log_index) {
+  int64_t vector_index_id = vector_index_wrapper->Id();
+  int64_t start_time = Helper::TimestampMs();
+
+  int64_t apply_log_index = vector_index_wrapper->FreezeWrite();
+  if (apply_log_index < 0) {
+    DINGO_LOG(WARNING) << fmt::format(
+        "[vector_index.save_snapshot][index_id({})] vector index write already frozen, maybe other saving.",
+        vector_index_id);
+    return butil::Status(pb::error::EINTERNAL, "vector index write already frozen");
+  }
+  bool is_write_frozen = true;
+  DEFER(if (is_write_frozen) { vector_index_wrapper->UnfreezeWrite(); });
+
+  // If already exist snapshot then give up.
+  auto snapshot_set = vector_index_wrapper->SnapshotSet();
+  if (snapshot_set->IsExistSnapshot(apply_log_index)) {
+    snapshot_log_index = apply_log_index;
+    DINGO_LOG(INFO) << fmt::format(
+        "[vector_index.save_snapshot][index_id({})] VectorIndex Snapshot already exist, cannot do save, log_id: {}",
+        vector_index_id, apply_log_index);
+    return butil::Status();
+  }
+
+  // Temp snapshot path for save vector index.
+  std::string tmp_snapshot_path = GetSnapshotTmpPath(vector_index_id);
+  if (std::filesystem::exists(tmp_snapshot_path)) {
+    Helper::RemoveAllFileOrDirectory(tmp_snapshot_path);
+  }
+
+  if (!Helper::CreateDirectory(tmp_snapshot_path)) {
+    DINGO_LOG(ERROR) << fmt::format(
+        "[vector_index.save_snapshot][index_id({})] Create tmp snapshot path failed, path: {}", vector_index_id,
+        tmp_snapshot_path);
+    return butil::Status(pb::error::EINTERNAL, "Create tmp snapshot path failed");
+  }
+
+  std::string index_filepath = fmt::format("{}/index_{}_{}.idx", tmp_snapshot_path, vector_index_id, apply_log_index);
+  std::string meta_filepath = fmt::format("{}/meta", tmp_snapshot_path);
+  std::string adaptive_search_filepath = fmt::format("{}/adaptive_search_parameter", tmp_snapshot_path);
+
+  DINGO_LOG(INFO) << fmt::format("[vector_index.save_snapshot][index_id({})] Online save vector index to file {}",
+                                 vector_index_id, index_filepath);
+
+  // Write is frozen, so no need lock write, search can go on.
+  VectorIndexSaveBuffer save_buffer;
+  auto status = vector_index->SaveToBuffer(index_filepath, save_buffer);
+  if (status.error_code() == pb::error::EVECTOR_NOT_SUPPORT) {
+    status = vector_index->Save(index_filepath);
+  }
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << fmt::format("[vector_index.save_snapshot][index_id({})] Online save vector index failed, {}",
+                                    vector_index_id, Helper::PrintStatus(status));
+    Helper::RemoveAllFileOrDirectory(tmp_snapshot_path);
+    return status;
+  }
+
+  if (!SaveAdaptiveSearchParameter(vector_index, adaptive_search_filepath)) {
+    DINGO_LOG(WARNING) << fmt::format(
+        "[vector_index.save_snapshot][index_id({})] Online save adaptive search parameter failed, path: {}",
+        vector_index_id, adaptive_search_filepath);
+  }
+
+  pb::store_internal::VectorIndexSnapshotMeta meta;
+  meta.set_vector_index_id(vector_index_id);
+  meta.set_snapshot_log_id(apply_log_index);
+  *(meta.mutable_range()) = vector_index->Range();
+  *(meta.mutable_epoch()) = vector_index->Epoch();
+
+  int64_t freeze_time_ms = Helper::TimestampMs() - start_time;
+  vector_index_wrapper->UnfreezeWrite();
+  is_write_frozen = false;
+
+  status = save_buffer.Flush(VectorIndexUtils::SaveRateLimit());
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << fmt::format(
+        "[vector_index.save_snapshot][index_id({})] Online save vector index failed, flush buffer error: {}",
+        vector_index_id, Helper::PrintStatus(status));
+    Helper::RemoveAllFileOrDirectory(tmp_snapshot_path);
+    return status;
+  }
+
+  braft::ProtoBufFile pb_file_meta(meta_filepath);
+  if (pb_file_meta.save(&meta, true) != 0) {
+    DINGO_LOG(ERROR) << fmt::format(
+        "[vector_index.save_snapshot][index_id({})] Online save vector index success, save meta file failed, meta: {}",
+        vector_index_id, meta.ShortDebugString());
+    Helper::RemoveAllFileOrDirectory(tmp_snapshot_path);
+    return butil::Status(pb::error::Errno::EINTERNAL, "Save vector index failed, save meta to meta file failed");
+  }
+
+  DINGO_LOG(INFO) << fmt::format(
+      "[vector_index.save_snapshot][index_id({})] Online save vector index snapshot_{:020} elapsed(1) time {}ms "
+      "freeze time {}ms",
+      vector_index_id, apply_log_index, Helper::TimestampMs() - start_time, freeze_time_ms);
+
+  return AddSavedSnapshot(vector_index_wrapper, tmp_snapshot_path, apply_log_index, start_time, snapshot_log_index);
+}
+
 // Load vector index for already exist vector index at bootstrap.
 std::shared_ptr<VectorIndex> VectorIndexSnapshotManager::LoadVectorIndexSnapshot(
     VectorIndexWrapperPtr vector_index_wrapper, const pb::common::RegionEpoch& epoch) {
@@ -901,6 +1061,9 @@ std::shared_ptr<VectorIndex> VectorIndexSnapshotManager::LoadVectorIndexSnapshot
     return nullptr;
   }
 
+  // restore calibrated adaptive search parameter
+  vector_index->SetCalibratedSearchParameter(LoadAdaptiveSearchParameter(last_snapshot->AdaptiveSearchParameterPath()));
+
   // set vector_index apply log id
   vector_index->SetSnapshotLogId(last_snapshot->SnapshotLogId());
   vector_index->SetApplyLogId(last_snapshot->SnapshotLogId());
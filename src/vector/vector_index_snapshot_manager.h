@@ -68,6 +68,14 @@ class VectorIndexSnapshotManager {
   static std::string GetSnapshotNewPath(int64_t vector_index_id, int64_t snapshot_log_id);
   static butil::Status DownloadSnapshotFile(const std::string& uri, const pb::node::VectorIndexSnapshotMeta& meta,
                                             vector_index::SnapshotMetaSetPtr snapshot_set);
+
+  // Save vector index snapshot in process, freeze write instead of fork.
+  static butil::Status SaveVectorIndexSnapshotOnline(VectorIndexWrapperPtr vector_index_wrapper,
+                                                     VectorIndexPtr vector_index, int64_t& snapshot_log_index);
+  // Rename tmp snapshot to formal snapshot, and add to snapshot set.
+  static butil::Status AddSavedSnapshot(VectorIndexWrapperPtr vector_index_wrapper,
+                                        const std::string& tmp_snapshot_path, int64_t apply_log_index,
+                                        int64_t start_time, int64_t& snapshot_log_index);
 };
 
 }  // namespace dingodb
@@ -14,8 +14,14 @@
 
 #include "vector/vector_index_utils.h"
 
+#include <unistd.h>
+
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fstream>
 #include <memory>
 #include <set>
 #include <string>
@@ -24,9 +30,16 @@
 
 #include "butil/status.h"
 #include "common/constant.h"
+#include "common/helper.h"
 #include "common/logging.h"
 #include "coprocessor/utils.h"
+#include "faiss/Clustering.h"
+#include "faiss/IndexFlat.h"
+#include "faiss/IndexFlatCodes.h"
+#include "faiss/IndexIVFPQ.h"
 #include "faiss/MetricType.h"
+#include "faiss/impl/IDSelector.h"
+#include "faiss/index_io.h"
 #include "faiss/utils/extra_distances-inl.h"
 #include "fmt/core.h"
 #include "hnswlib/hnswlib.h"
@@ -34,16 +47,147 @@
 #include "hnswlib/space_l2.h"
 #include "proto/common.pb.h"
 #include "proto/error.pb.h"
+#include "simd/hook.h"
 
 namespace dingodb {
 
 DECLARE_bool(dingo_log_switch_scalar_speed_up_detail);
 
+DEFINE_int64(vector_index_save_rate_limit_mb, 0, "vector index save write rate limit(MB/s), 0 means no limit");
+DEFINE_int64(vector_calc_distance_block_min_pairs, 1024,
+             "calc distance by block when left x right pairs not less than it, <0 means disable");
+DEFINE_int32(vector_calc_distance_block_rows, 64, "left vector rows of per calc distance block task");
+
+DEFINE_double(vector_index_ivf_rebalance_split_ratio, 4.0,
+              "split ivf list when its size exceed average list size * ratio, <=0 means disable rebalance");
+DEFINE_double(vector_index_ivf_rebalance_merge_ratio, 0.25,
+              "merge ivf list when its size less than average list size * ratio");
+DEFINE_int64(vector_index_ivf_rebalance_min_list_size, 1024, "min size of ivf list to split");
+DEFINE_int32(vector_index_ivf_rebalance_max_split_per_round, 4, "max split ivf list count of per rebalance round");
+
+// Split big write, so the rate limit is smooth.
+static const size_t kRateLimitWriteChunkSize = 1024 * 1024;
+
+WriteRateLimiter::WriteRateLimiter(int64_t bytes_per_second)
+    : bytes_per_second_(bytes_per_second), start_time_us_(Helper::TimestampUs()) {}
+
+void WriteRateLimiter::Acquire(int64_t bytes) {
+  if (bytes_per_second_ <= 0 || bytes <= 0) {
+    return;
+  }
+
+  written_bytes_ += bytes;
+  int64_t expect_elapsed_us = written_bytes_ * 1000000 / bytes_per_second_;
+  int64_t elapsed_us = Helper::TimestampUs() - start_time_us_;
+  if (expect_elapsed_us > elapsed_us) {
+    ::usleep(expect_elapsed_us - elapsed_us);
+  }
+}
+
+RateLimitedFileIOWriter::RateLimitedFileIOWriter(const char* fname, int64_t bytes_per_second)
+    : faiss::FileIOWriter(fname), rate_limiter_(bytes_per_second) {}
+
+size_t RateLimitedFileIOWriter::operator()(const void* ptr, size_t size, size_t nitems) {
+  if (size == 0) {
+    return faiss::FileIOWriter::operator()(ptr, size, nitems);
+  }
+
+  size_t chunk_nitems = std::max(static_cast<size_t>(1), kRateLimitWriteChunkSize / size);
+  const char* data = static_cast<const char*>(ptr);
+  size_t written_nitems = 0;
+  while (written_nitems < nitems) {
+    size_t batch_nitems = std::min(chunk_nitems, nitems - written_nitems);
+    size_t ret = faiss::FileIOWriter::operator()(data + written_nitems * size, size, batch_nitems);
+    written_nitems += ret;
+    rate_limiter_.Acquire(ret * size);
+    if (ret != batch_nitems) {
+      break;
+    }
+  }
+
+  return written_nitems;
+}
+
+RateLimitedFileWriter::RateLimitedFileWriter(const std::string& path, int64_t bytes_per_second)
+    : file_(path, std::ios::binary | std::ios::trunc), rate_limiter_(bytes_per_second) {}
+
+bool RateLimitedFileWriter::Write(const char* data, size_t size) {
+  size_t offset = 0;
+  while (offset < size && file_.good()) {
+    size_t batch_size = std::min(kRateLimitWriteChunkSize, size - offset);
+    file_.write(data + offset, batch_size);
+    rate_limiter_.Acquire(batch_size);
+    offset += batch_size;
+  }
+
+  return file_.good();
+}
+
+bool RateLimitedFileWriter::Close() {
+  if (!file_.is_open()) {
+    return false;
+  }
+
+  file_.close();
+  return !file_.fail();
+}
+
+std::vector<uint8_t>& VectorIndexSaveBuffer::AddFile(const std::string& path) {
+  return files_.emplace_back(path, std::vector<uint8_t>()).second;
+}
+
+int64_t VectorIndexSaveBuffer::Size() const {
+  int64_t size = 0;
+  for (const auto& [path, data] : files_) {
+    size += data.size();
+  }
+  return size;
+}
+
+butil::Status VectorIndexSaveBuffer::Flush(int64_t bytes_per_second) {
+  for (auto& [path, data] : files_) {
+    RateLimitedFileWriter writer(path, bytes_per_second);
+    if (!writer.IsOpen()) {
+      return butil::Status(pb::error::EINTERNAL, fmt::format("open file failed, path: {}", path));
+    }
+
+    bool ok = writer.Write(reinterpret_cast<const char*>(data.data()), data.size());
+    if (!writer.Close() || !ok) {
+      return butil::Status(pb::error::EINTERNAL, fmt::format("write file failed, path: {}", path));
+    }
+
+    // release memory as early as possible
+    std::vector<uint8_t>().swap(data);
+  }
+
+  return butil::Status::OK();
+}
+
+int64_t VectorIndexUtils::SaveRateLimit() { return FLAGS_vector_index_save_rate_limit_mb * 1024 * 1024; }
+
+void VectorIndexUtils::WriteIndex(const faiss::Index* index, const std::string& path) {
+  if (SaveRateLimit() <= 0) {
+    faiss::write_index(index, path.c_str());
+    return;
+  }
+
+  RateLimitedFileIOWriter writer(path.c_str(), SaveRateLimit());
+  faiss::write_index(index, &writer);
+}
+
+void VectorIndexUtils::WriteIndex(const faiss::Index* index, const std::string& path,
+                                  VectorIndexSaveBuffer& save_buffer) {
+  faiss::VectorIOWriter writer;
+  faiss::write_index(index, &writer);
+  save_buffer.AddFile(path).swap(writer.data);
+}
+
 butil::Status VectorIndexUtils::CalcDistanceEntry(
     const ::dingodb::pb::index::VectorCalcDistanceRequest& request,
     std::vector<std::vector<float>>& distances,                             // NOLINT
     std::vector<::dingodb::pb::common::Vector>& result_op_left_vectors,     // NOLINT
-    std::vector<::dingodb::pb::common::Vector>& result_op_right_vectors) {  // NOLINT
+    std::vector<::dingodb::pb::common::Vector>& result_op_right_vectors,   // NOLINT
+    ThreadPoolPtr thread_pool) {
 
   pb::index::AlgorithmType algorithm_type = request.algorithm_type();
   pb::common::MetricType metric_type = request.metric_type();
@@ -53,6 +197,28 @@ butil::Status VectorIndexUtils::CalcDistanceEntry(
 
   bool is_return_normlize = request.is_return_normlize();
 
+  // Large distance matrix use block calc.
+  int64_t pair_count = static_cast<int64_t>(op_left_vectors.size()) * op_right_vectors.size();
+  if (FLAGS_vector_calc_distance_block_min_pairs >= 0 && pair_count >= FLAGS_vector_calc_distance_block_min_pairs &&
+      (algorithm_type == pb::index::ALGORITHM_FAISS || algorithm_type == pb::index::ALGORITHM_HNSWLIB) &&
+      (metric_type == pb::common::METRIC_TYPE_L2 || metric_type == pb::common::METRIC_TYPE_INNER_PRODUCT ||
+       metric_type == pb::common::METRIC_TYPE_COSINE)) {
+    int32_t dimension = op_left_vectors.empty() ? 0 : op_left_vectors[0].float_values_size();
+    bool is_same_dimension = dimension > 0;
+    for (const auto& vector : op_left_vectors) {
+      is_same_dimension = is_same_dimension && vector.float_values_size() == dimension;
+    }
+    for (const auto& vector : op_right_vectors) {
+      is_same_dimension = is_same_dimension && vector.float_values_size() == dimension;
+    }
+
+    if (is_same_dimension) {
+      return CalcDistanceByBlock(algorithm_type, metric_type, dimension, op_left_vectors, op_right_vectors,
+                                 is_return_normlize, distances, result_op_left_vectors, result_op_right_vectors,
+                                 thread_pool);
+    }
+  }
+
   switch (algorithm_type) {
     case pb::index::ALGORITHM_FAISS: {
       return CalcDistanceByFaiss(metric_type, op_left_vectors, op_right_vectors, is_return_normlize, distances,
@@ -74,6 +240,128 @@ butil::Status VectorIndexUtils::CalcDistanceEntry(
   return butil::Status();
 }
 
+// Decode vectors to contiguous buffer, normalize it for cosine, keep same with the pair calc.
+static void DecodeVectorForCalcDistance(
+    pb::index::AlgorithmType algorithm_type, pb::common::MetricType metric_type, int32_t dimension,
+    const google::protobuf::RepeatedPtrField<::dingodb::pb::common::Vector>& op_vectors, std::vector<float>& data) {
+  data.resize(static_cast<size_t>(op_vectors.size()) * dimension);
+  for (int i = 0; i < op_vectors.size(); ++i) {
+    float* row = data.data() + static_cast<size_t>(i) * dimension;
+    memcpy(row, op_vectors[i].float_values().data(), dimension * sizeof(float));
+    if (metric_type == pb::common::METRIC_TYPE_COSINE) {
+      if (algorithm_type == pb::index::ALGORITHM_FAISS) {
+        VectorIndexUtils::NormalizeVectorForFaiss(row, dimension);
+      } else {
+        VectorIndexUtils::NormalizeVectorForHnsw(row, dimension, row);
+      }
+    }
+  }
+}
+
+static void FillResultOpVectors(pb::common::MetricType metric_type, int32_t dimension,
+                                const google::protobuf::RepeatedPtrField<::dingodb::pb::common::Vector>& op_vectors,
+                                const std::vector<float>& data,
+                                std::vector<::dingodb::pb::common::Vector>& result_op_vectors) {
+  result_op_vectors.clear();
+  result_op_vectors.resize(op_vectors.size());
+  for (int i = 0; i < op_vectors.size(); ++i) {
+    VectorIndexUtils::ResultOpVectorAssignment(result_op_vectors[i], op_vectors[i]);
+    if (metric_type == pb::common::METRIC_TYPE_COSINE) {
+      memcpy(result_op_vectors[i].mutable_float_values()->mutable_data(),
+             data.data() + static_cast<size_t>(i) * dimension, dimension * sizeof(float));
+    }
+  }
+}
+
+butil::Status VectorIndexUtils::CalcDistanceByBlock(
+    pb::index::AlgorithmType algorithm_type, pb::common::MetricType metric_type, int32_t dimension,
+    const google::protobuf::RepeatedPtrField<::dingodb::pb::common::Vector>& op_left_vectors,
+    const google::protobuf::RepeatedPtrField<::dingodb::pb::common::Vector>& op_right_vectors, bool is_return_normlize,
+    std::vector<std::vector<float>>& distances,                          // NOLINT
+    std::vector<::dingodb::pb::common::Vector>& result_op_left_vectors,  // NOLINT
+    std::vector<::dingodb::pb::common::Vector>& result_op_right_vectors, ThreadPoolPtr thread_pool) {
+  // Right block size fit in L2 cache, so it is reused by all rows of left block.
+  static constexpr size_t kBlockBytes = 256 * 1024;
+
+  size_t left_size = op_left_vectors.size();
+  size_t right_size = op_right_vectors.size();
+
+  std::vector<float> left_data;
+  std::vector<float> right_data;
+  DecodeVectorForCalcDistance(algorithm_type, metric_type, dimension, op_left_vectors, left_data);
+  DecodeVectorForCalcDistance(algorithm_type, metric_type, dimension, op_right_vectors, right_data);
+
+  std::vector<float> left_norms;
+  std::vector<float> right_norms;
+  if (metric_type == pb::common::METRIC_TYPE_L2) {
+    left_norms.resize(left_size);
+    for (size_t i = 0; i < left_size; ++i) {
+      left_norms[i] = dingodb::fvec_norm_L2sqr(left_data.data() + i * dimension, dimension);
+    }
+    right_norms.resize(right_size);
+    for (size_t j = 0; j < right_size; ++j) {
+      right_norms[j] = dingodb::fvec_norm_L2sqr(right_data.data() + j * dimension, dimension);
+    }
+  }
+
+  distances.clear();
+  distances.resize(left_size);
+  for (auto& distance : distances) {
+    distance.resize(right_size);
+  }
+
+  size_t block_cols = std::max(kBlockBytes / (dimension * sizeof(float)), static_cast<size_t>(1));
+  size_t block_rows = std::max(FLAGS_vector_calc_distance_block_rows, 1);
+  bool is_hnsw_ip = algorithm_type == pb::index::ALGORITHM_HNSWLIB && metric_type != pb::common::METRIC_TYPE_L2;
+
+  auto calc_block_func = [&](size_t row_begin) {
+    size_t row_end = std::min(row_begin + block_rows, left_size);
+    for (size_t col_begin = 0; col_begin < right_size; col_begin += block_cols) {
+      size_t col_count = std::min(block_cols, right_size - col_begin);
+      for (size_t i = row_begin; i < row_end; ++i) {
+        dingodb::fvec_inner_products_ny(distances[i].data() + col_begin, left_data.data() + i * dimension,
+                                        right_data.data() + col_begin * dimension, dimension, col_count);
+      }
+    }
+
+    for (size_t i = row_begin; i < row_end; ++i) {
+      auto& distance = distances[i];
+      if (metric_type == pb::common::METRIC_TYPE_L2) {
+        for (size_t j = 0; j < right_size; ++j) {
+          distance[j] = std::max(left_norms[i] + right_norms[j] - 2 * distance[j], 0.0f);
+        }
+      } else if (is_hnsw_ip) {
+        for (size_t j = 0; j < right_size; ++j) {
+          distance[j] = 1.0f - distance[j];
+        }
+      }
+    }
+  };
+
+  std::vector<ThreadPool::TaskPtr> tasks;
+  for (size_t row_begin = 0; row_begin < left_size; row_begin += block_rows) {
+    ThreadPool::TaskPtr task;
+    if (thread_pool != nullptr && left_size > block_rows) {
+      task = thread_pool->ExecuteTask([&, row_begin](void*) { calc_block_func(row_begin); }, nullptr);
+    }
+    if (task != nullptr) {
+      tasks.push_back(task);
+    } else {
+      calc_block_func(row_begin);
+    }
+  }
+  for (auto& task : tasks) {
+    task->Join();
+  }
+
+  if (is_return_normlize) {
+    FillResultOpVectors(metric_type, dimension, op_left_vectors, left_data, result_op_left_vectors);
+    FillResultOpVectors(metric_type, dimension, op_right_vectors, right_data, result_op_right_vectors);
+  }
+
+  return butil::Status();
+}
+
 butil::Status VectorIndexUtils::CalcDistanceCore(
     const google::protobuf::RepeatedPtrField<::dingodb::pb::common::Vector>& op_left_vectors,
     const google::protobuf::RepeatedPtrField<::dingodb::pb::common::Vector>& op_right_vectors, bool is_return_normlize,
@@ -445,6 +733,206 @@ std::unique_ptr<faiss::idx_t[]> VectorIndexUtils::CastVectorId(const std::vector
   return std::move(ids);
 }
 
+void VectorIndexUtils::EnableIvfDirectMap(faiss::IndexIVF* index) {
+  if (index == nullptr || index->direct_map.type == faiss::DirectMap::Hashtable) {
+    return;
+  }
+
+  index->set_direct_map_type(faiss::DirectMap::Hashtable);
+}
+
+size_t VectorIndexUtils::RemoveIvfVectorIds(faiss::IndexIVF* index, const faiss::idx_t* ids, size_t size) {
+  if (index->direct_map.type == faiss::DirectMap::Hashtable) {
+    // Hashtable direct map only support IDSelectorArray, the removed entry is swapped with the last entry of list.
+    faiss::IDSelectorArray sel(size, ids);
+    return index->remove_ids(sel);
+  }
+
+  faiss::IDSelectorBatch sel(size, ids);
+  return index->remove_ids(sel);
+}
+
+size_t VectorIndexUtils::RemoveIdMapVectorIds(faiss::IndexIDMap2* index, const faiss::idx_t* ids, size_t size) {
+  auto* flat_index = dynamic_cast<faiss::IndexFlatCodes*>(index->index);
+  if (BAIDU_UNLIKELY(flat_index == nullptr)) {
+    faiss::IDSelectorBatch sel(size, ids);
+    return index->remove_ids(sel);
+  }
+
+  auto& id_map = index->id_map;
+  auto& rev_map = index->rev_map;
+  size_t code_size = flat_index->code_size;
+  uint8_t* codes = flat_index->codes.data();
+
+  // Fill the hole with the last vector, so only touch the removed slots,
+  // IndexIDMap2::remove_ids scan and compact the whole codes and id_map.
+  size_t remove_count = 0;
+  for (size_t i = 0; i < size; ++i) {
+    auto iter = rev_map.find(ids[i]);
+    if (iter == rev_map.end()) {
+      continue;
+    }
+
+    faiss::idx_t offset = iter->second;
+    faiss::idx_t last = flat_index->ntotal - 1;
+    rev_map.erase(iter);
+    if (offset < last) {
+      memcpy(codes + offset * code_size, codes + last * code_size, code_size);
+      id_map[offset] = id_map[last];
+      rev_map[id_map[offset]] = offset;
+    }
+    id_map.pop_back();
+    --flat_index->ntotal;
+    ++remove_count;
+  }
+
+  flat_index->codes.resize(flat_index->ntotal * code_size);
+  index->ntotal = flat_index->ntotal;
+
+  return remove_count;
+}
+
+bool VectorIndexUtils::NeedToRebalanceIvf(const faiss::IndexIVF* index, size_t& largest_list_no,
+                                          size_t& smallest_list_no) {
+  if (FLAGS_vector_index_ivf_rebalance_split_ratio <= 0 || index == nullptr || index->invlists == nullptr ||
+      index->nlist <= 1 || index->ntotal <= 0) {
+    return false;
+  }
+
+  size_t largest_size = 0;
+  size_t smallest_size = SIZE_MAX;
+  for (size_t list_no = 0; list_no < index->nlist; ++list_no) {
+    size_t size = index->invlists->list_size(list_no);
+    if (size > largest_size) {
+      largest_size = size;
+      largest_list_no = list_no;
+    }
+    if (size < smallest_size) {
+      smallest_size = size;
+      smallest_list_no = list_no;
+    }
+  }
+
+  double average_size = static_cast<double>(index->ntotal) / index->nlist;
+  return largest_size >= FLAGS_vector_index_ivf_rebalance_min_list_size &&
+         largest_size > average_size * FLAGS_vector_index_ivf_rebalance_split_ratio &&
+         smallest_size < average_size * FLAGS_vector_index_ivf_rebalance_merge_ratio;
+}
+
+// Get ids and vectors of ivf list, must be called before centroid change, the residual code depend on it.
+static void ReconstructIvfList(const faiss::IndexIVF* index, size_t list_no, std::vector<faiss::idx_t>& ids,
+                               std::vector<float>& vectors) {
+  size_t size = index->invlists->list_size(list_no);
+  ids.resize(size);
+  vectors.resize(size * index->d);
+
+  faiss::InvertedLists::ScopedIds list_ids(index->invlists, list_no);
+  for (size_t offset = 0; offset < size; ++offset) {
+    ids[offset] = list_ids[offset];
+    index->reconstruct_from_offset(list_no, offset, vectors.data() + offset * index->d);
+  }
+}
+
+butil::Status VectorIndexUtils::RebalanceIvf(faiss::IndexIVF* index, size_t largest_list_no, size_t smallest_list_no) {
+  auto* quantizer = dynamic_cast<faiss::IndexFlat*>(index->quantizer);
+  if (quantizer == nullptr || index->direct_map.type == faiss::DirectMap::Array) {
+    return butil::Status(pb::error::EVECTOR_NOT_SUPPORT, "not support rebalance ivf");
+  }
+  if (largest_list_no == smallest_list_no) {
+    return butil::Status::OK();
+  }
+
+  size_t dimension = index->d;
+  auto* invlists = index->invlists;
+
+  std::vector<faiss::idx_t> large_ids;
+  std::vector<float> large_vectors;
+  std::vector<faiss::idx_t> small_ids;
+  std::vector<float> small_vectors;
+  std::vector<float> centroids(2 * dimension);
+  try {
+    ReconstructIvfList(index, largest_list_no, large_ids, large_vectors);
+    ReconstructIvfList(index, smallest_list_no, small_ids, small_vectors);
+    if (large_ids.size() < 2) {
+      return butil::Status::OK();
+    }
+
+    // kmeans subsample the points, so it is cheap.
+    faiss::kmeans_clustering(dimension, large_ids.size(), 2, large_vectors.data(), centroids.data());
+  } catch (std::exception& e) {
+    return butil::Status(pb::error::EINTERNAL, "rebalance ivf list failed, %s", e.what());
+  }
+
+  float* centroid_data = quantizer->get_xb();
+  float* large_centroid = centroid_data + largest_list_no * dimension;
+  float* small_centroid = centroid_data + smallest_list_no * dimension;
+  bool is_inner_product = index->metric_type == faiss::METRIC_INNER_PRODUCT;
+  if (is_inner_product) {
+    // Keep the centroid norm, inner product quantizer is sensitive to it.
+    float origin_norm = std::sqrt(dingodb::fvec_norm_L2sqr(large_centroid, dimension));
+    for (int i = 0; i < 2; ++i) {
+      float* centroid = centroids.data() + i * dimension;
+      float norm = std::sqrt(dingodb::fvec_norm_L2sqr(centroid, dimension));
+      if (norm > 0) {
+        for (size_t j = 0; j < dimension; ++j) {
+          centroid[j] *= origin_norm / norm;
+        }
+      }
+    }
+  }
+  std::vector<float> origin_centroids(large_centroid, large_centroid + dimension);
+  origin_centroids.insert(origin_centroids.end(), small_centroid, small_centroid + dimension);
+  memcpy(large_centroid, centroids.data(), dimension * sizeof(float));
+  memcpy(small_centroid, centroids.data() + dimension, dimension * sizeof(float));
+
+  auto* ivf_pq = dynamic_cast<faiss::IndexIVFPQ*>(index);
+
+  // Members of the split list only choose between the two new centroids,
+  // members of the tiny list go to the nearest centroid.
+  size_t large_size = large_ids.size();
+  size_t total_size = large_size + small_ids.size();
+  std::vector<faiss::idx_t> list_nos(total_size);
+  for (size_t i = 0; i < large_size; ++i) {
+    const float* vector = large_vectors.data() + i * dimension;
+    bool is_large = is_inner_product ? dingodb::fvec_inner_product(vector, large_centroid, dimension) >=
+                                           dingodb::fvec_inner_product(vector, small_centroid, dimension)
+                                     : dingodb::fvec_L2sqr(vector, large_centroid, dimension) <=
+                                           dingodb::fvec_L2sqr(vector, small_centroid, dimension);
+    list_nos[i] = is_large ? largest_list_no : smallest_list_no;
+  }
+
+  large_ids.insert(large_ids.end(), small_ids.begin(), small_ids.end());
+  large_vectors.insert(large_vectors.end(), small_vectors.begin(), small_vectors.end());
+
+  std::vector<uint8_t> codes(total_size * index->code_size);
+  try {
+    if (!small_ids.empty()) {
+      quantizer->assign(small_ids.size(), small_vectors.data(), list_nos.data() + large_size);
+    }
+    if (ivf_pq != nullptr && ivf_pq->by_residual) {
+      ivf_pq->precompute_table();
+    }
+    index->encode_vectors(total_size, large_vectors.data(), list_nos.data(), codes.data());
+  } catch (std::exception& e) {
+    // Restore centroids, the lists are not changed yet.
+    memcpy(large_centroid, origin_centroids.data(), dimension * sizeof(float));
+    memcpy(small_centroid, origin_centroids.data() + dimension, dimension * sizeof(float));
+    if (ivf_pq != nullptr && ivf_pq->by_residual) {
+      ivf_pq->precompute_table();
+    }
+    return butil::Status(pb::error::EINTERNAL, "rebalance ivf list failed, %s", e.what());
+  }
+
+  invlists->resize(largest_list_no, 0);
+  invlists->resize(smallest_list_no, 0);
+  for (size_t i = 0; i < total_size; ++i) {
+    size_t offset = invlists->add_entry(list_nos[i], large_ids[i], codes.data() + i * index->code_size);
+    index->direct_map.add_single_pointer(large_ids[i], list_nos[i], offset);
+  }
+
+  return butil::Status::OK();
+}
+
 std::unique_ptr<faiss::idx_t[]> VectorIndexUtils::ExtractVectorId(
     const std::vector<pb::common::VectorWithId>& vector_with_ids) {
   std::unique_ptr<faiss::idx_t[]> ids = std::make_unique<faiss::idx_t[]>(vector_with_ids.size());
@@ -545,6 +1033,27 @@ butil::Status VectorIndexUtils::FillRangeSearchResult(
   return butil::Status::OK();
 }
 
+butil::Status VectorIndexUtils::FillRangeSearchHits(
+    const std::unique_ptr<faiss::RangeSearchResult>& range_search_result, pb::common::MetricType metric_type,
+    std::vector<std::vector<VectorIndex::RangeSearchHit>>& hits) {
+  bool is_inner_product = metric_type == pb::common::MetricType::METRIC_TYPE_COSINE ||
+                          metric_type == pb::common::MetricType::METRIC_TYPE_INNER_PRODUCT;
+
+  hits.resize(range_search_result->nq);
+  for (size_t row = 0; row < range_search_result->nq; ++row) {
+    auto& row_hits = hits[row];
+    size_t begin = range_search_result->lims[row];
+    size_t end = range_search_result->lims[row + 1];
+    row_hits.reserve(end - begin);
+    for (size_t i = begin; i < end; ++i) {
+      float distance = range_search_result->distances[i];
+      row_hits.push_back({range_search_result->labels[i], is_inner_product ? 1.0F - distance : distance});
+    }
+  }
+
+  return butil::Status::OK();
+}
+
 butil::Status VectorIndexUtils::CheckVectorIndexParameterCompatibility(const pb::common::VectorIndexParameter& source,
                                                                        const pb::common::VectorIndexParameter& target) {
   if (source.vector_index_type() != target.vector_index_type()) {
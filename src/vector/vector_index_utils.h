@@ -16,18 +16,86 @@
 #define DINGODB_VECTOR_INDEX_UTILS_H_
 
 #include <cstdint>
+#include <fstream>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include "butil/status.h"
 #include "faiss/Index.h"
+#include "faiss/IndexIDMap.h"
+#include "faiss/IndexIVF.h"
 #include "faiss/impl/AuxIndexStructures.h"
+#include "faiss/impl/io.h"
 #include "proto/common.pb.h"
 #include "proto/index.pb.h"
+#include "vector/vector_index.h"
 
 namespace dingodb {
 
+// Limit the write throughput of saving vector index, sleep when write faster than the limit.
+// Not use bthread_usleep, the saving maybe in the fork child process.
+class WriteRateLimiter {
+ public:
+  // bytes_per_second <= 0 means no limit.
+  explicit WriteRateLimiter(int64_t bytes_per_second);
+  ~WriteRateLimiter() = default;
+
+  void Acquire(int64_t bytes);
+
+ private:
+  int64_t bytes_per_second_;
+  int64_t start_time_us_;
+  int64_t written_bytes_{0};
+};
+
+// faiss file writer with write rate limit.
+class RateLimitedFileIOWriter : public faiss::FileIOWriter {
+ public:
+  RateLimitedFileIOWriter(const char* fname, int64_t bytes_per_second);
+
+  size_t operator()(const void* ptr, size_t size, size_t nitems) override;
+
+ private:
+  WriteRateLimiter rate_limiter_;
+};
+
+// File writer with write rate limit, for the index not written by faiss IOWriter, e.g. hnsw.
+class RateLimitedFileWriter {
+ public:
+  RateLimitedFileWriter(const std::string& path, int64_t bytes_per_second);
+  ~RateLimitedFileWriter() = default;
+
+  bool IsOpen() const { return file_.is_open(); }
+  bool Write(const char* data, size_t size);
+  // Return false if any write failed.
+  bool Close();
+
+ private:
+  std::ofstream file_;
+  WriteRateLimiter rate_limiter_;
+};
+
+// In-memory image of the files of a vector index, taken in a short write freeze and flushed to disk
+// with write rate limit after the freeze, so the throttled disk write not block the write of vector index.
+class VectorIndexSaveBuffer {
+ public:
+  VectorIndexSaveBuffer() = default;
+  ~VectorIndexSaveBuffer() = default;
+
+  VectorIndexSaveBuffer(const VectorIndexSaveBuffer&) = delete;
+  VectorIndexSaveBuffer& operator=(const VectorIndexSaveBuffer&) = delete;
+
+  std::vector<uint8_t>& AddFile(const std::string& path);
+  int64_t Size() const;
+
+  butil::Status Flush(int64_t bytes_per_second);
+
+ private:
+  std::vector<std::pair<std::string, std::vector<uint8_t>>> files_;
+};
+
 class VectorIndexUtils {
  public:
   VectorIndexUtils() = delete;
@@ -38,10 +106,29 @@ class VectorIndexUtils {
   VectorIndexUtils(VectorIndexUtils&& rhs) = delete;
   VectorIndexUtils& operator=(VectorIndexUtils&& rhs) = delete;
 
+  // Save rate limit from FLAGS_vector_index_save_rate_limit_mb, unit is byte per second.
+  static int64_t SaveRateLimit();
+  // Write faiss index to file with save rate limit, throw exception like faiss::write_index.
+  static void WriteIndex(const faiss::Index* index, const std::string& path);
+  // Write faiss index to the save buffer as the file of path.
+  static void WriteIndex(const faiss::Index* index, const std::string& path, VectorIndexSaveBuffer& save_buffer);
+
   static butil::Status CalcDistanceEntry(const ::dingodb::pb::index::VectorCalcDistanceRequest& request,
                                          std::vector<std::vector<float>>& distances,
                                          std::vector<::dingodb::pb::common::Vector>& result_op_left_vectors,
-                                         std::vector<::dingodb::pb::common::Vector>& result_op_right_vectors);
+                                         std::vector<::dingodb::pb::common::Vector>& result_op_right_vectors,
+                                         ThreadPoolPtr thread_pool = nullptr);
+
+  // Many to many distance, decode vectors into contiguous buffer once, then compute inner product by
+  // left block x right block which fit in cache, l2 is derived from precomputed norms.
+  // All vectors must be same dimension, the left blocks are computed in thread pool if set.
+  static butil::Status CalcDistanceByBlock(
+      pb::index::AlgorithmType algorithm_type, pb::common::MetricType metric_type, int32_t dimension,
+      const google::protobuf::RepeatedPtrField<::dingodb::pb::common::Vector>& op_left_vectors,
+      const google::protobuf::RepeatedPtrField<::dingodb::pb::common::Vector>& op_right_vectors,
+      bool is_return_normlize, std::vector<std::vector<float>>& distances,
+      std::vector<::dingodb::pb::common::Vector>& result_op_left_vectors,
+      std::vector<::dingodb::pb::common::Vector>& result_op_right_vectors, ThreadPoolPtr thread_pool);
 
   using DoCalcDistanceFunc =
       std::function<butil::Status(const ::dingodb::pb::common::Vector&, const ::dingodb::pb::common::Vector&, bool,
@@ -165,6 +252,21 @@ class VectorIndexUtils {
 
   static std::unique_ptr<faiss::idx_t[]> CastVectorId(const std::vector<int64_t>& delete_ids);
 
+  // Maintain id to (list, offset) hashtable in ivf index, so remove only touch the hit list entries
+  // instead of scan all inverted lists. The index loaded from old file without direct map is rebuilt once.
+  static void EnableIvfDirectMap(faiss::IndexIVF* index);
+  // Remove ids from ivf index, return the removed count.
+  static size_t RemoveIvfVectorIds(faiss::IndexIVF* index, const faiss::idx_t* ids, size_t size);
+  // Remove ids from id map of flat codes index in O(batch), fill the hole with the last vector,
+  // return the removed count.
+  static size_t RemoveIdMapVectorIds(faiss::IndexIDMap2* index, const faiss::idx_t* ids, size_t size);
+
+  // Rebalance ivf inverted lists online and keep nlist unchanged, instead of retrain and rebuild.
+  // The oversized list is split by local 2-means on its members, the second centroid take the slot of the tiny list,
+  // whose members are reassigned to the nearest centroids, only vectors of the two lists are touched.
+  static bool NeedToRebalanceIvf(const faiss::IndexIVF* index, size_t& largest_list_no, size_t& smallest_list_no);
+  static butil::Status RebalanceIvf(faiss::IndexIVF* index, size_t largest_list_no, size_t smallest_list_no);
+
   static std::unique_ptr<faiss::idx_t[]> ExtractVectorId(const std::vector<pb::common::VectorWithId>& vector_with_ids);
   static butil::Status CheckVectorIdDuplicated(const std::unique_ptr<faiss::idx_t[]>& ids, size_t size);
 
@@ -180,6 +282,9 @@ class VectorIndexUtils {
   static butil::Status FillRangeSearchResult(const std::unique_ptr<faiss::RangeSearchResult>& range_search_result,
                                              pb::common::MetricType metric_type, faiss::idx_t dimension,
                                              std::vector<pb::index::VectorWithDistanceResult>& results);
+  static butil::Status FillRangeSearchHits(const std::unique_ptr<faiss::RangeSearchResult>& range_search_result,
+                                           pb::common::MetricType metric_type,
+                                           std::vector<std::vector<VectorIndex::RangeSearchHit>>& hits);
   static butil::Status CheckVectorIndexParameterCompatibility(const pb::common::VectorIndexParameter& source,
                                                               const pb::common::VectorIndexParameter& target);
   static butil::Status ValidateVectorIndexParameter(const pb::common::VectorIndexParameter& vector_index_parameter);
@@ -0,0 +1,273 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "vector/vector_range_search_cursor.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "bthread/mutex.h"
+#include "common/helper.h"
+#include "common/logging.h"
+#include "common/synchronization.h"
+#include "fmt/core.h"
+#include "gflags/gflags.h"
+#include "proto/error.pb.h"
+
+namespace dingodb {
+
+DEFINE_int64(vector_range_search_cursor_timeout_s, 60, "vector range search cursor idle timeout");
+DEFINE_int64(vector_range_search_cursor_max_hit_count, 100 * 1000,
+             "vector range search cursor max hit count of one chunk, for bound memory of one cursor, "
+             "the query vector with more hits is paged chunk by chunk");
+DEFINE_uint32(vector_range_search_cursor_max_page_size, 4096, "vector range search cursor max page size");
+DEFINE_int64(vector_range_search_cursor_clean_interval_s, 30, "vector range search cursor clean interval");
+
+VectorRangeSearchCursor::VectorRangeSearchCursor(int64_t id, int64_t region_id, pb::common::MetricType metric_type,
+                                                 int64_t timeout_ms)
+    : id_(id),
+      region_id_(region_id),
+      metric_type_(metric_type),
+      timeout_ms_(timeout_ms),
+      last_access_time_ms_(Helper::TimestampMs()) {
+  bthread_mutex_init(&mutex_, nullptr);
+}
+
+VectorRangeSearchCursor::~VectorRangeSearchCursor() { bthread_mutex_destroy(&mutex_); }
+
+void VectorRangeSearchCursor::SetHitLoader(size_t row_count, HitLoader loader) {
+  BAIDU_SCOPED_LOCK(mutex_);
+
+  row_count_ = row_count;
+  loader_ = std::move(loader);
+  chunk_ = HitChunk();
+  is_chunk_loaded_ = false;
+  hit_count_ = 0;
+  fetched_count_ = 0;
+  row_ = 0;
+  offset_ = 0;
+  last_access_time_ms_ = Helper::TimestampMs();
+}
+
+int64_t VectorRangeSearchCursor::HitCount() {
+  BAIDU_SCOPED_LOCK(mutex_);
+  return hit_count_;
+}
+
+int64_t VectorRangeSearchCursor::RemainHitCount() {
+  BAIDU_SCOPED_LOCK(mutex_);
+  return hit_count_ - fetched_count_;
+}
+
+butil::Status VectorRangeSearchCursor::NextPage(uint32_t page_size,
+                                                std::vector<pb::index::VectorWithDistanceResult>& results,
+                                                bool& has_more) {
+  BAIDU_SCOPED_LOCK(mutex_);
+
+  last_access_time_ms_ = Helper::TimestampMs();
+
+  page_size = std::max(page_size, static_cast<uint32_t>(1));
+  page_size = std::min(page_size, FLAGS_vector_range_search_cursor_max_page_size);
+
+  results.clear();
+  results.resize(row_count_);
+
+  uint32_t count = 0;
+  while (row_ < row_count_ && count < page_size) {
+    if (!is_chunk_loaded_) {
+      auto status = loader_(row_, chunk_);
+      if (!status.ok()) {
+        DINGO_LOG(ERROR) << fmt::format(
+            "[vector_range_search_cursor][id({})][region({})] load row({}) hits failed, error: {}", id_, region_id_,
+            row_, status.error_str());
+        return status;
+      }
+      is_chunk_loaded_ = true;
+      hit_count_ += chunk_.hits.size();
+    }
+
+    if (offset_ >= chunk_.hits.size()) {
+      // Free fetched chunk as soon as possible, the next chunk of the row start after chunk_.last.
+      std::vector<VectorIndex::RangeSearchHit>().swap(chunk_.hits);
+      if (chunk_.is_row_end) {
+        chunk_ = HitChunk();
+        ++row_;
+      }
+      is_chunk_loaded_ = false;
+      offset_ = 0;
+      continue;
+    }
+
+    auto& result = results[row_];
+    for (; offset_ < chunk_.hits.size() && count < page_size; ++offset_, ++count) {
+      auto* vector_with_distance = result.add_vector_with_distances();
+      vector_with_distance->mutable_vector_with_id()->set_id(chunk_.hits[offset_].id);
+      vector_with_distance->set_distance(chunk_.hits[offset_].distance);
+      vector_with_distance->set_metric_type(metric_type_);
+    }
+  }
+
+  fetched_count_ += count;
+
+  // The page is full at the end of a chunk, more hits is unknown until next chunk is loaded.
+  has_more = row_ < row_count_;
+  if (has_more && is_chunk_loaded_ && offset_ >= chunk_.hits.size() && chunk_.is_row_end && row_ + 1 == row_count_) {
+    has_more = false;
+  }
+
+  return butil::Status::OK();
+}
+
+void VectorRangeSearchCursor::CutChunk(std::vector<VectorIndex::RangeSearchHit>& hits, HitChunk& chunk) {
+  if (chunk.has_last) {
+    const auto& last = chunk.last;
+    hits.erase(std::remove_if(hits.begin(), hits.end(),
+                              [&last](const VectorIndex::RangeSearchHit& hit) { return !(last < hit); }),
+               hits.end());
+  }
+
+  size_t limit = std::max(FLAGS_vector_range_search_cursor_max_hit_count, static_cast<int64_t>(1));
+  chunk.is_row_end = hits.size() <= limit;
+  if (!chunk.is_row_end) {
+    std::nth_element(hits.begin(), hits.begin() + limit, hits.end());
+    hits.resize(limit);
+  }
+  std::sort(hits.begin(), hits.end());
+
+  if (!hits.empty()) {
+    chunk.has_last = true;
+    chunk.last = hits.back();
+  }
+}
+
+void VectorRangeSearchCursor::Release() {
+  BAIDU_SCOPED_LOCK(mutex_);
+  is_released_ = true;
+}
+
+bool VectorRangeSearchCursor::IsRecyclable() {
+  BAIDU_SCOPED_LOCK(mutex_);
+  if (is_released_) {
+    return true;
+  }
+
+  int64_t idle_time_ms = Helper::TimestampMs() - last_access_time_ms_;
+  if (idle_time_ms >= timeout_ms_) {
+    DINGO_LOG(INFO) << fmt::format(
+        "[vector_range_search_cursor][id({})][region({})] cursor timeout, idle_time({}ms) remain_hit_count({})", id_,
+        region_id_, idle_time_ms, hit_count_ - fetched_count_);
+    return true;
+  }
+
+  return false;
+}
+
+VectorRangeSearchCursorManager::VectorRangeSearchCursorManager()
+    : bvar_cursor_running_num_("dingo_vector_range_search_cursor_running_num"),
+      bvar_cursor_total_num_("dingo_vector_range_search_cursor_total_num") {
+  bthread_mutex_init(&mutex_, nullptr);
+}
+
+VectorRangeSearchCursorManager::~VectorRangeSearchCursorManager() {
+  alive_cursors_.clear();
+  bthread_mutex_destroy(&mutex_);
+}
+
+VectorRangeSearchCursorManager& VectorRangeSearchCursorManager::GetInstance() {
+  static VectorRangeSearchCursorManager instance;
+  return instance;
+}
+
+VectorRangeSearchCursorPtr VectorRangeSearchCursorManager::CreateCursor(int64_t region_id,
+                                                                        pb::common::MetricType metric_type) {
+  int64_t cursor_id = next_cursor_id_.fetch_add(1, std::memory_order_relaxed);
+  auto cursor = VectorRangeSearchCursor::New(cursor_id, region_id, metric_type,
+                                             FLAGS_vector_range_search_cursor_timeout_s * 1000);
+
+  BAIDU_SCOPED_LOCK(mutex_);
+  alive_cursors_[cursor_id] = cursor;
+  bvar_cursor_running_num_ << 1;
+  bvar_cursor_total_num_ << 1;
+
+  return cursor;
+}
+
+VectorRangeSearchCursorPtr VectorRangeSearchCursorManager::FindCursor(int64_t cursor_id) {
+  BAIDU_SCOPED_LOCK(mutex_);
+  auto iter = alive_cursors_.find(cursor_id);
+  return iter != alive_cursors_.end() ? iter->second : nullptr;
+}
+
+void VectorRangeSearchCursorManager::DeleteCursor(int64_t cursor_id) {
+  VectorRangeSearchCursorPtr cursor;
+  {
+    BAIDU_SCOPED_LOCK(mutex_);
+    auto iter = alive_cursors_.find(cursor_id);
+    if (iter == alive_cursors_.end()) {
+      return;
+    }
+    cursor = iter->second;
+    alive_cursors_.erase(iter);
+    bvar_cursor_running_num_ << -1;
+  }
+
+  // Destroy cursor out of lock, the hits maybe large.
+  cursor->Release();
+}
+
+void VectorRangeSearchCursorManager::TryDeleteCursor(int64_t cursor_id) {
+  auto cursor = FindCursor(cursor_id);
+  if (cursor != nullptr && cursor->IsRecyclable()) {
+    DeleteCursor(cursor_id);
+  }
+}
+
+int64_t VectorRangeSearchCursorManager::CursorCount() {
+  BAIDU_SCOPED_LOCK(mutex_);
+  return alive_cursors_.size();
+}
+
+void VectorRangeSearchCursorManager::RegularCleaningHandler(void* /*arg*/) {
+  static std::atomic<bool> g_vector_range_search_cursor_cleaning_running(false);
+
+  if (g_vector_range_search_cursor_cleaning_running.load(std::memory_order_relaxed)) {
+    DINGO_LOG(INFO) << "[vector_range_search_cursor] regular cleaning is running, return";
+    return;
+  }
+
+  AtomicGuard guard(g_vector_range_search_cursor_cleaning_running);
+
+  auto& manager = VectorRangeSearchCursorManager::GetInstance();
+
+  std::vector<VectorRangeSearchCursorPtr> waiting_destroyed_cursors;
+  {
+    BAIDU_SCOPED_LOCK(manager.mutex_);
+    for (auto iter = manager.alive_cursors_.begin(); iter != manager.alive_cursors_.end();) {
+      if (iter->second->IsRecyclable()) {
+        waiting_destroyed_cursors.push_back(iter->second);
+        iter = manager.alive_cursors_.erase(iter);
+        manager.bvar_cursor_running_num_ << -1;
+      } else {
+        ++iter;
+      }
+    }
+  }
+
+  // Free cursor out of lock.
+  waiting_destroyed_cursors.clear();
+}
+
+}  // namespace dingodb
@@ -0,0 +1,141 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGODB_VECTOR_RANGE_SEARCH_CURSOR_H_  // NOLINT
+#define DINGODB_VECTOR_RANGE_SEARCH_CURSOR_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "bthread/types.h"
+#include "butil/status.h"
+#include "bvar/bvar.h"
+#include "proto/common.pb.h"
+#include "proto/index.pb.h"
+#include "vector/vector_index.h"
+
+namespace dingodb {
+
+class VectorRangeSearchCursor;
+using VectorRangeSearchCursorPtr = std::shared_ptr<VectorRangeSearchCursor>;
+
+// Range search cursor page out the compact hit(id and distance) of query vectors by NextPage.
+// The hits of one query vector is loaded lazily chunk by chunk when the page reach it, so only one chunk is held,
+// and only the page is materialized as protobuf.
+class VectorRangeSearchCursor {
+ public:
+  VectorRangeSearchCursor(int64_t id, int64_t region_id, pb::common::MetricType metric_type, int64_t timeout_ms);
+  ~VectorRangeSearchCursor();
+
+  VectorRangeSearchCursor(const VectorRangeSearchCursor&) = delete;
+  VectorRangeSearchCursor& operator=(const VectorRangeSearchCursor&) = delete;
+
+  static VectorRangeSearchCursorPtr New(int64_t id, int64_t region_id, pb::common::MetricType metric_type,
+                                        int64_t timeout_ms) {
+    return std::make_shared<VectorRangeSearchCursor>(id, region_id, metric_type, timeout_ms);
+  }
+
+  int64_t Id() const { return id_; }
+  int64_t RegionId() const { return region_id_; }
+
+  // A chunk of the hits of one query vector, the hits are ordered by (distance, id).
+  struct HitChunk {
+    std::vector<VectorIndex::RangeSearchHit> hits;
+    // Last hit of the chunk before post filter, the next chunk start after it.
+    bool has_last{false};
+    VectorIndex::RangeSearchHit last{0, 0.0F};
+    // No more hits of the query vector after this chunk.
+    bool is_row_end{false};
+  };
+
+  // Load the next chunk of the row-th query vector, which start after chunk.last of the previous chunk.
+  using HitLoader = std::function<butil::Status(size_t row, HitChunk& chunk)>;
+
+  // Cut the hits of one query vector to the next chunk, keep the first vector_range_search_cursor_max_hit_count
+  // hits after chunk.last of the previous chunk, and update chunk.last and chunk.is_row_end.
+  static void CutChunk(std::vector<VectorIndex::RangeSearchHit>& hits, HitChunk& chunk);
+
+  void SetHitLoader(size_t row_count, HitLoader loader);
+  // Hit count of the loaded chunks.
+  int64_t HitCount();
+  int64_t RemainHitCount();
+
+  // Fetch at most page_size hits, results size is equal to query vector count,
+  // every result only contain the hits of this page. has_more is whether has more hits.
+  butil::Status NextPage(uint32_t page_size, std::vector<pb::index::VectorWithDistanceResult>& results,
+                         bool& has_more);
+
+  // Mark released, then it is recycled by manager.
+  void Release();
+  bool IsRecyclable();
+
+ private:
+  int64_t id_;
+  int64_t region_id_;
+  pb::common::MetricType metric_type_;
+  int64_t timeout_ms_;
+
+  bthread_mutex_t mutex_;
+  size_t row_count_{0};
+  HitLoader loader_;
+  // Current chunk of current row.
+  HitChunk chunk_;
+  bool is_chunk_loaded_{false};
+  int64_t hit_count_{0};
+  int64_t fetched_count_{0};
+  // Position of next page.
+  size_t row_{0};
+  size_t offset_{0};
+
+  int64_t last_access_time_ms_;
+  bool is_released_{false};
+};
+
+// Manage the alive range search cursor, release semantics like ScanManagerV2,
+// cursor is deleted when fetch finish or released, and recycled by RegularCleaningHandler when timeout.
+class VectorRangeSearchCursorManager {
+ public:
+  static VectorRangeSearchCursorManager& GetInstance();
+
+  VectorRangeSearchCursorManager(const VectorRangeSearchCursorManager&) = delete;
+  VectorRangeSearchCursorManager& operator=(const VectorRangeSearchCursorManager&) = delete;
+
+  VectorRangeSearchCursorPtr CreateCursor(int64_t region_id, pb::common::MetricType metric_type);
+  VectorRangeSearchCursorPtr FindCursor(int64_t cursor_id);
+  void DeleteCursor(int64_t cursor_id);
+  void TryDeleteCursor(int64_t cursor_id);
+
+  int64_t CursorCount();
+
+  static void RegularCleaningHandler(void* arg);
+
+ private:
+  VectorRangeSearchCursorManager();
+  ~VectorRangeSearchCursorManager();
+
+  bthread_mutex_t mutex_;
+  std::atomic<int64_t> next_cursor_id_{1};
+  std::map<int64_t, VectorRangeSearchCursorPtr> alive_cursors_;
+
+  bvar::Adder<int64_t> bvar_cursor_running_num_;
+  bvar::Adder<int64_t> bvar_cursor_total_num_;
+};
+
+}  // namespace dingodb
+
+#endif  // DINGODB_VECTOR_RANGE_SEARCH_CURSOR_H_  // NOLINT
@@ -15,6 +15,7 @@
 #include "vector/vector_reader.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <deque>
 #include <limits>
@@ -25,6 +26,7 @@
 #include <vector>
 
 #include "butil/status.h"
+#include "bvar/reducer.h"
 #include "common/constant.h"
 #include "common/helper.h"
 #include "common/logging.h"
@@ -40,6 +42,7 @@
 #include "vector/vector_index.h"
 #include "vector/vector_index_factory.h"
 #include "vector/vector_index_utils.h"
+#include "vector/vector_range_search_cursor.h"
 
 namespace dingodb {
 
@@ -51,9 +54,18 @@ namespace dingodb {
 DEFINE_int64(vector_index_max_range_search_result_count, 1024, "max range search result count");
 DEFINE_int64(vector_index_bruteforce_batch_count, 2048, "bruteforce batch count");
 DEFINE_bool(dingo_log_switch_scalar_speed_up_detail, false, "scalar speed up log");
+DEFINE_int64(vector_filter_bruteforce_max_count, 2048,
+             "exact search over the allowed ids when filter allowed count not exceed it, 0 is disable");
+DEFINE_double(vector_filter_post_filter_min_selectivity, 0.5,
+              "over fetch without ids filter and post filter when selectivity not less than it, >1 is disable");
+DEFINE_double(vector_filter_over_fetch_ratio, 1.5, "over fetch ratio of post filter search");
+
 
 bvar::LatencyRecorder g_bruteforce_search_latency("dingo_bruteforce_search_latency");
 bvar::LatencyRecorder g_bruteforce_range_search_latency("dingo_bruteforce_range_search_latency");
+bvar::Adder<int64_t> g_filter_search_bruteforce_count("dingo_vector_filter_search_bruteforce_count");
+bvar::Adder<int64_t> g_filter_search_post_filter_count("dingo_vector_filter_search_post_filter_count");
+bvar::Adder<int64_t> g_filter_search_fallback_count("dingo_vector_filter_search_fallback_count");
 
 DECLARE_bool(dingo_log_switch_coprocessor_scalar_detail);
 
@@ -447,6 +459,148 @@ butil::Status VectorReader::VectorBatchSearch(std::shared_ptr<Engine::VectorRead
   return butil::Status();
 }
 
+butil::Status VectorReader::VectorRangeSearchCursorOpen(std::shared_ptr<Engine::VectorReader::Context> ctx,
+                                                        int64_t& cursor_id) {
+  auto vector_index = ctx->vector_index;
+  if (vector_index == nullptr) {
+    return butil::Status(pb::error::EVECTOR_INDEX_NOT_FOUND, "vector index is nullptr");
+  }
+  if (ctx->vector_with_ids.empty()) {
+    return butil::Status(pb::error::EILLEGAL_PARAMTETERS, "vector_with_ids is empty");
+  }
+
+  const auto& parameter = ctx->parameter;
+  std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> filters;
+  std::shared_ptr<RawCoprocessor> scalar_coprocessor;
+  bool use_scalar_post_filter = false;
+  if (parameter.vector_filter() == pb::common::VectorFilter::VECTOR_ID_FILTER) {
+    auto vector_ids = Helper::PbRepeatedToVector(parameter.vector_ids());
+    auto status =
+        VectorReader::SetVectorIndexIdsFilter(parameter.is_negation(), parameter.is_sorted(), vector_ids, filters);
+    if (!status.ok()) {
+      return status;
+    }
+  } else if (parameter.vector_filter() == pb::common::VectorFilter::SCALAR_FILTER &&
+             parameter.vector_filter_type() == pb::common::VectorFilterType::QUERY_POST) {
+    if (parameter.has_vector_coprocessor()) {
+      scalar_coprocessor = std::make_shared<CoprocessorScalar>(Helper::GetKeyPrefix(ctx->region_range.start_key()));
+      auto status = scalar_coprocessor->Open(CoprocessorPbWrapper{parameter.vector_coprocessor()});
+      if (!status.ok()) {
+        DINGO_LOG(ERROR) << "scalar coprocessor::Open failed " << status.error_cstr();
+        return status;
+      }
+    } else {
+      use_scalar_post_filter = ctx->vector_with_ids[0].scalar_data().scalar_data_size() > 0;
+    }
+  } else {
+    return butil::Status(pb::error::EVECTOR_NOT_SUPPORT,
+                         "range search cursor only support vector id filter or scalar post filter");
+  }
+
+  // The hits of every query vector is searched when the cursor page reach it, and the scalar post filter is
+  // applied on the hits, so the cursor hold the reader and the search context.
+  auto vector_reader = VectorReader::New(reader_);
+  auto loader = [vector_reader, vector_index, filters, scalar_coprocessor, use_scalar_post_filter,
+                 vector_with_ids = ctx->vector_with_ids, region_range = ctx->region_range,
+                 partition_id = ctx->partition_id, region_id = ctx->region_id,
+                 parameter](size_t row, VectorRangeSearchCursor::HitChunk& chunk) -> butil::Status {
+    // Every chunk redo the range search and keep the hits after the previous chunk, so the memory of cursor is
+    // bounded by chunk size however many hits the query vector has.
+    std::vector<std::vector<VectorIndex::RangeSearchHit>> row_hits;
+    auto status = vector_index->RangeSearchHits({vector_with_ids[row]}, parameter.radius(), region_range, filters,
+                                                parameter, row_hits);
+    if (!status.ok()) {
+      DINGO_LOG(ERROR) << fmt::format("[vector_reader][region({})] range search hits failed, error: {} {}", region_id,
+                                      status.error_code(), status.error_str());
+      return status;
+    }
+
+    auto& hits = chunk.hits;
+    hits.clear();
+    if (!row_hits.empty()) {
+      hits.swap(row_hits[0]);
+    }
+    VectorRangeSearchCursor::CutChunk(hits, chunk);
+    if (scalar_coprocessor == nullptr && !use_scalar_post_filter) {
+      return butil::Status::OK();
+    }
+
+    size_t count = 0;
+    for (const auto& hit : hits) {
+      bool compare_result = false;
+      status = scalar_coprocessor != nullptr
+                   ? vector_reader->CompareVectorScalarDataWithCoprocessor(region_range, partition_id, hit.id,
+                                                                           scalar_coprocessor, compare_result)
+                   : vector_reader->CompareVectorScalarData(region_range, partition_id, hit.id,
+                                                            vector_with_ids[0].scalar_data(), compare_result);
+      if (!status.ok()) {
+        return status;
+      }
+      if (compare_result) {
+        hits[count++] = hit;
+      }
+    }
+    hits.resize(count);
+
+    return butil::Status::OK();
+  };
+
+  auto cursor = VectorRangeSearchCursorManager::GetInstance().CreateCursor(ctx->region_id,
+                                                                           vector_index->GetMetricType());
+  cursor->SetHitLoader(ctx->vector_with_ids.size(), std::move(loader));
+  cursor_id = cursor->Id();
+
+  return butil::Status::OK();
+}
+
+butil::Status VectorReader::VectorRangeSearchCursorNext(std::shared_ptr<Engine::VectorReader::Context> ctx,
+                                                        int64_t cursor_id, uint32_t page_size,
+                                                        std::vector<pb::index::VectorWithDistanceResult>& results,
+                                                        bool& has_more) {
+  auto& manager = VectorRangeSearchCursorManager::GetInstance();
+  auto cursor = manager.FindCursor(cursor_id);
+  if (cursor == nullptr || cursor->RegionId() != ctx->region_id) {
+    return butil::Status(pb::error::EILLEGAL_PARAMTETERS, fmt::format("not found cursor {}", cursor_id));
+  }
+
+  auto status = cursor->NextPage(page_size, results, has_more);
+  if (!status.ok()) {
+    manager.DeleteCursor(cursor_id);
+    return status;
+  }
+  if (!has_more) {
+    manager.DeleteCursor(cursor_id);
+  }
+
+  // Payload is only filled for this page.
+  if (ctx->with_vector_data) {
+    for (auto& result : results) {
+      for (auto& vector_with_distance : *result.mutable_vector_with_distances()) {
+        auto* vector_with_id = vector_with_distance.mutable_vector_with_id();
+        auto status = QueryVectorWithId(ctx->region_range, ctx->partition_id, vector_with_id->id(), true,
+                                        *vector_with_id);
+        if (!status.ok()) {
+          DINGO_LOG(WARNING) << fmt::format("Query vector_with_id failed, vector_id: {} error: {}",
+                                            vector_with_id->id(), status.error_str());
+        }
+      }
+    }
+  }
+
+  if (ctx->with_scalar_data) {
+    auto status = QueryVectorScalarData(ctx->region_range, ctx->partition_id, ctx->selected_scalar_keys, results);
+    if (!status.ok()) {
+      return status;
+    }
+  }
+
+  return butil::Status::OK();
+}
+
+void VectorReader::VectorRangeSearchCursorRelease(int64_t cursor_id) {
+  VectorRangeSearchCursorManager::GetInstance().DeleteCursor(cursor_id);
+}
+
 butil::Status VectorReader::VectorBatchQuery(std::shared_ptr<Engine::VectorReader::Context> ctx,
                                              std::vector<pb::common::VectorWithId>& vector_with_ids) {
   for (auto vector_id : ctx->vector_ids) {
@@ -1594,8 +1748,8 @@ butil::Status VectorReader::SearchAndRangeSearchWrapper(
         return status;
       }
     } else {
-      status = vector_index->Search(vector_with_ids, topk, region_range, filters, with_vector_data, parameter,
-                                    vector_with_distance_results);
+      status = FilteredSearch(vector_index, region_range, vector_with_ids, parameter, vector_with_distance_results,
+                              topk, filters);
       if (status.error_code() == pb::error::Errno::EVECTOR_NOT_SUPPORT) {
         DINGO_LOG(DEBUG) << "Search vector index not support, try brute force, id: " << vector_index->Id();
         return BruteForceSearch(vector_index, vector_with_ids, topk, region_range, filters, with_vector_data, parameter,
@@ -1611,6 +1765,178 @@ butil::Status VectorReader::SearchAndRangeSearchWrapper(
   return butil::Status::OK();
 }
 
+// Plan by the cardinality of ids filter:
+// 1. allowed ids is few, exact search over the allowed ids, not walk the index.
+// 2. allowed ids is most of index, over fetch without ids filter then post filter.
+// 3. others, search index with the fused filter.
+butil::Status VectorReader::FilteredSearch(VectorIndexWrapperPtr vector_index, const pb::common::Range& region_range,
+                                           const std::vector<pb::common::VectorWithId>& vector_with_ids,
+                                           const pb::common::VectorSearchParameter& parameter,
+                                           std::vector<pb::index::VectorWithDistanceResult>& results, uint32_t topk,
+                                           std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters) {
+  bool with_vector_data = !(parameter.without_vector_data());
+
+  std::shared_ptr<VectorIndex::FilterFunctor> ids_filter;
+  std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> base_filters;
+  for (const auto& filter : filters) {
+    if (ids_filter == nullptr && dynamic_cast<VectorIndex::SortFilterFunctor*>(filter.get()) != nullptr) {
+      ids_filter = filter;
+    } else {
+      base_filters.push_back(filter);
+    }
+  }
+
+  std::shared_ptr<VectorIndex::FusedFilterFunctor> fused_filter;
+  if (ids_filter != nullptr && topk > 0) {
+    int64_t min_vector_id = 0, max_vector_id = 0;
+    VectorCodec::DecodeRangeToVectorId(region_range, min_vector_id, max_vector_id);
+    auto plan_filters = filters;
+    plan_filters.push_back(std::make_shared<VectorIndex::RangeFilterFunctor>(min_vector_id, max_vector_id));
+    fused_filter = VectorIndex::FusedFilterFunctor::Compile(plan_filters);
+  }
+
+  if (fused_filter == nullptr) {
+    return vector_index->Search(vector_with_ids, topk, region_range, filters, with_vector_data, parameter, results);
+  }
+
+  int64_t total_count = 0;
+  auto status = vector_index->GetCount(total_count);
+  if (!status.ok()) {
+    total_count = 0;
+  }
+
+  int64_t allowed_count = fused_filter->IdCount();
+  if (fused_filter->IsNegation() || !fused_filter->HasIds()) {
+    allowed_count = std::max(total_count - fused_filter->IdCount(), static_cast<int64_t>(0));
+  }
+
+  if (fused_filter->HasIds() && !fused_filter->IsNegation() &&
+      allowed_count <= FLAGS_vector_filter_bruteforce_max_count) {
+    g_filter_search_bruteforce_count << 1;
+    std::vector<int64_t> allowed_ids;
+    fused_filter->GetAllowedIds(allowed_ids);
+    return BruteForceSearchByIds(vector_index, vector_with_ids, topk, region_range, allowed_ids, with_vector_data,
+                                 parameter, results);
+  }
+
+  double selectivity = total_count > 0 ? static_cast<double>(allowed_count) / total_count : 1.0;
+  if (total_count > 0 && allowed_count > 0 && selectivity >= FLAGS_vector_filter_post_filter_min_selectivity) {
+    g_filter_search_post_filter_count << 1;
+    uint32_t fetch_topk = static_cast<uint32_t>(
+        std::min(std::ceil(topk / selectivity * FLAGS_vector_filter_over_fetch_ratio), static_cast<double>(UINT32_MAX)));
+    fetch_topk = std::max(fetch_topk, topk);
+
+    std::vector<pb::index::VectorWithDistanceResult> fetch_results;
+    auto fetch_filters = base_filters;
+    status = vector_index->Search(vector_with_ids, fetch_topk, region_range, fetch_filters, with_vector_data,
+                                  parameter, fetch_results);
+    if (!status.ok()) {
+      return status;
+    }
+
+    // Result is sorted by distance, keep the first topk which pass filter.
+    bool is_enough = true;
+    int keep_size = static_cast<int>(topk);
+    for (auto& fetch_result : fetch_results) {
+      int fetch_size = fetch_result.vector_with_distances_size();
+      auto* vector_with_distances = fetch_result.mutable_vector_with_distances();
+      int size = 0;
+      for (int i = 0; i < fetch_size && size < keep_size; ++i) {
+        if (fused_filter->Check(vector_with_distances->Get(i).vector_with_id().id())) {
+          if (size != i) {
+            vector_with_distances->SwapElements(size, i);
+          }
+          ++size;
+        }
+      }
+      vector_with_distances->DeleteSubrange(size, fetch_size - size);
+
+      if (size < keep_size && fetch_size >= static_cast<int>(fetch_topk)) {
+        is_enough = false;
+        break;
+      }
+    }
+
+    if (is_enough) {
+      results.swap(fetch_results);
+      return butil::Status::OK();
+    }
+
+    // Filter is more selective than estimated, search again with filter.
+    g_filter_search_fallback_count << 1;
+  }
+
+  auto index_filters = base_filters;
+  index_filters.push_back(fused_filter);
+  return vector_index->Search(vector_with_ids, topk, region_range, index_filters, with_vector_data, parameter, results);
+}
+
+// Exact search over the allowed ids, get vector from raw engine by id.
+butil::Status VectorReader::BruteForceSearchByIds(VectorIndexWrapperPtr vector_index,
+                                                  const std::vector<pb::common::VectorWithId>& vector_with_ids,
+                                                  uint32_t topk, const pb::common::Range& region_range,
+                                                  const std::vector<int64_t>& vector_ids, bool reconstruct,
+                                                  const pb::common::VectorSearchParameter& parameter,
+                                                  std::vector<pb::index::VectorWithDistanceResult>& results) {
+  BvarLatencyGuard bvar_guard(&g_bruteforce_search_latency);
+
+  char prefix = region_range.start_key()[0];
+  int64_t partition_id = VectorCodec::DecodePartitionId(region_range.start_key());
+
+  std::vector<pb::common::VectorWithId> allowed_vector_with_ids;
+  allowed_vector_with_ids.reserve(vector_ids.size());
+  for (auto vector_id : vector_ids) {
+    if (vector_id <= 0 || vector_id == INT64_MAX) {
+      continue;
+    }
+
+    std::string key;
+    VectorCodec::EncodeVectorKey(prefix, partition_id, vector_id, key);
+    std::string value;
+    auto status = reader_->KvGet(Constant::kVectorDataCF, key, value);
+    if (status.error_code() == pb::error::EKEY_NOT_FOUND) {
+      continue;
+    }
+    if (!status.ok()) {
+      return status;
+    }
+
+    pb::common::Vector vector;
+    if (!vector.ParseFromString(value)) {
+      return butil::Status(pb::error::EINTERNAL, "Parse proto from string error");
+    }
+    auto& vector_with_id = allowed_vector_with_ids.emplace_back();
+    vector_with_id.set_id(vector_id);
+    vector_with_id.mutable_vector()->Swap(&vector);
+  }
+
+  results.clear();
+  if (allowed_vector_with_ids.empty()) {
+    results.resize(vector_with_ids.size());
+    return butil::Status::OK();
+  }
+
+  pb::common::RegionEpoch epoch;
+  pb::common::VectorIndexParameter index_parameter;
+  index_parameter.mutable_flat_parameter()->set_dimension(vector_index->GetDimension());
+  index_parameter.mutable_flat_parameter()->set_metric_type(vector_index->GetMetricType());
+
+  auto thread_pool = Server::GetInstance().GetVectorIndexThreadPool();
+  auto flat_index = VectorIndexFactory::NewFlat(INT64_MAX, index_parameter, epoch, region_range, thread_pool);
+  if (flat_index == nullptr) {
+    return butil::Status(pb::error::EINTERNAL, "New flat index failed");
+  }
+
+  auto status = flat_index->AddByParallel(allowed_vector_with_ids);
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << fmt::format("Add vector to flat index failed, error: {} {}", status.error_code(),
+                                    status.error_str());
+    return status;
+  }
+
+  return flat_index->SearchByParallel(vector_with_ids, topk, {}, reconstruct, parameter, results);
+}
+
 // DistanceResult
 // This class is used for priority queue to merge the search result from many batch scan data from raw engine.
 class DistanceResult {
@@ -59,6 +59,18 @@ class VectorReader {
 
   butil::Status VectorCount(const pb::common::Range& range, int64_t& count);
 
+  // Range search by cursor, the hits of every query vector are searched lazily and paged out by
+  // VectorRangeSearchCursorNext, so it is not limited by vector_index_max_range_search_result_count.
+  // Support vector id filter and scalar post filter.
+  butil::Status VectorRangeSearchCursorOpen(std::shared_ptr<Engine::VectorReader::Context> ctx, int64_t& cursor_id);
+  // Fetch next page of cursor, vector data and scalar data is filled on request by ctx.
+  // The cursor is deleted when all hits are fetched.
+  butil::Status VectorRangeSearchCursorNext(std::shared_ptr<Engine::VectorReader::Context> ctx, int64_t cursor_id,
+                                            uint32_t page_size,
+                                            std::vector<pb::index::VectorWithDistanceResult>& results,
+                                            bool& has_more);
+  static void VectorRangeSearchCursorRelease(int64_t cursor_id);
+
   // This function is for testing only
   butil::Status VectorBatchSearchDebug(std::shared_ptr<Engine::VectorReader::Context> ctx,
                                        std::vector<pb::index::VectorWithDistanceResult>& results,
@@ -167,6 +179,19 @@ class VectorReader {
       std::vector<pb::index::VectorWithDistanceResult>& vector_with_distance_results, uint32_t topk,  // NOLINT
       std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> filters);
 
+  // Choose exact search over allowed ids, filtered index search or over fetch and post filter by selectivity.
+  butil::Status FilteredSearch(VectorIndexWrapperPtr vector_index, const pb::common::Range& region_range,
+                               const std::vector<pb::common::VectorWithId>& vector_with_ids,
+                               const pb::common::VectorSearchParameter& parameter,
+                               std::vector<pb::index::VectorWithDistanceResult>& results, uint32_t topk,
+                               std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters);
+
+  butil::Status BruteForceSearchByIds(VectorIndexWrapperPtr vector_index,
+                                      const std::vector<pb::common::VectorWithId>& vector_with_ids, uint32_t topk,
+                                      const pb::common::Range& region_range, const std::vector<int64_t>& vector_ids,
+                                      bool reconstruct, const pb::common::VectorSearchParameter& parameter,
+                                      std::vector<pb::index::VectorWithDistanceResult>& results);
+
   butil::Status BruteForceSearch(VectorIndexWrapperPtr vector_index,
                                  const std::vector<pb::common::VectorWithId>& vector_with_ids, uint32_t topk,
                                  const pb::common::Range& region_range,
@@ -18,10 +18,16 @@
 #include <cstdint>
 #include <filesystem>
 #include <iostream>
+#include <memory>
+#include <vector>
 
 #include "butil/status.h"
 #include "document/codec.h"
+#include "document/document_index.h"
 #include "document/document_index_factory.h"
+#include "document/document_reader.h"
+#include "document/document_search_filter.h"
+#include "engine/engine.h"
 
 static size_t log_level = 1;
 
@@ -526,4 +532,122 @@ TEST(DingoDocumentIndexTest, test_upsert) {
     EXPECT_EQ(ret.ok(), true);
     EXPECT_EQ(results.size(), 0);
   }
-}
\ No newline at end of file
+}
+TEST(DingoDocumentIndexTest, test_search_with_filter) {
+  std::filesystem::remove_all(kDocumentIndexTestIndexPath);
+  std::string index_path{kDocumentIndexTestIndexPath};
+
+  std::string error_message;
+  std::string json_parameter;
+  std::map<std::string, dingodb::TokenizerType> column_tokenizer_parameter;
+
+  dingodb::pb::common::DocumentIndexParameter document_index_parameter;
+  auto* scalar_schema = document_index_parameter.mutable_scalar_schema();
+  auto* text_field = scalar_schema->add_fields();
+  text_field->set_key("text");
+  text_field->set_field_type(dingodb::pb::common::ScalarFieldType::STRING);
+  column_tokenizer_parameter["text"] = dingodb::TokenizerType::kTokenizerTypeText;
+
+  auto ret1 = dingodb::DocumentCodec::GenDefaultTokenizerJsonParameter(column_tokenizer_parameter, json_parameter,
+                                                                       error_message);
+  ASSERT_TRUE(ret1);
+  document_index_parameter.set_json_parameter(json_parameter);
+
+  dingodb::pb::common::RegionEpoch region_epoch;
+  dingodb::pb::common::Range range;
+
+  butil::Status tmp_status;
+  auto document_index = dingodb::DocumentIndexFactory::CreateIndex(1, index_path, document_index_parameter,
+                                                                   region_epoch, range, true, tmp_status);
+  ASSERT_TRUE(document_index != nullptr);
+
+  std::vector<std::string> texts_to_insert;
+  texts_to_insert.push_back("Ancient empires rise and fall, shaping history's course.");
+  texts_to_insert.push_back("Artistic expressions reflect diverse cultural heritages.");
+  texts_to_insert.push_back("Social movements transform societies, forging new paths.");
+  texts_to_insert.push_back("Economies fluctuate, reflecting the complex interplay of global forces.");
+  texts_to_insert.push_back("Strategic military campaigns alter the balance of power.");
+  texts_to_insert.push_back("Quantum leaps redefine understanding of physical laws.");
+  texts_to_insert.push_back("Chemical reactions unlock mysteries of nature.");
+
+  std::vector<dingodb::pb::common::DocumentWithId> document_with_ids;
+  for (int i = 0; i < texts_to_insert.size(); i++) {
+    dingodb::pb::common::DocumentWithId document_with_id;
+    document_with_id.set_id(i + 1);
+    dingodb::pb::common::DocumentValue document_value;
+    document_value.set_field_type(dingodb::pb::common::ScalarFieldType::STRING);
+    document_value.mutable_field_value()->set_string_data(texts_to_insert.at(i));
+    document_with_id.mutable_document()->mutable_document_data()->insert({"text", document_value});
+    document_with_ids.push_back(document_with_id);
+  }
+
+  auto ret = document_index->Add(document_with_ids, true);
+  ASSERT_TRUE(ret.ok());
+
+  auto document_index_wrapper = dingodb::DocumentIndexWrapper::New(1, document_index_parameter);
+  ASSERT_TRUE(document_index_wrapper != nullptr);
+  document_index_wrapper->UpdateDocumentIndex(document_index, "unit test");
+
+  auto document_reader = dingodb::DocumentReader::New(nullptr);
+
+  auto text_value = [](const std::string& text) {
+    dingodb::pb::common::DocumentValue document_value;
+    document_value.set_field_type(dingodb::pb::common::ScalarFieldType::STRING);
+    document_value.mutable_field_value()->set_string_data(text);
+    return document_value;
+  };
+
+  // query string and scalar predicate
+  {
+    auto ctx = std::make_shared<dingodb::Engine::DocumentReader::Context>();
+    ctx->document_index = document_index_wrapper;
+    ctx->region_range = range;
+    ctx->parameter.set_top_n(10);
+    ctx->parameter.set_query_string("of");
+    ctx->parameter.set_without_scalar_data(true);
+    ctx->scalar_predicates = {dingodb::DocumentScalarPredicate::Term("text", text_value("physical"))};
+
+    std::vector<dingodb::pb::common::DocumentWithScore> results;
+    ret = document_reader->DocumentSearch(ctx, results);
+    EXPECT_TRUE(ret.ok());
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_EQ(results[0].document_with_id().id(), 6);
+  }
+
+  // blank query string only filter by scalar predicate and id allow list
+  {
+    auto ctx = std::make_shared<dingodb::Engine::DocumentReader::Context>();
+    ctx->document_index = document_index_wrapper;
+    ctx->region_range = range;
+    ctx->parameter.set_top_n(10);
+    ctx->parameter.set_without_scalar_data(true);
+    ctx->scalar_predicates = {dingodb::DocumentScalarPredicate::Term("text", text_value("of"))};
+    ctx->use_id_filter = true;
+    ctx->alive_ids = {2, 4, 6, 7};
+
+    std::vector<dingodb::pb::common::DocumentWithScore> results;
+    ret = document_reader->DocumentSearch(ctx, results);
+    EXPECT_TRUE(ret.ok());
+    EXPECT_EQ(results.size(), 3);
+    for (const auto& result : results) {
+      EXPECT_NE(result.document_with_id().id(), 2);
+    }
+  }
+
+  // predicate on not indexed column
+  {
+    auto ctx = std::make_shared<dingodb::Engine::DocumentReader::Context>();
+    ctx->document_index = document_index_wrapper;
+    ctx->region_range = range;
+    ctx->parameter.set_top_n(10);
+    ctx->parameter.set_query_string("of");
+    ctx->parameter.set_without_scalar_data(true);
+    ctx->scalar_predicates = {dingodb::DocumentScalarPredicate::Term("title", text_value("of"))};
+
+    std::vector<dingodb::pb::common::DocumentWithScore> results;
+    ret = document_reader->DocumentSearch(ctx, results);
+    EXPECT_FALSE(ret.ok());
+  }
+
+  document_index_wrapper->Destroy();
+}
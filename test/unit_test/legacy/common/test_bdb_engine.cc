@@ -16,9 +16,12 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <cstdlib>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <string>
 #include <thread>
@@ -31,11 +34,14 @@
 #include "config/yaml_config.h"
 #include "engine/bdb_raw_engine.h"
 #include "engine/snapshot.h"
+#include "fmt/core.h"
 #include "gflags/gflags.h"
 #include "proto/common.pb.h"
 
 namespace dingodb {
 
+DECLARE_bool(bdb_partition_by_cf);
+
 DEFINE_uint32(bdb_test_max_count, 30000, "bdb_test_max_count");
 
 static const std::string kDefaultCf = "default";
@@ -553,6 +559,102 @@ TEST_F(RawBdbEngineTest, KvBatchPutAndDelete) {
   }
 }
 
+TEST_F(RawBdbEngineTest, KvBatchPutAndDeleteGroupCommit) {
+  auto writer = RawBdbEngineTest::engine->Writer();
+  auto reader = RawBdbEngineTest::engine->Reader();
+
+  const int thread_count = 8;
+  const int batch_count = 20;
+
+  // concurrent multi-cf write batches are merged into group commit.
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count);
+  for (int t = 0; t < thread_count; ++t) {
+    threads.emplace_back([&writer, t]() {
+      for (int i = 0; i < batch_count; ++i) {
+        std::map<std::string, std::vector<pb::common::KeyValue>> kv_puts_with_cf;
+        pb::common::KeyValue kv;
+        kv.set_key(fmt::format("GroupCommit_{}_{}", t, i));
+        kv.set_value(kv.key());
+        kv_puts_with_cf[kDefaultCf].push_back(kv);
+        kv_puts_with_cf["meta"].push_back(kv);
+
+        butil::Status ok = writer->KvBatchPutAndDelete(kv_puts_with_cf, {});
+        EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+      }
+    });
+  }
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  int64_t count = 0;
+  butil::Status ok = reader->KvCount(kDefaultCf, "GroupCommit_", "GroupCommit`", count);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(count, thread_count * batch_count);
+
+  ok = reader->KvCount("meta", "GroupCommit_", "GroupCommit`", count);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(count, thread_count * batch_count);
+
+  // a illegal batch only fail itself.
+  {
+    std::map<std::string, std::vector<pb::common::KeyValue>> kv_puts_with_cf;
+    kv_puts_with_cf[kDefaultCf].push_back(pb::common::KeyValue());
+
+    ok = writer->KvBatchPutAndDelete(kv_puts_with_cf, {});
+    EXPECT_EQ(ok.error_code(), pb::error::Errno::EKEY_EMPTY);
+  }
+
+  pb::common::Range range;
+  range.set_start_key("GroupCommit_");
+  range.set_end_key("GroupCommit`");
+  ok = writer->KvBatchDeleteRange({{kDefaultCf, {range}}, {"meta", {range}}});
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+}
+
+TEST_F(RawBdbEngineTest, GroupCommitterBatchStatus) {
+  const std::string bad_key = "GroupCommitterBad";
+
+  // a group contain the bad batch fail, then every batch is committed alone.
+  std::atomic<int> commit_count = 0;
+  bdb::GroupCommitter group_committer([&](const std::vector<bdb::GroupCommitter::WriteBatch *> &batches) {
+    ++commit_count;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    for (const auto *batch : batches) {
+      if (batch->kv_puts_with_cf->begin()->second.front().key() == bad_key) {
+        return butil::Status(pb::error::EINTERNAL, "bad batch");
+      }
+    }
+    return butil::Status::OK();
+  });
+
+  const int thread_count = 8;
+  std::vector<butil::Status> statuses(thread_count);
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count);
+  for (int t = 0; t < thread_count; ++t) {
+    threads.emplace_back([&, t]() {
+      std::map<std::string, std::vector<pb::common::KeyValue>> kv_puts_with_cf;
+      pb::common::KeyValue kv;
+      kv.set_key(t == 0 ? bad_key : fmt::format("GroupCommitterGood_{}", t));
+      kv_puts_with_cf[kDefaultCf].push_back(kv);
+      statuses[t] = group_committer.Write(kv_puts_with_cf, {});
+    });
+  }
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(statuses[0].error_code(), pb::error::Errno::EINTERNAL);
+  for (int t = 1; t < thread_count; ++t) {
+    EXPECT_EQ(statuses[t].error_code(), pb::error::Errno::OK) << "thread: " << t;
+  }
+  EXPECT_GE(commit_count.load(), 2);
+}
+
 TEST_F(RawBdbEngineTest, KvGet) {
   const std::string &cf_name = kDefaultCf;
   auto reader = RawBdbEngineTest::engine->Reader();
@@ -1965,4 +2067,109 @@ TEST_F(RawBdbEngineTest, MaxTxnNums) {
   DINGO_LOG(ERROR) << "MaxTxnNums end";
 }
 
+static const std::string kPartitionTempDataDirectory = "./unit_test/bdb_partition_unit_test";
+
+class RawBdbEnginePartitionByCfTest : public testing::Test {
+ public:
+  static void SetUpTestSuite() {
+    old_partition_by_cf = FLAGS_bdb_partition_by_cf;
+    FLAGS_bdb_partition_by_cf = true;
+
+    Helper::CreateDirectories(kPartitionTempDataDirectory);
+
+    std::string content = kYamlConfigContent;
+    auto pos = content.find(kTempDataDirectory);
+    ASSERT_NE(pos, std::string::npos);
+    content.replace(pos, kTempDataDirectory.size(), kPartitionTempDataDirectory);
+
+    config = std::make_shared<YamlConfig>();
+    ASSERT_EQ(0, config->Load(content));
+
+    engine = std::make_shared<BdbRawEngine>();
+    ASSERT_TRUE(engine->Init(config, {}));
+  }
+
+  static void TearDownTestSuite() {
+    engine->Close();
+    engine->Destroy();
+    Helper::RemoveAllFileOrDirectory(kPartitionTempDataDirectory);
+    FLAGS_bdb_partition_by_cf = old_partition_by_cf;
+  }
+
+  static bool old_partition_by_cf;
+  static std::shared_ptr<BdbRawEngine> engine;
+  static std::shared_ptr<Config> config;
+};
+
+bool RawBdbEnginePartitionByCfTest::old_partition_by_cf = false;
+std::shared_ptr<BdbRawEngine> RawBdbEnginePartitionByCfTest::engine = nullptr;
+std::shared_ptr<Config> RawBdbEnginePartitionByCfTest::config = nullptr;
+
+TEST_F(RawBdbEnginePartitionByCfTest, ReadWrite) {
+  ASSERT_TRUE(engine->IsPartitionByCf());
+
+  auto writer = engine->Writer();
+  auto reader = engine->Reader();
+
+  // same key in different cf are isolated.
+  pb::common::KeyValue kv;
+  kv.set_key("PartitionKey");
+  kv.set_value("default_value");
+  butil::Status ok = writer->KvPut(kDefaultCf, kv);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  std::map<std::string, std::vector<pb::common::KeyValue>> kv_puts_with_cf;
+  kv.set_value("meta_value");
+  kv_puts_with_cf["meta"].push_back(kv);
+  kv.set_key("PartitionKey2");
+  kv_puts_with_cf[kDefaultCf].push_back(kv);
+  ok = writer->KvBatchPutAndDelete(kv_puts_with_cf, {});
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  std::string value;
+  ok = reader->KvGet(kDefaultCf, "PartitionKey", value);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(value, "default_value");
+  ok = reader->KvGet("meta", "PartitionKey", value);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(value, "meta_value");
+
+  // read with snapshot and iterator.
+  auto snapshot = engine->GetSnapshot();
+  ok = reader->KvGet("meta", snapshot, "PartitionKey", value);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(value, "meta_value");
+
+  int count = 0;
+  IteratorOptions options;
+  options.upper_bound = "PartitionKey~";
+  auto iter = reader->NewIterator(kDefaultCf, snapshot, options);
+  ASSERT_NE(iter, nullptr);
+  for (iter->Seek("PartitionKey"); iter->Valid(); iter->Next()) {
+    ++count;
+  }
+  EXPECT_EQ(count, 2);
+  iter.reset();
+  snapshot.reset();
+
+  // delete only affect its own cf.
+  ok = writer->KvDelete("meta", "PartitionKey");
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+  ok = reader->KvGet("meta", "PartitionKey", value);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::EKEY_NOT_FOUND);
+  ok = reader->KvGet(kDefaultCf, "PartitionKey", value);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  pb::common::Range range;
+  range.set_start_key("PartitionKey");
+  range.set_end_key("PartitionKey~");
+  ok = writer->KvDeleteRange(kDefaultCf, range);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  int64_t total = 0;
+  ok = reader->KvCount(kDefaultCf, "PartitionKey", "PartitionKey~", total);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(total, 0);
+}
+
 }  // namespace dingodb
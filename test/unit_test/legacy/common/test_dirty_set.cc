@@ -0,0 +1,83 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "common/dirty_set.h"
+
+namespace dingodb {
+
+class DirtySetTest : public testing::Test {
+ protected:
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+TEST_F(DirtySetTest, DirtyFlag) {
+  DirtyFlag dirty_flag;
+  EXPECT_FALSE(dirty_flag.IsDirty());
+
+  // only the first mark turn clean to dirty.
+  EXPECT_TRUE(dirty_flag.Mark());
+  EXPECT_FALSE(dirty_flag.Mark());
+  EXPECT_TRUE(dirty_flag.IsDirty());
+
+  dirty_flag.Clear();
+  EXPECT_FALSE(dirty_flag.IsDirty());
+  EXPECT_TRUE(dirty_flag.Mark());
+}
+
+TEST_F(DirtySetTest, AddAndTake) {
+  DirtySet dirty_set;
+  EXPECT_TRUE(dirty_set.Take().empty());
+
+  dirty_set.Add(1);
+  dirty_set.Add(2);
+  dirty_set.Add(1);
+  EXPECT_EQ(2, dirty_set.Size());
+
+  auto ids = dirty_set.Take();
+  std::sort(ids.begin(), ids.end());
+  EXPECT_EQ(std::vector<int64_t>({1, 2}), ids);
+  EXPECT_EQ(0, dirty_set.Size());
+}
+
+TEST_F(DirtySetTest, ConcurrentMark) {
+  DirtySet dirty_set;
+  std::vector<DirtyFlag> dirty_flags(100);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&]() {
+      for (int j = 0; j < 1000; ++j) {
+        int64_t id = j % dirty_flags.size();
+        if (dirty_flags[id].Mark()) {
+          dirty_set.Add(id);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(dirty_flags.size(), dirty_set.Take().size());
+}
+
+}  // namespace dingodb
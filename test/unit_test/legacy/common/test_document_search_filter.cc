@@ -0,0 +1,111 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "document/codec.h"
+#include "document/document_search_filter.h"
+#include "proto/common.pb.h"
+
+namespace dingodb {
+
+class DocumentSearchFilterTest : public testing::Test {
+ protected:
+  static pb::common::DocumentValue LongValue(int64_t value) {
+    pb::common::DocumentValue document_value;
+    document_value.set_field_type(pb::common::ScalarFieldType::INT64);
+    document_value.mutable_field_value()->set_long_data(value);
+    return document_value;
+  }
+
+  static pb::common::DocumentValue StringValue(const std::string& value) {
+    pb::common::DocumentValue document_value;
+    document_value.set_field_type(pb::common::ScalarFieldType::STRING);
+    document_value.mutable_field_value()->set_string_data(value);
+    return document_value;
+  }
+
+  std::map<std::string, TokenizerType> column_types = {
+      {"col1", kTokenizerTypeText}, {"col2", kTokenizerTypeI64}, {"col3", kTokenizerTypeF64}};
+};
+
+TEST_F(DocumentSearchFilterTest, BuildQueryString) {
+  std::string result;
+  EXPECT_TRUE(DocumentSearchFilter::BuildQueryString("col1:hello", {}, column_types, result).ok());
+  EXPECT_EQ("col1:hello", result);
+
+  auto lower = LongValue(-5);
+  auto upper = LongValue(10);
+  std::vector<DocumentScalarPredicate> predicates = {
+      DocumentScalarPredicate::Range("col2", &lower, true, &upper, false),
+      DocumentScalarPredicate::Range("col3", &lower, false, nullptr, false),
+      DocumentScalarPredicate::Term("col1", StringValue("a \"b\"")),
+  };
+  EXPECT_TRUE(DocumentSearchFilter::BuildQueryString("col1:hello", predicates, column_types, result).ok());
+  EXPECT_EQ(R"(+(col1:hello) +(col2:[-5 TO 10})^0 +(col3:{-5 TO *})^0 +(col1:"a \"b\"")^0)", result);
+
+  // Blank query string only filter by predicates.
+  EXPECT_TRUE(DocumentSearchFilter::BuildQueryString(" ", predicates, column_types, result).ok());
+  EXPECT_EQ(R"(+(col2:[-5 TO 10})^0 +(col3:{-5 TO *})^0 +(col1:"a \"b\"")^0)", result);
+
+  // Not indexed column.
+  predicates = {DocumentScalarPredicate::Term("col9", LongValue(1))};
+  EXPECT_FALSE(DocumentSearchFilter::BuildQueryString("col1:hello", predicates, column_types, result).ok());
+
+  // Text column not support range.
+  predicates = {DocumentScalarPredicate::Range("col1", &lower, true, &upper, true)};
+  EXPECT_FALSE(DocumentSearchFilter::BuildQueryString("col1:hello", predicates, column_types, result).ok());
+
+  // Value type not match.
+  predicates = {DocumentScalarPredicate::Term("col2", StringValue("1"))};
+  EXPECT_FALSE(DocumentSearchFilter::BuildQueryString("col1:hello", predicates, column_types, result).ok());
+}
+
+TEST_F(DocumentSearchFilterTest, CompactAllowIds) {
+  // Continuous ids convert to range filter.
+  std::vector<uint64_t> alive_ids = {5, 3, 4, 4, 6};
+  bool use_range_filter = false;
+  int64_t start_id = 0;
+  int64_t end_id = INT64_MAX;
+  bool use_id_filter = true;
+  EXPECT_TRUE(DocumentSearchFilter::CompactAllowIds(alive_ids, use_range_filter, start_id, end_id, use_id_filter));
+  EXPECT_TRUE(use_range_filter);
+  EXPECT_FALSE(use_id_filter);
+  EXPECT_EQ(3, start_id);
+  EXPECT_EQ(7, end_id);
+  EXPECT_TRUE(alive_ids.empty());
+
+  // Drop ids out of range filter.
+  alive_ids = {1, 20, 12, 15, 12};
+  use_range_filter = true;
+  start_id = 10;
+  end_id = 20;
+  use_id_filter = true;
+  EXPECT_TRUE(DocumentSearchFilter::CompactAllowIds(alive_ids, use_range_filter, start_id, end_id, use_id_filter));
+  EXPECT_TRUE(use_id_filter);
+  EXPECT_EQ(std::vector<uint64_t>({12, 15}), alive_ids);
+  EXPECT_EQ(10, start_id);
+  EXPECT_EQ(20, end_id);
+
+  // Not exist alive id.
+  alive_ids = {1, 2};
+  EXPECT_FALSE(DocumentSearchFilter::CompactAllowIds(alive_ids, use_range_filter, start_id, end_id, use_id_filter));
+}
+
+}  // namespace dingodb
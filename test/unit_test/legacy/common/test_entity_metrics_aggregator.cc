@@ -0,0 +1,156 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+
+#include "common/safe_map.h"
+#include "coordinator/entity_metrics_aggregator.h"
+#include "proto/common.pb.h"
+#include "proto/meta.pb.h"
+
+namespace dingodb {
+
+static pb::common::RegionMetrics TableRegionMetrics(int64_t region_id, int64_t table_id, int64_t row_count,
+                                                    int64_t region_size, const std::string& min_key,
+                                                    const std::string& max_key) {
+  pb::common::RegionMetrics region_metrics;
+  region_metrics.set_id(region_id);
+  region_metrics.mutable_region_definition()->set_table_id(table_id);
+  region_metrics.set_row_count(row_count);
+  region_metrics.set_region_size(region_size);
+  region_metrics.set_min_key(min_key);
+  region_metrics.set_max_key(max_key);
+  return region_metrics;
+}
+
+static pb::common::RegionMetrics IndexRegionMetrics(int64_t region_id, int64_t index_id, int64_t current_count,
+                                                    int64_t min_id, int64_t max_id) {
+  pb::common::RegionMetrics region_metrics;
+  region_metrics.set_id(region_id);
+  region_metrics.mutable_region_definition()->set_table_id(index_id);
+  region_metrics.mutable_region_definition()->set_index_id(index_id);
+  region_metrics.set_row_count(current_count);
+  auto* vector_index_metrics = region_metrics.mutable_vector_index_metrics();
+  vector_index_metrics->set_vector_index_type(pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW);
+  vector_index_metrics->set_current_count(current_count);
+  vector_index_metrics->set_deleted_count(1);
+  vector_index_metrics->set_memory_bytes(current_count * 100);
+  vector_index_metrics->set_min_id(min_id);
+  vector_index_metrics->set_max_id(max_id);
+  return region_metrics;
+}
+
+TEST(EntityMetricsAggregatorTest, AggregateTable) {
+  EntityMetricsAggregator aggregator;
+
+  pb::meta::TableMetrics table_metrics;
+  EXPECT_FALSE(aggregator.GetTableMetrics(1001, table_metrics));
+
+  aggregator.UpdateRegion(TableRegionMetrics(1, 1001, 10, 100, "b", "d"));
+  aggregator.UpdateRegion(TableRegionMetrics(2, 1001, 20, 200, "d", "f"));
+  aggregator.UpdateRegion(TableRegionMetrics(3, 1002, 30, 300, "x", "z"));
+  EXPECT_EQ(aggregator.RegionCount(), 3);
+
+  ASSERT_TRUE(aggregator.GetTableMetrics(1001, table_metrics));
+  EXPECT_EQ(table_metrics.rows_count(), 30);
+  EXPECT_EQ(table_metrics.table_size(), 300);
+
+  // update replace the old contribution of the region
+  aggregator.UpdateRegion(TableRegionMetrics(1, 1001, 15, 150, "b", "d"));
+  table_metrics.Clear();
+  ASSERT_TRUE(aggregator.GetTableMetrics(1001, table_metrics));
+  EXPECT_EQ(table_metrics.rows_count(), 35);
+  EXPECT_EQ(table_metrics.table_size(), 350);
+  EXPECT_EQ(aggregator.RegionCount(), 3);
+
+  // remove subtract the contribution, the last region remove the table
+  aggregator.RemoveRegion(2);
+  table_metrics.Clear();
+  ASSERT_TRUE(aggregator.GetTableMetrics(1001, table_metrics));
+  EXPECT_EQ(table_metrics.rows_count(), 15);
+  EXPECT_EQ(table_metrics.table_size(), 150);
+
+  aggregator.RemoveRegion(1);
+  EXPECT_FALSE(aggregator.GetTableMetrics(1001, table_metrics));
+  EXPECT_TRUE(aggregator.GetTableMetrics(1002, table_metrics));
+  EXPECT_EQ(aggregator.RegionCount(), 1);
+
+  // remove not exist region is ignored
+  aggregator.RemoveRegion(100);
+  EXPECT_EQ(aggregator.RegionCount(), 1);
+}
+
+TEST(EntityMetricsAggregatorTest, AggregateIndex) {
+  EntityMetricsAggregator aggregator;
+
+  aggregator.UpdateRegion(IndexRegionMetrics(11, 2001, 100, 1, 100));
+  aggregator.UpdateRegion(IndexRegionMetrics(12, 2001, 50, 101, 150));
+
+  // region of index is not counted to table
+  pb::meta::TableMetrics table_metrics;
+  EXPECT_FALSE(aggregator.GetTableMetrics(2001, table_metrics));
+
+  pb::meta::IndexMetrics index_metrics;
+  ASSERT_TRUE(aggregator.GetIndexMetrics(2001, index_metrics));
+  EXPECT_EQ(index_metrics.rows_count(), 150);
+  EXPECT_EQ(index_metrics.vector_index_type(), pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW);
+  EXPECT_EQ(index_metrics.current_count(), 150);
+  EXPECT_EQ(index_metrics.deleted_count(), 2);
+  EXPECT_EQ(index_metrics.memory_bytes(), 15000);
+  EXPECT_EQ(index_metrics.min_id(), 1);
+  EXPECT_EQ(index_metrics.max_id(), 150);
+
+  aggregator.UpdateRegion(IndexRegionMetrics(12, 2001, 40, 101, 140));
+  index_metrics.Clear();
+  ASSERT_TRUE(aggregator.GetIndexMetrics(2001, index_metrics));
+  EXPECT_EQ(index_metrics.current_count(), 140);
+  EXPECT_EQ(index_metrics.memory_bytes(), 14000);
+  // max id only widen by delta
+  EXPECT_EQ(index_metrics.max_id(), 150);
+}
+
+TEST(EntityMetricsAggregatorTest, RebuildAndClear) {
+  EntityMetricsAggregator aggregator;
+
+  aggregator.UpdateRegion(TableRegionMetrics(1, 1001, 10, 100, "b", "d"));
+  aggregator.UpdateRegion(IndexRegionMetrics(12, 2001, 50, 101, 150));
+  aggregator.UpdateRegion(IndexRegionMetrics(12, 2001, 40, 101, 140));
+
+  // rebuild reset the aggregate to the region metrics map exactly
+  DingoSafeMap<int64_t, pb::common::RegionMetrics> region_metrics_map;
+  region_metrics_map.Init(16);
+  region_metrics_map.Put(2, TableRegionMetrics(2, 1001, 20, 200, "d", "f"));
+  region_metrics_map.Put(12, IndexRegionMetrics(12, 2001, 40, 101, 140));
+  EXPECT_EQ(aggregator.Rebuild(region_metrics_map), 2);
+  EXPECT_EQ(aggregator.RegionCount(), 2);
+
+  pb::meta::TableMetrics table_metrics;
+  ASSERT_TRUE(aggregator.GetTableMetrics(1001, table_metrics));
+  EXPECT_EQ(table_metrics.rows_count(), 20);
+
+  pb::meta::IndexMetrics index_metrics;
+  ASSERT_TRUE(aggregator.GetIndexMetrics(2001, index_metrics));
+  EXPECT_EQ(index_metrics.current_count(), 40);
+  EXPECT_EQ(index_metrics.max_id(), 140);
+
+  aggregator.Clear();
+  EXPECT_EQ(aggregator.RegionCount(), 0);
+  EXPECT_FALSE(aggregator.GetTableMetrics(1001, table_metrics));
+  EXPECT_FALSE(aggregator.GetIndexMetrics(2001, index_metrics));
+}
+
+}  // namespace dingodb
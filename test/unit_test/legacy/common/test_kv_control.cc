@@ -0,0 +1,149 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/constant.h"
+#include "common/helper.h"
+#include "config/yaml_config.h"
+#include "coordinator/kv_control.h"
+#include "engine/rocks_raw_engine.h"
+#include "meta/meta_reader.h"
+#include "meta/meta_writer.h"
+#include "proto/coordinator_internal.pb.h"
+
+namespace dingodb {
+
+static const std::string kKvControlRootPath = "./unit_test_kv_control";
+static const std::string kKvControlStorePath = kKvControlRootPath + "/db";
+
+static const std::string kKvControlYamlConfigContent =
+    "cluster:\n"
+    "  name: dingodb\n"
+    "  instance_id: 12345\n"
+    "server:\n"
+    "  host: 127.0.0.1\n"
+    "  port: 23000\n"
+    "store:\n"
+    "  path: " +
+    kKvControlStorePath + "\n";
+
+static pb::coordinator_internal::RevisionInternal Revision(int64_t main) {
+  pb::coordinator_internal::RevisionInternal revision;
+  revision.set_main(main);
+  revision.set_sub(0);
+  return revision;
+}
+
+class KvControlTest : public testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    Helper::CreateDirectories(kKvControlStorePath);
+
+    auto config = std::make_shared<YamlConfig>();
+    ASSERT_EQ(0, config->Load(kKvControlYamlConfigContent));
+
+    engine = std::make_shared<RocksRawEngine>();
+    ASSERT_TRUE(engine->Init(config, {Constant::kStoreDataCF, Constant::kStoreMetaCF}));
+  }
+
+  static void TearDownTestSuite() {
+    engine->Close();
+    engine->Destroy();
+    Helper::RemoveAllFileOrDirectory(kKvControlRootPath);
+  }
+
+  static std::shared_ptr<KvControl> NewKvControl() {
+    auto kv_control =
+        std::make_shared<KvControl>(std::make_shared<MetaReader>(engine), std::make_shared<MetaWriter>(engine), engine);
+    if (!kv_control->Recover()) {
+      return nullptr;
+    }
+    return kv_control;
+  }
+
+  inline static std::shared_ptr<RocksRawEngine> engine;
+};
+
+TEST_F(KvControlTest, CompactToRevision) {
+  auto kv_control = NewKvControl();
+  ASSERT_NE(nullptr, kv_control);
+
+  // key a has garbage revision 100 and 101, key b only has the latest revision.
+  ASSERT_TRUE(kv_control->KvPutApply("a", Revision(100), false, 0, false, "a100").ok());
+  ASSERT_TRUE(kv_control->KvPutApply("a", Revision(101), false, 0, false, "a101").ok());
+  ASSERT_TRUE(kv_control->KvPutApply("b", Revision(102), false, 0, false, "b102").ok());
+  ASSERT_TRUE(kv_control->KvPutApply("a", Revision(103), false, 0, false, "a103").ok());
+
+  pb::coordinator_internal::MetaIncrement meta_increment;
+  kv_control->GenKvCompactToRevisionIncrement(Revision(103), meta_increment);
+  kv_control->ApplyMetaIncrement(meta_increment, true, 1, 1, nullptr);
+  EXPECT_EQ(103, kv_control->GetKvCompactRevision());
+
+  // Nothing is deleted until the local compaction step.
+  pb::coordinator_internal::KvRevInternal kv_rev;
+  EXPECT_TRUE(kv_control->GetRawKvRev(Revision(100), kv_rev).ok());
+
+  kv_control->KvCompactionStep();
+
+  EXPECT_FALSE(kv_control->GetRawKvRev(Revision(100), kv_rev).ok());
+  EXPECT_FALSE(kv_control->GetRawKvRev(Revision(101), kv_rev).ok());
+  EXPECT_TRUE(kv_control->GetRawKvRev(Revision(102), kv_rev).ok());
+  EXPECT_TRUE(kv_control->GetRawKvRev(Revision(103), kv_rev).ok());
+
+  pb::coordinator_internal::KvIndexInternal kv_index;
+  ASSERT_TRUE(kv_control->GetRawKvIndex("a", kv_index).ok());
+  ASSERT_EQ(1, kv_index.generations_size());
+  ASSERT_EQ(1, kv_index.generations(0).revisions_size());
+  EXPECT_EQ(103, kv_index.generations(0).revisions(0).main());
+
+  // The compact revision is persisted, so it is recovered after restart.
+  auto recovered_kv_control = NewKvControl();
+  ASSERT_NE(nullptr, recovered_kv_control);
+  EXPECT_EQ(103, recovered_kv_control->GetKvCompactRevision());
+}
+
+TEST_F(KvControlTest, CompactRevisionInSnapshot) {
+  auto kv_control = NewKvControl();
+  ASSERT_NE(nullptr, kv_control);
+
+  ASSERT_TRUE(kv_control->KvPutApply("c", Revision(200), false, 0, false, "c200").ok());
+  ASSERT_TRUE(kv_control->KvPutApply("c", Revision(201), false, 0, false, "c201").ok());
+
+  pb::coordinator_internal::MetaIncrement meta_increment;
+  kv_control->GenKvCompactToRevisionIncrement(Revision(201), meta_increment);
+  kv_control->ApplyMetaIncrement(meta_increment, true, 1, 2, nullptr);
+
+  pb::coordinator_internal::MetaSnapshotFile meta_snapshot_file;
+  ASSERT_TRUE(kv_control->LoadMetaToSnapshotFile(kv_control->PrepareRaftSnapshot(), meta_snapshot_file));
+
+  // The snapshot carries the compact revision, and the garbage is still compacted after load.
+  auto loaded_kv_control = NewKvControl();
+  ASSERT_NE(nullptr, loaded_kv_control);
+  ASSERT_TRUE(loaded_kv_control->LoadMetaFromSnapshotFile(meta_snapshot_file));
+  EXPECT_EQ(201, loaded_kv_control->GetKvCompactRevision());
+
+  loaded_kv_control->KvCompactionStep();
+
+  pb::coordinator_internal::KvRevInternal kv_rev;
+  EXPECT_FALSE(loaded_kv_control->GetRawKvRev(Revision(200), kv_rev).ok());
+  EXPECT_TRUE(loaded_kv_control->GetRawKvRev(Revision(201), kv_rev).ok());
+}
+
+}  // namespace dingodb
@@ -0,0 +1,94 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "coordinator/lease_timer_wheel.h"
+
+namespace dingodb {
+
+static std::vector<int64_t> DueLeaseIds(LeaseTimerWheel& wheel, int64_t now_seconds) {
+  std::vector<LeaseTimerWheel::Entry> due_entries;
+  wheel.Advance(now_seconds, due_entries);
+
+  std::vector<int64_t> lease_ids;
+  lease_ids.reserve(due_entries.size());
+  for (const auto& entry : due_entries) {
+    lease_ids.push_back(entry.lease_id);
+  }
+  return lease_ids;
+}
+
+TEST(LeaseTimerWheelTest, Advance) {
+  int64_t now = 1000000;
+  LeaseTimerWheel wheel(now);
+
+  wheel.Add(1, now + 10);
+  wheel.Add(2, now + 5);
+  wheel.Add(3, now + 100);
+  wheel.Add(4, now + 5000);
+  EXPECT_EQ(4, wheel.Size());
+
+  EXPECT_TRUE(DueLeaseIds(wheel, now + 4).empty());
+  EXPECT_EQ(std::vector<int64_t>({2}), DueLeaseIds(wheel, now + 5));
+  EXPECT_EQ(std::vector<int64_t>({1}), DueLeaseIds(wheel, now + 99));
+  EXPECT_EQ(std::vector<int64_t>({3}), DueLeaseIds(wheel, now + 100));
+  EXPECT_TRUE(DueLeaseIds(wheel, now + 4999).empty());
+  EXPECT_EQ(std::vector<int64_t>({4}), DueLeaseIds(wheel, now + 5000));
+  EXPECT_EQ(0, wheel.Size());
+}
+
+TEST(LeaseTimerWheelTest, AlreadyDue) {
+  int64_t now = 1000000;
+  LeaseTimerWheel wheel(now);
+
+  wheel.Add(1, now - 10);
+  EXPECT_EQ(std::vector<int64_t>({1}), DueLeaseIds(wheel, now));
+}
+
+TEST(LeaseTimerWheelTest, RenewAddStaleEntry) {
+  int64_t now = 1000000;
+  LeaseTimerWheel wheel(now);
+
+  // Renew add a new entry, the old entry is still due and dropped by caller.
+  wheel.Add(1, now + 3);
+  wheel.Add(1, now + 70);
+  EXPECT_EQ(std::vector<int64_t>({1}), DueLeaseIds(wheel, now + 3));
+  EXPECT_TRUE(DueLeaseIds(wheel, now + 69).empty());
+  EXPECT_EQ(std::vector<int64_t>({1}), DueLeaseIds(wheel, now + 70));
+}
+
+TEST(LeaseTimerWheelTest, ClockJump) {
+  int64_t now = 1000000;
+  LeaseTimerWheel wheel(now);
+
+  wheel.Add(1, now + 10);
+  wheel.Add(2, now + 1000000);
+
+  // Jump beyond the wheel range.
+  EXPECT_EQ(std::vector<int64_t>({1}), DueLeaseIds(wheel, now + 500000));
+  EXPECT_EQ(1, wheel.Size());
+  EXPECT_TRUE(DueLeaseIds(wheel, now + 999999).empty());
+  EXPECT_EQ(std::vector<int64_t>({2}), DueLeaseIds(wheel, now + 1000000));
+
+  wheel.Add(3, now + 1000010);
+  wheel.Clear(now + 1000001);
+  EXPECT_EQ(0, wheel.Size());
+  EXPECT_TRUE(DueLeaseIds(wheel, now + 1000010).empty());
+}
+
+}  // namespace dingodb
@@ -204,6 +204,41 @@ TEST_F(RawRocksEngineTest, CastValue) {
   }
 }
 
+TEST_F(RawRocksEngineTest, TxnKeyPrefixTransform) {
+  rocks::TxnKeyPrefixTransform transform;
+
+  for (const std::string &key : {std::string("a"), std::string("abcdefgh"), std::string("abcdefghijklmnopq")}) {
+    std::string txn_key = Helper::EncodeTxnKey(key, 100);
+    ASSERT_TRUE(transform.InDomain(txn_key));
+    EXPECT_EQ(Helper::PaddingUserKey(key), transform.Transform(txn_key).ToString());
+
+    // All versions of a key share one prefix.
+    EXPECT_EQ(transform.Transform(txn_key).ToString(), transform.Transform(Helper::EncodeTxnKey(key, 1)).ToString());
+  }
+
+  // Not txn key.
+  EXPECT_FALSE(transform.InDomain("abcdefgh"));
+  EXPECT_FALSE(transform.InDomain(Helper::PaddingUserKey("abcdefgh")));
+  EXPECT_FALSE(transform.InDomain(std::string(17, '\xff')));
+  EXPECT_FALSE(transform.InDomain(std::string(26, 'a')));
+}
+
+TEST_F(RawRocksEngineTest, VectorKeyPrefixTransform) {
+  rocks::VectorKeyPrefixTransform transform;
+
+  std::string vector_key = "r" + std::string(16, '\x01');
+  ASSERT_TRUE(transform.InDomain(vector_key));
+  EXPECT_EQ(vector_key, transform.Transform(vector_key).ToString());
+  ASSERT_TRUE(transform.InDomain(vector_key + "scalar_key"));
+  EXPECT_EQ(vector_key, transform.Transform(vector_key + "scalar_key").ToString());
+
+  EXPECT_FALSE(transform.InDomain(vector_key.substr(0, 9)));
+
+  size_t len = 0;
+  EXPECT_TRUE(transform.FullLengthEnabled(&len));
+  EXPECT_EQ(vector_key.size(), len);
+}
+
 TEST_F(RawRocksEngineTest, GetName) {
   std::string name = RawRocksEngineTest::engine->GetName();
   EXPECT_EQ(name, "RAW_ENG_ROCKSDB");
@@ -446,3 +446,76 @@ TEST(DingoSafeStdMapTest, DingoSafeStdMapGetRangeKeyValues) {
   EXPECT_EQ(keys.size(), values.size());
   EXPECT_EQ(keys.size(), 5);
 }
+
+TEST(DingoSafeStdMapTest, DingoSafeStdMapTraverseRange) {
+  dingodb::DingoSafeStdMap<int64_t, std::string> safe_map;
+
+  for (int64_t i = 0; i < 100; ++i) {
+    safe_map.Put(i, std::to_string(i));
+  }
+
+  std::vector<int64_t> keys;
+  auto ret = safe_map.TraverseRange(10, 20, [&keys](const int64_t& key, const std::string& value) -> bool {
+    EXPECT_EQ(std::to_string(key), value);
+    keys.push_back(key);
+    return true;
+  });
+  EXPECT_EQ(ret, 10);
+  EXPECT_EQ(keys.size(), 10);
+  EXPECT_EQ(keys.front(), 10);
+  EXPECT_EQ(keys.back(), 19);
+
+  // stop by visitor
+  keys.clear();
+  ret = safe_map.TraverseRange(10, 20, [&keys](const int64_t& key, const std::string& /*value*/) -> bool {
+    keys.push_back(key);
+    return keys.size() < 3;
+  });
+  EXPECT_EQ(ret, 3);
+  EXPECT_EQ(keys.size(), 3);
+
+  ret = safe_map.TraverseRange(200, 300, [](const int64_t&, const std::string&) -> bool { return true; });
+  EXPECT_EQ(ret, 0);
+}
+
+TEST(DingoSafeMapTest, DingoSafeMapTraverse) {
+  dingodb::DingoSafeMap<int64_t, int64_t> safe_map;
+  safe_map.Init(1000);
+
+  for (int64_t i = 0; i < 100; ++i) {
+    safe_map.Put(i, i * 2);
+  }
+
+  int64_t sum = 0;
+  auto ret = safe_map.Traverse([&sum](const int64_t& key, const int64_t& value) -> bool {
+    EXPECT_EQ(key * 2, value);
+    sum += value;
+    return true;
+  });
+  EXPECT_EQ(ret, 100);
+  EXPECT_EQ(sum, 9900);
+
+  // stop by visitor
+  int count = 0;
+  ret = safe_map.Traverse([&count](const int64_t&, const int64_t&) -> bool { return ++count < 5; });
+  EXPECT_EQ(ret, 5);
+}
+
+TEST(DingoSafeStdMapTest, DingoSafeStdMapTraverse) {
+  dingodb::DingoSafeStdMap<int64_t, std::string> safe_map;
+
+  for (int64_t i = 99; i >= 0; --i) {
+    safe_map.Put(i, std::to_string(i));
+  }
+
+  std::vector<int64_t> keys;
+  auto ret = safe_map.Traverse([&keys](const int64_t& key, const std::string& value) -> bool {
+    EXPECT_EQ(std::to_string(key), value);
+    keys.push_back(key);
+    return key < 9;
+  });
+  EXPECT_EQ(ret, 10);
+  EXPECT_EQ(keys.size(), 10);
+  EXPECT_EQ(keys.front(), 0);
+  EXPECT_EQ(keys.back(), 9);
+}
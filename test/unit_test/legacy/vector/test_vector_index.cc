@@ -15,11 +15,14 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <random>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -142,6 +145,63 @@ TEST_F(VectorIndexWrapperTest, Add_Sibling) {
   EXPECT_EQ(1499, count);
 }
 
+TEST_F(VectorIndexWrapperTest, FreezeWrite) {
+  int64_t id = 1;
+  pb::common::VectorIndexParameter index_parameter;
+  index_parameter.set_vector_index_type(::dingodb::pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW);
+  index_parameter.mutable_hnsw_parameter()->set_dimension(64);
+  index_parameter.mutable_hnsw_parameter()->set_metric_type(::dingodb::pb::common::MetricType::METRIC_TYPE_L2);
+  index_parameter.mutable_hnsw_parameter()->set_efconstruction(200);
+  index_parameter.mutable_hnsw_parameter()->set_max_elements(10000);
+  index_parameter.mutable_hnsw_parameter()->set_nlinks(16);
+
+  auto vector_index =
+      VectorIndexFactory::NewHnsw(id, index_parameter, GenEpoch(10), GenRange(1, 1000), vector_index_thread_pool);
+
+  auto vector_index_wrapper = VectorIndexWrapper::New(id, index_parameter);
+  vector_index_wrapper->UpdateVectorIndex(vector_index, "unit test");
+  vector_index_wrapper->SetApplyLogId(100);
+
+  auto status = vector_index_wrapper->Upsert(GenVectorWithIds(1, 100, 64));
+  EXPECT_EQ(true, status.ok());
+
+  // write after freeze wait until unfreeze, search see the frozen index.
+  EXPECT_EQ(100, vector_index_wrapper->FreezeWrite());
+  EXPECT_EQ(-1, vector_index_wrapper->FreezeWrite());
+  EXPECT_EQ(true, vector_index_wrapper->IsWriteFrozen());
+
+  std::atomic<bool> is_write_done{false};
+  std::thread write_thread([&]() {
+    auto status = vector_index_wrapper->Upsert(GenVectorWithIds(100, 200, 64), 101);
+    EXPECT_EQ(true, status.ok());
+    status = vector_index_wrapper->Delete({1, 2, 3, 100}, 102);
+    EXPECT_EQ(true, status.ok());
+    is_write_done.store(true);
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  EXPECT_EQ(false, is_write_done.load());
+  EXPECT_EQ(100, vector_index_wrapper->ApplyLogId());
+
+  int64_t count = 0;
+  vector_index_wrapper->GetCount(count);
+  EXPECT_EQ(99, count);
+
+  vector_index_wrapper->UnfreezeWrite();
+  write_thread.join();
+  EXPECT_EQ(true, is_write_done.load());
+  EXPECT_EQ(false, vector_index_wrapper->IsWriteFrozen());
+
+  // apply log id is set with the write.
+  EXPECT_EQ(102, vector_index_wrapper->ApplyLogId());
+
+  int64_t deleted_count = 0;
+  vector_index_wrapper->GetCount(count);
+  vector_index_wrapper->GetDeletedCount(deleted_count);
+  EXPECT_EQ(199, count);
+  EXPECT_EQ(4, deleted_count);
+}
+
 static void MergeSearchResult(uint32_t topk, pb::index::VectorWithDistanceResult& input_1,
                               pb::index::VectorWithDistanceResult& input_2,
                               pb::index::VectorWithDistanceResult& results) {
@@ -284,4 +344,42 @@ TEST_F(VectorIndexWrapperTest, SortFilterFunctorPerformance) {
   std::cout << "query elapsed time: " << dingodb::Helper::TimestampUs() - start_time << std::endl;
 }
 
+TEST_F(VectorIndexWrapperTest, FusedFilterFunctor) {
+  // Dense ids use bitmap.
+  std::vector<int64_t> vector_ids = {3, 5, 7, 9, 11, 100};
+  std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> filters;
+  filters.push_back(std::make_shared<VectorIndex::SortFilterFunctor>(vector_ids));
+  filters.push_back(std::make_shared<VectorIndex::RangeFilterFunctor>(4, 50));
+  filters.push_back(std::make_shared<VectorIndex::RangeFilterFunctor>(0, 10));
+
+  auto fused_filter = VectorIndex::FusedFilterFunctor::Compile(filters);
+  ASSERT_NE(nullptr, fused_filter);
+  EXPECT_EQ(3, fused_filter->IdCount());
+  for (int64_t vector_id = 0; vector_id < 200; ++vector_id) {
+    bool expect = true;
+    for (const auto& filter : filters) {
+      expect = expect && filter->Check(vector_id);
+    }
+    EXPECT_EQ(expect, fused_filter->Check(vector_id)) << vector_id;
+  }
+
+  std::vector<int64_t> allowed_ids;
+  fused_filter->GetAllowedIds(allowed_ids);
+  EXPECT_EQ(std::vector<int64_t>({5, 7, 9}), allowed_ids);
+
+  // Sparse ids use sorted list.
+  vector_ids = {1, 1000000, 2000000};
+  filters.clear();
+  filters.push_back(std::make_shared<VectorIndex::SortFilterFunctor>(vector_ids, true));
+  fused_filter = VectorIndex::FusedFilterFunctor::Compile(filters);
+  ASSERT_NE(nullptr, fused_filter);
+  EXPECT_TRUE(fused_filter->IsNegation());
+  EXPECT_FALSE(fused_filter->Check(1000000));
+  EXPECT_TRUE(fused_filter->Check(1000001));
+
+  // Concrete filter can't fuse.
+  filters.push_back(std::make_shared<VectorIndex::ConcreteFilterFunctor>(std::vector<int64_t>{1}));
+  EXPECT_EQ(nullptr, VectorIndex::FusedFilterFunctor::Compile(filters));
+}
+
 }  // namespace dingodb
@@ -19,14 +19,19 @@
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <memory>
 #include <random>
+#include <set>
+#include <sstream>
+#include <string>
 #include <vector>
 
 #include "butil/status.h"
 #include "faiss/MetricType.h"
 #include "fmt/core.h"
+#include "gflags/gflags.h"
 #include "proto/common.pb.h"
 #include "proto/error.pb.h"
 #include "proto/index.pb.h"
@@ -37,6 +42,12 @@
 
 namespace dingodb {
 
+DECLARE_uint32(hnsw_max_init_max_elements);
+DECLARE_int64(vector_max_batch_count);
+DECLARE_int64(hnsw_parallel_search_min_count);
+DECLARE_bool(hnsw_enable_reorder);
+DECLARE_int64(vector_index_save_rate_limit_mb);
+
 class VectorIndexHnswTest : public testing::Test {
  protected:
   static void SetUpTestSuite() {}
@@ -607,4 +618,556 @@ TEST_F(VectorIndexHnswTest, EfSearchCosine) {
   }
 }
 
+TEST_F(VectorIndexHnswTest, ExpandMaxElements) {
+  static const pb::common::Range kRange;
+
+  auto old_init_max_elements = FLAGS_hnsw_max_init_max_elements;
+  auto old_max_batch_count = FLAGS_vector_max_batch_count;
+  FLAGS_hnsw_max_init_max_elements = 100;
+  FLAGS_vector_max_batch_count = 16;
+
+  pb::common::VectorIndexParameter index_parameter;
+  index_parameter.set_vector_index_type(::dingodb::pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW);
+  index_parameter.mutable_hnsw_parameter()->set_dimension(dimension);
+  index_parameter.mutable_hnsw_parameter()->set_metric_type(::dingodb::pb::common::MetricType::METRIC_TYPE_L2);
+  index_parameter.mutable_hnsw_parameter()->set_efconstruction(efconstruction);
+  index_parameter.mutable_hnsw_parameter()->set_max_elements(100000);
+  index_parameter.mutable_hnsw_parameter()->set_nlinks(16);
+
+  pb::common::RegionEpoch epoch;
+  epoch.set_conf_version(1);
+  epoch.set_version(10);
+
+  auto index = VectorIndexFactory::NewHnsw(2, index_parameter, epoch, kRange, nullptr);
+  ASSERT_NE(index.get(), nullptr);
+  auto *hnsw_index = dynamic_cast<VectorIndexHnsw *>(index.get());
+  ASSERT_NE(hnsw_index, nullptr);
+  EXPECT_EQ(hnsw_index->GetHnswIndex()->getMaxElements(), 100);
+
+  std::mt19937 rng;
+  std::uniform_real_distribution<> distrib;
+
+  const int total_count = 1000;
+  const int batch_size = 50;
+  std::vector<pb::common::VectorWithId> all_vector_with_ids;
+  for (int64_t id = 0; id < total_count; ++id) {
+    pb::common::VectorWithId vector_with_id;
+    vector_with_id.set_id(id);
+    for (size_t i = 0; i < dimension; i++) {
+      vector_with_id.mutable_vector()->add_float_values(distrib(rng));
+    }
+    all_vector_with_ids.push_back(vector_with_id);
+  }
+
+  // grow max elements by resize index
+  for (int start = 0; start < total_count; start += batch_size) {
+    std::vector<pb::common::VectorWithId> vector_with_ids(all_vector_with_ids.begin() + start,
+                                                          all_vector_with_ids.begin() + start + batch_size);
+    auto ok = index->Upsert(vector_with_ids);
+    ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  }
+
+  int64_t count = 0;
+  index->GetCount(count);
+  EXPECT_EQ(count, total_count);
+  EXPECT_GE(hnsw_index->GetHnswIndex()->getMaxElements(), total_count);
+
+  // upsert exist id, count not change
+  {
+    auto ok = index->Upsert({all_vector_with_ids[0]});
+    EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+    index->GetCount(count);
+    EXPECT_EQ(count, total_count);
+  }
+
+  // every vector can find itself
+  for (int64_t id : {0, total_count / 2, total_count - 1}) {
+    std::vector<pb::index::VectorWithDistanceResult> results;
+    auto ok = index->Search({all_vector_with_ids[id]}, 1, {}, false, {}, results);
+    ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+    ASSERT_EQ(results.size(), 1);
+    ASSERT_EQ(results[0].vector_with_distances_size(), 1);
+    EXPECT_EQ(results[0].vector_with_distances(0).vector_with_id().id(), id);
+  }
+
+  // delete vectors inserted before and after expand
+  {
+    auto ok = index->Delete({0, total_count - 1});
+    EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+    int64_t deleted_count = 0;
+    index->GetDeletedCount(deleted_count);
+    EXPECT_EQ(deleted_count, 2);
+  }
+
+  // save and load all segments
+  {
+    std::string path = "./hnsw_segment_expand_test.idx";
+    auto ok = index->Save(path);
+    ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+    auto load_index = VectorIndexFactory::NewHnsw(3, index_parameter, epoch, kRange, nullptr);
+    ok = load_index->Load(path);
+    ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+    int64_t load_count = 0;
+    load_index->GetCount(load_count);
+    EXPECT_EQ(load_count, total_count);
+    EXPECT_EQ(dynamic_cast<VectorIndexHnsw *>(load_index.get())->GetHnswIndex()->getMaxElements(),
+              hnsw_index->GetHnswIndex()->getMaxElements());
+
+    std::remove(path.c_str());
+  }
+
+  FLAGS_hnsw_max_init_max_elements = old_init_max_elements;
+  FLAGS_vector_max_batch_count = old_max_batch_count;
+}
+
+TEST_F(VectorIndexHnswTest, ReuseDeletedSlot) {
+  static const pb::common::Range kRange;
+
+  pb::common::VectorIndexParameter index_parameter;
+  index_parameter.set_vector_index_type(::dingodb::pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW);
+  index_parameter.mutable_hnsw_parameter()->set_dimension(dimension);
+  index_parameter.mutable_hnsw_parameter()->set_metric_type(::dingodb::pb::common::MetricType::METRIC_TYPE_L2);
+  index_parameter.mutable_hnsw_parameter()->set_efconstruction(efconstruction);
+  index_parameter.mutable_hnsw_parameter()->set_max_elements(10000);
+  index_parameter.mutable_hnsw_parameter()->set_nlinks(16);
+
+  pb::common::RegionEpoch epoch;
+  epoch.set_conf_version(1);
+  epoch.set_version(10);
+
+  auto index = VectorIndexFactory::NewHnsw(5, index_parameter, epoch, kRange, nullptr);
+  ASSERT_NE(index.get(), nullptr);
+
+  std::mt19937 rng;
+  std::uniform_real_distribution<> distrib;
+
+  const int total_count = 1000;
+  std::vector<pb::common::VectorWithId> vector_with_ids;
+  for (int64_t id = 0; id < total_count * 2; ++id) {
+    pb::common::VectorWithId vector_with_id;
+    vector_with_id.set_id(id);
+    for (size_t i = 0; i < dimension; i++) {
+      vector_with_id.mutable_vector()->add_float_values(distrib(rng));
+    }
+    vector_with_ids.push_back(vector_with_id);
+  }
+
+  auto ok = index->Upsert({vector_with_ids.begin(), vector_with_ids.begin() + total_count});
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  // delete half, deleted vector is not returned
+  std::vector<int64_t> delete_ids;
+  for (int64_t id = 0; id < total_count / 2; ++id) {
+    delete_ids.push_back(id);
+  }
+  ok = index->Delete(delete_ids);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  int64_t deleted_count = 0;
+  index->GetDeletedCount(deleted_count);
+  EXPECT_EQ(deleted_count, total_count / 2);
+
+  std::vector<pb::index::VectorWithDistanceResult> results;
+  ok = index->Search({vector_with_ids[0]}, 10, {}, false, {}, results);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  ASSERT_EQ(results.size(), 1);
+  for (const auto &vector_with_distance : results[0].vector_with_distances()) {
+    EXPECT_GE(vector_with_distance.vector_with_id().id(), total_count / 2);
+  }
+
+  // new vector reuse the deleted slot, the element count not grow
+  ok = index->Upsert({vector_with_ids.begin() + total_count, vector_with_ids.begin() + total_count * 3 / 2});
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  int64_t count = 0;
+  index->GetCount(count);
+  EXPECT_EQ(count, total_count);
+  index->GetDeletedCount(deleted_count);
+  EXPECT_EQ(deleted_count, 0);
+
+  // every live vector can find itself
+  for (int64_t id : {total_count / 2, total_count - 1, total_count, total_count * 3 / 2 - 1}) {
+    results.clear();
+    ok = index->Search({vector_with_ids[id]}, 1, {}, false, {}, results);
+    ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+    ASSERT_EQ(results.size(), 1);
+    ASSERT_EQ(results[0].vector_with_distances_size(), 1);
+    EXPECT_EQ(results[0].vector_with_distances(0).vector_with_id().id(), id);
+  }
+}
+
+TEST_F(VectorIndexHnswTest, DeleteThenReUpsert) {
+  static const pb::common::Range kRange;
+
+  pb::common::VectorIndexParameter index_parameter;
+  index_parameter.set_vector_index_type(::dingodb::pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW);
+  index_parameter.mutable_hnsw_parameter()->set_dimension(dimension);
+  index_parameter.mutable_hnsw_parameter()->set_metric_type(::dingodb::pb::common::MetricType::METRIC_TYPE_L2);
+  index_parameter.mutable_hnsw_parameter()->set_efconstruction(efconstruction);
+  index_parameter.mutable_hnsw_parameter()->set_max_elements(10000);
+  index_parameter.mutable_hnsw_parameter()->set_nlinks(16);
+
+  pb::common::RegionEpoch epoch;
+  epoch.set_conf_version(1);
+  epoch.set_version(10);
+
+  auto index = VectorIndexFactory::NewHnsw(6, index_parameter, epoch, kRange, nullptr);
+  ASSERT_NE(index.get(), nullptr);
+
+  std::mt19937 rng;
+  std::uniform_real_distribution<> distrib;
+
+  const int total_count = 200;
+  std::vector<pb::common::VectorWithId> vector_with_ids;
+  for (int64_t id = 0; id < total_count; ++id) {
+    pb::common::VectorWithId vector_with_id;
+    vector_with_id.set_id(id);
+    for (size_t i = 0; i < dimension; i++) {
+      vector_with_id.mutable_vector()->add_float_values(distrib(rng));
+    }
+    vector_with_ids.push_back(vector_with_id);
+  }
+
+  auto ok = index->Upsert(vector_with_ids);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  ok = index->Delete({0, 1, 2});
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  int64_t deleted_count = 0;
+  index->GetDeletedCount(deleted_count);
+  EXPECT_EQ(deleted_count, 3);
+
+  // re-upsert deleted label with new vector, one of them twice in the batch
+  std::vector<pb::common::VectorWithId> re_upsert_vector_with_ids;
+  for (int64_t id : {0, 1, 1}) {
+    pb::common::VectorWithId vector_with_id;
+    vector_with_id.set_id(id);
+    for (size_t i = 0; i < dimension; i++) {
+      vector_with_id.mutable_vector()->add_float_values(distrib(rng));
+    }
+    re_upsert_vector_with_ids.push_back(vector_with_id);
+  }
+  ok = index->Upsert(re_upsert_vector_with_ids);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  int64_t count = 0;
+  index->GetCount(count);
+  EXPECT_EQ(count, total_count);
+  index->GetDeletedCount(deleted_count);
+  EXPECT_EQ(deleted_count, 1);
+
+  // re-upserted label is alive with the new vector, the still deleted one is not returned
+  for (const auto &vector_with_id : {re_upsert_vector_with_ids[0], re_upsert_vector_with_ids[2]}) {
+    std::vector<pb::index::VectorWithDistanceResult> results;
+    ok = index->Search({vector_with_id}, 1, {}, false, {}, results);
+    ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+    ASSERT_EQ(results.size(), 1);
+    ASSERT_EQ(results[0].vector_with_distances_size(), 1);
+    EXPECT_EQ(results[0].vector_with_distances(0).vector_with_id().id(), vector_with_id.id());
+  }
+
+  std::vector<pb::index::VectorWithDistanceResult> results;
+  ok = index->Search({vector_with_ids[2]}, 10, {}, false, {}, results);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  ASSERT_EQ(results.size(), 1);
+  for (const auto &vector_with_distance : results[0].vector_with_distances()) {
+    EXPECT_NE(vector_with_distance.vector_with_id().id(), 2);
+  }
+}
+
+TEST_F(VectorIndexHnswTest, ParallelSearch) {
+  static const pb::common::Range kRange;
+
+  auto old_parallel_search_min_count = FLAGS_hnsw_parallel_search_min_count;
+
+  pb::common::VectorIndexParameter index_parameter;
+  index_parameter.set_vector_index_type(::dingodb::pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW);
+  index_parameter.mutable_hnsw_parameter()->set_dimension(dimension);
+  index_parameter.mutable_hnsw_parameter()->set_metric_type(::dingodb::pb::common::MetricType::METRIC_TYPE_L2);
+  index_parameter.mutable_hnsw_parameter()->set_efconstruction(efconstruction);
+  index_parameter.mutable_hnsw_parameter()->set_max_elements(10000);
+  index_parameter.mutable_hnsw_parameter()->set_nlinks(16);
+
+  pb::common::RegionEpoch epoch;
+  epoch.set_conf_version(1);
+  epoch.set_version(10);
+
+  auto thread_pool = std::make_shared<ThreadPool>("vector_index", 4);
+  auto index = VectorIndexFactory::NewHnsw(8, index_parameter, epoch, kRange, thread_pool);
+  ASSERT_NE(index.get(), nullptr);
+
+  std::mt19937 rng;
+  std::uniform_real_distribution<> distrib;
+
+  std::vector<pb::common::VectorWithId> vector_with_ids;
+  for (int64_t id = 0; id < 1000; ++id) {
+    pb::common::VectorWithId vector_with_id;
+    vector_with_id.set_id(id);
+    for (size_t i = 0; i < dimension; i++) {
+      vector_with_id.mutable_vector()->add_float_values(distrib(rng));
+    }
+    vector_with_ids.push_back(vector_with_id);
+  }
+  auto ok = index->Upsert(vector_with_ids);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  // deleted vector is skipped by parallel search too
+  ok = index->Delete({1});
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  const uint32_t topk = 10;
+  pb::common::VectorSearchParameter parameter;
+  parameter.mutable_hnsw()->set_efsearch(64);
+  for (int64_t id : {0, 500, 999}) {
+    FLAGS_hnsw_parallel_search_min_count = INT64_MAX;
+    std::vector<pb::index::VectorWithDistanceResult> serial_results;
+    ok = index->Search({vector_with_ids[id]}, topk, {}, false, parameter, serial_results);
+    ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+    FLAGS_hnsw_parallel_search_min_count = 0;
+    std::vector<pb::index::VectorWithDistanceResult> parallel_results;
+    ok = index->Search({vector_with_ids[id]}, topk, {}, false, parameter, parallel_results);
+    ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+    ASSERT_EQ(serial_results.size(), 1);
+    ASSERT_EQ(parallel_results.size(), 1);
+    ASSERT_EQ(parallel_results[0].vector_with_distances_size(), topk);
+    EXPECT_EQ(parallel_results[0].vector_with_distances(0).vector_with_id().id(), id);
+
+    // the beam visit other path than serial search, so compare the recall instead of the order
+    std::set<int64_t> serial_ids;
+    for (const auto &vector_with_distance : serial_results[0].vector_with_distances()) {
+      serial_ids.insert(vector_with_distance.vector_with_id().id());
+    }
+    int same_count = 0;
+    float last_distance = 0.0f;
+    for (const auto &vector_with_distance : parallel_results[0].vector_with_distances()) {
+      EXPECT_NE(vector_with_distance.vector_with_id().id(), 1);
+      EXPECT_GE(vector_with_distance.distance(), last_distance);
+      last_distance = vector_with_distance.distance();
+      same_count += serial_ids.count(vector_with_distance.vector_with_id().id());
+    }
+    EXPECT_GE(same_count, static_cast<int>(topk) * 8 / 10);
+  }
+
+  FLAGS_hnsw_parallel_search_min_count = old_parallel_search_min_count;
+}
+
+TEST_F(VectorIndexHnswTest, WarmUpReorder) {
+  static const pb::common::Range kRange;
+
+  auto old_enable_reorder = FLAGS_hnsw_enable_reorder;
+  FLAGS_hnsw_enable_reorder = true;
+
+  pb::common::VectorIndexParameter index_parameter;
+  index_parameter.set_vector_index_type(::dingodb::pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW);
+  index_parameter.mutable_hnsw_parameter()->set_dimension(dimension);
+  index_parameter.mutable_hnsw_parameter()->set_metric_type(::dingodb::pb::common::MetricType::METRIC_TYPE_L2);
+  index_parameter.mutable_hnsw_parameter()->set_efconstruction(efconstruction);
+  index_parameter.mutable_hnsw_parameter()->set_max_elements(10000);
+  index_parameter.mutable_hnsw_parameter()->set_nlinks(16);
+
+  pb::common::RegionEpoch epoch;
+  epoch.set_conf_version(1);
+  epoch.set_version(10);
+
+  auto index = VectorIndexFactory::NewHnsw(7, index_parameter, epoch, kRange, nullptr);
+  ASSERT_NE(index.get(), nullptr);
+
+  std::mt19937 rng;
+  std::uniform_real_distribution<> distrib;
+
+  std::vector<pb::common::VectorWithId> vector_with_ids;
+  for (int64_t id = 0; id < 500; ++id) {
+    pb::common::VectorWithId vector_with_id;
+    vector_with_id.set_id(id);
+    for (size_t i = 0; i < dimension; i++) {
+      vector_with_id.mutable_vector()->add_float_values(distrib(rng));
+    }
+    vector_with_ids.push_back(vector_with_id);
+  }
+  auto ok = index->Upsert(vector_with_ids);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  ok = index->Delete({0, 1, 2});
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  index->WarmUp();
+
+  int64_t count = 0;
+  int64_t deleted_count = 0;
+  ok = index->GetCount(count);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  ok = index->GetDeletedCount(deleted_count);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(count, 500);
+  EXPECT_EQ(deleted_count, 3);
+
+  pb::common::VectorSearchParameter parameter;
+  parameter.mutable_hnsw()->set_efsearch(64);
+  for (int64_t id : {0, 3, 250, 499}) {
+    std::vector<pb::index::VectorWithDistanceResult> results;
+    ok = index->Search({vector_with_ids[id]}, 1, {}, false, parameter, results);
+    ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+    ASSERT_EQ(results.size(), 1);
+    ASSERT_EQ(results[0].vector_with_distances_size(), 1);
+    if (id < 3) {
+      EXPECT_NE(results[0].vector_with_distances(0).vector_with_id().id(), id);
+    } else {
+      EXPECT_EQ(results[0].vector_with_distances(0).vector_with_id().id(), id);
+    }
+  }
+
+  // Relabeled index still accept write.
+  ok = index->Upsert({vector_with_ids[0], vector_with_ids[250]});
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  ok = index->GetDeletedCount(deleted_count);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(deleted_count, 2);
+
+  FLAGS_hnsw_enable_reorder = old_enable_reorder;
+}
+
+TEST_F(VectorIndexHnswTest, CalibrateSearchParameter) {
+  static const pb::common::Range kRange;
+
+  pb::common::VectorIndexParameter index_parameter;
+  index_parameter.set_vector_index_type(::dingodb::pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW);
+  index_parameter.mutable_hnsw_parameter()->set_dimension(dimension);
+  index_parameter.mutable_hnsw_parameter()->set_metric_type(::dingodb::pb::common::MetricType::METRIC_TYPE_L2);
+  index_parameter.mutable_hnsw_parameter()->set_efconstruction(efconstruction);
+  index_parameter.mutable_hnsw_parameter()->set_max_elements(10000);
+  index_parameter.mutable_hnsw_parameter()->set_nlinks(16);
+
+  pb::common::RegionEpoch epoch;
+  epoch.set_conf_version(1);
+  epoch.set_version(10);
+
+  auto index = VectorIndexFactory::NewHnsw(4, index_parameter, epoch, kRange, nullptr);
+  ASSERT_NE(index.get(), nullptr);
+
+  // not calibrated
+  EXPECT_EQ(index->AdaptiveSearchParameter(10), 0);
+
+  std::mt19937 rng;
+  std::uniform_real_distribution<> distrib;
+
+  std::vector<pb::common::VectorWithId> vector_with_ids;
+  for (int64_t id = 0; id < 2000; ++id) {
+    pb::common::VectorWithId vector_with_id;
+    vector_with_id.set_id(id);
+    for (size_t i = 0; i < dimension; i++) {
+      vector_with_id.mutable_vector()->add_float_values(distrib(rng));
+    }
+    vector_with_ids.push_back(vector_with_id);
+  }
+
+  auto ok = index->Upsert(vector_with_ids);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  std::vector<pb::common::VectorWithId> samples(vector_with_ids.begin(), vector_with_ids.begin() + 50);
+  ok = index->CalibrateSearchParameter(samples, 0.9);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  int32_t efsearch = index->AdaptiveSearchParameter(10);
+  EXPECT_GE(efsearch, 16);
+  EXPECT_LE(efsearch, VectorIndexHnsw::kMaxEfSearch);
+  // larger topk scale the calibrated parameter
+  EXPECT_EQ(index->AdaptiveSearchParameter(30), efsearch * 3);
+
+  // search without efsearch use the calibrated one
+  std::vector<pb::index::VectorWithDistanceResult> results;
+  ok = index->Search({vector_with_ids[100]}, 10, {}, false, {}, results);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_EQ(results[0].vector_with_distances(0).vector_with_id().id(), 100);
+
+  // the raw calibrated parameter is persisted with snapshot, and restored to the loaded index
+  EXPECT_EQ(index->CalibratedSearchParameter(), efsearch);
+  auto loaded_index = VectorIndexFactory::NewHnsw(5, index_parameter, epoch, kRange, nullptr);
+  ASSERT_NE(loaded_index.get(), nullptr);
+  loaded_index->SetCalibratedSearchParameter(index->CalibratedSearchParameter());
+  EXPECT_EQ(loaded_index->AdaptiveSearchParameter(10), efsearch);
+  EXPECT_EQ(loaded_index->AdaptiveSearchParameter(30), efsearch * 3);
+}
+
+static std::string ReadFileContent(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
+
+TEST_F(VectorIndexHnswTest, SaveWithRateLimitAndToBuffer) {
+  static const pb::common::Range kRange;
+
+  pb::common::VectorIndexParameter index_parameter;
+  index_parameter.set_vector_index_type(::dingodb::pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW);
+  index_parameter.mutable_hnsw_parameter()->set_dimension(dimension);
+  index_parameter.mutable_hnsw_parameter()->set_metric_type(::dingodb::pb::common::MetricType::METRIC_TYPE_L2);
+  index_parameter.mutable_hnsw_parameter()->set_efconstruction(efconstruction);
+  index_parameter.mutable_hnsw_parameter()->set_max_elements(1000);
+  index_parameter.mutable_hnsw_parameter()->set_nlinks(16);
+
+  pb::common::RegionEpoch epoch;
+  epoch.set_conf_version(1);
+  epoch.set_version(10);
+
+  auto index = VectorIndexFactory::NewHnsw(6, index_parameter, epoch, kRange, nullptr);
+  ASSERT_NE(index.get(), nullptr);
+
+  std::mt19937 rng;
+  std::uniform_real_distribution<> distrib;
+  std::vector<pb::common::VectorWithId> vector_with_ids;
+  for (int64_t id = 0; id < 500; ++id) {
+    pb::common::VectorWithId vector_with_id;
+    vector_with_id.set_id(id);
+    for (size_t i = 0; i < dimension; i++) {
+      vector_with_id.mutable_vector()->add_float_values(distrib(rng));
+    }
+    vector_with_ids.push_back(vector_with_id);
+  }
+  auto ok = index->Upsert(vector_with_ids);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  auto old_rate_limit = FLAGS_vector_index_save_rate_limit_mb;
+
+  std::string path = "./hnsw_save_test.idx";
+  std::string rate_limit_path = "./hnsw_save_rate_limit_test.idx";
+  std::string buffer_path = "./hnsw_save_buffer_test.idx";
+
+  FLAGS_vector_index_save_rate_limit_mb = 0;
+  ok = index->Save(path);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  // rate limited save write the same file as hnswlib.
+  FLAGS_vector_index_save_rate_limit_mb = 1024;
+  ok = index->Save(rate_limit_path);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(ReadFileContent(path), ReadFileContent(rate_limit_path));
+
+  // save to buffer then flush also write the same file.
+  VectorIndexSaveBuffer save_buffer;
+  ok = index->SaveToBuffer(buffer_path, save_buffer);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(save_buffer.Size(), static_cast<int64_t>(ReadFileContent(path).size()));
+  ok = save_buffer.Flush(VectorIndexUtils::SaveRateLimit());
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(ReadFileContent(path), ReadFileContent(buffer_path));
+
+  auto load_index = VectorIndexFactory::NewHnsw(7, index_parameter, epoch, kRange, nullptr);
+  ok = load_index->Load(buffer_path);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  int64_t count = 0;
+  load_index->GetCount(count);
+  EXPECT_EQ(count, 500);
+
+  FLAGS_vector_index_save_rate_limit_mb = old_rate_limit;
+  std::remove(path.c_str());
+  std::remove(rate_limit_path.c_str());
+  std::remove(buffer_path.c_str());
+}
+
 }  // namespace dingodb
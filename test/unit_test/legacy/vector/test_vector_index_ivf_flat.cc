@@ -1650,4 +1650,108 @@ TEST_F(VectorIndexIvfFlatTest, RangeSearchAfterLoad) {
   }
 }
 
+TEST_F(VectorIndexIvfFlatTest, UpsertAndDeleteBatch) {
+  static const pb::common::Range kRange;
+  static pb::common::RegionEpoch k_epoch;
+  k_epoch.set_conf_version(1);
+  k_epoch.set_version(10);
+
+  pb::common::VectorIndexParameter index_parameter;
+  index_parameter.set_vector_index_type(::dingodb::pb::common::VectorIndexType::VECTOR_INDEX_TYPE_IVF_FLAT);
+  index_parameter.mutable_ivf_flat_parameter()->set_dimension(dimension);
+  index_parameter.mutable_ivf_flat_parameter()->set_metric_type(::dingodb::pb::common::MetricType::METRIC_TYPE_L2);
+  index_parameter.mutable_ivf_flat_parameter()->set_ncentroids(ncentroids);
+  auto vector_index = VectorIndexFactory::NewIvfFlat(2, index_parameter, k_epoch, kRange, vector_index_thread_pool);
+  ASSERT_NE(vector_index.get(), nullptr);
+
+  std::mt19937 rng;
+  std::uniform_real_distribution<> distrib;
+  auto new_vector = [&](int64_t id) {
+    pb::common::VectorWithId vector_with_id;
+    vector_with_id.set_id(id);
+    for (int j = 0; j < dimension; j++) {
+      vector_with_id.mutable_vector()->add_float_values(distrib(rng));
+    }
+    return vector_with_id;
+  };
+
+  std::vector<pb::common::VectorWithId> vector_with_ids;
+  for (int64_t id = 1; id <= 200; ++id) {
+    vector_with_ids.push_back(new_vector(id));
+  }
+
+  auto ok = vector_index->Train(vector_with_ids);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  ok = vector_index->Add(vector_with_ids);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  int64_t count = 0;
+  vector_index->GetCount(count);
+  EXPECT_EQ(count, 200);
+
+  // upsert exist ids replace the old entry, not leave an orphan one.
+  std::vector<pb::common::VectorWithId> upsert_vector_with_ids;
+  for (int64_t id = 1; id <= 50; ++id) {
+    upsert_vector_with_ids.push_back(new_vector(id));
+  }
+  ok = vector_index->Upsert(upsert_vector_with_ids);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  vector_index->GetCount(count);
+  EXPECT_EQ(count, 200);
+
+  pb::common::VectorSearchParameter parameter;
+  parameter.mutable_ivf_flat()->set_nprobe(ncentroids);
+  std::vector<pb::index::VectorWithDistanceResult> results;
+  ok = vector_index->Search({upsert_vector_with_ids[9]}, 1, {}, false, parameter, results);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  ASSERT_EQ(results.size(), 1);
+  ASSERT_EQ(results[0].vector_with_distances_size(), 1);
+  EXPECT_EQ(results[0].vector_with_distances(0).vector_with_id().id(), 10);
+  EXPECT_FLOAT_EQ(results[0].vector_with_distances(0).distance(), 0.0f);
+
+  // delete only remove the hit entries.
+  std::vector<int64_t> delete_ids;
+  for (int64_t id = 1; id <= 50; ++id) {
+    delete_ids.push_back(id);
+  }
+  ok = vector_index->Delete(delete_ids);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  vector_index->GetCount(count);
+  EXPECT_EQ(count, 150);
+
+  ok = vector_index->Delete(delete_ids);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::EVECTOR_INVALID);
+
+  results.clear();
+  ok = vector_index->Search({upsert_vector_with_ids[9]}, 150, {}, false, parameter, results);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_EQ(results[0].vector_with_distances_size(), 150);
+  for (const auto& vector_with_distance : results[0].vector_with_distances()) {
+    EXPECT_GT(vector_with_distance.vector_with_id().id(), 50);
+  }
+
+  // raft apply of add not check exist id, add a duplicate id then delete it, no orphan entry is left.
+  auto duplicate_vector_with_id = new_vector(100);
+  ok = vector_index->Add({duplicate_vector_with_id});
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  vector_index->GetCount(count);
+  EXPECT_EQ(count, 150);
+
+  ok = vector_index->Delete({100});
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  vector_index->GetCount(count);
+  EXPECT_EQ(count, 149);
+
+  for (const auto& query : {duplicate_vector_with_id, vector_with_ids[99]}) {
+    results.clear();
+    ok = vector_index->Search({query}, 149, {}, false, parameter, results);
+    ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+    ASSERT_EQ(results.size(), 1);
+    for (const auto& vector_with_distance : results[0].vector_with_distances()) {
+      EXPECT_NE(vector_with_distance.vector_with_id().id(), 100);
+    }
+  }
+}
+
 }  // namespace dingodb
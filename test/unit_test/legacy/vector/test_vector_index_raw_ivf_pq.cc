@@ -29,6 +29,7 @@
 #include "common/helper.h"
 #include "common/logging.h"
 #include "faiss/MetricType.h"
+#include "gflags/gflags.h"
 #include "proto/common.pb.h"
 #include "proto/error.pb.h"
 #include "proto/index.pb.h"
@@ -37,6 +38,8 @@
 
 namespace dingodb {
 
+DECLARE_bool(ivf_pq_enable_rerank);
+
 static const std::string kTempDataDirectory = "./unit_test/vector_index_raw_ivf_pq";
 
 class VectorIndexRawIvfPqTest : public testing::Test {
@@ -1560,4 +1563,80 @@ TEST_F(VectorIndexRawIvfPqTest, SearchAfterLoad) {
   }
 }
 
+TEST_F(VectorIndexRawIvfPqTest, Rerank) {
+  static const pb::common::Range kRange;
+  pb::common::RegionEpoch epoch;
+  epoch.set_conf_version(1);
+  epoch.set_version(10);
+
+  auto old_enable_rerank = FLAGS_ivf_pq_enable_rerank;
+  FLAGS_ivf_pq_enable_rerank = true;
+
+  pb::common::VectorIndexParameter index_parameter;
+  index_parameter.set_vector_index_type(::dingodb::pb::common::VectorIndexType::VECTOR_INDEX_TYPE_IVF_PQ);
+  index_parameter.mutable_ivf_pq_parameter()->set_dimension(dimension);
+  index_parameter.mutable_ivf_pq_parameter()->set_metric_type(::dingodb::pb::common::MetricType::METRIC_TYPE_L2);
+  index_parameter.mutable_ivf_pq_parameter()->set_ncentroids(16);
+  index_parameter.mutable_ivf_pq_parameter()->set_nsubvector(nsubvector);
+  index_parameter.mutable_ivf_pq_parameter()->set_nbits_per_idx(nbits_per_idx);
+  auto index = std::make_shared<VectorIndexRawIvfPq>(10, index_parameter, epoch, kRange, nullptr);
+
+  std::mt19937 rng;
+  std::uniform_real_distribution<> distrib;
+  std::vector<pb::common::VectorWithId> vector_with_ids;
+  for (int64_t id = 0; id < 4000; ++id) {
+    pb::common::VectorWithId vector_with_id;
+    vector_with_id.set_id(id);
+    for (int j = 0; j < dimension; j++) {
+      vector_with_id.mutable_vector()->add_float_values(distrib(rng));
+    }
+    vector_with_ids.push_back(vector_with_id);
+  }
+
+  auto ok = index->Train(vector_with_ids);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  ok = index->Upsert(vector_with_ids);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  EXPECT_FALSE(index->NeedToRebuild());
+
+  pb::common::VectorSearchParameter parameter;
+  parameter.mutable_ivf_pq()->set_nprobe(16);
+  auto check_search_self = [&](const std::shared_ptr<VectorIndexRawIvfPq>& search_index) {
+    for (int64_t id : {0, 1000, 3999}) {
+      std::vector<pb::index::VectorWithDistanceResult> results;
+      auto ok = search_index->Search({vector_with_ids[id]}, 1, {}, false, parameter, results);
+      ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+      ASSERT_EQ(results.size(), 1);
+      ASSERT_EQ(results[0].vector_with_distances_size(), 1);
+      // exact distance of itself is zero, pq distance is not.
+      EXPECT_EQ(results[0].vector_with_distances(0).vector_with_id().id(), id);
+      EXPECT_NEAR(results[0].vector_with_distances(0).distance(), 0.0f, 1e-3);
+    }
+  };
+  check_search_self(index);
+
+  // side store is saved and loaded with index
+  std::string path = kTempDataDirectory + "/rerank_raw_ivf_pq";
+  ok = index->Save(path);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  auto load_index = std::make_shared<VectorIndexRawIvfPq>(11, index_parameter, epoch, kRange, nullptr);
+  ok = load_index->Load(path);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  EXPECT_FALSE(load_index->NeedToRebuild());
+  check_search_self(load_index);
+
+  // deleted vector is not reranked
+  ok = index->Delete({0});
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  std::vector<pb::index::VectorWithDistanceResult> results;
+  ok = index->Search({vector_with_ids[0]}, 10, {}, false, parameter, results);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  ASSERT_EQ(results.size(), 1);
+  for (const auto& vector_with_distance : results[0].vector_with_distances()) {
+    EXPECT_NE(vector_with_distance.vector_with_id().id(), 0);
+  }
+
+  FLAGS_ivf_pq_enable_rerank = old_enable_rerank;
+}
+
 }  // namespace dingodb
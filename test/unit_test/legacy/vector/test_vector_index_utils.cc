@@ -25,6 +25,8 @@
 #include <vector>
 
 #include "butil/status.h"
+#include "faiss/IndexFlat.h"
+#include "faiss/IndexIVFFlat.h"
 #include "glog/logging.h"
 #include "proto/common.pb.h"
 #include "proto/error.pb.h"
@@ -4018,6 +4020,123 @@ TEST_F(VectorIndexUtilsTest, CalcCosineDistanceByHnswlib) {
   }
 }
 
+TEST_F(VectorIndexUtilsTest, CalcDistanceByBlock) {
+  constexpr int32_t kDimension = 33;
+  std::mt19937 rng;
+  std::uniform_real_distribution<> distrib;
+
+  google::protobuf::RepeatedPtrField<::dingodb::pb::common::Vector> op_left_vectors;
+  google::protobuf::RepeatedPtrField<::dingodb::pb::common::Vector> op_right_vectors;
+  for (size_t i = 0; i < 70; i++) {
+    auto* vector = op_left_vectors.Add();
+    for (int32_t j = 0; j < kDimension; j++) {
+      vector->add_float_values(distrib(rng));
+    }
+  }
+  for (size_t i = 0; i < 9; i++) {
+    auto* vector = op_right_vectors.Add();
+    for (int32_t j = 0; j < kDimension; j++) {
+      vector->add_float_values(distrib(rng));
+    }
+  }
+
+  for (auto algorithm_type : {pb::index::ALGORITHM_FAISS, pb::index::ALGORITHM_HNSWLIB}) {
+    for (auto metric_type : {pb::common::METRIC_TYPE_L2, pb::common::METRIC_TYPE_INNER_PRODUCT,
+                             pb::common::METRIC_TYPE_COSINE}) {
+      std::vector<std::vector<float>> expect_distances;
+      std::vector<::dingodb::pb::common::Vector> expect_left_vectors;
+      std::vector<::dingodb::pb::common::Vector> expect_right_vectors;
+      butil::Status ok;
+      if (algorithm_type == pb::index::ALGORITHM_FAISS) {
+        ok = VectorIndexUtils::CalcDistanceByFaiss(metric_type, op_left_vectors, op_right_vectors, true,
+                                                   expect_distances, expect_left_vectors, expect_right_vectors);
+      } else {
+        ok = VectorIndexUtils::CalcDistanceByHnswlib(metric_type, op_left_vectors, op_right_vectors, true,
+                                                     expect_distances, expect_left_vectors, expect_right_vectors);
+      }
+      EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+      std::vector<std::vector<float>> distances;
+      std::vector<::dingodb::pb::common::Vector> result_op_left_vectors;
+      std::vector<::dingodb::pb::common::Vector> result_op_right_vectors;
+      ok = VectorIndexUtils::CalcDistanceByBlock(algorithm_type, metric_type, kDimension, op_left_vectors,
+                                                 op_right_vectors, true, distances, result_op_left_vectors,
+                                                 result_op_right_vectors, nullptr);
+      EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+      ASSERT_EQ(expect_distances.size(), distances.size());
+      for (size_t i = 0; i < distances.size(); ++i) {
+        ASSERT_EQ(expect_distances[i].size(), distances[i].size());
+        for (size_t j = 0; j < distances[i].size(); ++j) {
+          EXPECT_NEAR(expect_distances[i][j], distances[i][j], 1e-4);
+        }
+      }
+
+      ASSERT_EQ(expect_left_vectors.size(), result_op_left_vectors.size());
+      for (size_t i = 0; i < result_op_left_vectors.size(); ++i) {
+        ASSERT_EQ(kDimension, result_op_left_vectors[i].float_values_size());
+        for (int32_t j = 0; j < kDimension; ++j) {
+          EXPECT_NEAR(expect_left_vectors[i].float_values(j), result_op_left_vectors[i].float_values(j), 1e-6);
+        }
+      }
+      EXPECT_EQ(expect_right_vectors.size(), result_op_right_vectors.size());
+    }
+  }
+}
+
+TEST_F(VectorIndexUtilsTest, RebalanceIvf) {
+  constexpr int32_t kDimension = 8;
+  constexpr size_t kNlist = 8;
+  constexpr size_t kCount = 2000;
+  std::mt19937 rng;
+  std::uniform_real_distribution<> distrib;
+
+  std::vector<float> train_vectors(kNlist * 64 * kDimension);
+  for (auto& value : train_vectors) {
+    value = distrib(rng);
+  }
+
+  faiss::IndexFlatL2 quantizer(kDimension);
+  faiss::IndexIVFFlat index(&quantizer, kDimension, kNlist);
+  index.train(train_vectors.size() / kDimension, train_vectors.data());
+  VectorIndexUtils::EnableIvfDirectMap(&index);
+
+  // All vectors are put into list 0, so it is skewed.
+  std::vector<float> vectors(kCount * kDimension);
+  for (auto& value : vectors) {
+    value = distrib(rng);
+  }
+  std::vector<faiss::idx_t> ids(kCount);
+  std::vector<faiss::idx_t> list_nos(kCount, 0);
+  for (size_t i = 0; i < kCount; ++i) {
+    ids[i] = static_cast<faiss::idx_t>(i + 1);
+  }
+  index.add_core(kCount, vectors.data(), ids.data(), list_nos.data());
+
+  size_t largest_list_no = 0;
+  size_t smallest_list_no = 0;
+  ASSERT_TRUE(VectorIndexUtils::NeedToRebalanceIvf(&index, largest_list_no, smallest_list_no));
+  EXPECT_EQ(0, largest_list_no);
+  EXPECT_NE(0, smallest_list_no);
+
+  auto status = VectorIndexUtils::RebalanceIvf(&index, largest_list_no, smallest_list_no);
+  EXPECT_EQ(status.error_code(), pb::error::Errno::OK);
+
+  EXPECT_EQ(kCount, index.ntotal);
+  EXPECT_LT(index.invlists->list_size(largest_list_no), kCount);
+  EXPECT_GT(index.invlists->list_size(smallest_list_no), 0);
+  EXPECT_EQ(kCount, index.invlists->list_size(largest_list_no) + index.invlists->list_size(smallest_list_no));
+
+  // Vector is still found by id after move.
+  std::vector<float> vector(kDimension);
+  for (size_t i = 0; i < kCount; i += 97) {
+    index.reconstruct(ids[i], vector.data());
+    for (int32_t j = 0; j < kDimension; ++j) {
+      EXPECT_FLOAT_EQ(vectors[i * kDimension + j], vector[j]);
+    }
+  }
+}
+
 TEST_F(VectorIndexUtilsTest, DoCalcL2DistanceByFaiss) {
   // ok
   {
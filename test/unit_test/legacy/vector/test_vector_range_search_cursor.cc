@@ -0,0 +1,329 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "butil/status.h"
+#include "gflags/gflags.h"
+#include "proto/common.pb.h"
+#include "proto/error.pb.h"
+#include "proto/index.pb.h"
+#include "vector/vector_index_factory.h"
+#include "vector/vector_range_search_cursor.h"
+
+namespace dingodb {
+
+DECLARE_int64(vector_range_search_cursor_max_hit_count);
+
+class VectorRangeSearchCursorTest : public testing::Test {
+ protected:
+  static void SetUpTestSuite() { vector_index_thread_pool = std::make_shared<ThreadPool>("vector_index", 4); }
+
+  static void TearDownTestSuite() { vector_index_thread_pool.reset(); }
+
+  inline static ThreadPoolPtr vector_index_thread_pool;
+};
+
+TEST_F(VectorRangeSearchCursorTest, NextPage) {
+  auto& manager = VectorRangeSearchCursorManager::GetInstance();
+  auto cursor = manager.CreateCursor(1, pb::common::METRIC_TYPE_L2);
+  ASSERT_NE(nullptr, cursor);
+  EXPECT_EQ(cursor, manager.FindCursor(cursor->Id()));
+
+  // 3 query vectors, 5 + 0 + 3 hits.
+  std::vector<std::vector<VectorIndex::RangeSearchHit>> hits(3);
+  for (int64_t i = 0; i < 5; ++i) {
+    hits[0].push_back({i, static_cast<float>(i)});
+  }
+  for (int64_t i = 100; i < 103; ++i) {
+    hits[2].push_back({i, static_cast<float>(i)});
+  }
+  std::vector<size_t> loaded_rows;
+  cursor->SetHitLoader(hits.size(), [&](size_t row, VectorRangeSearchCursor::HitChunk& chunk) {
+    loaded_rows.push_back(row);
+    chunk.hits = hits[row];
+    VectorRangeSearchCursor::CutChunk(chunk.hits, chunk);
+    return butil::Status::OK();
+  });
+  EXPECT_EQ(0, cursor->HitCount());
+
+  std::vector<int64_t> fetched_ids;
+  std::vector<pb::index::VectorWithDistanceResult> results;
+  bool has_more = true;
+  int page_count = 0;
+  while (has_more) {
+    ASSERT_TRUE(cursor->NextPage(3, results, has_more).ok());
+    ASSERT_EQ(3, results.size());
+
+    int count = 0;
+    for (const auto& result : results) {
+      for (const auto& vector_with_distance : result.vector_with_distances()) {
+        fetched_ids.push_back(vector_with_distance.vector_with_id().id());
+        ++count;
+      }
+    }
+    EXPECT_LE(count, 3);
+    ++page_count;
+  }
+
+  // Every row is loaded once and only when the page reach it.
+  EXPECT_EQ(3, page_count);
+  EXPECT_EQ((std::vector<size_t>{0, 1, 2}), loaded_rows);
+  EXPECT_EQ(8, cursor->HitCount());
+  EXPECT_EQ(8, fetched_ids.size());
+  EXPECT_EQ(0, cursor->RemainHitCount());
+  EXPECT_EQ(102, fetched_ids.back());
+
+  manager.DeleteCursor(cursor->Id());
+  EXPECT_EQ(nullptr, manager.FindCursor(cursor->Id()));
+  EXPECT_TRUE(cursor->IsRecyclable());
+}
+
+TEST_F(VectorRangeSearchCursorTest, NextPageLoadFailed) {
+  auto& manager = VectorRangeSearchCursorManager::GetInstance();
+  auto cursor = manager.CreateCursor(1, pb::common::METRIC_TYPE_L2);
+  ASSERT_NE(nullptr, cursor);
+
+  cursor->SetHitLoader(2, [](size_t row, VectorRangeSearchCursor::HitChunk& chunk) {
+    if (row == 1) {
+      return butil::Status(pb::error::EINTERNAL, "load failed");
+    }
+    chunk.hits = {{1, 0.1F}, {2, 0.2F}};
+    VectorRangeSearchCursor::CutChunk(chunk.hits, chunk);
+    return butil::Status::OK();
+  });
+
+  std::vector<pb::index::VectorWithDistanceResult> results;
+  bool has_more = false;
+  ASSERT_TRUE(cursor->NextPage(2, results, has_more).ok());
+  EXPECT_TRUE(has_more);
+  EXPECT_EQ(2, results[0].vector_with_distances_size());
+
+  EXPECT_EQ(pb::error::EINTERNAL, cursor->NextPage(2, results, has_more).error_code());
+
+  manager.DeleteCursor(cursor->Id());
+}
+
+TEST_F(VectorRangeSearchCursorTest, NextPageByChunk) {
+  auto& manager = VectorRangeSearchCursorManager::GetInstance();
+  auto cursor = manager.CreateCursor(1, pb::common::METRIC_TYPE_L2);
+  ASSERT_NE(nullptr, cursor);
+
+  // 2 query vectors, 25 + 7 hits, with same distance to check paging by (distance, id), more than one chunk.
+  std::vector<std::vector<VectorIndex::RangeSearchHit>> hits(2);
+  for (int64_t i = 25; i > 0; --i) {
+    hits[0].push_back({i, static_cast<float>(i / 3)});
+  }
+  for (int64_t i = 100; i < 107; ++i) {
+    hits[1].push_back({i, 1.0F});
+  }
+
+  int64_t old_max_hit_count = FLAGS_vector_range_search_cursor_max_hit_count;
+  FLAGS_vector_range_search_cursor_max_hit_count = 10;
+
+  int load_count = 0;
+  cursor->SetHitLoader(hits.size(), [&](size_t row, VectorRangeSearchCursor::HitChunk& chunk) {
+    ++load_count;
+    chunk.hits = hits[row];
+    VectorRangeSearchCursor::CutChunk(chunk.hits, chunk);
+    EXPECT_LE(chunk.hits.size(), 10U);
+    // Post filter drop the odd id, the chunk is continued from the last hit before filter.
+    chunk.hits.erase(std::remove_if(chunk.hits.begin(), chunk.hits.end(),
+                                    [](const VectorIndex::RangeSearchHit& hit) { return hit.id % 2 == 1; }),
+                     chunk.hits.end());
+    return butil::Status::OK();
+  });
+
+  std::vector<std::vector<VectorIndex::RangeSearchHit>> fetched_hits(hits.size());
+  std::vector<pb::index::VectorWithDistanceResult> results;
+  bool has_more = true;
+  while (has_more) {
+    ASSERT_TRUE(cursor->NextPage(4, results, has_more).ok());
+    ASSERT_EQ(2, results.size());
+    for (size_t row = 0; row < results.size(); ++row) {
+      for (const auto& vector_with_distance : results[row].vector_with_distances()) {
+        fetched_hits[row].push_back({vector_with_distance.vector_with_id().id(), vector_with_distance.distance()});
+      }
+    }
+  }
+
+  FLAGS_vector_range_search_cursor_max_hit_count = old_max_hit_count;
+
+  // 3 chunks of the first row and 1 chunk of the second row.
+  EXPECT_EQ(4, load_count);
+  for (size_t row = 0; row < hits.size(); ++row) {
+    std::vector<VectorIndex::RangeSearchHit> expected_hits;
+    for (const auto& hit : hits[row]) {
+      if (hit.id % 2 == 0) {
+        expected_hits.push_back(hit);
+      }
+    }
+    std::sort(expected_hits.begin(), expected_hits.end());
+
+    ASSERT_EQ(expected_hits.size(), fetched_hits[row].size());
+    for (size_t i = 0; i < expected_hits.size(); ++i) {
+      EXPECT_EQ(expected_hits[i].id, fetched_hits[row][i].id);
+      EXPECT_EQ(expected_hits[i].distance, fetched_hits[row][i].distance);
+    }
+  }
+  EXPECT_EQ(16, cursor->HitCount());
+
+  manager.DeleteCursor(cursor->Id());
+}
+
+TEST_F(VectorRangeSearchCursorTest, FlatRangeSearchHits) {
+  const int dimension = 8;
+  const int data_base_size = 1000;
+
+  pb::common::VectorIndexParameter index_parameter;
+  index_parameter.set_vector_index_type(pb::common::VectorIndexType::VECTOR_INDEX_TYPE_FLAT);
+  index_parameter.mutable_flat_parameter()->set_dimension(dimension);
+  index_parameter.mutable_flat_parameter()->set_metric_type(pb::common::METRIC_TYPE_L2);
+
+  pb::common::RegionEpoch epoch;
+  epoch.set_conf_version(1);
+  epoch.set_version(1);
+  pb::common::Range range;
+
+  auto vector_index = VectorIndexFactory::NewFlat(1, index_parameter, epoch, range, vector_index_thread_pool);
+  ASSERT_NE(nullptr, vector_index);
+
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<> distrib;
+  std::vector<pb::common::VectorWithId> vector_with_ids;
+  for (int64_t id = 1; id <= data_base_size; ++id) {
+    pb::common::VectorWithId vector_with_id;
+    vector_with_id.set_id(id);
+    vector_with_id.mutable_vector()->set_dimension(dimension);
+    vector_with_id.mutable_vector()->set_value_type(pb::common::ValueType::FLOAT);
+    for (int j = 0; j < dimension; ++j) {
+      vector_with_id.mutable_vector()->add_float_values(distrib(rng));
+    }
+    vector_with_ids.push_back(vector_with_id);
+  }
+  ASSERT_TRUE(vector_index->Add(vector_with_ids).ok());
+
+  std::vector<pb::common::VectorWithId> queries(vector_with_ids.begin(), vector_with_ids.begin() + 2);
+  const float radius = 0.5F;
+  pb::common::VectorSearchParameter parameter;
+
+  std::vector<pb::index::VectorWithDistanceResult> results;
+  ASSERT_TRUE(vector_index->RangeSearch(queries, radius, {}, false, parameter, results).ok());
+
+  std::vector<std::vector<VectorIndex::RangeSearchHit>> hits;
+  ASSERT_TRUE(vector_index->RangeSearchHits(queries, radius, {}, parameter, hits).ok());
+
+  ASSERT_EQ(results.size(), hits.size());
+  for (size_t i = 0; i < hits.size(); ++i) {
+    ASSERT_EQ(results[i].vector_with_distances_size(), hits[i].size());
+    std::set<int64_t> ids;
+    for (const auto& vector_with_distance : results[i].vector_with_distances()) {
+      ids.insert(vector_with_distance.vector_with_id().id());
+    }
+    for (const auto& hit : hits[i]) {
+      EXPECT_TRUE(ids.count(hit.id) > 0);
+      EXPECT_LT(hit.distance, radius);
+    }
+  }
+}
+
+TEST_F(VectorRangeSearchCursorTest, HnswRangeSearchHits) {
+  const int dimension = 8;
+  const int data_base_size = 2000;
+
+  pb::common::VectorIndexParameter flat_parameter;
+  flat_parameter.set_vector_index_type(pb::common::VectorIndexType::VECTOR_INDEX_TYPE_FLAT);
+  flat_parameter.mutable_flat_parameter()->set_dimension(dimension);
+  flat_parameter.mutable_flat_parameter()->set_metric_type(pb::common::METRIC_TYPE_L2);
+
+  pb::common::VectorIndexParameter hnsw_parameter;
+  hnsw_parameter.set_vector_index_type(pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW);
+  hnsw_parameter.mutable_hnsw_parameter()->set_dimension(dimension);
+  hnsw_parameter.mutable_hnsw_parameter()->set_metric_type(pb::common::METRIC_TYPE_L2);
+  hnsw_parameter.mutable_hnsw_parameter()->set_efconstruction(200);
+  hnsw_parameter.mutable_hnsw_parameter()->set_max_elements(data_base_size);
+  hnsw_parameter.mutable_hnsw_parameter()->set_nlinks(32);
+
+  pb::common::RegionEpoch epoch;
+  epoch.set_conf_version(1);
+  epoch.set_version(1);
+  pb::common::Range range;
+
+  auto flat_index = VectorIndexFactory::NewFlat(2, flat_parameter, epoch, range, vector_index_thread_pool);
+  ASSERT_NE(nullptr, flat_index);
+  auto hnsw_index = VectorIndexFactory::NewHnsw(3, hnsw_parameter, epoch, range, vector_index_thread_pool);
+  ASSERT_NE(nullptr, hnsw_index);
+
+  std::mt19937 rng(2);
+  std::uniform_real_distribution<> distrib;
+  std::vector<pb::common::VectorWithId> vector_with_ids;
+  for (int64_t id = 1; id <= data_base_size; ++id) {
+    pb::common::VectorWithId vector_with_id;
+    vector_with_id.set_id(id);
+    vector_with_id.mutable_vector()->set_dimension(dimension);
+    vector_with_id.mutable_vector()->set_value_type(pb::common::ValueType::FLOAT);
+    for (int j = 0; j < dimension; ++j) {
+      vector_with_id.mutable_vector()->add_float_values(distrib(rng));
+    }
+    vector_with_ids.push_back(vector_with_id);
+  }
+  ASSERT_TRUE(flat_index->Add(vector_with_ids).ok());
+  ASSERT_TRUE(hnsw_index->Add(vector_with_ids).ok());
+  ASSERT_TRUE(hnsw_index->Delete({1}).ok());
+
+  std::vector<pb::common::VectorWithId> queries(vector_with_ids.begin(), vector_with_ids.begin() + 2);
+  const float radius = 0.3F;
+  pb::common::VectorSearchParameter parameter;
+
+  std::vector<std::vector<VectorIndex::RangeSearchHit>> expected_hits;
+  ASSERT_TRUE(flat_index->RangeSearchHits(queries, radius, {}, parameter, expected_hits).ok());
+  std::vector<std::vector<VectorIndex::RangeSearchHit>> hits;
+  ASSERT_TRUE(hnsw_index->RangeSearchHits(queries, radius, {}, parameter, hits).ok());
+
+  ASSERT_EQ(expected_hits.size(), hits.size());
+  for (size_t i = 0; i < hits.size(); ++i) {
+    std::set<int64_t> expected_ids;
+    for (const auto& hit : expected_hits[i]) {
+      if (hit.id != 1) {
+        expected_ids.insert(hit.id);
+      }
+    }
+
+    // Hits are sorted by distance, in radius and not deleted, and most of the ground truth is found.
+    std::set<int64_t> ids;
+    for (size_t j = 0; j < hits[i].size(); ++j) {
+      EXPECT_NE(1, hits[i][j].id);
+      EXPECT_LT(hits[i][j].distance, radius);
+      if (j > 0) {
+        EXPECT_LE(hits[i][j - 1].distance, hits[i][j].distance);
+      }
+      ids.insert(hits[i][j].id);
+    }
+
+    size_t found = 0;
+    for (auto id : expected_ids) {
+      found += ids.count(id);
+    }
+    EXPECT_GE(found * 10, expected_ids.size() * 9);
+  }
+}
+
+}  // namespace dingodb